@@ -4,10 +4,21 @@
 // include for std::pair
 #include <utility>
 
+#include "../sstl_iterator_base.hpp"
+
 /**
  * @author Xiaoxi
  **/
 
+/**
+ * Concepts:
+ *  - branchless bounds: lower_bound & upper_bound keep the answer in
+ *    [first, first + n] and halve n whatever the comparison says, so the
+ *    loop has no branch to mispredict; the new first is picked by a
+ *    conditional move. A branching binary search mispredicts about every
+ *    other step on random keys.
+ **/
+
 namespace sup {
 template <class ForwardIterator, class T>
 bool binary_search (ForwardIterator first, ForwardIterator last,
@@ -44,57 +55,61 @@ bool binary_search (ForwardIterator first, ForwardIterator last,
 template <class ForwardIterator, class T>
 ForwardIterator upper_bound (ForwardIterator first, ForwardIterator last,
                     const T& val) {
-  while (first < last) {
-    ForwardIterator mid = first + (last - first)/2;
-    if (val < *mid) {
-      last = mid;
-    } else 
-      first = mid + 1;
+  typename sup::iterator_traits<ForwardIterator>::difference_type n =
+    last - first;
+  if (n == 0) return first;
+  while (n > 1) {
+    typename sup::iterator_traits<ForwardIterator>::difference_type half =
+      n / 2;
+    first = !(val < first[half]) ? first + half : first;
+    n -= half;
   }
-  
-  return first;
+  return !(val < *first) ? first + 1 : first;
 }
 
 template <class ForwardIterator, class T, class Comparator>
 ForwardIterator upper_bound (ForwardIterator first, ForwardIterator last,
                     const T& val, Comparator cmp) {
-  while (first < last) {
-    ForwardIterator mid = first + (last - first)/2;
-    if (cmp(val, *mid)) {
-      last = mid;
-    } else 
-      first = mid + 1;
+  typename sup::iterator_traits<ForwardIterator>::difference_type n =
+    last - first;
+  if (n == 0) return first;
+  while (n > 1) {
+    typename sup::iterator_traits<ForwardIterator>::difference_type half =
+      n / 2;
+    first = !cmp(val, first[half]) ? first + half : first;
+    n -= half;
   }
-  
-  return first;
+  return !cmp(val, *first) ? first + 1 : first;
 }
 
 template <class ForwardIterator, class T>
 ForwardIterator lower_bound (ForwardIterator first, ForwardIterator last,
                     const T& val) {
-  while (first < last) {
-    ForwardIterator mid = first + (last - first)/2;
-    if (*mid < val) {
-      first = mid + 1;
-    } else 
-      last = mid;
+  typename sup::iterator_traits<ForwardIterator>::difference_type n =
+    last - first;
+  if (n == 0) return first;
+  while (n > 1) {
+    typename sup::iterator_traits<ForwardIterator>::difference_type half =
+      n / 2;
+    first = first[half] < val ? first + half : first;
+    n -= half;
   }
-  
-  return first;
+  return *first < val ? first + 1 : first;
 }
 
 template <class ForwardIterator, class T, class Comparator>
 ForwardIterator lower_bound (ForwardIterator first, ForwardIterator last,
                     const T& val, Comparator cmp) {
-  while (first < last) {
-    ForwardIterator mid = first + (last - first)/2;
-    if (cmp(*mid, val)) {
-      first = mid + 1;
-    } else 
-      last = mid;
+  typename sup::iterator_traits<ForwardIterator>::difference_type n =
+    last - first;
+  if (n == 0) return first;
+  while (n > 1) {
+    typename sup::iterator_traits<ForwardIterator>::difference_type half =
+      n / 2;
+    first = cmp(first[half], val) ? first + half : first;
+    n -= half;
   }
-  
-  return first;
+  return cmp(*first, val) ? first + 1 : first;
 }
 
 template <class ForwardIterator, class T>
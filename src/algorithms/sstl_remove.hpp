@@ -0,0 +1,128 @@
+#ifndef _SSTL_REMOVE_H
+#define _SSTL_REMOVE_H
+
+#include <type_traits>  // is_trivially_copyable
+#include <utility>      // std::move
+
+#include "../sstl_iterator.hpp"
+
+/**
+ * @author Xiaoxi Sun
+ **/
+
+/**
+ * Concepts:
+ *  - compaction: remove & remove_if move the elements to keep to the front
+ *    in one pass and return the new end; the caller erases [new end, last)
+ *    (erase_if of vector & deque). Erasing the matches one by one shifts
+ *    the tail every time, which is O(n^2).
+ *  - branchless compaction: on pointers to trivially copyable elements each
+ *    element is written to the output unconditionally and the output only
+ *    advances when it is kept. There is no branch to mispredict, which is
+ *    what a branching loop pays for when about half of the elements match.
+ *    It is the scalar form of SIMD "mask & compress"; with an arbitrary
+ *    predicate the mask cannot be computed for a whole register at once.
+ **/
+
+/**
+ * Questions:
+ *  - std::is_trivially_copyable used
+ *  - std::move used
+ **/
+
+namespace sup {
+
+template <class ForwardIterator, class Predicate>
+ForwardIterator find_if(ForwardIterator first, ForwardIterator last,
+                        Predicate pred) {
+  while (first != last && !pred(*first)) ++first;
+  return first;
+}
+
+// the kept elements are moved one by one
+template <bool Branchless>
+struct __remove_if {
+  template <class ForwardIterator, class Predicate>
+  static ForwardIterator _remove_if(ForwardIterator first, ForwardIterator last,
+                                    Predicate pred) {
+    ForwardIterator result = first;
+    for (++first; first != last; ++first) {
+      if (!pred(*first)) {
+        *result = std::move(*first);
+        ++result;
+      }
+    }
+    return result;
+  }
+};
+// trivially copyable elements behind pointers: written unconditionally
+template <>
+struct __remove_if<true> {
+  template <class T, class Predicate>
+  static T* _remove_if(T* first, T* last, Predicate pred) {
+    T* result = first;
+    for (++first; first != last; ++first) {
+      T value = *first;
+      *result = value;
+      result += !pred(value);
+    }
+    return result;
+  }
+};
+
+template <class ForwardIterator>
+struct __branchless_remove : std::false_type {};
+template <class T>
+struct __branchless_remove<T*>
+    : std::integral_constant<bool, std::is_trivially_copyable<T>::value> {};
+
+/**
+ * Remove the elements satisfying pred from [first, last): the others are
+ * moved to the front, in the same order.
+ *
+ * @tparam ForwardIterator - iterator type
+ * @tparam Predicate - unary predicate on the elements
+ * @param first - start position
+ * @param last - end position
+ * @param pred - true for the elements to remove
+ *
+ * @return the end of the kept elements; [result, last) holds moved-from
+ *  (or stale) elements
+ **/
+template <class ForwardIterator, class Predicate>
+ForwardIterator remove_if(ForwardIterator first, ForwardIterator last,
+                          Predicate pred) {
+  first = sup::find_if(first, last, pred);
+  if (first == last) return first;
+  return sup::__remove_if<__branchless_remove<ForwardIterator>::value>::
+      _remove_if(first, last, pred);
+}
+
+// compares to a value, see remove()
+template <class T>
+struct __equal_to_value {
+  const T& value;
+  template <class U>
+  bool operator()(const U& x) const { return x == value; }
+};
+
+/**
+ * Remove the elements equal to value from [first, last) (see remove_if).
+ *
+ * @tparam ForwardIterator - iterator type
+ * @tparam T - value type
+ * @param first - start position
+ * @param last - end position
+ * @param value - the value to remove
+ *
+ * @return the end of the kept elements
+ **/
+template <class ForwardIterator, class T>
+ForwardIterator remove(ForwardIterator first, ForwardIterator last,
+                       const T& value) {
+  return sup::remove_if(first, last, __equal_to_value<T>{value});
+}
+
+}  // namespace sup
+
+#endif
@@ -3,6 +3,7 @@
 
 #include "./algorithms/sstl_binary_operations.hpp"
 #include "./algorithms/sstl_heap.hpp"
+#include "./algorithms/sstl_remove.hpp"
 #include "./algorithms/sstl_set_operations.hpp"
 #include "./algorithms/sstl_sort.hpp"
 
@@ -0,0 +1,223 @@
+#ifndef _SSTL_ALLOC_TELEMETRY_H
+#define _SSTL_ALLOC_TELEMETRY_H
+
+#include <atomic>
+#include <cstdio>
+
+#include "sstl_allocator.hpp"
+
+/**
+ * @author Xiaoxi Sun
+ **/
+
+/**
+ * Concepts:
+ *  telemetry allocator - an allocator adaptor that forwards to Alloc and
+ *   records what goes through it: number of allocations & deallocations,
+ *   bytes (the usable sizes of the blocks), live bytes, the peak of live
+ *   bytes and a histogram of block sizes (powers of two). Give each
+ *   container type (or instance) its own Tag to tell them apart, e.g.
+ *     struct index_tag {};
+ *     sup::unordered_map<K, V, H, E, sup::telemetry_alloc<sup::alloc, index_tag>>
+ *   and read sup::alloc_telemetry<index_tag>::snapshot() later.
+ *
+ *  zero cost when compiled out - define __SSTL_NO_ALLOC_TELEMETRY and
+ *   telemetry_alloc<Alloc, Tag> becomes Alloc itself; snapshots are empty.
+ *
+ *  std::memory_order_relaxed - counters are only summed, never used to
+ *   synchronize, so the cheapest atomic operations are enough.
+ **/
+
+/**
+ * Questions:
+ *  - std::atomic used
+ *  - __builtin_clzl used for the histogram
+ **/
+
+namespace sup {
+
+// number of size classes: [1, 2), [2, 4), ..., [2^31, ...)
+enum { __SSTL_TELEMETRY_BUCKETS = 32 };
+
+// a plain copy of the counters
+struct alloc_stats_snapshot {
+  size_t allocations;
+  size_t deallocations;
+  size_t allocated_bytes;   // total bytes ever allocated
+  size_t live_bytes;
+  size_t peak_bytes;        // the maximum of live_bytes
+  size_t histogram[__SSTL_TELEMETRY_BUCKETS];
+};
+
+/**
+ * @brief counters of one tag
+ */
+class alloc_stats {
+public:
+  alloc_stats() { reset(); }
+
+  // index of the size class of n (n > 0)
+  static size_t size_class(size_t n) {
+    size_t c = sizeof(unsigned long) * 8 - 1 - __builtin_clzl(n);
+    return c < __SSTL_TELEMETRY_BUCKETS ? c : __SSTL_TELEMETRY_BUCKETS - 1;
+  }
+
+  void on_allocate(size_t n) {
+    if (n == 0) return;
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(n, std::memory_order_relaxed);
+    histogram[size_class(n)].fetch_add(1, std::memory_order_relaxed);
+    add_live_bytes(n);
+  }
+
+  void on_deallocate(size_t n) {
+    if (n == 0) return;
+    deallocations.fetch_add(1, std::memory_order_relaxed);
+    live_bytes.fetch_sub(n, std::memory_order_relaxed);
+  }
+
+  alloc_stats_snapshot snapshot() const {
+    alloc_stats_snapshot s;
+    s.allocations = allocations.load(std::memory_order_relaxed);
+    s.deallocations = deallocations.load(std::memory_order_relaxed);
+    s.allocated_bytes = allocated_bytes.load(std::memory_order_relaxed);
+    s.live_bytes = live_bytes.load(std::memory_order_relaxed);
+    s.peak_bytes = peak_bytes.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < __SSTL_TELEMETRY_BUCKETS; ++i)
+      s.histogram[i] = histogram[i].load(std::memory_order_relaxed);
+    return s;
+  }
+
+  // start counting again (the peak restarts from the live bytes)
+  void reset() {
+    allocations = 0;
+    deallocations = 0;
+    allocated_bytes = 0;
+    peak_bytes = live_bytes.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < __SSTL_TELEMETRY_BUCKETS; ++i) histogram[i] = 0;
+  }
+
+private:
+  void add_live_bytes(size_t n) {
+    size_t live = live_bytes.fetch_add(n, std::memory_order_relaxed) + n;
+    size_t peak = peak_bytes.load(std::memory_order_relaxed);
+    while (live > peak &&
+           !peak_bytes.compare_exchange_weak(peak, live,
+                                             std::memory_order_relaxed)) {}
+  }
+
+  std::atomic<size_t> allocations;
+  std::atomic<size_t> deallocations;
+  std::atomic<size_t> allocated_bytes;
+  std::atomic<size_t> live_bytes{0};
+  std::atomic<size_t> peak_bytes;
+  std::atomic<size_t> histogram[__SSTL_TELEMETRY_BUCKETS];
+};
+
+/**
+ * @brief print a snapshot: one line of counters, then the non-empty size
+ *  classes
+ *
+ * @param name - printed in front of the counters
+ * @param s - the snapshot
+ * @param out - where to print
+ */
+inline void report_alloc_stats(const char* name, const alloc_stats_snapshot& s,
+                               FILE* out = stdout) {
+  std::fprintf(out,
+               "%s: %zu allocations, %zu deallocations, %zu bytes allocated, "
+               "%zu live bytes, %zu peak bytes\n",
+               name, s.allocations, s.deallocations, s.allocated_bytes,
+               s.live_bytes, s.peak_bytes);
+  for (size_t i = 0; i < __SSTL_TELEMETRY_BUCKETS; ++i) {
+    if (s.histogram[i] != 0)
+      std::fprintf(out, "  [%zu, %zu) bytes: %zu\n", size_t(1) << i,
+                   size_t(2) << i, s.histogram[i]);
+  }
+}
+
+/**
+ * @brief the counters of Tag
+ *
+ * @tparam Tag - any type naming a container type or instance
+ */
+template <class Tag>
+struct alloc_telemetry {
+  static alloc_stats& stats() {
+    static alloc_stats s;
+    return s;
+  }
+
+  static alloc_stats_snapshot snapshot() {
+#ifdef __SSTL_NO_ALLOC_TELEMETRY
+    return alloc_stats_snapshot();
+#else
+    return stats().snapshot();
+#endif
+  }
+
+  static void reset() { stats().reset(); }
+
+  static void report(const char* name, FILE* out = stdout) {
+    report_alloc_stats(name, snapshot(), out);
+  }
+};
+
+#ifdef __SSTL_NO_ALLOC_TELEMETRY
+
+template <class Alloc=alloc, class Tag=void>
+using telemetry_alloc = Alloc;
+
+#else
+
+/**
+ * @brief the allocator adaptor recording into alloc_telemetry<Tag>
+ *
+ * @tparam Alloc - the underlying allocator
+ * @tparam Tag - the tag of the counters
+ */
+template <class Alloc=alloc, class Tag=void>
+class telemetry_alloc : public Alloc {
+public:
+  telemetry_alloc() {}
+  telemetry_alloc(const Alloc& a) : Alloc(a) {}
+
+  void* allocate(size_t n) {
+    void* p = (void*) Alloc::allocate(n);
+    alloc_telemetry<Tag>::stats().on_allocate(usable_size(p, n));
+    return p;
+  }
+
+  void deallocate(char* p, size_t n) {
+    if (p == nullptr) return;
+    alloc_telemetry<Tag>::stats().on_deallocate(usable_size(p, n));
+    Alloc::deallocate(p, n);
+  }
+
+  void* reallocate(void* p, size_t old_n, size_t new_n) {
+    size_t old_usable = p == nullptr ? 0 : usable_size(p, old_n);
+    void* result = _alloc_reallocate<Alloc>::_reallocate(*this, p, old_n, new_n);
+    alloc_telemetry<Tag>::stats().on_deallocate(old_usable);
+    alloc_telemetry<Tag>::stats().on_allocate(usable_size(result, new_n));
+    return result;
+  }
+
+  // a pure query: nothing is recorded. Blocks are counted by their usable
+  // size when they are allocated and when they are freed.
+  size_t usable_size(void* p, size_t n) {
+    return _alloc_usable_size<Alloc>::_usable_size(*this, p, n);
+  }
+};
+
+template <class Alloc, class Tag>
+struct _alloc_alignment<telemetry_alloc<Alloc, Tag>>
+  : _alloc_alignment<Alloc> {};
+
+// _alloc_bulk_release is not passed through on purpose: containers keep
+// deallocating node by node, so the live bytes stay correct.
+
+#endif
+
+}  // namespace sup
+
+#endif
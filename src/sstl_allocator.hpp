@@ -1,6 +1,9 @@
 #ifndef _SSTL_ALLOCATOR_H
 #define _SSTL_ALLOCATOR_H
 
+#include <cstring>  // memcpy
+#include <utility>  // std::swap
+
 #include "sstl_allocator_base.hpp"
 #include "naiveallocator.hpp"
 
@@ -35,33 +38,228 @@
  *  Swap:
  *   Use __is_empty() to determine whether a allocator is an empty type. This
  *   would save swapping time.
+ *
+ *  allocate_at_least (C++23):
+ *   Returns the block together with the number of objects it can really
+ *   hold, which is at least the number asked for. Growing containers record
+ *   that number as their capacity instead of wasting the rounding of the
+ *   allocator.
+ *
+ *  Stateful allocators:
+ *   A container stores its allocator object (as an empty base when the
+ *   allocator is stateless), so allocators with state, e.g. a pointer to a
+ *   memory resource, can be given to each container.
  **/
 
 /**
  * Questions & Issues:
  *   allocator<void> is not complete
  * 
- *   shrink_to_fit is not implemented here, which was introduced since C++11. 
+ *   shrink_to_fit (since C++11) is a member of the containers: vector,
+ *   small_vector, deque and the hashtable give back unused capacity.
  **/
 
 namespace sup {
 
 class naive_allocator;
 
-#ifdef __SSTL_USE_MALLOC
-#  define __malloc_allocator alloc
-#else
+// The pool is thread safe (with per-thread caches) unless
+// __SSTL_NODE_ALLOCATOR_THREADS is defined as false.
+#ifndef __SSTL_NODE_ALLOCATOR_THREADS
+#  define __SSTL_NODE_ALLOCATOR_THREADS true
+#endif
+
+// The default allocator of all containers. Define __SSTL_USE_MALLOC to
+// bypass the memory pool and use malloc & free directly, or
+// __SSTL_USE_NAIVE_ALLOC to go back to the new & delete wrapper.
+#if defined(__SSTL_USE_MALLOC)
+  typedef malloc_alloc alloc;
+#elif defined(__SSTL_USE_NAIVE_ALLOC)
   typedef naive_allocator alloc;
+#else
+  typedef __simple_default_allocator_template<__SSTL_NODE_ALLOCATOR_THREADS, 0>
+    alloc;
 #endif
 
+// a pool without any lock, for containers used by a single thread only
+typedef __simple_default_allocator_template<false, 0> single_client_alloc;
+
+// there are specialization of allocators
+// even with volatile specifier of a template paramter.
+// check
+// https://www.tutorialspoint.com/What-does-the-volatile-keyword-mean-in-Cplusplus
+// for explanation of the volatile keyword.
+
+// Swap interface of allocators, where __is_empty() is used
+// Note that the naming standard here is contradictary to it in
+// sstl_construct in STL sources.
+template <class Alloc, bool = __is_empty(Alloc)>
+struct _alloc_swap {
+  static void _swap(Alloc&, Alloc&) {}  // just the empty one
+};
+// specialize the non-empty one
+template <class Alloc>
+struct _alloc_swap<Alloc, false> {
+  static void _swap(Alloc& first, Alloc& second) {
+    if (first != second) std::swap(first, second);
+  }
+};
+
+// Compare (not equal) interface of allocators.
+template <class Alloc, bool = __is_empty(Alloc)>
+struct _alloc_neq {
+  // this is for improving efficiency related to stateless
+  // allocators
+  static bool _neq(const Alloc&, const Alloc&) { return false; }
+};
+// partial specialization for non-empty allocators
+template <class Alloc>
+struct _alloc_neq<Alloc, false> {
+  static bool _neq(const Alloc& first, const Alloc& second) {
+    return first != second;
+  }
+};
+
+// Whether deallocate() of Alloc does nothing and the memory is released all
+// at once by its owner (e.g. monotonic_alloc).
+template <class Alloc>
+struct _alloc_bulk_release {
+  static const bool value = false;
+};
+
+// Whether a node container may drop its nodes without visiting them, in
+// clear() & the destructor: deallocating a node does nothing (the arena
+// gets its memory back all at once), and neither does destroying a value
+// of T. Clearing then costs O(1) (O(buckets) for a hashtable) instead of a
+// walk over every node.
+template <class Alloc, class T>
+struct _alloc_skip_node_release {
+  static const bool value =
+    _alloc_bulk_release<Alloc>::value && __has_trivial_destructor(T);
+};
+
+// Whether Alloc can resize a block by reallocate(p, old_n, new_n), like the
+// default pool and malloc_alloc (realloc & mremap).
+template <class Alloc>
+struct _alloc_has_reallocate {
+  template <class A>
+  static char test(decltype(&A::reallocate));
+  template <class A>
+  static long test(...);
+  static const bool value = sizeof(test<Alloc>(nullptr)) == 1;
+};
+
+// Reallocate interface of allocators: allocate, copy & deallocate when Alloc
+// cannot resize a block by itself.
+template <class Alloc, bool = _alloc_has_reallocate<Alloc>::value>
+struct _alloc_reallocate {
+  static void* _reallocate(Alloc& a, void* p, size_t old_n, size_t new_n) {
+    void* result = (void*) a.allocate(new_n);
+    if (p != nullptr) {
+      memcpy(result, p, old_n < new_n ? old_n : new_n);
+      a.deallocate((char*) p, old_n);
+    }
+    return result;
+  }
+};
+template <class Alloc>
+struct _alloc_reallocate<Alloc, true> {
+  static void* _reallocate(Alloc& a, void* p, size_t old_n, size_t new_n) {
+    return (void*) a.reallocate(p, old_n, new_n);
+  }
+};
+
+// Whether Alloc reports the usable size of its blocks by usable_size(p, n).
+template <class Alloc>
+struct _alloc_has_usable_size {
+  template <class A>
+  static char test(decltype(&A::usable_size));
+  template <class A>
+  static long test(...);
+  static const bool value = sizeof(test<Alloc>(nullptr)) == 1;
+};
+
+// Usable size interface of allocators: exactly the requested bytes when
+// Alloc does not tell.
+template <class Alloc, bool = _alloc_has_usable_size<Alloc>::value>
+struct _alloc_usable_size {
+  static size_t _usable_size(Alloc&, void*, size_t n) { return n; }
+};
+template <class Alloc>
+struct _alloc_usable_size<Alloc, true> {
+  static size_t _usable_size(Alloc& a, void* p, size_t n) {
+    return a.usable_size(p, n);
+  }
+};
+
+// the result of allocate_at_least: the block and the number of objects
+template <class Pointer>
+struct allocation_result {
+  Pointer ptr;
+  size_t count;
+};
+
+// The size of a cache line. Blocks of cache_aligned_alloc start on it.
+#ifndef __SSTL_CACHE_LINE_SIZE
+#  define __SSTL_CACHE_LINE_SIZE 64
+#endif
+
+// The alignment of the blocks that an allocator has to give at least. Every
+// allocator here aligns to __SSTL_ALIGN by itself; larger alignments are
+// handled by simple_alloc.
+template <class Alloc>
+struct _alloc_alignment {
+  static const size_t value = __SSTL_ALIGN;
+};
+
+/**
+ * @brief opt-in cache line alignment: every block (vector & deque buffers,
+ *  nodes) allocated through simple_alloc starts on a __SSTL_CACHE_LINE_SIZE
+ *  boundary, so hot data of different containers never shares a cache line
+ *  (false sharing).
+ *
+ * @tparam Alloc - the underlying allocator
+ */
+template <class Alloc=alloc>
+class cache_aligned_alloc : public Alloc {
+public:
+  cache_aligned_alloc() {}
+  cache_aligned_alloc(const Alloc& a) : Alloc(a) {}
+};
+
+template <class Alloc>
+struct _alloc_alignment<cache_aligned_alloc<Alloc>> {
+  static const size_t value = 
+    _alloc_alignment<Alloc>::value > __SSTL_CACHE_LINE_SIZE ?
+    _alloc_alignment<Alloc>::value : __SSTL_CACHE_LINE_SIZE;
+};
+
+template <class Alloc>
+struct _alloc_bulk_release<cache_aligned_alloc<Alloc>>
+  : _alloc_bulk_release<Alloc> {};
+
 template <class T, class Alloc>
 class simple_alloc;
 
-template <class T, class Alloc=naive_allocator>
-class simple_alloc {
+/**
+ * @brief the typed interface used by containers. It allocates objects of T
+ *  through Alloc, which deals with bytes.
+ *
+ *  Alloc might be stateless (all static functions, e.g. alloc) or stateful
+ *  (e.g. polymorphic_alloc, which points to a memory resource). It is stored
+ *  as a private base so that a stateless Alloc takes no space (empty base
+ *  optimization), and Alloc::allocate works for both static and non-static
+ *  functions.
+ *
+ * @tparam T - object type
+ * @tparam Alloc - the underlying byte allocator
+ */
+template <class T, class Alloc=alloc>
+class simple_alloc : private Alloc {
 public:
   typedef T value_type;
   typedef size_t size_type;
+  typedef Alloc alloc_type;
 
   // rebind for other usage.
   template <class T2, class Alloc2>
@@ -75,84 +273,151 @@ public:
    * BConstructors use _GLIBCXX20_CONSTEXPR and _GLIBCXX_NOTHROW
    **/
   simple_alloc() {}
-  simple_alloc(const simple_alloc& a) {}
+  simple_alloc(const simple_alloc& a) : Alloc(a.get_alloc()) {}
+  // implicit, so a container can be given the underlying allocator directly
+  simple_alloc(const Alloc& a) : Alloc(a) {}
 
-  // can be copy constructed by other types of allocators...
-  // although there might not be one...
-  template <class T2, class Alloc2>
-  simple_alloc(const simple_alloc<T2, Alloc2> a) {}
+  // can be copy constructed by allocators of other types, which share the
+  // same underlying allocator (e.g. the map allocator of deque).
+  template <class T2>
+  simple_alloc(const simple_alloc<T2, Alloc>& a) : Alloc(a.get_alloc()) {}
 
   ~simple_alloc() {}
 
-  static T* allocate(const size_t n) {
-    return n == 0 ? nullptr : (T*) Alloc::allocate(n * sizeof(T));
+  simple_alloc& operator=(const simple_alloc& a) {
+    Alloc::operator=(a.get_alloc());
+    return *this;
   }
 
-  static T* allocate() {
-    return (T*) Alloc::allocate(sizeof(T));
+  // the underlying allocator
+  const Alloc& get_alloc() const { return *this; }
+
+  // the alignment of the returned blocks: alignof(T) or the alignment
+  // requested by Alloc, whichever is larger
+  static constexpr size_t alignment() {
+    return alignof(T) > _alloc_alignment<Alloc>::value ?
+      alignof(T) : _alloc_alignment<Alloc>::value;
   }
 
-  static void deallocate(const T* p, const size_type n) {
-    Alloc::deallocate((char*) p, n*sizeof(T));
+  T* allocate(const size_t n) {
+    if (n == 0) return nullptr;
+    if (alignment() <= __SSTL_ALIGN)
+      return (T*) Alloc::allocate(n * sizeof(T));
+    return (T*) aligned_allocate(n * sizeof(T));
   }
 
-  static void deallocate(const T* p) {
-    Alloc::deallocate((char*) p, sizeof(T));
+  T* allocate() {
+    if (alignment() <= __SSTL_ALIGN)
+      return (T*) Alloc::allocate(sizeof(T));
+    return (T*) aligned_allocate(sizeof(T));
+  }
+
+  /**
+   * @brief allocate a block of at least n objects
+   *
+   * @param n - the least number of objects
+   * @return allocation_result<T*> - the block and the number of objects it
+   *  holds; deallocate it with that number
+   */
+  allocation_result<T*> allocate_at_least(const size_type n) {
+    allocation_result<T*> result;
+    result.ptr = allocate(n);
+    result.count = usable_size(result.ptr, n);
+    return result;
+  }
+
+  /**
+   * @brief the number of objects that fit into the block p of n objects
+   *  (allocated or reallocated by this)
+   *
+   * @param p - the block
+   * @param n - the number of objects p was allocated with
+   * @return size_type - at least n
+   */
+  size_type usable_size(T* p, const size_type n) {
+    if (p == nullptr || alignment() > __SSTL_ALIGN) return n;
+    return _alloc_usable_size<Alloc>::_usable_size(*this, p, n * sizeof(T)) /
+      sizeof(T);
+  }
+
+  void deallocate(const T* p, const size_type n) {
+    if (alignment() <= __SSTL_ALIGN)
+      Alloc::deallocate((char*) p, n*sizeof(T));
+    else
+      aligned_deallocate(p, n*sizeof(T));
+  }
+
+  void deallocate(const T* p) {
+    if (alignment() <= __SSTL_ALIGN)
+      Alloc::deallocate((char*) p, sizeof(T));
+    else
+      aligned_deallocate(p, sizeof(T));
+  }
+
+  /**
+   * @brief resize a block of n objects, moving the objects by their bytes.
+   *  Only for trivially relocatable T; callers dispatch on the trait so
+   *  that it is not instantiated for other types. Large blocks are grown
+   *  in place (realloc) or by remapping pages (mremap) when Alloc supports
+   *  it.
+   *
+   * @param p - allocated by this with old_n objects (or nullptr)
+   * @param old_n - the old number of objects
+   * @param new_n - the new number of objects
+   * @return T* - the new block
+   */
+  T* reallocate(T* p, const size_type old_n, const size_type new_n) {
+    if (alignment() <= __SSTL_ALIGN) {
+      return (T*) _alloc_reallocate<Alloc>::_reallocate(
+        *this, p, old_n * sizeof(T), new_n * sizeof(T));
+    }
+    T* result = allocate(new_n);
+    if (p != nullptr) {
+      memcpy((void*) result, (const void*) p,
+             (old_n < new_n ? old_n : new_n) * sizeof(T));
+      deallocate(p, old_n);
+    }
+    return result;
   }
   // Operator = overload here since C++11:
   // allocator interface requirements
-  friend bool operator==(const simple_alloc&, const simple_alloc&) { return true; }
-  friend bool operator!=(const simple_alloc&, const simple_alloc&) { return false; }
+  // Two allocators are equal if memory allocated by one can be deallocated
+  // by the other, which is always true for stateless allocators.
+  friend bool operator==(const simple_alloc& a, const simple_alloc& b) {
+    return !_alloc_neq<Alloc>::_neq(a.get_alloc(), b.get_alloc());
+  }
+  friend bool operator!=(const simple_alloc& a, const simple_alloc& b) {
+    return _alloc_neq<Alloc>::_neq(a.get_alloc(), b.get_alloc());
+  }
 
   // inherit everthing else (! from GNU sources code)
-};
 
-// operator== interfaces
-template <class T1, class Alloc1, class T2, class Alloc2>
-bool operator==(const simple_alloc<T1, Alloc1>&, const simple_alloc<T2, Alloc2>&) {
-  return true;
-}
-template <class T1, class Alloc1, class T2, class Alloc2>
-bool operator!=(const simple_alloc<T1, Alloc1>&, const simple_alloc<T2, Alloc2>&) {
-  return false;
-}
-
-// there are specialization of allocators
-// even with volatile specifier of a template paramter.
-// check
-// https://www.tutorialspoint.com/What-does-the-volatile-keyword-mean-in-Cplusplus
-// for explanation of the volatile keyword.
-
-// Swap interface of allocators, where __is_empty() is used
-// Note that the naming standard here is contradictary to it in
-// sstl_construct in STL sources.
-template <class Alloc, bool = __is_empty(Alloc)>
-struct _alloc_swap {
-  static void _swap(Alloc&, Alloc&) {}  // just the empty one
-};
-// specialize the non-empty one
-template <class Alloc>
-struct _alloc_swap<Alloc, false> {
-  static void _swap(Alloc& first, Alloc& second) {
-    if (first != second) swap(first, second);
+private:
+  // Over-aligned blocks: take alignment() more bytes from Alloc, round the
+  // pointer up, and keep the original pointer right before the block. Alloc
+  // aligns to __SSTL_ALIGN (>= sizeof(void*)), so there is always room.
+  char* aligned_allocate(size_t bytes) {
+    char* raw = (char*) Alloc::allocate(bytes + alignment());
+    char* p = (char*) (((size_t) raw + alignment()) & ~(alignment() - 1));
+    ((char**) p)[-1] = raw;
+    return p;
   }
-};
 
-// Compare (not equal) interface of allocators.
-template <class Alloc, bool = __is_empty(Alloc)>
-struct _alloc_neq {
-  // this is for improving efficiency related to stateless
-  // allocators
-  static bool _neq(Alloc&, Alloc&) { return false; }
-};
-// partial specialization for non-empty allocators
-template <class Alloc>
-struct _alloc_neq<Alloc, false> {
-  static bool _neq(Alloc& first, Alloc& second) { return first != second; }
+  void aligned_deallocate(const T* p, size_t bytes) {
+    if (p == nullptr) return;
+    Alloc::deallocate(((char**) p)[-1], bytes + alignment());
+  }
 };
 
-// There is a shrink_to_fit interface provided since C++11, which is 
-// not shown here. 
+// operator== interfaces
+template <class T1, class T2, class Alloc>
+bool operator==(const simple_alloc<T1, Alloc>& a, const simple_alloc<T2, Alloc>& b) {
+  return !_alloc_neq<Alloc>::_neq(a.get_alloc(), b.get_alloc());
+}
+template <class T1, class T2, class Alloc>
+bool operator!=(const simple_alloc<T1, Alloc>& a, const simple_alloc<T2, Alloc>& b) {
+  return _alloc_neq<Alloc>::_neq(a.get_alloc(), b.get_alloc());
+}
 
 }  // namespace sup
 
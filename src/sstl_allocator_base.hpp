@@ -1,8 +1,20 @@
 #ifndef _SSTL_ALLOCATOR_BASE_H
 #define _SSTL_ALLOCATOR_BASE_H
 
+#include <cstddef>  // size_t, max_align_t
+#include <cstdlib>  // malloc, free, realloc
+#include <cstring>  // memcpy
+#include <mutex>
 #include <new>
 
+#if defined(__linux__)
+#  include <sys/mman.h>  // mmap, mremap, madvise, munmap
+#  include <unistd.h>    // sysconf
+#endif
+#if defined(__GLIBC__)
+#  include <malloc.h>    // malloc_usable_size
+#endif
+
 /**
  * @author Xiaoxi Sun
  **/
@@ -35,6 +47,46 @@
  *
  * rebind():
  *   The container might have the need of allcoating space for different types
+ *
+ * two-level allocator (SGI):
+ *   Blocks larger than __SSTL_MAX_BYTES go to the first level allocator, which
+ *   is a thin wrapper of malloc & free. Smaller blocks are rounded up to a
+ *   multiple of __SSTL_ALIGN and served by the second level allocator from one
+ *   of the free lists. Free lists are refilled by carving objects out of large
+ *   chunks, so most node allocations never reach malloc.
+ *
+ * union obj:
+ *   A free block stores the link to the next free block inside itself. No
+ *   extra space is needed to manage free blocks.
+ *
+ * thread cache (threads == true):
+ *   Every thread owns a set of free lists (a magazine per size class), so
+ *   allocate & deallocate take no lock in the common case. An empty magazine
+ *   takes a batch of __SSTL_NOBJS objects from the central pool under a lock,
+ *   and a magazine holding 2 * __SSTL_NOBJS objects gives a batch back. A
+ *   block freed by another thread simply goes into that thread's magazine,
+ *   since blocks of a size class are interchangeable.
+ *
+ * thread_local:
+ *   The thread cache is destroyed when its thread exits; all cached objects
+ *   are returned to the central pool at that time. Blocks allocated or freed
+ *   later in the exit of the thread (by destructors of other thread_local
+ *   objects) go to the central pool directly.
+ *
+ * mmap & mremap (Linux):
+ *   Blocks of at least __SSTL_MMAP_THRESHOLD bytes are mapped directly from
+ *   the kernel. madvise(MADV_HUGEPAGE) asks for transparent huge pages (2MB
+ *   pages, fewer TLB misses). Growing such a block by mremap lets the kernel
+ *   move the page table entries instead of copying the bytes, and the old
+ *   and new blocks are never both alive.
+ *
+ * usable size (size feedback):
+ *   An allocator rounds a request up to its size class (a multiple of
+ *   __SSTL_ALIGN in the pool, a malloc chunk, whole pages for mmap).
+ *   usable_size(p, n) tells how many bytes of the block p allocated with n
+ *   bytes can really be used, so a growing container can take the slack as
+ *   capacity. The block may then be deallocated or resized with any size
+ *   between n and usable_size(p, n).
  **/
 
 /**
@@ -46,19 +98,240 @@
  * Construct & destroy:
  *   Not sure about what the version control is doing
  *   (std::forward in construct & destroy)
+ *
+ * Memory pool:
+ *   Chunks of the pool are never returned to the system (the same as SGI).
+ *   valgrind would report them as "still reachable".
  **/
 
 namespace sup {
 
+// blocks from this size on are mapped by mmap instead of malloc
+#ifndef __SSTL_MMAP_THRESHOLD
+#  define __SSTL_MMAP_THRESHOLD (1 << 21)
+#endif
+// the size of a transparent huge page
+#ifndef __SSTL_HUGE_PAGE_SIZE
+#  define __SSTL_HUGE_PAGE_SIZE (1 << 21)
+#endif
 
 /**
- * @brief a wrapper for new and delete allocator 
- * 
- * @tparam threads 
- * @tparam inst 
+ * @brief the first level allocator: a wrapper for malloc and free. It is
+ *  the direct path for large blocks. Very large blocks are mapped by mmap
+ *  (on Linux) and resized by mremap.
+ *
+ * @tparam inst - for making different instances
+ */
+template <int inst>
+class __malloc_alloc_template {
+ public:
+  /**
+   * Allocation function.
+   *
+   * @param n - number of bytes
+   * @return the allocated space; throw std::bad_alloc on failure
+   **/
+  static void* allocate(size_t n) {
+    if (n == 0) return nullptr;
+
+    if (use_mmap(n)) return map_allocate(n);
+
+    void* result = malloc(n);
+    if (result == nullptr) throw std::bad_alloc();
+    return result;
+  }
+
+  /**
+   * @param p - pointing to the space that would be deallocated
+   * @param n - the size passed to allocate (or reallocate). It must be
+   *  exact: whether p is a mapped block is told by use_mmap(n).
+   **/
+  static void deallocate(char* p, size_t n) {
+    if (p == nullptr) return;
+#if defined(__linux__)
+    if (use_mmap(n)) {
+      munmap(p, page_round_up(n));
+      return;
+    }
+#endif
+    free(p);
+  }
+
+  /**
+   * Resize a block, keeping the first min(old_n, new_n) bytes. Mapped blocks
+   * are moved by mremap, others by realloc.
+   *
+   * @param p - allocated by this allocator with old_n bytes
+   * @param old_n - the old size
+   * @param new_n - the new size
+   * @return void* - the resized block; throw std::bad_alloc on failure
+   **/
+  static void* reallocate(void* p, size_t old_n, size_t new_n) {
+    if (p == nullptr) return allocate(new_n);
+#if defined(__linux__)
+    if (use_mmap(old_n) && use_mmap(new_n)) {
+      void* result = mremap(p, page_round_up(old_n), page_round_up(new_n),
+                            MREMAP_MAYMOVE);
+      if (result == MAP_FAILED) throw std::bad_alloc();
+      advise_huge_pages(result, page_round_up(new_n));
+      return result;
+    }
+#endif
+    if (use_mmap(old_n) == use_mmap(new_n)) {
+      void* result = realloc(p, new_n);
+      if (result == nullptr) throw std::bad_alloc();
+      return result;
+    }
+    // moving between malloc and mmap
+    void* result = allocate(new_n);
+    memcpy(result, p, old_n < new_n ? old_n : new_n);
+    deallocate((char*) p, old_n);
+    return result;
+  }
+
+  /**
+   * @param p - allocated by this allocator with n bytes
+   * @param n - the size passed to allocate (or reallocate)
+   * @return size_t - the number of bytes of p that can be used
+   **/
+  static size_t usable_size(void* p, size_t n) {
+    if (p == nullptr) return n;
+#if defined(__linux__)
+    if (use_mmap(n)) return page_round_up(n);
+#endif
+#if defined(__GLIBC__)
+    // the block must stay a malloc block for deallocate & reallocate
+    size_t usable = malloc_usable_size(p);
+    if (usable > n && !use_mmap(usable)) return usable;
+#endif
+    return n;
+  }
+
+  static size_t max_size() { return size_t(-1); }
+
+ private:
+  static bool use_mmap(size_t n) {
+#if defined(__linux__)
+    return n >= (size_t) __SSTL_MMAP_THRESHOLD;
+#else
+    return false;
+#endif
+  }
+
+#if defined(__linux__)
+  static size_t page_round_up(size_t n) {
+    static const size_t page_size = (size_t) sysconf(_SC_PAGESIZE);
+    return (n + page_size - 1) & ~(page_size - 1);
+  }
+
+  static void advise_huge_pages(void* p, size_t n) {
+#  if defined(MADV_HUGEPAGE)
+    if (n >= (size_t) __SSTL_HUGE_PAGE_SIZE) madvise(p, n, MADV_HUGEPAGE);
+#  endif
+  }
+
+  static void* map_allocate(size_t n) {
+    size_t size = page_round_up(n);
+    void* result = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (result == MAP_FAILED) throw std::bad_alloc();
+    advise_huge_pages(result, size);
+    return result;
+  }
+#else
+  static void* map_allocate(size_t) { return nullptr; }
+#endif
+};
+
+typedef __malloc_alloc_template<0> malloc_alloc;
+
+// blocks are aligned to (and rounded up to a multiple of) __SSTL_ALIGN bytes.
+// 16 is the alignment malloc guarantees, i.e. alignof(max_align_t).
+enum { __SSTL_ALIGN = 16 };
+// upper limit of small blocks
+enum { __SSTL_MAX_BYTES = 256 };
+// number of free lists
+enum { __SSTL_NFREELISTS = __SSTL_MAX_BYTES / __SSTL_ALIGN };
+// number of objects that are carved out at a time when a free list is empty
+enum { __SSTL_NOBJS = 20 };
+
+/**
+ * @brief the second level allocator: a memory pool with free lists of size
+ *  classes 16, 32, ..., 256 bytes. Larger blocks are forwarded to the first
+ *  level allocator.
+ *
+ * @tparam threads - whether the allocator is used by multiple threads. If
+ *  true, each thread caches free objects and the central pool is locked only
+ *  when a batch of objects moves between a thread and the pool. If false,
+ *  no lock is taken at all.
+ * @tparam inst - for making different instances, each of which has its own
+ *  pool
  */
 template <bool threads, int inst>
 class __simple_default_allocator_template {
+ private:
+  union obj {
+    union obj* free_list_link;
+    char client_data[1];
+  };
+
+  static obj* free_list[__SSTL_NFREELISTS];
+
+  // the pool: [start_free, end_free) has not been carved into any list
+  static char* start_free;
+  static char* end_free;
+  static size_t heap_size;
+
+  // round bytes up to a multiple of __SSTL_ALIGN
+  static size_t round_up(size_t bytes) {
+    return (bytes + __SSTL_ALIGN - 1) & ~(size_t(__SSTL_ALIGN) - 1);
+  }
+  // the index of the free list serving blocks of the given size
+  static size_t freelist_index(size_t bytes) {
+    return (bytes + __SSTL_ALIGN - 1) / __SSTL_ALIGN - 1;
+  }
+
+  static void* refill(size_t n);
+  static char* chunk_alloc(size_t size, int& nobjs);
+
+  // lock of the central pool (free_list, start_free and end_free); only used
+  // when threads is true
+  static std::mutex pool_lock;
+
+  // free lists owned by a single thread. They are plain arrays so that the
+  // fast path does not check whether the thread cache is initialized.
+  static thread_local obj* thread_free_list[__SSTL_NFREELISTS];
+  static thread_local size_t thread_count[__SSTL_NFREELISTS];
+  // set when the thread cache has been flushed at thread exit
+  static thread_local bool thread_cache_closed;
+
+  // returns the objects of the thread cache to the central pool when the
+  // thread exits. It is created the first time a thread visits the pool.
+  struct thread_cache_guard {
+    void touch() {}
+    ~thread_cache_guard() {
+      for (size_t i = 0; i < (size_t) __SSTL_NFREELISTS; ++i) {
+        if (thread_free_list[i] != nullptr) {
+          release_to_pool(i, thread_free_list[i], thread_count[i]);
+          thread_free_list[i] = nullptr;
+          thread_count[i] = 0;
+        }
+      }
+      thread_cache_closed = true;
+    }
+  };
+
+  // make sure the thread cache is flushed when the thread exits. Must not
+  // be called once the cache is closed.
+  static void open_thread_cache() {
+    static thread_local thread_cache_guard cache_guard;
+    cache_guard.touch();
+  }
+
+  static void* thread_allocate(size_t n);
+  static void thread_deallocate(char* p, size_t n);
+  static void release_to_pool(size_t index, obj* first, size_t count);
+
  public:
   // The container might have the need of allcoating
   // space for different types
@@ -83,16 +356,6 @@ class __simple_default_allocator_template {
 
   ~__simple_default_allocator_template<threads, inst>() {}
 
-  /**
-   * Return the address of x
-   *
-   * @param x - the address being asked
-   * @return &x
-   *
-   * Macros used here:
-   *  - _GLIBCXX_NOEXCEPT
-   **/
-
   /**
    * Allocation function. This is what you are looking for!
    *
@@ -105,20 +368,74 @@ class __simple_default_allocator_template {
     // C++ standard does not specify this. Return nullptr for completeness
     if (n == 0) return nullptr;
 
-    // There should be a branch dealing with alignment issues
+    if (n > (size_t) __SSTL_MAX_BYTES) return malloc_alloc::allocate(n);
+
+    if (threads) return thread_allocate(n);
+
+    obj** my_free_list = free_list + freelist_index(n);
+    obj* result = *my_free_list;
+    if (result == nullptr) return refill(round_up(n));
+
+    *my_free_list = result->free_list_link;
+    return result;
+  }
+
+  /**
+   * Resize a block, keeping the first min(old_n, new_n) bytes. Large blocks
+   * are resized by the first level allocator (realloc or mremap).
+   *
+   * @param p - allocated by this allocator with old_n bytes
+   * @param old_n - the old size
+   * @param new_n - the new size
+   * @return void* - the resized block
+   **/
+  static void* reallocate(void* p, size_t old_n, size_t new_n) {
+    if (old_n > (size_t) __SSTL_MAX_BYTES && new_n > (size_t) __SSTL_MAX_BYTES)
+      return malloc_alloc::reallocate(p, old_n, new_n);
+    if (p != nullptr && round_up(old_n) == round_up(new_n)) return p;
+
+    void* result = allocate(new_n);
+    if (p != nullptr) {
+      memcpy(result, p, old_n < new_n ? old_n : new_n);
+      deallocate((char*) p, old_n);
+    }
+    return result;
+  }
 
-    return new char[n];
+  /**
+   * @param p - allocated by this allocator with n bytes
+   * @param n - the size passed to allocate (or reallocate)
+   * @return size_t - the number of bytes of p that can be used: the size
+   *  class for small blocks
+   **/
+  static size_t usable_size(void* p, size_t n) {
+    if (n > (size_t) __SSTL_MAX_BYTES) return malloc_alloc::usable_size(p, n);
+    return round_up(n);
   }
 
   /**
-   * p should not be a null pointer
+   * p should be allocated by this allocator with the same n
    *
    * @param p - pointing to the space that would be deallocated
-   * @param size_type - used for considering using first alloc or sub alloc
+   * @param n - used for considering using first alloc or sub alloc
    **/
-  static void deallocate(char* p, size_t) {
-    // there should be some alignment issues
-    delete [] p;
+  static void deallocate(char* p, size_t n) {
+    if (p == nullptr) return;
+
+    if (n > (size_t) __SSTL_MAX_BYTES) {
+      malloc_alloc::deallocate(p, n);
+      return;
+    }
+
+    if (threads) {
+      thread_deallocate(p, n);
+      return;
+    }
+
+    obj** my_free_list = free_list + freelist_index(n);
+    obj* q = (obj*) p;
+    q->free_list_link = *my_free_list;
+    *my_free_list = q;
   }
 
   /**
@@ -132,24 +449,259 @@ class __simple_default_allocator_template {
 
   // For C++ 11 and later versions, STL uses std::forward.
   //
+};
 
-  // Here is the simmplified version:
-  /**
-   * Comparator
-   **/
-  template <bool threads1, int inst1, bool threads2, int inst2>
-  friend bool operator==(
-    const __simple_default_allocator_template<threads1, inst1>&, 
-    const __simple_default_allocator_template<threads2, inst2>&) {
-    return true;
-  }
-  template <bool threads1, int inst1, bool threads2, int inst2>
-  friend bool operator!=(
-    const __simple_default_allocator_template<threads1, inst1>&, 
-    const __simple_default_allocator_template<threads2, inst2>&) {
-    return false;
+// Here is the simmplified version:
+/**
+ * Comparator
+ *
+ * Defined outside of the class: a friend template defined inside would be
+ * redefined by every instantiation of the allocator.
+ **/
+template <bool threads1, int inst1, bool threads2, int inst2>
+bool operator==(
+  const __simple_default_allocator_template<threads1, inst1>&, 
+  const __simple_default_allocator_template<threads2, inst2>&) {
+  return true;
+}
+template <bool threads1, int inst1, bool threads2, int inst2>
+bool operator!=(
+  const __simple_default_allocator_template<threads1, inst1>&, 
+  const __simple_default_allocator_template<threads2, inst2>&) {
+  return false;
+}
+
+/**
+ * @brief return an object of size n, and put the other objects carved out
+ *  of the pool into the free list of size n.
+ *
+ * @param n - already rounded up to a multiple of __SSTL_ALIGN
+ * @return void* - the object
+ */
+template <bool threads, int inst>
+void* __simple_default_allocator_template<threads, inst>::refill(size_t n) {
+  int nobjs = __SSTL_NOBJS;
+  char* chunk = chunk_alloc(n, nobjs);
+
+  if (nobjs == 1) return chunk;
+
+  obj** my_free_list = free_list + freelist_index(n);
+  obj* result = (obj*) chunk;
+  obj* next_obj = (obj*) (chunk + n);
+  *my_free_list = next_obj;
+
+  // link the remaining nobjs - 1 objects
+  for (int i = 1; ; ++i) {
+    obj* cur_obj = next_obj;
+    next_obj = (obj*) ((char*) next_obj + n);
+    if (i == nobjs - 1) {
+      cur_obj->free_list_link = nullptr;
+      break;
+    }
+    cur_obj->free_list_link = next_obj;
   }
-};
+
+  return result;
+}
+
+/**
+ * @brief take nobjs objects of the given size from the pool. The pool is
+ *  refilled with malloc when it is not enough for even one object.
+ *
+ * @param size - size of an object, already rounded up
+ * @param nobjs - number of objects wanted; set to the number of objects
+ *  actually returned
+ * @return char* - the start of the objects
+ */
+template <bool threads, int inst>
+char* __simple_default_allocator_template<threads, inst>::chunk_alloc(
+    size_t size, int& nobjs) {
+  size_t total_bytes = size * nobjs;
+  size_t bytes_left = end_free - start_free;
+
+  if (bytes_left >= total_bytes) {  // enough for all objects
+    char* result = start_free;
+    start_free += total_bytes;
+    return result;
+  } else if (bytes_left >= size) {  // enough for at least one object
+    nobjs = (int) (bytes_left / size);
+    total_bytes = size * nobjs;
+    char* result = start_free;
+    start_free += total_bytes;
+    return result;
+  }
+
+  // put the remaining bytes into a proper free list. bytes_left is always a
+  // multiple of __SSTL_ALIGN
+  if (bytes_left > 0) {
+    obj** my_free_list = free_list + freelist_index(bytes_left);
+    ((obj*) start_free)->free_list_link = *my_free_list;
+    *my_free_list = (obj*) start_free;
+  }
+
+  // grow the pool; the chunk becomes larger as the pool grows
+  size_t bytes_to_get = 2 * total_bytes + round_up(heap_size >> 4);
+  start_free = (char*) malloc(bytes_to_get);
+  if (start_free == nullptr) {
+    // try the free lists of larger objects
+    for (size_t i = size; i <= (size_t) __SSTL_MAX_BYTES; i += __SSTL_ALIGN) {
+      obj** my_free_list = free_list + freelist_index(i);
+      obj* p = *my_free_list;
+      if (p != nullptr) {
+        *my_free_list = p->free_list_link;
+        start_free = (char*) p;
+        end_free = start_free + i;
+        return chunk_alloc(size, nobjs);
+      }
+    }
+    end_free = nullptr;
+    // throw std::bad_alloc if there is really no memory
+    start_free = (char*) malloc_alloc::allocate(bytes_to_get);
+  }
+
+  heap_size += bytes_to_get;
+  end_free = start_free + bytes_to_get;
+  return chunk_alloc(size, nobjs);
+}
+
+/**
+ * @brief allocate an object of size n from the thread cache. An empty
+ *  cache takes a batch of objects from the central pool.
+ *
+ * @param n - number of bytes, no larger than __SSTL_MAX_BYTES
+ * @return void* - the object
+ */
+template <bool threads, int inst>
+void* __simple_default_allocator_template<threads, inst>::thread_allocate(
+    size_t n) {
+  size_t index = freelist_index(n);
+  obj* result = thread_free_list[index];
+
+  if (result != nullptr) {  // fast path: no lock
+    thread_free_list[index] = result->free_list_link;
+    --thread_count[index];
+    return result;
+  }
+
+  // a closed cache takes a single object, which is not cached
+  const bool cached = !thread_cache_closed;
+  if (cached) open_thread_cache();
+  const size_t wanted = cached ? (size_t) __SSTL_NOBJS : 1;
+
+  // take a batch from the central pool
+  obj* batch = nullptr;
+  size_t got = 0;
+  {
+    std::lock_guard<std::mutex> lock(pool_lock);
+    obj** my_free_list = free_list + index;
+    while (*my_free_list != nullptr && got < wanted) {
+      obj* q = *my_free_list;
+      *my_free_list = q->free_list_link;
+      q->free_list_link = batch;
+      batch = q;
+      ++got;
+    }
+
+    if (got == 0) {  // the central free list is empty as well
+      size_t size = round_up(n);
+      int nobjs = (int) wanted;
+      char* chunk = chunk_alloc(size, nobjs);
+      for (int i = nobjs - 1; i >= 0; --i) {
+        obj* q = (obj*) (chunk + i * size);
+        q->free_list_link = batch;
+        batch = q;
+      }
+      got = nobjs;
+    }
+  }
+
+  thread_free_list[index] = batch->free_list_link;
+  thread_count[index] = got - 1;
+  return batch;
+}
+
+/**
+ * @brief put an object into the thread cache. A full cache gives a batch of
+ *  objects back to the central pool.
+ *
+ * @param p - the object; it might be allocated by another thread
+ * @param n - number of bytes, no larger than __SSTL_MAX_BYTES
+ */
+template <bool threads, int inst>
+void __simple_default_allocator_template<threads, inst>::thread_deallocate(
+    char* p, size_t n) {
+  size_t index = freelist_index(n);
+
+  obj* q = (obj*) p;
+  if (thread_cache_closed) {
+    q->free_list_link = nullptr;
+    release_to_pool(index, q, 1);
+    return;
+  }
+
+  q->free_list_link = thread_free_list[index];
+  thread_free_list[index] = q;
+  // a thread that only frees (e.g. a consumer) never allocated from the
+  // pool, so make sure its cache is flushed when it exits
+  if (++thread_count[index] == 1) open_thread_cache();
+
+  if (thread_count[index] >= 2 * (size_t) __SSTL_NOBJS) {
+    // detach the first __SSTL_NOBJS objects and give them back
+    obj* first = thread_free_list[index];
+    obj* last = first;
+    for (int i = 1; i < __SSTL_NOBJS; ++i) last = last->free_list_link;
+    thread_free_list[index] = last->free_list_link;
+    thread_count[index] -= __SSTL_NOBJS;
+    last->free_list_link = nullptr;
+    release_to_pool(index, first, __SSTL_NOBJS);
+  }
+}
+
+/**
+ * @brief splice a null terminated list of objects into a central free list
+ *
+ * @param index - of the free list
+ * @param first - the first object of the list
+ * @param count - number of objects in the list
+ */
+template <bool threads, int inst>
+void __simple_default_allocator_template<threads, inst>::release_to_pool(
+    size_t index, obj* first, size_t count) {
+  obj* last = first;
+  for (size_t i = 1; i < count; ++i) last = last->free_list_link;
+
+  std::lock_guard<std::mutex> lock(pool_lock);
+  last->free_list_link = free_list[index];
+  free_list[index] = first;
+}
+
+template <bool threads, int inst>
+std::mutex __simple_default_allocator_template<threads, inst>::pool_lock;
+
+template <bool threads, int inst>
+thread_local typename __simple_default_allocator_template<threads, inst>::obj*
+__simple_default_allocator_template<threads, inst>::thread_free_list[__SSTL_NFREELISTS] = {};
+
+template <bool threads, int inst>
+thread_local size_t
+__simple_default_allocator_template<threads, inst>::thread_count[__SSTL_NFREELISTS] = {};
+
+template <bool threads, int inst>
+thread_local bool
+__simple_default_allocator_template<threads, inst>::thread_cache_closed = false;
+
+template <bool threads, int inst>
+typename __simple_default_allocator_template<threads, inst>::obj*
+__simple_default_allocator_template<threads, inst>::free_list[__SSTL_NFREELISTS] = {};
+
+template <bool threads, int inst>
+char* __simple_default_allocator_template<threads, inst>::start_free = nullptr;
+
+template <bool threads, int inst>
+char* __simple_default_allocator_template<threads, inst>::end_free = nullptr;
+
+template <bool threads, int inst>
+size_t __simple_default_allocator_template<threads, inst>::heap_size = 0;
 
 }  // namespace sup
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,640 @@
+#ifndef _SSTL_BIT_VECTOR_H
+#define _SSTL_BIT_VECTOR_H
+
+#include <algorithm>  // std::copy, std::copy_backward & std::fill
+#include <cstring>    // memcpy
+#include <type_traits>
+
+#include "sstl_vector.hpp"
+
+/**
+ * @author Xiaoxi Sun
+ **/
+
+/**
+ * Concepts:
+ *  - vector<bool>: the bits are packed into words (unsigned long), one bit
+ *    per element instead of one byte, so a flag array is 8 times smaller
+ *  - proxy reference: a bit has no address, so operator[] and the iterators
+ *    return __bit_reference (a word pointer and a mask) that reads the bit
+ *    by conversion to bool and writes it by assignment
+ *  - the bits after size() in the last word are always 0. count, any, find
+ *    and the bulk operations then work on whole words without masking the
+ *    tail, and only the functions changing size() have to clear it.
+ *  - word-level kernels: count() is a popcount per word, find_first() &
+ *    find_next() skip zero words and take the lowest bit by counting the
+ *    trailing zeros, &= |= ^= and flip() combine 64 bits per operation in
+ *    plain loops the compiler can vectorize. Scanning is then bound by the
+ *    memory bandwidth, not by one bit per iteration.
+ *  - the words are trivially copyable, so growth is a reallocate (realloc
+ *    & mremap for large buffers) following the Growth policy, in words
+ **/
+
+/**
+ * Questions:
+ *  - __builtin_popcountl is used when the target has a popcnt instruction
+ *    (-mpopcnt, -march=native...); otherwise a SWAR popcount, since the
+ *    builtin would be a library call
+ *  - __builtin_ctzl used by find_first & find_next
+ *  - std::copy & std::copy_backward shift the bits of insert & erase one by
+ *    one
+ **/
+
+namespace sup {
+
+typedef unsigned long __bit_word;
+enum { __SSTL_WORD_BIT = int(sizeof(__bit_word) * 8) };
+
+// number of set bits of w
+inline size_t __bit_popcount(__bit_word w) {
+#ifdef __POPCNT__
+  return __builtin_popcountl(w);
+#else
+  // add the bits in pairs, then nibbles, then bytes, and sum the bytes by
+  // one multiplication
+  const __bit_word m1 = ~__bit_word(0) / 3;    // 0x5555...
+  const __bit_word m2 = ~__bit_word(0) / 5;    // 0x3333...
+  const __bit_word m4 = ~__bit_word(0) / 17;   // 0x0f0f...
+  const __bit_word h01 = ~__bit_word(0) / 255; // 0x0101...
+  w -= (w >> 1) & m1;
+  w = (w & m2) + ((w >> 2) & m2);
+  w = (w + (w >> 4)) & m4;
+  return (w * h01) >> (__SSTL_WORD_BIT - 8);
+#endif
+}
+
+/**
+ * @brief reference to one bit
+ */
+struct __bit_reference {
+  __bit_word* p;
+  __bit_word mask;
+
+  __bit_reference(__bit_word* x, __bit_word y) : p(x), mask(y) {}
+
+  operator bool() const { return (*p & mask) != 0; }
+  __bit_reference& operator=(bool x) {
+    if (x)
+      *p |= mask;
+    else
+      *p &= ~mask;
+    return *this;
+  }
+  __bit_reference& operator=(const __bit_reference& x) {
+    return *this = bool(x);
+  }
+  bool operator==(const __bit_reference& x) const {
+    return bool(*this) == bool(x);
+  }
+  bool operator<(const __bit_reference& x) const {
+    return !bool(*this) && bool(x);
+  }
+  void flip() { *p ^= mask; }
+};
+
+inline void swap(__bit_reference x, __bit_reference y) {
+  bool tmp = x;
+  x = y;
+  y = tmp;
+}
+
+// position of a bit: a word and the offset of the bit in it
+struct __bit_iterator_base {
+  typedef random_access_iterator_tag iterator_category;
+  typedef bool value_type;
+  typedef ptrdiff_t difference_type;
+
+  __bit_word* p;
+  unsigned int offset;
+
+  __bit_iterator_base(__bit_word* x, unsigned int y) : p(x), offset(y) {}
+
+  void bump_up() {
+    if (offset++ == __SSTL_WORD_BIT - 1) {
+      offset = 0;
+      ++p;
+    }
+  }
+  void bump_down() {
+    if (offset-- == 0) {
+      offset = __SSTL_WORD_BIT - 1;
+      --p;
+    }
+  }
+  void incr(difference_type i) {
+    difference_type n = i + offset;
+    p += n / __SSTL_WORD_BIT;
+    n = n % __SSTL_WORD_BIT;
+    if (n < 0) {
+      n += __SSTL_WORD_BIT;
+      --p;
+    }
+    offset = (unsigned int) n;
+  }
+
+  bool operator==(const __bit_iterator_base& x) const {
+    return p == x.p && offset == x.offset;
+  }
+  bool operator!=(const __bit_iterator_base& x) const { return !(*this == x); }
+  bool operator<(const __bit_iterator_base& x) const {
+    return p < x.p || (p == x.p && offset < x.offset);
+  }
+  bool operator>(const __bit_iterator_base& x) const { return x < *this; }
+  bool operator<=(const __bit_iterator_base& x) const { return !(x < *this); }
+  bool operator>=(const __bit_iterator_base& x) const { return !(*this < x); }
+};
+
+inline ptrdiff_t operator-(const __bit_iterator_base& x,
+                           const __bit_iterator_base& y) {
+  return __SSTL_WORD_BIT * (x.p - y.p) + x.offset - y.offset;
+}
+
+struct __bit_iterator : public __bit_iterator_base {
+  typedef __bit_reference reference;
+  typedef __bit_reference* pointer;
+  typedef __bit_iterator _self;
+
+  __bit_iterator() : __bit_iterator_base(nullptr, 0) {}
+  __bit_iterator(__bit_word* x, unsigned int y) : __bit_iterator_base(x, y) {}
+
+  reference operator*() const { return reference(p, __bit_word(1) << offset); }
+  reference operator[](difference_type i) const { return *(*this + i); }
+
+  _self& operator++() { bump_up(); return *this; }
+  _self operator++(int) { _self tmp = *this; bump_up(); return tmp; }
+  _self& operator--() { bump_down(); return *this; }
+  _self operator--(int) { _self tmp = *this; bump_down(); return tmp; }
+  _self& operator+=(difference_type i) { incr(i); return *this; }
+  _self& operator-=(difference_type i) { incr(-i); return *this; }
+  _self operator+(difference_type i) const { _self tmp = *this; return tmp += i; }
+  _self operator-(difference_type i) const { _self tmp = *this; return tmp -= i; }
+};
+
+struct __bit_const_iterator : public __bit_iterator_base {
+  typedef bool reference;
+  typedef bool const_reference;
+  typedef const bool* pointer;
+  typedef __bit_const_iterator _self;
+
+  __bit_const_iterator() : __bit_iterator_base(nullptr, 0) {}
+  __bit_const_iterator(__bit_word* x, unsigned int y)
+      : __bit_iterator_base(x, y) {}
+  __bit_const_iterator(const __bit_iterator& x)
+      : __bit_iterator_base(x.p, x.offset) {}
+
+  reference operator*() const { return (*p >> offset) & 1; }
+  reference operator[](difference_type i) const { return *(*this + i); }
+
+  _self& operator++() { bump_up(); return *this; }
+  _self operator++(int) { _self tmp = *this; bump_up(); return tmp; }
+  _self& operator--() { bump_down(); return *this; }
+  _self operator--(int) { _self tmp = *this; bump_down(); return tmp; }
+  _self& operator+=(difference_type i) { incr(i); return *this; }
+  _self& operator-=(difference_type i) { incr(-i); return *this; }
+  _self operator+(difference_type i) const { _self tmp = *this; return tmp += i; }
+  _self operator-(difference_type i) const { _self tmp = *this; return tmp -= i; }
+};
+
+/**
+ * @brief the bit-packed vector of bool
+ *
+ * @tparam Alloc - allocator type (allocating words)
+ * @tparam Growth - growth policy, applied to the number of words
+ */
+template <class Alloc, class Growth>
+class vector<bool, Alloc, Growth> : protected simple_alloc<__bit_word, Alloc> {
+ public:
+  typedef bool value_type;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+  typedef __bit_reference reference;
+  typedef bool const_reference;
+  typedef __bit_reference* pointer;
+  typedef const bool* const_pointer;
+  typedef __bit_iterator iterator;
+  typedef __bit_const_iterator const_iterator;
+  typedef sup::reverse_iterator<iterator> reverse_iterator;
+  typedef sup::reverse_iterator<const_iterator> const_reverse_iterator;
+  typedef simple_alloc<__bit_word, Alloc> allocator_type;
+
+  // the words do not point back to the vector
+  typedef __true_type is_trivially_relocatable;
+
+  /******** Constructors ********/
+  vector() : words(nullptr), num_bits(0), num_words(0) {}
+  explicit vector(const allocator_type& a)
+      : word_allocator(a), words(nullptr), num_bits(0), num_words(0) {}
+  explicit vector(size_type n)
+      : words(nullptr), num_bits(0), num_words(0) {
+    resize(n, false);
+  }
+  vector(size_type n, bool value, const allocator_type& a = allocator_type())
+      : word_allocator(a), words(nullptr), num_bits(0), num_words(0) {
+    resize(n, value);
+  }
+  template <class InputIterator>
+  vector(InputIterator first, InputIterator last)
+      : words(nullptr), num_bits(0), num_words(0) {
+    initialize_dispatch(first, last, std::is_integral<InputIterator>());
+  }
+  vector(const vector& x)
+      : word_allocator(x.get_allocator()), words(nullptr), num_bits(0),
+        num_words(0) {
+    reserve(x.size());
+    copy_words(x);
+  }
+  vector(vector&& x) noexcept
+      : word_allocator(x.get_allocator()), words(x.words),
+        num_bits(x.num_bits), num_words(x.num_words) {
+    x.words = nullptr;
+    x.num_bits = 0;
+    x.num_words = 0;
+  }
+  ~vector() { deallocate(); }
+
+  vector& operator=(const vector& x) {
+    if (this == &x) return *this;
+    num_bits = 0;
+    reserve(x.size());
+    copy_words(x);
+    return *this;
+  }
+  vector& operator=(vector&& x) noexcept {
+    vector tmp(std::move(x));
+    swap(tmp);
+    return *this;
+  }
+
+  /******** Sizes ********/
+  size_type size() const { return num_bits; }
+  size_type capacity() const { return num_words * __SSTL_WORD_BIT; }
+  // bytes allocated by the vector
+  size_type memory_usage() const { return num_words * sizeof(__bit_word); }
+  size_type max_size() const { return size_type(-1); }
+  bool empty() const { return num_bits == 0; }
+  void resize(size_type new_size, bool value = false);
+  void reserve(size_type n);
+  void shrink_to_fit();
+
+  /******** Iterators ********/
+  iterator begin() { return iterator(words, 0); }
+  iterator end() { return begin() + num_bits; }
+  const_iterator begin() const { return const_iterator(words, 0); }
+  const_iterator end() const { return begin() + num_bits; }
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
+  /******** Element access ********/
+  reference operator[](size_type n) {
+    return reference(words + n / __SSTL_WORD_BIT,
+                     __bit_word(1) << (n % __SSTL_WORD_BIT));
+  }
+  const_reference operator[](size_type n) const {
+    return (words[n / __SSTL_WORD_BIT] >> (n % __SSTL_WORD_BIT)) & 1;
+  }
+  reference front() { return *begin(); }
+  const_reference front() const { return *begin(); }
+  reference back() { return (*this)[num_bits - 1]; }
+  const_reference back() const { return (*this)[num_bits - 1]; }
+
+  /******** Modifiers ********/
+  void push_back(bool value) {
+    if (num_bits == capacity()) grow(num_bits + 1);
+    // the word is new: it has to be cleared
+    if (num_bits % __SSTL_WORD_BIT == 0) words[num_bits / __SSTL_WORD_BIT] = 0;
+    ++num_bits;
+    if (value) back() = true;
+  }
+  void pop_back() {
+    --num_bits;
+    (*this)[num_bits] = false;
+  }
+  iterator insert(iterator position, bool value) {
+    return insert(position, 1, value);
+  }
+  iterator insert(iterator position, size_type n, bool value);
+  iterator erase(iterator position) { return erase(position, position + 1); }
+  iterator erase(iterator first, iterator last);
+  void clear() { num_bits = 0; }
+  void swap(vector& x);
+  allocator_type get_allocator() const { return *this; }
+
+  /******** Word-level operations ********/
+  void flip();
+  size_type count() const;
+  bool any() const;
+  bool none() const { return !any(); }
+  bool all() const { return count() == num_bits; }
+  size_type find_first() const;
+  size_type find_next(size_type pos) const;
+
+  vector& operator&=(const vector& x);
+  vector& operator|=(const vector& x);
+  vector& operator^=(const vector& x);
+
+ protected:
+  typedef simple_alloc<__bit_word, Alloc> word_allocator;
+  __bit_word* words;
+  size_type num_bits;
+  size_type num_words;  // capacity in words
+
+  static size_type words_for(size_type bits) {
+    return (bits + __SSTL_WORD_BIT - 1) / __SSTL_WORD_BIT;
+  }
+  // number of words holding bits
+  size_type used_words() const { return words_for(num_bits); }
+
+  // keep the bits after size() 0
+  void clear_tail() {
+    if (num_bits % __SSTL_WORD_BIT != 0) {
+      words[num_bits / __SSTL_WORD_BIT] &=
+          (__bit_word(1) << (num_bits % __SSTL_WORD_BIT)) - 1;
+    }
+  }
+
+  // make room for bits bits, growing by Growth
+  void grow(size_type bits);
+  void reallocate_words(size_type n);
+  void deallocate() {
+    if (words) word_allocator::deallocate(words, num_words);
+  }
+  void copy_words(const vector& x) {
+    if (x.size() != 0) {
+      memcpy(words, x.words, x.used_words() * sizeof(__bit_word));
+    }
+    num_bits = x.num_bits;
+  }
+
+  template <class Integer>
+  void initialize_dispatch(Integer n, Integer value, std::true_type) {
+    resize(size_type(n), bool(value));
+  }
+  template <class InputIterator>
+  void initialize_dispatch(InputIterator first, InputIterator last,
+                           std::false_type) {
+    for (; first != last; ++first) push_back(bool(*first));
+  }
+};
+
+/**
+ * @brief resize the vector; the new bits are value. Whole words are filled
+ *  at once.
+ *
+ * @tparam Alloc - allocator type
+ * @param new_size - new size
+ * @param value - value of the new bits
+ */
+template <class Alloc, class Growth>
+void vector<bool, Alloc, Growth>::resize(size_type new_size, bool value) {
+  if (new_size <= num_bits) {
+    num_bits = new_size;
+    clear_tail();
+    return;
+  }
+
+  if (new_size > capacity()) grow(new_size);
+  const __bit_word fill = value ? ~__bit_word(0) : 0;
+  size_type w = num_bits / __SSTL_WORD_BIT;
+  if (num_bits % __SSTL_WORD_BIT != 0) {
+    // the rest of the last word (its tail bits are 0)
+    words[w] |= fill << (num_bits % __SSTL_WORD_BIT);
+    ++w;
+  }
+  for (; w < words_for(new_size); ++w) words[w] = fill;
+  num_bits = new_size;
+  clear_tail();
+}
+
+/**
+ * @brief reserve a capacity of at least n bits
+ *
+ * @tparam Alloc - allocator type
+ * @param n - number of bits
+ */
+template <class Alloc, class Growth>
+void vector<bool, Alloc, Growth>::reserve(size_type n) {
+  if (n > capacity()) reallocate_words(words_for(n));
+}
+
+/**
+ * @brief give back the words after the last bit
+ *
+ * @tparam Alloc - allocator type
+ */
+template <class Alloc, class Growth>
+void vector<bool, Alloc, Growth>::shrink_to_fit() {
+  const size_type n = used_words();
+  if (n == num_words) return;
+  if (n == 0) {
+    deallocate();
+    words = nullptr;
+    num_words = 0;
+  } else {
+    reallocate_words(n);
+  }
+}
+
+template <class Alloc, class Growth>
+void vector<bool, Alloc, Growth>::grow(size_type bits) {
+  const size_type n =
+      Growth::next_capacity(num_words, words_for(bits), sizeof(__bit_word));
+  words = word_allocator::reallocate(words, num_words, n);
+  num_words = word_allocator::usable_size(words, n);
+}
+
+template <class Alloc, class Growth>
+void vector<bool, Alloc, Growth>::reallocate_words(size_type n) {
+  words = word_allocator::reallocate(words, num_words, n);
+  num_words = n;
+}
+
+/**
+ * @brief insert n bits of value before position
+ *
+ * @tparam Alloc - allocator type
+ * @param position - the place of insertion
+ * @param n - number of bits
+ * @param value - value of the bits
+ * @return vector<bool, Alloc, Growth>::iterator - the first inserted bit
+ */
+template <class Alloc, class Growth>
+typename vector<bool, Alloc, Growth>::iterator
+vector<bool, Alloc, Growth>::insert(iterator position, size_type n,
+                                    bool value) {
+  const size_type index = position - begin();
+  const size_type old_size = num_bits;
+  resize(old_size + n);  // may reallocate: position is not used after
+  std::copy_backward(begin() + index, begin() + old_size, end());
+  std::fill(begin() + index, begin() + index + n, value);
+  return begin() + index;
+}
+
+/**
+ * @brief erase the bits in [first, last)
+ *
+ * @tparam Alloc - allocator type
+ * @param first - start of the range
+ * @param last - end of the range
+ * @return vector<bool, Alloc, Growth>::iterator - first
+ */
+template <class Alloc, class Growth>
+typename vector<bool, Alloc, Growth>::iterator
+vector<bool, Alloc, Growth>::erase(iterator first, iterator last) {
+  std::copy(last, end(), first);
+  num_bits -= last - first;
+  clear_tail();
+  return first;
+}
+
+template <class Alloc, class Growth>
+void vector<bool, Alloc, Growth>::swap(vector& x) {
+  std::swap(words, x.words);
+  std::swap(num_bits, x.num_bits);
+  std::swap(num_words, x.num_words);
+  _alloc_swap<word_allocator>::_swap(*this, x);
+}
+
+/**
+ * @brief flip every bit
+ *
+ * @tparam Alloc - allocator type
+ */
+template <class Alloc, class Growth>
+void vector<bool, Alloc, Growth>::flip() {
+  const size_type n = used_words();
+  for (size_type w = 0; w < n; ++w) words[w] = ~words[w];
+  clear_tail();
+}
+
+/**
+ * @brief number of bits set
+ *
+ * @tparam Alloc - allocator type
+ * @return vector<bool, Alloc, Growth>::size_type - the count
+ */
+template <class Alloc, class Growth>
+typename vector<bool, Alloc, Growth>::size_type
+vector<bool, Alloc, Growth>::count() const {
+  const size_type n = used_words();
+  // independent sums keep several popcounts in flight
+  size_type c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+  size_type w = 0;
+  for (; w + 4 <= n; w += 4) {
+    c0 += __bit_popcount(words[w]);
+    c1 += __bit_popcount(words[w + 1]);
+    c2 += __bit_popcount(words[w + 2]);
+    c3 += __bit_popcount(words[w + 3]);
+  }
+  for (; w < n; ++w) c0 += __bit_popcount(words[w]);
+  return c0 + c1 + c2 + c3;
+}
+
+template <class Alloc, class Growth>
+bool vector<bool, Alloc, Growth>::any() const {
+  const size_type n = used_words();
+  for (size_type w = 0; w < n; ++w) {
+    if (words[w] != 0) return true;
+  }
+  return false;
+}
+
+/**
+ * @brief index of the first bit set
+ *
+ * @tparam Alloc - allocator type
+ * @return vector<bool, Alloc, Growth>::size_type - size() if there is none
+ */
+template <class Alloc, class Growth>
+typename vector<bool, Alloc, Growth>::size_type
+vector<bool, Alloc, Growth>::find_first() const {
+  const size_type n = used_words();
+  for (size_type w = 0; w < n; ++w) {
+    if (words[w] != 0) return w * __SSTL_WORD_BIT + __builtin_ctzl(words[w]);
+  }
+  return num_bits;
+}
+
+/**
+ * @brief index of the first bit set after pos
+ *
+ * @tparam Alloc - allocator type
+ * @param pos - a bit index
+ * @return vector<bool, Alloc, Growth>::size_type - size() if there is none
+ */
+template <class Alloc, class Growth>
+typename vector<bool, Alloc, Growth>::size_type
+vector<bool, Alloc, Growth>::find_next(size_type pos) const {
+  ++pos;
+  if (pos >= num_bits) return num_bits;
+
+  size_type w = pos / __SSTL_WORD_BIT;
+  // the bits before pos are masked off
+  __bit_word word = words[w] & (~__bit_word(0) << (pos % __SSTL_WORD_BIT));
+  const size_type n = used_words();
+  while (word == 0) {
+    if (++w == n) return num_bits;
+    word = words[w];
+  }
+  return w * __SSTL_WORD_BIT + __builtin_ctzl(word);
+}
+
+/**
+ * @brief bitwise and with x; the bits after x.size() become 0
+ *
+ * @tparam Alloc - allocator type
+ * @param x - another bit vector
+ * @return vector<bool, Alloc, Growth>& - *this
+ */
+template <class Alloc, class Growth>
+vector<bool, Alloc, Growth>& vector<bool, Alloc, Growth>::operator&=(
+    const vector& x) {
+  const size_type n = used_words();
+  const size_type m = n < x.used_words() ? n : x.used_words();
+  for (size_type w = 0; w < m; ++w) words[w] &= x.words[w];
+  for (size_type w = m; w < n; ++w) words[w] = 0;
+  return *this;
+}
+
+/**
+ * @brief bitwise or with x, up to the shorter size
+ *
+ * @tparam Alloc - allocator type
+ * @param x - another bit vector
+ * @return vector<bool, Alloc, Growth>& - *this
+ */
+template <class Alloc, class Growth>
+vector<bool, Alloc, Growth>& vector<bool, Alloc, Growth>::operator|=(
+    const vector& x) {
+  const size_type n = used_words();
+  const size_type m = n < x.used_words() ? n : x.used_words();
+  for (size_type w = 0; w < m; ++w) words[w] |= x.words[w];
+  clear_tail();
+  return *this;
+}
+
+/**
+ * @brief bitwise xor with x, up to the shorter size
+ *
+ * @tparam Alloc - allocator type
+ * @param x - another bit vector
+ * @return vector<bool, Alloc, Growth>& - *this
+ */
+template <class Alloc, class Growth>
+vector<bool, Alloc, Growth>& vector<bool, Alloc, Growth>::operator^=(
+    const vector& x) {
+  const size_type n = used_words();
+  const size_type m = n < x.used_words() ? n : x.used_words();
+  for (size_type w = 0; w < m; ++w) words[w] ^= x.words[w];
+  clear_tail();
+  return *this;
+}
+
+}  // namespace sup
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <ext/alloc_traits.h>  // destroy based on allocator
 #include <new>                 // to use placement new
+#include <utility>             // std::forward
 
 #include "sstl_iterator_base.hpp"
 
@@ -20,6 +21,10 @@
  * destroy: __cplusplus >= 201103L has an assertion about "is_destructible"
  *
  * iterator_traits - defined in std namespace. Remember this!
+ *
+ * perfect forwarding - Args&&... binds to lvalues and rvalues alike, and
+ * std::forward passes each argument on as what it was, so one _construct
+ * copies, moves or emplaces.
  **/
 
 /**
@@ -35,14 +40,15 @@
 namespace sup {
 
 /**
- * Constructor bsed on type and value
+ * Constructor bsed on type and the arguments of a constructor of T1 (a
+ * value to copy, an rvalue to move, or the arguments of emplace)
  *
  * @param T1
- * @param T2
+ * @param Args
  **/
-template <class T1, class T2>
-inline void _construct(T1* p, const T2& value) {
-  new (p) T1(value);  // placement new
+template <class T1, class... Args>
+inline void _construct(T1* p, Args&&... args) {
+  new (p) T1(std::forward<Args>(args)...);  // placement new
 }
 
 template <typename T>
@@ -1,6 +1,7 @@
 #ifndef _SSTL_DEQUE_H
-#define _SSTL_DEUQE_H
+#define _SSTL_DEQUE_H
 
+#include "./algorithms/sstl_remove.hpp"
 #include "sstl_allocator.hpp"
 #include "sstl_iterator.hpp"
 #include "sstl_uninitialized.hpp"
@@ -13,6 +14,18 @@
  * Concepts:
  *  - Now I see why the range [first, last) is a good assumption
  *  - std::copy and std::copy_backward are used
+ *  - move semantics: a moved deque hands over its map and buffers and is
+ *    left without a map (no allocation, so moving is noexcept); the map is
+ *    created again by the next push. Elements shifted by insert are moved
+ *    (std::move & std::move_backward)
+ *  - emplace: the element is constructed in place from the arguments
+ *  - only the buffers in use are kept (pop & clear give back the others);
+ *    shrink_to_fit shrinks the map after a burst
+ *  - growth never relocates elements: only the map of buffer pointers is
+ *    moved (one memmove in reallocate_map), so a deque is itself trivially
+ *    relocatable
+ *  - erase_if & erase(deque, value) compact the deque in one pass and give
+ *    back the buffers after the new end
  **/
 
 /**
@@ -49,9 +62,10 @@ struct __deque_iterator {
 
   reference operator* () const { return *cur; }
   pointer operator-> () const {return &(operator*());}
+  // also 0 for the null iterators of a deque without a map
   difference_type operator - (const _self&x) const {
-    return difference_type(buffer_size()) * (node - x.node - 1) +
-      (cur - first) + (x.last - x.cur);
+    return difference_type(buffer_size()) * (node - x.node) +
+      (cur - first) - (x.cur - x.first);
   }
 
   _self& operator++ () {
@@ -119,24 +133,74 @@ struct __deque_iterator {
 };
 
 template <class T, class Alloc=alloc, size_t BufSiz=0>
-class deque {
+class deque : protected simple_alloc<T, Alloc> {
 public: 
   typedef T value_type;
   typedef value_type* pointer; 
   typedef T& reference;
   typedef ptrdiff_t difference_type;
+
+  // the map & buffers do not point back to the deque
+  typedef __true_type is_trivially_relocatable;
   typedef size_t size_type;
   typedef __deque_iterator<T, T&, T*, BufSiz> iterator;
+  typedef sup::simple_alloc<T, Alloc> allocator_type;
 
   /********** Con-destructors **********/
   deque() {create_map_and_nodes(0);}
+  explicit deque(const allocator_type& a) : data_allocator(a) {
+    create_map_and_nodes(0);
+  }
   deque(int n, const value_type& val) { fill_initialize(n, val); }
+  deque(int n, const value_type& val, const allocator_type& a)
+    : data_allocator(a) { fill_initialize(n, val); }
+  deque(const deque& x) : data_allocator(x.get_allocator()) {
+    create_map_and_nodes(x.size());
+    try {
+      sup::uninitialized_copy(x.start, x.finish, start);
+    } catch (...) {
+      destroy_map_and_nodes();
+      throw;
+    }
+  }
+  // x is left empty and without a map
+  deque(deque&& x) noexcept
+    : data_allocator(x.get_allocator()), start(x.start), finish(x.finish),
+      map(x.map), map_size(x.map_size) {
+    x.start = x.finish = iterator();
+    x.map = nullptr;
+    x.map_size = 0;
+  }
   ~deque() {
+    if (map == nullptr) return;
     clear();
     data_allocator::deallocate(start.first, buffer_size());
-    map_allocator::deallocate(map, map_size);
+    get_map_allocator().deallocate(map, map_size);
+  }
+
+  deque& operator=(const deque& x) {
+    if (this != &x) {
+      clear();
+      for (iterator it = x.start; it != x.finish; ++it) push_back(*it);
+    }
+    return *this;
+  }
+  deque& operator=(deque&& x) noexcept {
+    deque tmp(std::move(x));
+    swap(tmp);
+    return *this;
+  }
+
+  void swap(deque& x) {
+    std::swap(start, x.start);
+    std::swap(finish, x.finish);
+    std::swap(map, x.map);
+    std::swap(map_size, x.map_size);
+    _alloc_swap<data_allocator>::_swap(*this, x);
   }
 
+  allocator_type get_allocator() const { return *this; }
+
   /*********** Accessors ***********/
   static size_t buffer_size(){ return __deque_buf_size(BufSiz, sizeof(T)); }
   iterator begin() { return start; }
@@ -148,17 +212,33 @@ public:
   size_type size() const { return finish - start; }
   size_type max_size() const { return size_type(-1); }
   bool empty() const { return finish == start; }
+  // bytes allocated by the deque: the map and the buffers
+  size_type memory_usage() const {
+    if (map == nullptr) return 0;
+    return map_size * sizeof(pointer) +
+           size_type(finish.node - start.node + 1) * buffer_size() * sizeof(T);
+  }
 
   /*********** Modifiers ***********/
   void push_back(const value_type& val);
+  void push_back(value_type&& val);
   void push_front(const value_type& val);
+  void push_front(value_type&& val);
+  template <class... Args>
+  void emplace_back(Args&&... args);
+  template <class... Args>
+  void emplace_front(Args&&... args);
   
   void pop_back();
   void pop_front();
   void clear();
+  void shrink_to_fit();
   iterator erase(iterator position);
   iterator erase(iterator first, iterator last);
   iterator insert(iterator position, const value_type& val);
+  iterator insert(iterator position, value_type&& val);
+  template <class... Args>
+  iterator emplace(iterator position, Args&&... args);
 
 protected:
   typedef pointer* map_pointer; 
@@ -173,6 +253,11 @@ protected:
   map_pointer map;
   size_type map_size;
 
+  // the map allocator shares the underlying allocator of data_allocator
+  map_allocator get_map_allocator() const {
+    return map_allocator(static_cast<const data_allocator&>(*this));
+  }
+
   // helper functions
   size_type initialize_map_size() { // minimum size of the map is 8
     return size_type(8); 
@@ -184,7 +269,10 @@ protected:
     map_size = // create buffers at both sides
       (init_size > (num_nodes + 2)) ? init_size : (num_nodes + 2);
 
-    map = map_allocator::allocate(map_size);
+    allocation_result<map_pointer> map_block =
+      get_map_allocator().allocate_at_least(map_size);
+    map = map_block.ptr;
+    map_size = map_block.count;
     map_pointer nstart = map + (map_size - num_nodes) / 2;
     // nfinish is the exact end as the exact ending of the data might be in the last buffer
     map_pointer nfinish = nstart + num_nodes - 1; 
@@ -200,6 +288,12 @@ protected:
     // note that is the cur that points to the position after the last element
     finish.cur = finish.first + num_elements%buffer_size();
   }
+  // give back the buffers and the map of create_map_and_nodes
+  void destroy_map_and_nodes() {
+    for (map_pointer cur = start.node; cur <= finish.node; ++cur)
+      data_allocator::deallocate(*cur, buffer_size());
+    get_map_allocator().deallocate(map, map_size);
+  }
   // fill in values  during initialization
   void fill_initialize(size_type n, const value_type& val) {
     create_map_and_nodes(n);
@@ -213,34 +307,39 @@ protected:
     }
   }
   // helper function for push back when buffer is not enough
-  void push_back_aux(const value_type& val) {
-    value_type val_copy = val;
-
+  template <class... Args>
+  void push_back_aux(Args&&... args) {
+    if (map == nullptr) {  // moved from
+      create_map_and_nodes(0);
+      emplace_back(std::forward<Args>(args)...);
+      return;
+    }
     reserve_map_at_back();
     *(finish.node + 1) = data_allocator::allocate(buffer_size());
     try {
-      sup::_construct(finish.cur, val_copy);
+      // elements never move, so args still refer to valid objects
+      sup::_construct(finish.cur, std::forward<Args>(args)...);
       finish.set_node(finish.node + 1);
       finish.cur = finish.first;
     } catch(...) {
-      data_allocator::deallocate(*(finish.node + 1), 1);
+      data_allocator::deallocate(*(finish.node + 1), buffer_size());
       throw;
     }
   }
   // helper function for push front when buffer is not enough
-  void push_front_aux(const value_type& val) {
-    value_type val_copy = val;
-
+  template <class... Args>
+  void push_front_aux(Args&&... args) {
+    if (map == nullptr) create_map_and_nodes(0);  // moved from
     reserve_map_at_front();
     *(start.node - 1) = data_allocator::allocate(buffer_size());
     try {
       start.set_node(start.node - 1);
       start.cur = start.last - 1;
-      sup::_construct(start.cur, val_copy);
+      sup::_construct(start.cur, std::forward<Args>(args)...);
     } catch(...) { // commit or rollback
       start.set_node(start.node + 1);
       start.cur = start.first;
-      data_allocator::deallocate(*(finish.node + 1), 1);
+      data_allocator::deallocate(*(start.node - 1), buffer_size());
       throw;
     }
   }
@@ -270,12 +369,16 @@ protected:
     } else {
       size_type new_map_size = map_size + (map_size > new_num_nodes ? map_size : new_num_nodes) + 2; 
       
-      map_pointer new_map = map_allocator::allocate(new_map_size);
+      // the map holds plain pointers: resize it in place (realloc, or
+      // mremap for a very large map) and move the nodes to the middle
+      const difference_type old_offset = start.node - map;
+      map_allocator map_alloc = get_map_allocator();
+      map_pointer new_map = map_alloc.reallocate(map, map_size, new_map_size);
+      new_map_size = map_alloc.usable_size(new_map, new_map_size);
       new_nstart = new_map + (new_map_size - new_num_nodes)/2 + 
         (add_at_front ? nodes_to_add : 0);
-      std::copy(start.node, finish.node + 1, new_nstart);
+      memmove(new_nstart, new_map + old_offset, old_num_nodes * sizeof(pointer));
 
-      map_allocator::deallocate(map, map_size);
       map = new_map;
       map_size = new_map_size;
     }
@@ -283,28 +386,33 @@ protected:
     start.set_node(new_nstart);
     finish.set_node(new_nstart + old_num_nodes - 1);
   }
-  // helper for insertion
-  iterator insert_aux(iterator position, const value_type& val) {
-    difference_type elem_before = position - start;
-    value_type val_copy = val;
-    if (elem_before > (size()>>1) ) { // before there are more elements
-      push_back(back());
-      iterator back1 = finish;
-      --back1;
-      iterator back2 = back1;
-      --back2;
-      std::copy_backward(position, back2, back1);
-    } else { // otherwise
-      push_front(front());
+  // helper for insertion in the middle
+  template <class... Args>
+  iterator emplace_aux(iterator position, Args&&... args) {
+    const difference_type index = position - start;
+    // args might refer to an element being shifted
+    value_type val_copy(std::forward<Args>(args)...);
+    if (size_type(index) < (size() >> 1)) { // fewer elements before
+      push_front(std::move(front()));
       iterator front1 = start;
       ++front1;
       iterator front2 = front1;
       ++front2;
-      iterator new_pos = position;
-      --new_pos;
-      std::copy(front2, new_pos, front1);
+      // position is invalid if the map was reallocated
+      position = start + index;
+      iterator pos1 = position;
+      ++pos1;
+      std::move(front2, pos1, front1);
+    } else { // otherwise
+      push_back(std::move(back()));
+      iterator back1 = finish;
+      --back1;
+      iterator back2 = back1;
+      --back2;
+      position = start + index;
+      std::move_backward(position, back2, back1);
     }
-    *position = val;
+    *position = std::move(val_copy);
     return position;
   }
 };
@@ -319,13 +427,45 @@ protected:
  */
 template <class T, class Alloc, size_t BufSiz>
 void sup::deque<T, Alloc, BufSiz>::push_back(const value_type& val) {
-  if (finish.cur != finish.last - 1) { // there is space remaining 
+  if (finish.last - finish.cur > 1) { // there is space remaining 
     sup::_construct(finish.cur, val);
     ++finish.cur; // inplace ++ just for the pointer cur
   } else 
     push_back_aux(val);
 }
 
+/**
+ * @brief move an element into the back of the deque
+ * 
+ * @tparam T - element type parameter
+ * @tparam Alloc - allocator type
+ * @tparam BufSiz - buffer size
+ * @param val - to be moved in
+ */
+template <class T, class Alloc, size_t BufSiz>
+void sup::deque<T, Alloc, BufSiz>::push_back(value_type&& val) {
+  emplace_back(std::move(val));
+}
+
+/**
+ * @brief construct an element at the back of the deque from args
+ * 
+ * @tparam T - element type parameter
+ * @tparam Alloc - allocator type
+ * @tparam BufSiz - buffer size
+ * @tparam Args - types of the arguments of a constructor of T
+ * @param args - the arguments
+ */
+template <class T, class Alloc, size_t BufSiz>
+template <class... Args>
+void sup::deque<T, Alloc, BufSiz>::emplace_back(Args&&... args) {
+  if (finish.last - finish.cur > 1) { // there is space remaining 
+    sup::_construct(finish.cur, std::forward<Args>(args)...);
+    ++finish.cur;
+  } else 
+    push_back_aux(std::forward<Args>(args)...);
+}
+
 /**
  * @brief push an element into the front of the deque
  * 
@@ -343,6 +483,38 @@ void sup::deque<T, Alloc, BufSiz>::push_front(const value_type& val) {
     push_front_aux(val);
 }
 
+/**
+ * @brief move an element into the front of the deque
+ * 
+ * @tparam T - element type parameter
+ * @tparam Alloc - allocator type
+ * @tparam BufSiz - buffer size
+ * @param val - to be moved in
+ */
+template <class T, class Alloc, size_t BufSiz>
+void sup::deque<T, Alloc, BufSiz>::push_front(value_type&& val) {
+  emplace_front(std::move(val));
+}
+
+/**
+ * @brief construct an element at the front of the deque from args
+ * 
+ * @tparam T - element type parameter
+ * @tparam Alloc - allocator type
+ * @tparam BufSiz - buffer size
+ * @tparam Args - types of the arguments of a constructor of T
+ * @param args - the arguments
+ */
+template <class T, class Alloc, size_t BufSiz>
+template <class... Args>
+void sup::deque<T, Alloc, BufSiz>::emplace_front(Args&&... args) {
+  if (start.cur != start.first) { // there is space remaining 
+    sup::_construct(start.cur - 1, std::forward<Args>(args)...);
+    --start.cur;
+  } else 
+    push_front_aux(std::forward<Args>(args)...);
+}
+
 /**
  * @brief pop an element out at the back
  * 
@@ -392,9 +564,12 @@ void sup::deque<T, Alloc, BufSiz>::pop_front() {
  */
 template <class T, class Alloc, size_t BufSiz>
 void sup::deque<T, Alloc, BufSiz>::clear() {
+  if (map == nullptr) return;
   // full buffers in the middle
-  for (map_pointer p_mid_buffer = start.node + 1; p_mid_buffer < finish.node; ++p_mid_buffer) 
+  for (map_pointer p_mid_buffer = start.node + 1; p_mid_buffer < finish.node; ++p_mid_buffer) {
     sup::_destroy(*p_mid_buffer, *p_mid_buffer + buffer_size());
+    data_allocator::deallocate(*p_mid_buffer, buffer_size());
+  }
 
   // start buffer and the finish buffer
   if (start.node != finish.node) { // keep the start buffer
@@ -408,6 +583,33 @@ void sup::deque<T, Alloc, BufSiz>::clear() {
   finish = start;
 }
 
+/**
+ * @brief shrink the map to the buffers in use (plus one free slot at each
+ *  end). The buffers themselves are never kept unused.
+ * 
+ * @tparam T - element type parameter
+ * @tparam Alloc - allocator type
+ * @tparam BufSiz - buffer size
+ */
+template <class T, class Alloc, size_t BufSiz>
+void sup::deque<T, Alloc, BufSiz>::shrink_to_fit() {
+  const size_type num_nodes = finish.node - start.node + 1;
+  size_type new_map_size = num_nodes + 2;
+  if (new_map_size < initialize_map_size()) new_map_size = initialize_map_size();
+  if (new_map_size >= map_size) return;
+
+  map_allocator map_alloc = get_map_allocator();
+  map_pointer new_map = map_alloc.allocate(new_map_size);
+  map_pointer new_nstart = new_map + (new_map_size - num_nodes) / 2;
+  std::copy(start.node, finish.node + 1, new_nstart);
+  map_alloc.deallocate(map, map_size);
+
+  map = new_map;
+  map_size = new_map_size;
+  start.set_node(new_nstart);
+  finish.set_node(new_nstart + num_nodes - 1);
+}
+
 /**
  * @brief erase the element pointed by the iterator
  * 
@@ -463,7 +665,7 @@ sup::deque<T, Alloc, BufSiz>::erase(iterator first, iterator last) {
     iterator new_start = start + n;
     sup::_destroy(start, new_start);
     for (map_pointer cur = start.node; cur < new_start.node; ++cur) {
-      map_allocator::deallocate(cur, buffer_size());
+      data_allocator::deallocate(*cur, buffer_size());
     }
     start = new_start;
   } else { // other wise
@@ -471,7 +673,7 @@ sup::deque<T, Alloc, BufSiz>::erase(iterator first, iterator last) {
     iterator new_finish = finish - n;
     sup::_destroy(new_finish, finish);
     for (map_pointer cur = new_finish.node + 1; cur <= finish.node; ++cur) {
-      map_allocator::deallocate(cur, buffer_size());
+      data_allocator::deallocate(*cur, buffer_size());
     }
     finish = new_finish;
   }
@@ -494,18 +696,99 @@ sup::deque<T, Alloc, BufSiz>::erase(iterator first, iterator last) {
 template <class T, class Alloc, size_t BufSiz>
 typename sup::deque<T, Alloc, BufSiz>::iterator 
 sup::deque<T, Alloc, BufSiz>::insert(iterator position, const value_type& val) {
+  return emplace(position, val);
+}
+
+/**
+ * @brief move an element in before the element pointed by position
+ * 
+ * @tparam T - element type parameter
+ * @tparam Alloc - allocator type
+ * @tparam BufSiz - buffer size
+ * @param position - the place after insertion happens
+ * @param val - to be moved in
+ * @return sup::deque<T, Alloc, BufSiz>::iterator - pointing to the element 
+ *  inserted
+ */
+template <class T, class Alloc, size_t BufSiz>
+typename sup::deque<T, Alloc, BufSiz>::iterator 
+sup::deque<T, Alloc, BufSiz>::insert(iterator position, value_type&& val) {
+  return emplace(position, std::move(val));
+}
+
+/**
+ * @brief construct an element from args before the element pointed by
+ *  position
+ * 
+ * @tparam T - element type parameter
+ * @tparam Alloc - allocator type
+ * @tparam BufSiz - buffer size
+ * @tparam Args - types of the arguments of a constructor of T
+ * @param position - the place after insertion happens
+ * @param args - the arguments
+ * @return sup::deque<T, Alloc, BufSiz>::iterator - pointing to the element 
+ *  inserted
+ */
+template <class T, class Alloc, size_t BufSiz>
+template <class... Args>
+typename sup::deque<T, Alloc, BufSiz>::iterator 
+sup::deque<T, Alloc, BufSiz>::emplace(iterator position, Args&&... args) {
   if (position.cur == start.cur) {
-    push_front(val);
+    emplace_front(std::forward<Args>(args)...);
     return start;
   } else if (position.cur == finish.cur) {
-    push_back(val);
+    emplace_back(std::forward<Args>(args)...);
     iterator tmp = finish;
     --tmp;
     return tmp;
   } else {
-    return insert_aux(position, val);
+    return emplace_aux(position, std::forward<Args>(args)...);
   }
 }
 
+/************** Erasure **************/
+
+/**
+ * @brief erase the elements satisfying pred in one pass (compaction by
+ *  remove_if, then one erase of the tail)
+ *
+ * @tparam T - element type parameter
+ * @tparam Alloc - allocator type
+ * @tparam BufSiz - buffer size
+ * @tparam Predicate - predicate type
+ * @param c - the deque
+ * @param pred - true for the elements to erase
+ * @return deque<T, Alloc, BufSiz>::size_type - number of erased elements
+ */
+template <class T, class Alloc, size_t BufSiz, class Predicate>
+typename deque<T, Alloc, BufSiz>::size_type erase_if(
+    deque<T, Alloc, BufSiz>& c, Predicate pred) {
+  typename deque<T, Alloc, BufSiz>::iterator new_end =
+      sup::remove_if(c.begin(), c.end(), pred);
+  typename deque<T, Alloc, BufSiz>::size_type n = c.end() - new_end;
+  c.erase(new_end, c.end());
+  return n;
+}
+
+/**
+ * @brief erase the elements equal to value in one pass
+ *
+ * @tparam T - element type parameter
+ * @tparam Alloc - allocator type
+ * @tparam BufSiz - buffer size
+ * @param c - the deque
+ * @param value - the value to erase
+ * @return deque<T, Alloc, BufSiz>::size_type - number of erased elements
+ */
+template <class T, class Alloc, size_t BufSiz, class U>
+typename deque<T, Alloc, BufSiz>::size_type erase(
+    deque<T, Alloc, BufSiz>& c, const U& value) {
+  typename deque<T, Alloc, BufSiz>::iterator new_end =
+      sup::remove(c.begin(), c.end(), value);
+  typename deque<T, Alloc, BufSiz>::size_type n = c.end() - new_end;
+  c.erase(new_end, c.end());
+  return n;
+}
+
 }
 #endif
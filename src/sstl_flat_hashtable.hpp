@@ -0,0 +1,596 @@
+#ifndef _SSTL_FLAT_HASHTABLE_H
+#define _SSTL_FLAT_HASHTABLE_H
+
+#include <cstring>  // memset & memcpy
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "sstl_allocator.hpp"
+#include "sstl_construct.hpp"
+#include "sstl_iterator.hpp"
+#include "sstl_uninitialized.hpp"
+
+/**
+ * @author Xiaoxi Sun
+ **/
+
+/**
+ * Concepts:
+ *  - open addressing: the elements live in one array of slots, not in one
+ *    heap node each. A lookup touches the control bytes and the slots they
+ *    point to, without chasing a chain of pointers.
+ *  - control bytes (Swiss table): every slot has one byte of metadata: empty,
+ *    deleted, or the low 7 bits of the hash (h2) of its element. The other
+ *    bits (h1) choose the group where the probe starts.
+ *  - groups: the slots are probed 16 at a time. One SSE2 compare & movemask
+ *    turns the 16 control bytes of a group into a bit mask of the slots whose
+ *    h2 matches; only those keys are compared, which is 1 in 128 of the
+ *    others on average. A probe stops at the first group holding an empty
+ *    slot, and moves to the next group quadratically otherwise.
+ *  - deletion: a slot can be marked empty again only if no probe ever went
+ *    past its group, i.e. if the group still has an empty slot. Otherwise it
+ *    becomes a tombstone (deleted): probes go on, insertions reuse it, and
+ *    rehashing drops it.
+ *  - load: at most 7/8 of the slots are full or deleted; the capacity is a
+ *    power of two (at least 16) and grows by doubling. A table with many
+ *    tombstones is rehashed in place (same capacity) instead.
+ *  - the hash is mixed before use: std::hash of an integer is the integer
+ *    itself, whose low bits would all go to h2.
+ **/
+
+/**
+ * Questions:
+ *  - the elements move on rehash: iterators, pointers & references are
+ *    invalidated by insertions (unlike hashtable)
+ *  - max_load_factor is fixed at 7/8
+ **/
+
+namespace sup {
+
+typedef signed char __ctrl_t;
+
+// the full control bytes are h2, in [0, 127]
+enum : __ctrl_t {
+  __ctrl_empty = -128,
+  __ctrl_deleted = -2,
+  __ctrl_sentinel = -1  // after the last slot, ends the iteration
+};
+
+#define __SSTL_GROUP_WIDTH 16
+
+// bit i of the masks stands for slot i of the group
+struct __flat_group {
+#ifdef __SSE2__
+  static unsigned match(const __ctrl_t* g, __ctrl_t h2) {
+    __m128i ctrl = _mm_loadu_si128((const __m128i*) g);
+    return (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl));
+  }
+  static unsigned match_empty(const __ctrl_t* g) {
+    return match(g, __ctrl_empty);
+  }
+  // empty & deleted are the control bytes with the sign bit set
+  static unsigned match_empty_or_deleted(const __ctrl_t* g) {
+    return (unsigned) _mm_movemask_epi8(_mm_loadu_si128((const __m128i*) g));
+  }
+#else
+  static unsigned match(const __ctrl_t* g, __ctrl_t h2) {
+    unsigned mask = 0;
+    for (int i = 0; i < __SSTL_GROUP_WIDTH; ++i) mask |= (unsigned) (g[i] == h2) << i;
+    return mask;
+  }
+  static unsigned match_empty(const __ctrl_t* g) {
+    return match(g, __ctrl_empty);
+  }
+  static unsigned match_empty_or_deleted(const __ctrl_t* g) {
+    unsigned mask = 0;
+    for (int i = 0; i < __SSTL_GROUP_WIDTH; ++i) mask |= (unsigned) (g[i] < 0) << i;
+    return mask;
+  }
+#endif
+};
+
+// index of the lowest set bit of a non-zero mask
+inline unsigned __lowest_bit(unsigned mask) {
+#if defined(__GNUC__)
+  return (unsigned) __builtin_ctz(mask);
+#else
+  unsigned i = 0;
+  while (!(mask & 1u)) {
+    mask >>= 1;
+    ++i;
+  }
+  return i;
+#endif
+}
+
+// spread the bits of a hash: the high & low halves of a multiplication
+// by the golden ratio, folded together
+inline size_t __flat_hash_mix(size_t h) {
+#if defined(__SIZEOF_INT128__)
+  unsigned __int128 x = (unsigned __int128) h * 0x9E3779B97F4A7C15ull;
+  return (size_t) (x ^ (x >> 64));
+#else
+  unsigned long long x = (unsigned long long) h * 0x9E3779B97F4A7C15ull;
+  return (size_t) (x ^ (x >> 32));
+#endif
+}
+
+template <class Value, class Ref, class Ptr>
+struct __flat_hashtable_iterator {
+  typedef __flat_hashtable_iterator<Value, Value&, Value*> iterator;
+  typedef __flat_hashtable_iterator<Value, const Value&, const Value*>
+    const_iterator;
+  typedef __flat_hashtable_iterator<Value, Ref, Ptr> _self;
+
+  typedef forward_iterator_tag iterator_category;
+  typedef Value value_type;
+  typedef ptrdiff_t difference_type;
+  typedef size_t size_type;
+  typedef Ptr pointer;
+  typedef Ref reference;
+
+  const __ctrl_t* ctrl;
+  Value* slot;
+
+  __flat_hashtable_iterator(const __ctrl_t* c, Value* s) : ctrl(c), slot(s) {}
+  __flat_hashtable_iterator() {}
+  __flat_hashtable_iterator(const iterator& it) : ctrl(it.ctrl), slot(it.slot) {}
+
+  reference operator*() const { return *slot; }
+  pointer operator->() const { return slot; }
+  _self& operator++() {
+    ++ctrl;
+    ++slot;
+    skip_empty_or_deleted();
+    return *this;
+  }
+  _self operator++(int) {
+    _self tmp = *this;
+    ++*this;
+    return tmp;
+  }
+  bool operator==(const _self& it) const { return ctrl == it.ctrl; }
+  bool operator!=(const _self& it) const { return ctrl != it.ctrl; }
+
+  // stops at a full slot or at the sentinel
+  void skip_empty_or_deleted() {
+    while (*ctrl < __ctrl_sentinel) {
+      ++ctrl;
+      ++slot;
+    }
+  }
+};
+
+template <class Key, class Value, class HashFunc,
+          class ExtractKey, class EqualKey, class Alloc=alloc>
+class flat_hashtable : private simple_alloc<Value, Alloc> {
+public:
+  typedef Key key_type;
+  typedef HashFunc hasher;
+  typedef EqualKey key_equal;
+  typedef size_t size_type;
+  typedef Value value_type;
+  typedef ptrdiff_t difference_type;
+  typedef Value* pointer;
+  typedef const Value* const_pointer;
+  typedef Value& reference;
+  typedef const Value& const_reference;
+  typedef Alloc allocator_type;
+  typedef __flat_hashtable_iterator<Value, Value&, Value*> iterator;
+  typedef __flat_hashtable_iterator<Value, const Value&, const Value*>
+    const_iterator;
+
+private:
+  typedef simple_alloc<Value, Alloc> slot_allocator;
+  typedef simple_alloc<__ctrl_t, Alloc> ctrl_allocator;
+
+  hasher hash;
+  key_equal equals;
+  ExtractKey get_key;
+
+  __ctrl_t* ctrl;     // capacity + 1 bytes, the last is the sentinel
+  Value* slots;
+  size_type num_of_slots;  // 0 or a power of two, at least 16
+  size_type num_of_elements;
+  size_type growth_left;   // insertions into empty slots before a rehash
+
+public:
+  /*************** De-constructors ***************/
+  flat_hashtable(size_type n, const HashFunc& hfc, const EqualKey& eq_k)
+    : hash(hfc), equals(eq_k), get_key(ExtractKey()) {
+    initialize_empty();
+    reserve(n);
+  }
+  flat_hashtable(size_type n, const HashFunc& hfc, const EqualKey& eq_k,
+                 const allocator_type& a)
+    : slot_allocator(a), hash(hfc), equals(eq_k), get_key(ExtractKey()) {
+    initialize_empty();
+    reserve(n);
+  }
+  flat_hashtable(const flat_hashtable& table)
+    : slot_allocator(table), hash(table.hash), equals(table.equals),
+      get_key(table.get_key) {
+    initialize_empty();
+    copy_from(table);
+  }
+  flat_hashtable(flat_hashtable&& table) noexcept
+    : slot_allocator(table), hash(table.hash), equals(table.equals),
+      get_key(table.get_key) {
+    initialize_empty();
+    swap_storage(table);
+  }
+  ~flat_hashtable() {
+    destroy_elements();
+    deallocate_storage();
+  }
+
+  flat_hashtable& operator=(const flat_hashtable& table) {
+    if (this == &table) return *this;
+    flat_hashtable tmp(table);
+    swap(tmp);
+    return *this;
+  }
+  flat_hashtable& operator=(flat_hashtable&& table) noexcept {
+    swap(table);
+    return *this;
+  }
+
+  /*************** Accessors ***************/
+  size_type size() const { return num_of_elements; }
+  bool empty() const { return num_of_elements == 0; }
+  size_type max_size() const { return size_type(-1) / (sizeof(Value) + 1); }
+  // the number of slots
+  size_type bucket_count() const { return num_of_slots; }
+  size_type count(const key_type& key) const {
+    return find_index(key) != num_of_slots;
+  }
+
+  iterator begin() { return make_iterator(0, true); }
+  iterator end() { return make_iterator(num_of_slots); }
+  const_iterator begin() const {
+    return const_cast<flat_hashtable*>(this)->begin();
+  }
+  const_iterator end() const {
+    return const_cast<flat_hashtable*>(this)->end();
+  }
+
+  iterator find(const key_type& key) { return make_iterator(find_index(key)); }
+  const_iterator find(const key_type& key) const {
+    return const_cast<flat_hashtable*>(this)->find(key);
+  }
+  std::pair<iterator, iterator> equal_range(const key_type& key) {
+    iterator first = find(key);
+    if (first == end()) return std::pair<iterator, iterator>(first, first);
+    iterator last = first;
+    return std::pair<iterator, iterator>(first, ++last);
+  }
+  std::pair<const_iterator, const_iterator>
+  equal_range(const key_type& key) const {
+    std::pair<iterator, iterator> range =
+        const_cast<flat_hashtable*>(this)->equal_range(key);
+    return std::pair<const_iterator, const_iterator>(range.first, range.second);
+  }
+
+  // traits
+  hasher hash_function() const { return hash; }
+  key_equal key_eq() const { return equals; }
+  allocator_type get_allocator() const { return slot_allocator::get_alloc(); }
+
+  /*************** Modifiers ***************/
+  std::pair<iterator, bool> insert_unique(const value_type& val) {
+    return emplace_unique_key(get_key(val), val);
+  }
+  std::pair<iterator, bool> insert_unique(value_type&& val) {
+    return emplace_unique_key(get_key(val), std::move(val));
+  }
+  template <class InputIterator>
+  void insert_unique(InputIterator first, InputIterator last) {
+    insert_unique(first, last, iterator_category(first));
+  }
+
+  // the element is only constructed from args if key is not found
+  template <class... Args>
+  std::pair<iterator, bool> emplace_unique_key(const key_type& key,
+                                               Args&&... args) {
+    size_type h = hash_of(key);
+    size_type i = find_index(key, h);
+    if (i != num_of_slots)
+      return std::pair<iterator, bool>(make_iterator(i), false);
+
+    if (num_of_slots == 0) rehash_for_insert();
+    i = find_insert_slot(h);
+    if (growth_left == 0 && ctrl[i] == __ctrl_empty) {
+      rehash_for_insert();
+      i = find_insert_slot(h);
+    }
+    sup::_construct(slots + i, std::forward<Args>(args)...);
+    growth_left -= ctrl[i] == __ctrl_empty;
+    ctrl[i] = (__ctrl_t) (h & 0x7F);
+    ++num_of_elements;
+    return std::pair<iterator, bool>(make_iterator(i), true);
+  }
+
+  size_type erase(const key_type& key) {
+    size_type i = find_index(key);
+    if (i == num_of_slots) return 0;
+    erase_at(i);
+    return 1;
+  }
+  void erase(const const_iterator& it) { erase_at(it.ctrl - ctrl); }
+  void erase(const_iterator first, const_iterator last) {
+    while (first != last) {
+      size_type i = first.ctrl - ctrl;
+      ++first;  // erasing does not move the other elements
+      erase_at(i);
+    }
+  }
+  void clear();
+  void swap(flat_hashtable& table) {
+    std::swap(hash, table.hash);
+    std::swap(equals, table.equals);
+    _alloc_swap<slot_allocator>::_swap(*this, table);
+    swap_storage(table);
+  }
+
+  /*************** Load & capacity ***************/
+  float load_factor() const {
+    return num_of_slots == 0 ? 0.0f : (float) num_of_elements / num_of_slots;
+  }
+  float max_load_factor() const { return 0.875f; }
+  void max_load_factor(float) {}
+
+  // at least n slots
+  void rehash(size_type n) {
+    if (n > num_of_slots) rehash_to(slots_for_capacity(n));
+  }
+  // room for n elements without rehashing
+  void reserve(size_type n) {
+    if (n > num_of_elements + growth_left) rehash_to(slots_for(n));
+  }
+  // the fewest slots the elements need; tombstones are dropped
+  void shrink_to_fit() {
+    if (num_of_elements == 0) {
+      deallocate_storage();
+      initialize_empty();
+    } else {
+      rehash_to(slots_for(num_of_elements));
+    }
+  }
+  // bytes allocated by the table
+  size_type memory_usage() const {
+    return num_of_slots == 0 ? 0 : num_of_slots * (sizeof(Value) + 1) + 1;
+  }
+
+private:
+  /*************** Helpers ***************/
+  size_type hash_of(const key_type& key) const {
+    return __flat_hash_mix(hash(key));
+  }
+  size_type group_mask() const {
+    return num_of_slots / __SSTL_GROUP_WIDTH - 1;
+  }
+  static size_type max_elements(size_type slots) { return slots - slots / 8; }
+  // the power of two slots holding n elements
+  static size_type slots_for(size_type n) {
+    size_type s = __SSTL_GROUP_WIDTH;
+    while (max_elements(s) < n) s <<= 1;
+    return s;
+  }
+  static size_type slots_for_capacity(size_type n) {
+    size_type s = __SSTL_GROUP_WIDTH;
+    while (s < n) s <<= 1;
+    return s;
+  }
+
+  iterator make_iterator(size_type i, bool skip=false) {
+    iterator it(ctrl + i, slots + i);
+    if (skip) it.skip_empty_or_deleted();
+    return it;
+  }
+
+  size_type find_index(const key_type& key) const {
+    return num_of_slots == 0 ? 0 : find_index(key, hash_of(key));
+  }
+  // the slot of key, or num_of_slots
+  size_type find_index(const key_type& key, size_type h) const {
+    if (num_of_slots == 0) return 0;
+    const __ctrl_t h2 = (__ctrl_t) (h & 0x7F);
+    size_type g = (h >> 7) & group_mask();
+    for (size_type step = 1;; ++step) {
+      const __ctrl_t* group = ctrl + g * __SSTL_GROUP_WIDTH;
+      for (unsigned m = __flat_group::match(group, h2); m != 0; m &= m - 1) {
+        size_type i = g * __SSTL_GROUP_WIDTH + __lowest_bit(m);
+        if (equals(get_key(slots[i]), key)) return i;
+      }
+      if (__flat_group::match_empty(group) != 0) return num_of_slots;
+      g = (g + step) & group_mask();
+    }
+  }
+  // the first empty or deleted slot on the probe sequence of h
+  size_type find_insert_slot(size_type h) const {
+    size_type g = (h >> 7) & group_mask();
+    for (size_type step = 1;; ++step) {
+      const __ctrl_t* group = ctrl + g * __SSTL_GROUP_WIDTH;
+      unsigned m = __flat_group::match_empty_or_deleted(group);
+      if (m != 0) return g * __SSTL_GROUP_WIDTH + __lowest_bit(m);
+      g = (g + step) & group_mask();
+    }
+  }
+
+  void erase_at(size_type i) {
+    sup::_destroy(slots + i);
+    --num_of_elements;
+    // no probe went past a group with an empty slot
+    const __ctrl_t* group = ctrl + (i & ~(size_type) (__SSTL_GROUP_WIDTH - 1));
+    if (__flat_group::match_empty(group) != 0) {
+      ctrl[i] = __ctrl_empty;
+      ++growth_left;
+    } else {
+      ctrl[i] = __ctrl_deleted;
+    }
+  }
+
+  // double, or drop the tombstones if they take half of the room
+  void rehash_for_insert() {
+    if (num_of_slots != 0 && num_of_elements < max_elements(num_of_slots) / 2)
+      rehash_to(num_of_slots);
+    else
+      rehash_to(num_of_slots == 0 ? __SSTL_GROUP_WIDTH : num_of_slots * 2);
+  }
+  void rehash_to(size_type n);
+
+  void initialize_empty() {
+    static __ctrl_t sentinel = __ctrl_sentinel;
+    ctrl = &sentinel;
+    slots = nullptr;
+    num_of_slots = 0;
+    num_of_elements = 0;
+    growth_left = 0;
+  }
+  // the members are only changed once both blocks are allocated
+  void allocate_storage(size_type n) {
+    __ctrl_t* new_ctrl = ctrl_allocator(*this).allocate(n + 1);
+    try {
+      slots = slot_allocator::allocate(n);
+    } catch (...) {
+      ctrl_allocator(*this).deallocate(new_ctrl, n + 1);
+      throw;
+    }
+    ctrl = new_ctrl;
+    memset(ctrl, (unsigned char) __ctrl_empty, n);
+    ctrl[n] = __ctrl_sentinel;
+    num_of_slots = n;
+    num_of_elements = 0;
+    growth_left = max_elements(n);
+  }
+  void deallocate_storage() {
+    if (num_of_slots == 0) return;
+    ctrl_allocator(*this).deallocate(ctrl, num_of_slots + 1);
+    slot_allocator::deallocate(slots, num_of_slots);
+  }
+  void destroy_elements() {
+    for (size_type i = 0; i < num_of_slots; ++i)
+      if (ctrl[i] >= 0) sup::_destroy(slots + i);
+  }
+  void swap_storage(flat_hashtable& table) {
+    std::swap(ctrl, table.ctrl);
+    std::swap(slots, table.slots);
+    std::swap(num_of_slots, table.num_of_slots);
+    std::swap(num_of_elements, table.num_of_elements);
+    std::swap(growth_left, table.growth_left);
+  }
+  void copy_from(const flat_hashtable& table);
+
+  template <class InputIterator>
+  void insert_unique(InputIterator first, InputIterator last,
+                     input_iterator_tag) {
+    for (; first != last; ++first) insert_unique(*first);
+  }
+  template <class ForwardIterator>
+  void insert_unique(ForwardIterator first, ForwardIterator last,
+                     forward_iterator_tag) {
+    reserve(num_of_elements + (size_type) sup::distance(first, last));
+    for (; first != last; ++first) insert_unique(*first);
+  }
+};
+
+/**
+ * @brief destroy all the elements; the slots are kept
+ *
+ * @tparam Key - of the hashtable
+ * @tparam Value - of the hashtable
+ * @tparam HashFunc - of the hashtable
+ * @tparam ExtractKey - extract key from the value of Value type
+ * @tparam EqualKey - determine whether two keys are equal
+ * @tparam Alloc - allocator type
+ */
+template <class Key, class Value, class HashFunc,
+          class ExtractKey, class EqualKey, class Alloc>
+void flat_hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::clear() {
+  if (num_of_slots == 0) return;
+  destroy_elements();
+  memset(ctrl, (unsigned char) __ctrl_empty, num_of_slots);
+  num_of_elements = 0;
+  growth_left = max_elements(num_of_slots);
+}
+
+/**
+ * @brief move the elements into n slots, n a power of two that holds them.
+ *  Each element is relocated (moved & destroyed, or its bytes copied) to the
+ *  slot its hash finds in the new table; the tombstones are dropped.
+ *
+ * @tparam Key - of the hashtable
+ * @tparam Value - of the hashtable
+ * @tparam HashFunc - of the hashtable
+ * @tparam ExtractKey - extract key from the value of Value type
+ * @tparam EqualKey - determine whether two keys are equal
+ * @tparam Alloc - allocator type
+ * @param n - the new number of slots
+ */
+template <class Key, class Value, class HashFunc,
+          class ExtractKey, class EqualKey, class Alloc>
+void flat_hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::rehash_to(
+    size_type n) {
+  __ctrl_t* old_ctrl = ctrl;
+  Value* old_slots = slots;
+  size_type old_num_of_slots = num_of_slots;
+  size_type elements = num_of_elements;
+
+  allocate_storage(n);
+  for (size_type i = 0; i < old_num_of_slots; ++i) {
+    if (old_ctrl[i] < 0) continue;
+    size_type h = hash_of(get_key(old_slots[i]));
+    size_type j = find_insert_slot(h);
+    sup::uninitialized_relocate(old_slots + i, old_slots + i + 1, slots + j);
+    ctrl[j] = (__ctrl_t) (h & 0x7F);
+  }
+  num_of_elements = elements;
+  growth_left -= elements;
+
+  if (old_num_of_slots != 0) {
+    ctrl_allocator(*this).deallocate(old_ctrl, old_num_of_slots + 1);
+    slot_allocator::deallocate(old_slots, old_num_of_slots);
+  }
+}
+
+/**
+ * @brief copy the slots of table into empty storage of the same size; each
+ *  element keeps its slot, so nothing is rehashed.
+ *
+ * @tparam Key - of the hashtable
+ * @tparam Value - of the hashtable
+ * @tparam HashFunc - of the hashtable
+ * @tparam ExtractKey - extract key from the value of Value type
+ * @tparam EqualKey - determine whether two keys are equal
+ * @tparam Alloc - allocator type
+ * @param table - another hash table of the same type
+ */
+template <class Key, class Value, class HashFunc,
+          class ExtractKey, class EqualKey, class Alloc>
+void flat_hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::copy_from(
+    const flat_hashtable& table) {
+  if (table.num_of_elements == 0) return;
+  allocate_storage(table.num_of_slots);
+  size_type i = 0;
+  try {
+    for (; i < num_of_slots; ++i) {
+      if (table.ctrl[i] >= 0) sup::_construct(slots + i, table.slots[i]);
+    }
+  } catch (...) {
+    while (i-- > 0)
+      if (table.ctrl[i] >= 0) sup::_destroy(slots + i);
+    deallocate_storage();
+    initialize_empty();
+    throw;
+  }
+  memcpy(ctrl, table.ctrl, num_of_slots);
+  num_of_elements = table.num_of_elements;
+  growth_left = table.growth_left;
+}
+
+}  // namespace sup
+
+#endif
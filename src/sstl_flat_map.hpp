@@ -0,0 +1,360 @@
+#ifndef _SSTL_FLAT_MAP_H
+#define _SSTL_FLAT_MAP_H
+
+#include <algorithm>  // std::stable_sort & std::equal
+#include <functional>
+#include <type_traits>  // std::remove_const
+#include <utility>
+
+#include "./algorithms/sstl_binary_operations.hpp"
+#include "sstl_flat_storage.hpp"
+#include "sstl_iterator.hpp"
+#include "sstl_vector.hpp"
+
+/**
+ * @author Xiaoxi Sun
+ **/
+
+/**
+ * Concepts:
+ *  - flat map: the keys are kept sorted in one vector and the values in
+ *    another one, at the same indices. A lookup is a binary search over the
+ *    keys only, so the values never pollute the cache lines being searched,
+ *    and iterating the values walks one array. A map node costs 3 pointers
+ *    and a color besides the pair; here only the unused capacity is extra.
+ *    insert & erase move O(n) elements, so it suits read-mostly tables.
+ *  - bulk construction: the range constructors & insert(first, last) sort
+ *    the new pairs, drop the duplicate keys once (the first one wins, as in
+ *    map) and merge them with the current ones in one pass
+ *  - proxy reference: there is no pair in memory, so dereferencing an
+ *    iterator gives std::pair<const Key&, Value&> (a pair of references), and
+ *    operator-> returns a small object holding that pair
+ *  - bool keys & values: vector<bool> packs its elements into bits and has
+ *    no bool& nor bool*, so they are kept one byte each, as __flat_bool
+ *    (sstl_flat_storage.hpp); the iterators project the bool out of it
+ **/
+
+/**
+ * Questions:
+ *  - std::stable_sort used; sup::sort has no comparator
+ *  - std::pair of references as the reference type (same as std::flat_map)
+ *  - reverse_iterator::operator-> does not work with the proxy pointer
+ **/
+
+namespace sup {
+
+// the pointer type of a proxy reference: holds the reference itself
+template <class Reference>
+struct __arrow_proxy {
+  Reference ref;
+  Reference* operator->() { return &ref; }
+};
+
+/**
+ * @brief iterator of flat_map: a key pointer and a value pointer moving
+ *  together, pointing to the stored elements (see __flat_storage)
+ *
+ * @tparam Key - key type
+ * @tparam Value - mapped type (const Value for const_iterator)
+ */
+template <class Key, class Value>
+struct __flat_map_iterator {
+  typedef random_access_iterator_tag iterator_category;
+  typedef std::pair<Key, typename std::remove_const<Value>::type> value_type;
+  typedef ptrdiff_t difference_type;
+  typedef std::pair<const Key&, Value&> reference;
+  typedef __arrow_proxy<reference> pointer;
+  typedef __flat_map_iterator<Key, Value> _self;
+  typedef typename std::remove_const<Value>::type mapped_type;
+  typedef __flat_map_iterator<Key, mapped_type> iterator;
+  typedef __flat_storage<Key> key_storage;
+  typedef __flat_storage<mapped_type> mapped_storage;
+  typedef typename std::conditional<
+      std::is_const<Value>::value, const typename mapped_storage::type,
+      typename mapped_storage::type>::type stored_value_type;
+
+  const typename key_storage::type* key;
+  stored_value_type* value;
+
+  __flat_map_iterator() : key(nullptr), value(nullptr) {}
+  __flat_map_iterator(const typename key_storage::type* k,
+                      stored_value_type* v)
+      : key(k), value(v) {}
+  // iterator to const_iterator
+  __flat_map_iterator(const iterator& it) : key(it.key), value(it.value) {}
+
+  reference operator*() const {
+    return reference(key_storage::get(*key), mapped_storage::get(*value));
+  }
+  pointer operator->() const { return pointer{**this}; }
+  reference operator[](difference_type n) const { return *(*this + n); }
+
+  _self& operator++() { ++key; ++value; return *this; }
+  _self operator++(int) { _self tmp = *this; ++*this; return tmp; }
+  _self& operator--() { --key; --value; return *this; }
+  _self operator--(int) { _self tmp = *this; --*this; return tmp; }
+  _self& operator+=(difference_type n) { key += n; value += n; return *this; }
+  _self& operator-=(difference_type n) { key -= n; value -= n; return *this; }
+  _self operator+(difference_type n) const { _self tmp = *this; return tmp += n; }
+  _self operator-(difference_type n) const { _self tmp = *this; return tmp -= n; }
+  difference_type operator-(const _self& x) const { return key - x.key; }
+
+  bool operator==(const _self& x) const { return key == x.key; }
+  bool operator!=(const _self& x) const { return key != x.key; }
+  bool operator<(const _self& x) const { return key < x.key; }
+  bool operator>(const _self& x) const { return key > x.key; }
+  bool operator<=(const _self& x) const { return key <= x.key; }
+  bool operator>=(const _self& x) const { return key >= x.key; }
+};
+
+template <class Key, class Value, class Compare=std::less<Key>, class Alloc=alloc>
+class flat_map {
+ public:
+  typedef Key key_type;
+  typedef Value data_type;
+  typedef Value mapped_type;
+  typedef std::pair<const key_type, mapped_type> pair_type;
+  typedef std::pair<key_type, mapped_type> value_type;
+  typedef Compare key_compare;
+
+ private:
+  typedef vector<typename __flat_storage<Key>::type, Alloc> key_container_type;
+  typedef vector<typename __flat_storage<Value>::type, Alloc>
+      mapped_container_type;
+
+ public:
+  typedef __flat_map_iterator<Key, Value> iterator;
+  typedef __flat_map_iterator<Key, const Value> const_iterator;
+  typedef typename iterator::reference reference;
+  typedef typename const_iterator::reference const_reference;
+  typedef typename iterator::pointer pointer;
+  typedef typename const_iterator::pointer const_pointer;
+  typedef sup::reverse_iterator<iterator> reverse_iterator;
+  typedef sup::reverse_iterator<const_iterator> const_reverse_iterator;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+  typedef typename key_container_type::allocator_type allocator_type;
+
+  /************ De-construcotrs ************/
+  flat_map() : comp(Compare()) {}
+  explicit flat_map(const Compare& c) : comp(c) {}
+  template <class InputIterator>
+  flat_map(InputIterator first, InputIterator last) : comp(Compare()) {
+    insert(first, last);
+  }
+  template <class InputIterator>
+  flat_map(InputIterator first, InputIterator last, const Compare& c)
+      : comp(c) {
+    insert(first, last);
+  }
+
+  /************** Accessors **************/
+  key_compare key_comp() const { return comp; }
+  iterator begin() { return iterator(keys.begin(), vals.begin()); }
+  const_iterator begin() const {
+    return const_iterator(keys.begin(), vals.begin());
+  }
+  iterator end() { return iterator(keys.end(), vals.end()); }
+  const_iterator end() const { return const_iterator(keys.end(), vals.end()); }
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+  bool empty() const { return keys.empty(); }
+  size_type size() const { return keys.size(); }
+  size_type max_size() const {
+    return size_type(-1) / (sizeof(Key) + sizeof(Value));
+  }
+  // the sorted keys, and the values in the same order (as __flat_bool for
+  // bool keys & values)
+  const key_container_type& key_sequence() const { return keys; }
+  const mapped_container_type& value_sequence() const { return vals; }
+
+  data_type& operator[](const key_type& k) {
+    size_type i = lower_bound_index(k);
+    if (i == size() || comp(k, keys[i])) {
+      insert_at(i, k, Value());
+    }
+    return __flat_storage<Value>::get(vals[i]);
+  }
+  void swap(flat_map& m2) {
+    keys.swap(m2.keys);
+    vals.swap(m2.vals);
+    std::swap(comp, m2.comp);
+  }
+
+  iterator find(const key_type& k) { return begin() + find_index(k); }
+  const_iterator find(const key_type& k) const {
+    return begin() + find_index(k);
+  }
+  size_type count(const key_type& k) const { return find_index(k) != size(); }
+  bool contains(const key_type& k) const { return find_index(k) != size(); }
+
+  iterator lower_bound(const key_type& k) {
+    return begin() + lower_bound_index(k);
+  }
+  const_iterator lower_bound(const key_type& k) const {
+    return begin() + lower_bound_index(k);
+  }
+  iterator upper_bound(const key_type& k) {
+    return begin() + upper_bound_index(k);
+  }
+  const_iterator upper_bound(const key_type& k) const {
+    return begin() + upper_bound_index(k);
+  }
+
+  std::pair<iterator, iterator> equal_range(const key_type& k) {
+    iterator it = lower_bound(k);
+    return std::pair<iterator, iterator>(
+        it, it != end() && !comp(k, (*it).first) ? it + 1 : it);
+  }
+  std::pair<const_iterator, const_iterator> equal_range(
+      const key_type& k) const {
+    const_iterator it = lower_bound(k);
+    return std::pair<const_iterator, const_iterator>(
+        it, it != end() && !comp(k, (*it).first) ? it + 1 : it);
+  }
+
+  /************** Capacity **************/
+  void reserve(size_type n) {
+    keys.reserve(n);
+    vals.reserve(n);
+  }
+  void shrink_to_fit() {
+    keys.shrink_to_fit();
+    vals.shrink_to_fit();
+  }
+  // bytes allocated by the map
+  size_type memory_usage() const {
+    return keys.memory_usage() + vals.memory_usage();
+  }
+
+  /************** Modifiers **************/
+  std::pair<iterator, bool> insert(const pair_type& pair_val) {
+    size_type i = lower_bound_index(pair_val.first);
+    if (i != size() && !comp(pair_val.first, keys[i])) {
+      return std::pair<iterator, bool>(begin() + i, false);
+    }
+    insert_at(i, pair_val.first, pair_val.second);
+    return std::pair<iterator, bool>(begin() + i, true);
+  }
+
+  template <class InputIterator>
+  void insert(InputIterator first, InputIterator last) {
+    vector<value_type, Alloc> batch;
+    for (; first != last; ++first) batch.push_back(value_type(*first));
+    sort_unique(batch);
+    merge_unique(batch);
+  }
+
+  iterator erase(iterator position) {
+    size_type i = position.key - keys.begin();
+    keys.erase(keys.begin() + i);
+    vals.erase(vals.begin() + i);
+    return begin() + i;
+  }
+  size_type erase(const key_type& key) {
+    size_type i = find_index(key);
+    if (i == size()) return 0;
+    erase(begin() + i);
+    return 1;
+  }
+  iterator erase(iterator first, iterator last) {
+    size_type i = first.key - keys.begin();
+    size_type j = last.key - keys.begin();
+    keys.erase(keys.begin() + i, keys.begin() + j);
+    vals.erase(vals.begin() + i, vals.begin() + j);
+    return begin() + i;
+  }
+  void clear() {
+    keys.clear();
+    vals.clear();
+  }
+
+ private:
+  key_container_type keys;
+  mapped_container_type vals;
+  Compare comp;
+
+  size_type lower_bound_index(const key_type& k) const {
+    return sup::lower_bound(keys.begin(), keys.end(), k, comp) - keys.begin();
+  }
+  size_type upper_bound_index(const key_type& k) const {
+    return sup::upper_bound(keys.begin(), keys.end(), k, comp) - keys.begin();
+  }
+  // size() if not found
+  size_type find_index(const key_type& k) const {
+    size_type i = lower_bound_index(k);
+    return i != size() && !comp(k, keys[i]) ? i : size();
+  }
+
+  // both vectors grow, or neither does
+  void insert_at(size_type i, const key_type& k, const mapped_type& v) {
+    keys.insert(keys.begin() + i, k);
+    try {
+      vals.insert(vals.begin() + i, v);
+    } catch (...) {
+      keys.erase(keys.begin() + i);
+      throw;
+    }
+  }
+
+  // sort by key and keep the first pair of the equivalent keys
+  void sort_unique(vector<value_type, Alloc>& batch) {
+    const Compare& cmp = comp;
+    std::stable_sort(batch.begin(), batch.end(),
+                     [&cmp](const value_type& a, const value_type& b) {
+                       return cmp(a.first, b.first);
+                     });
+    typename vector<value_type, Alloc>::iterator new_end = std::unique(
+        batch.begin(), batch.end(),
+        [&cmp](const value_type& a, const value_type& b) {
+          return !cmp(a.first, b.first);
+        });
+    batch.erase(new_end, batch.end());
+  }
+
+  // merge pairs sorted by unique keys; the keys already in the map win
+  void merge_unique(vector<value_type, Alloc>& batch) {
+    if (batch.empty()) return;
+
+    key_container_type new_keys;
+    mapped_container_type new_vals;
+    new_keys.reserve(size() + batch.size());
+    new_vals.reserve(size() + batch.size());
+    size_type a = 0;
+    typename vector<value_type, Alloc>::iterator b = batch.begin();
+    while (a != size() && b != batch.end()) {
+      if (comp(b->first, keys[a])) {
+        new_keys.push_back(std::move(b->first));
+        new_vals.push_back(std::move(b->second));
+        ++b;
+      } else {
+        if (!comp(keys[a], b->first)) ++b;  // equivalent
+        new_keys.push_back(std::move(keys[a]));
+        new_vals.push_back(std::move(vals[a]));
+        ++a;
+      }
+    }
+    for (; a != size(); ++a) {
+      new_keys.push_back(std::move(keys[a]));
+      new_vals.push_back(std::move(vals[a]));
+    }
+    for (; b != batch.end(); ++b) {
+      new_keys.push_back(std::move(b->first));
+      new_vals.push_back(std::move(b->second));
+    }
+    keys.swap(new_keys);
+    vals.swap(new_vals);
+  }
+};
+
+template <class Key, class Value, class Compare, class Alloc>
+bool operator==(const flat_map<Key, Value, Compare, Alloc>& m1,
+                const flat_map<Key, Value, Compare, Alloc>& m2) {
+  return m1.size() == m2.size() && std::equal(m1.begin(), m1.end(), m2.begin());
+}
+
+}  // namespace sup
+
+#endif
@@ -0,0 +1,202 @@
+#ifndef _SSTL_FLAT_SET_H
+#define _SSTL_FLAT_SET_H
+
+#include <algorithm>  // std::stable_sort & std::unique
+#include <functional>
+#include <utility>
+
+#include "./algorithms/sstl_binary_operations.hpp"
+#include "sstl_flat_storage.hpp"
+#include "sstl_vector.hpp"
+
+/**
+ * @author Xiaoxi Sun
+ **/
+
+/**
+ * Concepts:
+ *  - flat set: the keys are kept sorted in one vector. A lookup is a binary
+ *    search over contiguous memory, iteration walks an array, and there is
+ *    no node overhead (a set node holds 3 pointers and a color besides the
+ *    key). The cost is insert & erase: O(n) moves instead of O(log n).
+ *    Suits tables that are built once and then mostly read.
+ *  - bulk construction: the range constructors & insert(first, last) sort
+ *    the new keys and drop the duplicates once (O(m log m)), then merge them
+ *    with the current keys in one pass, instead of m sorted insertions
+ *  - iterators are const pointers: modifying a key would break the order.
+ *    bool keys are stored as __flat_bool (sstl_flat_storage.hpp), since
+ *    vector<bool> has no bool*
+ **/
+
+/**
+ * Questions:
+ *  - std::stable_sort & std::unique used; sup::sort has no comparator
+ *  - std::less used as the default comparator
+ **/
+
+namespace sup {
+
+template <class Key, class Compare=std::less<Key>, class Alloc=alloc>
+class flat_set {
+ public:
+  typedef Key key_type;
+  typedef Key value_type;
+  typedef Compare key_compare;
+  typedef Compare value_compare;
+
+ private:
+  typedef vector<typename __flat_storage<Key>::type, Alloc> container_type;
+
+ public:
+  typedef const Key* pointer;
+  typedef const Key* const_pointer;
+  typedef const Key& reference;
+  typedef const Key& const_reference;
+  typedef typename __flat_storage<Key>::const_iterator iterator;
+  typedef typename __flat_storage<Key>::const_iterator const_iterator;
+  typedef sup::reverse_iterator<const_iterator> reverse_iterator;
+  typedef sup::reverse_iterator<const_iterator> const_reverse_iterator;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+  typedef typename container_type::allocator_type allocator_type;
+
+  /*************** De-Constructors ***************/
+  flat_set() : comp(Compare()) {}
+  explicit flat_set(const Compare& cmp) : comp(cmp) {}
+  template <class InputIterator>
+  flat_set(InputIterator first, InputIterator last)
+      : keys(first, last), comp(Compare()) {
+    sort_unique(keys);
+  }
+  template <class InputIterator>
+  flat_set(InputIterator first, InputIterator last, const Compare& cmp)
+      : keys(first, last), comp(cmp) {
+    sort_unique(keys);
+  }
+
+  /*************** Accessors ***************/
+  iterator begin() const { return iterator(keys.begin()); }
+  iterator end() const { return iterator(keys.end()); }
+  reverse_iterator rbegin() const { return reverse_iterator(end()); }
+  reverse_iterator rend() const { return reverse_iterator(begin()); }
+  bool empty() const { return keys.empty(); }
+  size_type size() const { return keys.size(); }
+  size_type max_size() const { return size_type(-1) / sizeof(Key); }
+  key_compare key_comp() const { return comp; }
+  value_compare value_comp() const { return comp; }
+  // the sorted keys (as __flat_bool for bool keys)
+  const container_type& sequence() const { return keys; }
+
+  iterator find(const Key& k) const {
+    iterator it = lower_bound(k);
+    return it != end() && !comp(k, *it) ? it : end();
+  }
+  size_type count(const Key& k) const { return find(k) != end(); }
+  bool contains(const Key& k) const { return find(k) != end(); }
+
+  iterator lower_bound(const Key& k) const {
+    return sup::lower_bound(begin(), end(), k, comp);
+  }
+  iterator upper_bound(const Key& k) const {
+    return sup::upper_bound(begin(), end(), k, comp);
+  }
+  std::pair<iterator, iterator> equal_range(const Key& k) const {
+    iterator it = lower_bound(k);
+    return std::pair<iterator, iterator>(
+        it, it != end() && !comp(k, *it) ? it + 1 : it);
+  }
+
+  /*************** Capacity ***************/
+  void reserve(size_type n) { keys.reserve(n); }
+  void shrink_to_fit() { keys.shrink_to_fit(); }
+  // bytes allocated by the set
+  size_type memory_usage() const { return keys.memory_usage(); }
+
+  /*************** Modifiers ***************/
+  std::pair<iterator, bool> insert(const value_type& val) {
+    iterator it = lower_bound(val);
+    if (it != end() && !comp(val, *it)) {
+      return std::pair<iterator, bool>(it, false);
+    }
+    size_type i = it - begin();
+    keys.insert(keys.begin() + i, val);
+    return std::pair<iterator, bool>(begin() + i, true);
+  }
+
+  template <class InputIterator>
+  void insert(InputIterator first, InputIterator last) {
+    container_type batch(first, last);
+    sort_unique(batch);
+    merge_unique(batch);
+  }
+
+  iterator erase(iterator position) {
+    size_type i = position - begin();
+    keys.erase(keys.begin() + i);
+    return begin() + i;
+  }
+  iterator erase(iterator first, iterator last) {
+    size_type i = first - begin();
+    keys.erase(keys.begin() + i, keys.begin() + (last - begin()));
+    return begin() + i;
+  }
+  size_type erase(const Key& k) {
+    iterator it = find(k);
+    if (it == end()) return 0;
+    erase(it);
+    return 1;
+  }
+  void clear() { keys.clear(); }
+  void swap(flat_set& s) {
+    keys.swap(s.keys);
+    std::swap(comp, s.comp);
+  }
+
+ private:
+  container_type keys;
+  Compare comp;
+
+  // sort and keep the first of the equivalent keys
+  void sort_unique(container_type& v) {
+    const Compare& cmp = comp;
+    std::stable_sort(v.begin(), v.end(), cmp);
+    typename container_type::iterator new_end = std::unique(
+        v.begin(), v.end(),
+        [&cmp](const Key& a, const Key& b) { return !cmp(a, b); });
+    v.erase(new_end, v.end());
+  }
+
+  // merge sorted unique keys; the keys already in the set win
+  void merge_unique(container_type& batch) {
+    if (batch.empty()) return;
+    if (empty()) {
+      keys.swap(batch);
+      return;
+    }
+
+    container_type merged;
+    merged.reserve(size() + batch.size());
+    typename container_type::iterator a = keys.begin(), b = batch.begin();
+    while (a != keys.end() && b != batch.end()) {
+      if (comp(*b, *a)) {
+        merged.push_back(std::move(*b++));
+      } else {
+        if (!comp(*a, *b)) ++b;  // equivalent
+        merged.push_back(std::move(*a++));
+      }
+    }
+    for (; a != keys.end(); ++a) merged.push_back(std::move(*a));
+    for (; b != batch.end(); ++b) merged.push_back(std::move(*b));
+    keys.swap(merged);
+  }
+};
+
+template <class Key, class Compare, class Alloc>
+bool operator==(const flat_set<Key, Compare, Alloc>& s1,
+                const flat_set<Key, Compare, Alloc>& s2) {
+  return s1.size() == s2.size() && std::equal(s1.begin(), s1.end(), s2.begin());
+}
+
+}  // namespace sup
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef _SSTL_FLAT_STORAGE_H
+#define _SSTL_FLAT_STORAGE_H
+
+#include <cstddef>
+#include <type_traits>  // std::conditional & std::is_const
+
+#include "sstl_iterator.hpp"
+
+/**
+ * @author Xiaoxi Sun
+ **/
+
+/**
+ * Concepts:
+ *  element storage of the flat containers - flat_map & flat_set keep their
+ *   keys and values in vectors and hand out pointers & references into
+ *   them. vector<bool> packs its elements into bits and has neither bool&
+ *   nor bool*, so a bool is stored as a __flat_bool (one byte) instead, and
+ *   the iterators project the bool out of it.
+ **/
+
+namespace sup {
+
+// a bool element of a flat container: a byte, not a bit of vector<bool>.
+// It converts from & to bool, so comparators & algorithms taking bool work
+// on it.
+struct __flat_bool {
+  bool value;
+  __flat_bool(bool v = false) : value(v) {}
+  operator bool() const { return value; }
+};
+
+/**
+ * @brief random access iterator over __flat_bool elements, giving bool&
+ *
+ * @tparam Bool - bool, or const bool for a const iterator
+ */
+template <class Bool>
+struct __flat_bool_iterator {
+  typedef random_access_iterator_tag iterator_category;
+  typedef bool value_type;
+  typedef ptrdiff_t difference_type;
+  typedef Bool* pointer;
+  typedef Bool& reference;
+  typedef __flat_bool_iterator<Bool> _self;
+  typedef typename std::conditional<std::is_const<Bool>::value,
+                                    const __flat_bool, __flat_bool>::type
+      stored_type;
+
+  stored_type* cur;
+
+  __flat_bool_iterator() : cur(nullptr) {}
+  __flat_bool_iterator(stored_type* p) : cur(p) {}
+  // iterator to const_iterator
+  __flat_bool_iterator(const __flat_bool_iterator<bool>& it) : cur(it.cur) {}
+
+  reference operator*() const { return cur->value; }
+  pointer operator->() const { return &cur->value; }
+  reference operator[](difference_type n) const { return cur[n].value; }
+
+  _self& operator++() { ++cur; return *this; }
+  _self operator++(int) { _self tmp = *this; ++cur; return tmp; }
+  _self& operator--() { --cur; return *this; }
+  _self operator--(int) { _self tmp = *this; --cur; return tmp; }
+  _self& operator+=(difference_type n) { cur += n; return *this; }
+  _self& operator-=(difference_type n) { cur -= n; return *this; }
+  _self operator+(difference_type n) const { return _self(cur + n); }
+  _self operator-(difference_type n) const { return _self(cur - n); }
+  difference_type operator-(const _self& x) const { return cur - x.cur; }
+
+  bool operator==(const _self& x) const { return cur == x.cur; }
+  bool operator!=(const _self& x) const { return cur != x.cur; }
+  bool operator<(const _self& x) const { return cur < x.cur; }
+  bool operator>(const _self& x) const { return cur > x.cur; }
+  bool operator<=(const _self& x) const { return cur <= x.cur; }
+  bool operator>=(const _self& x) const { return cur >= x.cur; }
+};
+
+/**
+ * @brief how a flat container stores elements of type T: as T itself,
+ *  iterated by pointers
+ *
+ * @tparam T - key or mapped type
+ */
+template <class T>
+struct __flat_storage {
+  typedef T type;
+  typedef T* iterator;
+  typedef const T* const_iterator;
+
+  static T& get(T& s) { return s; }
+  static const T& get(const T& s) { return s; }
+};
+
+// bool: as __flat_bool
+template <>
+struct __flat_storage<bool> {
+  typedef __flat_bool type;
+  typedef __flat_bool_iterator<bool> iterator;
+  typedef __flat_bool_iterator<const bool> const_iterator;
+
+  static bool& get(__flat_bool& s) { return s.value; }
+  static const bool& get(const __flat_bool& s) { return s.value; }
+};
+
+}  // namespace sup
+
+#endif
@@ -164,7 +164,7 @@ struct __fwd_list_const_iterator {
 };
 
 template<typename T, typename Alloc=alloc>
-class forward_list {
+class forward_list : private simple_alloc<__fwd_list_node<T>, Alloc> {
 public:
   typedef T value_type;
   typedef value_type* pointer;
@@ -176,6 +176,7 @@ public:
 
   typedef __fwd_list_iterator<T> iterator;
   typedef __fwd_list_const_iterator<T> const_iterator;
+  typedef Alloc allocator_type;
 
 private:
   typedef __fwd_list_node<T> list_node;
@@ -186,8 +187,20 @@ public:
 
   /******** De-constructors ********/
   forward_list() { head.next=0; }
+  explicit forward_list(const allocator_type& a) : list_node_allocator(a) {
+    head.next=0;
+  }
   ~forward_list() { clear(); }
 
+  /**
+   * @brief return the allocator of the list
+   * 
+   * @return allocator_type - the allocator
+   */
+  allocator_type get_allocator() const {
+    return list_node_allocator::get_alloc();
+  }
+
   /********** Accessors **********/
 
   /**
@@ -223,7 +236,8 @@ public:
    * @brief clear the list
    */
   void clear () {
-    list_node_base *cur = head.next;
+    list_node_base *cur = 
+      _alloc_skip_node_release<Alloc, T>::value ? nullptr : head.next;
     while (cur != nullptr) {
       list_node_base* tmp = cur;
       cur = cur->next;
@@ -241,6 +255,7 @@ public:
     list_node_base* tmp = head.next;
     head.next = l.head.next;
     l.head.next = tmp;
+    _alloc_swap<list_node_allocator>::_swap(*this, l);
   }
 
   /**
@@ -274,7 +289,7 @@ private:
   list_node_base head;
 
   // create a node with value
-  static list_node* create_node(const value_type& val) {
+  list_node* create_node(const value_type& val) {
     list_node* node = list_node_allocator::allocate(1);
     try{ // stl catch
       sup::_construct(&(node->data), val);
@@ -288,7 +303,7 @@ private:
   }
 
   // destroy a node and deallocate the space
-  static void destory_node(list_node* node) {
+  void destory_node(list_node* node) {
     sup::_destroy(&(node->data));
     list_node_allocator::deallocate(node, 1);
   }
@@ -0,0 +1,68 @@
+#ifndef _SSTL_GROWTH_POLICY_H
+#define _SSTL_GROWTH_POLICY_H
+
+#include <cstddef>
+
+/**
+ * @author Xiaoxi Sun
+ **/
+
+/**
+ * Concepts:
+ *  growth policy - how much a vector asks for when it runs out of capacity.
+ *   A policy is a class with
+ *     static size_t next_capacity(size_t old_size, size_t min_size,
+ *                                 size_t object_size);
+ *   returning a capacity of at least min_size objects (old_size is the size
+ *   before the insertion, object_size is sizeof(T)).
+ *
+ *  growth_factor_2 - double the size (the default). Fewest reallocations,
+ *   but up to half of a large buffer is unused, and the sum of all the
+ *   previous blocks is always smaller than the next one, so a freed block
+ *   can never be reused by the same vector.
+ *
+ *  growth_factor_1_5 - grow by half. About 70% more reallocations than
+ *   doubling, at most a third of the buffer is unused, and after a few
+ *   steps the freed blocks together are large enough to be reused.
+ *
+ *  growth_size_class - grow by half, then round the block up to a size
+ *   class of the allocator (multiples of 16 bytes up to 256 bytes, then four
+ *   classes per power of two), so no byte of the block is rounded away.
+ **/
+
+namespace sup {
+
+struct growth_factor_2 {
+  static size_t next_capacity(size_t old_size, size_t min_size, size_t) {
+    return 2 * old_size >= min_size ? 2 * old_size : min_size;
+  }
+};
+
+struct growth_factor_1_5 {
+  static size_t next_capacity(size_t old_size, size_t min_size, size_t) {
+    size_t n = old_size + old_size / 2;
+    return n >= min_size ? n : min_size;
+  }
+};
+
+struct growth_size_class {
+  static size_t next_capacity(size_t old_size, size_t min_size,
+                              size_t object_size) {
+    size_t n = growth_factor_1_5::next_capacity(old_size, min_size,
+                                                object_size);
+    return size_class(n * object_size) / object_size;
+  }
+
+  // the smallest size class holding bytes bytes
+  static size_t size_class(size_t bytes) {
+    if (bytes <= 256) return (bytes + 15) & ~size_t(15);
+    // 2^k < bytes <= 2^(k+1): classes are 2^k / 4 apart
+    size_t k = sizeof(unsigned long) * 8 - 1 - __builtin_clzl(bytes - 1);
+    size_t step = (size_t(1) << k) / 4;
+    return (bytes + step - 1) / step * step;
+  }
+};
+
+}  // namespace sup
+
+#endif
@@ -2,10 +2,58 @@
 #define _SSTL_HASHTABLE_H
 
 #include <algorithm>
+#include <cmath>        // ceil
+#include <iterator>     // the iterator tags of std
+#include <thread>
+#include <type_traits>  // integral_constant & is_trivial
+#include <vector>       // scratch space of bulk_insert
+
+#include "sstl_allocator.hpp"
+#include "sstl_iterator.hpp"
+#include "sstl_node_cache.hpp"
+#include "sstl_type_tratis.hpp"
+#include "sstl_vector.hpp"
 
-#include "../../src/sstl_allocator.hpp"
-#include "../../src/sstl_iterator.hpp"
-#include "../../src/sstl_vector.hpp"
+/**
+ * Concepts:
+ *  - one chain: all the nodes form a single list that starts after the
+ *    before-begin node of the table, and the nodes of a bucket are next to
+ *    each other in it. A bucket points to the node *before* its first node
+ *    (the before-begin node for the bucket at the head of the list), or is
+ *    null when empty. begin() is the node after before-begin and ++ follows
+ *    next: iteration never visits an empty bucket, and neither does clear()
+ *    or copying. This is the layout of libstdc++'s unordered containers.
+ *  - the end of a bucket is where the bucket of the next node differs, so
+ *    lookups find the bucket of the nodes they pass: free with stored hash
+ *    codes, one call of HashFunc otherwise
+ *  - erasing the first node of a bucket may empty it; the bucket after it in
+ *    the chain then points to the node before the erased one
+ *  - bucket policy: the bucket of a hash code is computed on every lookup,
+ *    insertion and erasure, and for every node passed in a chain. A 64-bit
+ *    division costs tens of cycles; the policies use multiplications
+ *    instead (see _hashtable_bucket_policy)
+ *  - incremental rehashing (Redis' dict): growing allocates the new buckets
+ *    but moves no node. The chain holds the nodes of the new buckets, then
+ *    those of the previous buckets, which still point into their part of
+ *    it. Each insertion and each erase(key) moves the first previous
+ *    buckets, and lookups search both until the previous buckets are empty.
+ *    No insertion pays for all the nodes, only for allocating the buckets.
+ *    Lookups and erasures by iterator move nothing: they keep the order of
+ *    the other elements. So lookups alone never end a rehashing; rehash,
+ *    reserve and shrink_to_fit end it at once.
+ *  - heterogeneous lookup: when both HashFunc and EqualKey are transparent
+ *    (they define is_transparent), find, count, equal_range & erase take
+ *    any key they accept; the key must hash as the equal Key does
+ *  - range insertion: a forward range is counted first and the buckets grow
+ *    once to fit it, so no insertion of the range rehashes or checks the
+ *    load factor (except with incremental rehashing, which keeps inserting
+ *    one element at a time)
+ *  - bulk insertion: the hash codes of a range are computed first, by
+ *    several threads for large ranges, then the elements are sorted by
+ *    block of buckets (counting sort) and inserted a block after the other,
+ *    so that the buckets being written stay in the cache. The nodes are
+ *    created by the calling thread only.
+ **/
 
 namespace sup {
 
@@ -14,22 +62,46 @@ template <class Key, class Value, class HashFunc,
           class ExtractKey, class EqualKey, class Alloc=alloc>
 class hashtable;
 
+// Whether the nodes of a hashtable store the full hash code of their key.
+// Rehashing, iteration and erasure then never call HashFunc, and lookups
+// compare the codes before calling EqualKey. On by default for non-trivial
+// keys (e.g. strings), whose hashing & comparison are not cheap; specialize
+// it to choose for a key and hash function.
+template <class Key, class HashFunc>
+struct _hashtable_cache_hash_code
+    : std::integral_constant<bool, !std::is_trivial<Key>::value> {};
+
+// the link of the chain; the before-begin node of a table is one
+struct __hashtable_node_base {
+  __hashtable_node_base *next;
+};
+
+template <class Value, bool CacheHashCode=false>
+struct __hashtable_node : __hashtable_node_base {
+  Value val;
+  __hashtable_node* next_node() const {
+    return static_cast<__hashtable_node*>(next);
+  }
+};
+
 template <class Value>
-struct __hashtable_node {
-  __hashtable_node *next;
+struct __hashtable_node<Value, true> : __hashtable_node_base {
+  size_t hash_code;
   Value val;
+  __hashtable_node* next_node() const {
+    return static_cast<__hashtable_node*>(next);
+  }
 };
 
 template <class Key, class Value, class HashFunc, 
           class ExtractKey, class EqualKey, class Alloc>
 struct __hashtable_iterator {
-  typedef hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>
-    _hashtable;
   typedef __hashtable_iterator<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>
     iterator;
   typedef __hashtable_iterator<Key, const Value, HashFunc, ExtractKey, EqualKey, Alloc>
     const_iterator;
-  typedef __hashtable_node<Value> node; 
+  typedef __hashtable_node<Value,
+      _hashtable_cache_hash_code<Key, HashFunc>::value> node;
 
   typedef forward_iterator_tag iterator_category; 
   typedef Value value_type;
@@ -39,44 +111,35 @@ struct __hashtable_iterator {
   typedef Value& reference; 
 
   node* cur;
-  _hashtable* table; 
 
-  __hashtable_iterator(node* n, _hashtable* tb): cur(n), table(tb) {}
+  explicit __hashtable_iterator(node* n): cur(n) {}
   __hashtable_iterator() {}
 
   reference operator*() const { return cur->val; }
   pointer operator->() const { return &(operator*());}
   iterator& operator++() {
-    node* pre = cur;
-    cur = cur->next;
-    if (cur == nullptr) {
-      size_type bucket = table->bkt_num(pre->val);
-      while (cur == nullptr && ++bucket < table->buckets.size()) {
-        cur = table->buckets[bucket];
-      }
-    }
+    cur = cur->next_node();
     return *this;
   }
   iterator operator++(int) {
-    iterator tmp = *this
+    iterator tmp = *this;
     ++(*this);
     return tmp;
   }
 
-  bool operator==(const iterator& it) { return cur == it.cur; }
-  bool operator!=(const iterator& it) { return cur != it.cur; }
+  bool operator==(const iterator& it) const { return cur == it.cur; }
+  bool operator!=(const iterator& it) const { return cur != it.cur; }
 };
 
 template <class Key, class Value, class HashFunc, 
           class ExtractKey, class EqualKey, class Alloc>
 struct __hashtable_const_iterator {
-  typedef hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>
-    _hashtable;
   typedef __hashtable_iterator<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>
     iterator;
   typedef __hashtable_const_iterator<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>
     const_iterator;
-  typedef __hashtable_node<Value> node; 
+  typedef __hashtable_node<Value,
+      _hashtable_cache_hash_code<Key, HashFunc>::value> node;
 
   typedef forward_iterator_tag iterator_category; 
   typedef Value value_type;
@@ -86,34 +149,25 @@ struct __hashtable_const_iterator {
   typedef const Value& reference; 
 
   const node* cur;
-  const _hashtable* table; 
 
-  __hashtable_const_iterator(node* n, _hashtable* tb): cur(n), table(tb) {}
+  explicit __hashtable_const_iterator(const node* n): cur(n) {}
   __hashtable_const_iterator() {}
-  __hashtable_const_iterator(const iterator& it)
-    :cur(it.cur), table(it.table) {}
+  __hashtable_const_iterator(const iterator& it): cur(it.cur) {}
 
   reference operator*() const { return cur->val; }
   pointer operator->() const { return &(operator*());}
   const_iterator& operator++() {
-    node* pre = cur;
-    cur = cur->next;
-    if (cur == nullptr) {
-      size_type bucket = table->bkt_num(pre->val);
-      while (cur == nullptr && ++bucket < table->buckets.size()) {
-        cur = table->buckets[bucket];
-      }
-    }
+    cur = cur->next_node();
     return *this;
   }
   const_iterator operator++(int) {
-    const_iterator tmp = *this
+    const_iterator tmp = *this;
     ++(*this);
     return tmp;
   }
 
-  bool operator==(const iterator& it) { return cur == it.cur; }
-  bool operator!=(const iterator& it) { return cur != it.cur; }
+  bool operator==(const const_iterator& it) const { return cur == it.cur; }
+  bool operator!=(const const_iterator& it) const { return cur != it.cur; }
 };
 
 
@@ -145,9 +199,81 @@ inline unsigned long __sstl_next_prime(unsigned long num) {
   return (position == last) ? *(position - 1) : *position;
 }
 
+// A bucket policy maps hash codes to buckets. The table keeps one, set up by
+// reset() for its number of buckets:
+//  - next_size(n): the number of buckets to grow to from n (more than n)
+//  - at_least(n): the number of buckets for a request of n (rehash)
+//  - index(h): the bucket of hash code h
+
+// Prime numbers of buckets (__sstl_prime_list). The modulo is Lemire's
+// fastmod: two multiplications by a multiplier computed once per number of
+// buckets, instead of a division for every key. The hash code is folded to
+// 32 bits first, which keeps the index of the codes below 2^32.
+struct __hashtable_prime_buckets {
+  static size_t next_size(size_t n) { return __sstl_next_prime(n); }
+  // any number of buckets works
+  static size_t at_least(size_t n) { return n < max_size() ? n : max_size(); }
+  static size_t max_size() {
+    return __hashtable_prime_list<unsigned long>::__get_prime_list()[sstl_num_of_primes-1];
+  }
+
+  void reset(size_t n) {
+    divisor = (unsigned int) n;
+    multiplier = ~0ull / divisor + 1;
+  }
+  size_t index(size_t h) const {
+    const unsigned long long code = h;
+    const unsigned int x = (unsigned int) (code ^ (code >> 32));
+#if defined(__SIZEOF_INT128__)
+    const unsigned long long low = multiplier * x;
+    return (size_t) (((unsigned __int128) low * divisor) >> 64);
+#else
+    return x % divisor;
+#endif
+  }
+
+ private:
+  unsigned long long multiplier;
+  unsigned int divisor;
+};
+
+// Power of two numbers of buckets. The hash code is multiplied by 2^64 / phi
+// (Fibonacci hashing) and the top bits are the index: a multiplication and a
+// shift, and every bit of the code reaches the index, which a mask of the
+// low bits would not give for codes such as aligned pointers.
+struct __hashtable_power2_buckets {
+  static size_t next_size(size_t n) {
+    size_t s = 8;
+    while (s <= n && s < max_size()) s <<= 1;
+    return s;
+  }
+  static size_t at_least(size_t n) { return n <= 8 ? 8 : next_size(n - 1); }
+  static size_t max_size() { return (size_t) 1 << (sizeof(size_t) * 8 - 1); }
+
+  void reset(size_t n) {
+    shift = 64;
+    for (; n > 1; n >>= 1) --shift;
+  }
+  size_t index(size_t h) const {
+    return (size_t) (((unsigned long long) h * 0x9E3779B97F4A7C15ull) >> shift);
+  }
+
+ private:
+  unsigned int shift;
+};
+
+// The bucket policy of a hashtable. Prime numbers of buckets by default;
+// specialize it to choose for a key and hash function.
+template <class Key, class HashFunc>
+struct _hashtable_bucket_policy {
+  typedef __hashtable_prime_buckets type;
+};
+
 template <class Key, class Value, class HashFunc, 
           class ExtractKey, class EqualKey, class Alloc>
-class hashtable {
+class hashtable
+    : private simple_alloc<__hashtable_node<Value,
+          _hashtable_cache_hash_code<Key, HashFunc>::value>, Alloc> {
 public: 
   typedef Key key_type;
   typedef HashFunc hasher;
@@ -163,147 +289,132 @@ public:
   typedef const Value* const_pointer;
   typedef Value& reference;
   typedef const Value& const_reference;
+  typedef Alloc allocator_type;
 
 private:
   hasher hash;
   key_equal equals;
   ExtractKey get_key;
 
-  typedef __hashtable_node<Value> node;
+  typedef __hashtable_node<Value,
+      _hashtable_cache_hash_code<Key, HashFunc>::value> node;
+  typedef __hashtable_node<Value, true> cached_node;
+  typedef __hashtable_node<Value, false> uncached_node;
   typedef simple_alloc<node, Alloc> node_allocator;
   typedef hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc> _self;
-  typedef sup::vector<node*, Alloc> bucket_type;
-  sup::vector<node*, Alloc> buckets;
+  typedef __hashtable_node_base node_base;
+  typedef sup::vector<node_base*, Alloc> bucket_type;
+  typedef typename _hashtable_bucket_policy<Key, HashFunc>::type bucket_policy;
+  bucket_type buckets;     // the node before the first of each bucket
+  bucket_policy policy;    // set up for buckets.size()
+  node_base before_begin;  // before the first node of the chain
   size_type num_of_elements;
   float max_load_factor_value;
+  _node_cache<node> spare_nodes;  // erased nodes kept for reuse
+  // while rehashing incrementally: the buckets being emptied, whose nodes
+  // follow new_tail, the last node of buckets (or before_begin). new_tail
+  // is nullptr otherwise.
+  bucket_type old_buckets;
+  bucket_policy old_policy;
+  node_base* new_tail;
+  bool incremental;
 
 public:
   /*************** De-constructors ***************/
   hashtable(size_type n, const HashFunc hfc, const EqualKey eq_k)
-    :hash(hfc), equals(eq_k), get_key(ExtractKey()), num_of_elements(0), max_load_factor_value(1.0) {
+    :hash(hfc), equals(eq_k), get_key(ExtractKey()), num_of_elements(0), max_load_factor_value(1.0),
+     new_tail(nullptr), incremental(false) {
     initialize_buckets(n);
   }
-  ~hashtable() { clear(); }
+  hashtable(size_type n, const HashFunc hfc, const EqualKey eq_k,
+            const allocator_type& a)
+    :node_allocator(a), hash(hfc), equals(eq_k), get_key(ExtractKey()),
+     buckets(a), num_of_elements(0), max_load_factor_value(1.0),
+     old_buckets(a), new_tail(nullptr), incremental(false) {
+    initialize_buckets(n);
+  }
+  hashtable(const hashtable& table)
+    :node_allocator(table), hash(table.hash), equals(table.equals),
+     get_key(table.get_key), buckets(table.buckets.get_allocator()),
+     num_of_elements(0), max_load_factor_value(table.max_load_factor_value),
+     old_buckets(table.buckets.get_allocator()), new_tail(nullptr),
+     incremental(table.incremental) {
+    *this = table;
+  }
+  ~hashtable() {
+    clear();
+    spare_nodes.release(static_cast<node_allocator&>(*this));
+  }
   
   /*************** Accessors ***************/
   size_type size() const { return num_of_elements; }
   bool empty() const { return num_of_elements == 0; }
-  size_type count(const key_type& key) {
-    std::pair<iterator, iterator> tmp_range = equal_range(key);
-    size_type num = 0;
-    while (tmp_range.first != tmp_range.second) {
-      ++tmp_range.first;
-      ++num;
-    }
-    return num;
-  }
+  size_type count(const key_type& key) { return count_key(key); }
   size_type max_size() const { return size_type(-1); }
   size_type bucket_count() const { return buckets.size(); }
-  size_type max_bucket_count() const 
-    { return __hashtable_prime_list<unsigned long>::__get_prime_list()[sstl_num_of_primes-1]; }
+  size_type max_bucket_count() const { return bucket_policy::max_size(); }
 
   // iterators
-  iterator begin() { 
-    if (num_of_elements == 0)
-      return end();
-    
-    for (size_type i = 0; i < buckets.size(); ++i) {
-      if (buckets[i] != nullptr)
-        return iterator(buckets[i], this);
-    }
-
-    return end();
-  }
-  iterator end() { return iterator(nullptr, this); }
-
-  const_iterator begin() const { 
-    if (num_of_elements == 0)
-      return end();
-    
-    for (size_type i = 0; i < buckets.size(); ++i) {
-      if (buckets[i] != nullptr)
-        return const_iterator(buckets[i], this);
-    }
-
-    return end();
-  }
-  const_iterator end() const { return const_iterator(nullptr, this); }
-
-  iterator find(const key_type& k) {
-    size_type bucket = bkt_num_key(k);
-    node* cur = buckets[bucket];
-
-    while (cur != nullptr && !equals(k, get_key(cur->val))) {
-      cur = cur->next;
-    }
-
-    return iterator(cur, this);
+  iterator begin() { return iterator(static_cast<node*>(before_begin.next)); }
+  iterator end() { return iterator(nullptr); }
+  const_iterator begin() const {
+    return const_iterator(static_cast<const node*>(before_begin.next));
   }
+  const_iterator end() const { return const_iterator(nullptr); }
 
+  iterator find(const key_type& k) { return iterator(find_node(k, hash(k))); }
   const_iterator find(const key_type& k) const {
-    size_type bucket = bkt_num_key(k);
-    node* cur = buckets[bucket];
-
-    while (cur != nullptr && !equals(k, get_key(cur->val))) {
-      cur = cur->next;
-    }
-
-    return const_iterator(cur, this);
+    return const_cast<hashtable*>(this)->find(k);
   }
-  std::pair<iterator, iterator> equal_range(const key_type& key) {
-    iterator first = find(key);
-    if (first == end())
-      return std::pair<iterator, iterator>(first, first);
-    iterator last = first;
-    ++last;
-    while (last != end() && get_key(*last) == key) {
-      ++last;
-    }
 
-    return std::pair<iterator, iterator>(first, last);
+  std::pair<iterator, iterator> equal_range(const key_type& key) {
+    return equal_range_key(key);
   }
-
   std::pair<const_iterator, const_iterator> 
   equal_range(const key_type& key) const {
-    iterator first = find(key);
-    if (first == end())
-      return std::pair<iterator, iterator>(first, first);
-    iterator last = first;
-    ++last;
-    while (last != end() && get_key(*last) == key) {
-      ++last;
-    }
+    std::pair<iterator, iterator> range =
+        const_cast<hashtable*>(this)->equal_range(key);
+    return std::pair<const_iterator, const_iterator>(range.first, range.second);
+  }
 
-    return std::pair<iterator, iterator>(first, last);
+  // heterogeneous lookup (transparent HashFunc & EqualKey only): k is any key
+  // they accept
+  template <class K, class H = HashFunc, class E = EqualKey,
+            class = __enable_if_transparent<H>, class = __enable_if_transparent<E>>
+  size_type count(const K& k) { return count_key(k); }
+  template <class K, class H = HashFunc, class E = EqualKey,
+            class = __enable_if_transparent<H>, class = __enable_if_transparent<E>>
+  iterator find(const K& k) { return iterator(find_node(k, hash(k))); }
+  template <class K, class H = HashFunc, class E = EqualKey,
+            class = __enable_if_transparent<H>, class = __enable_if_transparent<E>>
+  const_iterator find(const K& k) const {
+    return const_cast<hashtable*>(this)->find(k);
+  }
+  template <class K, class H = HashFunc, class E = EqualKey,
+            class = __enable_if_transparent<H>, class = __enable_if_transparent<E>>
+  std::pair<iterator, iterator> equal_range(const K& k) {
+    return equal_range_key(k);
+  }
+  template <class K, class H = HashFunc, class E = EqualKey,
+            class = __enable_if_transparent<H>, class = __enable_if_transparent<E>>
+  std::pair<const_iterator, const_iterator> equal_range(const K& k) const {
+    std::pair<iterator, iterator> range =
+        const_cast<hashtable*>(this)->equal_range_key(k);
+    return std::pair<const_iterator, const_iterator>(range.first, range.second);
   }
 
 
-  // operator [] overloading
-  value_type& operator[] (key_type key) {
-    size_type bucket = bkt_num_key(key);
-    node* cur = buckets[bucket];
-    if (cur != nullptr) { // there are other elements
-      while (cur != nullptr) {
-        if (equals(get_key(cur->val), key)) // there exists the exact key
-          return cur->val;
-        cur = cur->next;
-      }
-    }
-    // there are no other elements or 
-    // there are no elements of the same key
-    resize(num_of_elements + 1); 
-    bucket = bkt_num_key(key);
-    cur = new_node(value_type());
-    cur->next = buckets[bucket];
-    buckets[bucket] = cur;
-    ++num_of_elements;
-    return cur->val;
+  // the element of the key of val; val is inserted if there is none. The
+  // table cannot build a value from a key alone: the node of a key must
+  // hold that key, or it splits its bucket in the chain.
+  value_type& find_or_insert(const value_type& val) {
+    return *insert_unique(val).first;
   }
   
   // traits
   hasher hash_function() const { return hasher(); }
   key_equal key_eq() const { return key_equal(); }
-  node_allocator get_allocator() const { return node_allocator(); }
+  allocator_type get_allocator() const { return node_allocator::get_alloc(); }
 
   /*************** Modifiers ***************/
   iterator insert_equal(const value_type& val);
@@ -314,7 +425,28 @@ public:
   template<class InputIterator>
   void insert_unique(InputIterator first, InputIterator last);
 
-  size_type erase(const key_type& key);
+  // bulk insertion: with threads > 1, HashFunc must be callable from
+  // several threads at once (and not throw)
+  template <class InputIterator>
+  void bulk_insert_unique(InputIterator first, InputIterator last,
+                          unsigned threads = 1) {
+    bulk_insert(first, last, threads, true, range_category(first));
+  }
+  template <class InputIterator>
+  void bulk_insert_equal(InputIterator first, InputIterator last,
+                         unsigned threads = 1) {
+    bulk_insert(first, last, threads, false, range_category(first));
+  }
+
+  size_type erase(const key_type& key) { return erase_key(key); }
+  // heterogeneous erase (transparent HashFunc & EqualKey only); not for
+  // iterators
+  template <class K, class H = HashFunc, class E = EqualKey,
+            class = __enable_if_transparent<H>, class = __enable_if_transparent<E>,
+            class = typename std::enable_if<
+                !std::is_convertible<K, iterator>::value &&
+                !std::is_convertible<K, const_iterator>::value>::type>
+  size_type erase(const K& key) { return erase_key(key); }
   void erase(iterator& position);
   void erase(const_iterator& position);
   void erase(iterator first, iterator last);
@@ -331,91 +463,352 @@ public:
   void rehash(size_type n);
   void reserve(size_type n);
 
+  // incremental rehashing: growing moves the nodes a bucket at a time, at
+  // each insertion and erase(key), instead of all at once. Turning it off
+  // finishes the rehashing in progress.
+  bool incremental_rehash() const { return incremental; }
+  void incremental_rehash(bool on) {
+    incremental = on;
+    if (!on && rehashing()) rehash_to(buckets.size());
+  }
+  // whether some nodes are still in the previous buckets
+  bool rehashing() const { return new_tail != nullptr; }
+
+  // spare nodes
+  size_type spare_nodes_count() const { return spare_nodes.size(); }
+  size_type max_spare_nodes() const { return spare_nodes.max_size(); }
+  void max_spare_nodes(size_type n) {
+    spare_nodes.max_size(n);
+    spare_nodes.release(static_cast<node_allocator&>(*this), n);
+  }
+  void reserve_nodes(size_type n);
+  // give back the spare nodes, and rehash down to the fewest buckets the
+  // elements need under max_load_factor()
+  void shrink_to_fit() {
+    spare_nodes.release(static_cast<node_allocator&>(*this));
+    size_type n = next_size(
+        (size_type) ((float) num_of_elements / max_load_factor_value));
+    if (n < buckets.size()) rehash_to(n);
+    else if (rehashing()) rehash_to(buckets.size());
+  }
+  // bytes allocated by the table: the buckets and the nodes (spare ones
+  // included)
+  size_type memory_usage() const {
+    return buckets.memory_usage() + old_buckets.memory_usage() +
+           (num_of_elements + spare_nodes.size()) * sizeof(node);
+  }
+
   // assignment operator overloading
   hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>&
-    operator= (hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>& table);
+    operator= (const hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>& table);
 
 private:
   // helper functions
   // create & delete node
-  node* new_node(const value_type& val) {
-    node *n = node_allocator::allocate();
+  node* new_node(const value_type& val, size_type h) {
+    node *n = spare_nodes.pop();
+    if (n == nullptr) n = node_allocator::allocate();
     n->next = nullptr;
+    store_hash_code(n, h);
     try {
       sup::_construct(&(n->val), val);
       return n; 
     } catch (...) {
       // commit or rollback
-      node_allocator::deallocate(n); 
+      put_node(n);
       throw;
     }
     return n;
   }
   void delete_node(const node* n) {
     sup::_destroy(&(n->val));
-    node_allocator::deallocate(n);
+    put_node((node*) n);
+  }
+  // keep n as a spare node if there is room
+  void put_node(node* n) {
+    if (!spare_nodes.push(n)) node_allocator::deallocate(n);
   }
   // init buckts when table is first constructed
   void initialize_buckets(size_type n) {
     const size_type n_buckets = next_size(n);
     buckets.reserve(n_buckets);
     buckets.insert(buckets.end(), n_buckets, nullptr);
+    policy.reset(n_buckets);
+    before_begin.next = nullptr;
     num_of_elements = 0;
   }
-  // helper function that returns the next prime capacity
-  inline size_type next_size(unsigned long num) { return __sstl_next_prime(num); }
-  // helper function that calls hash
-  size_type bkt_num_key (const key_type& key) const {
-    return hash(key) % buckets.size();
+  // the number of buckets to grow to
+  size_type next_size(size_type num) const { return bucket_policy::next_size(num); }
+  size_type bucket_index(size_type h) const { return policy.index(h); }
+  size_type bkt_num_node(const node* n) const { return bucket_index(hash_code(n)); }
+
+  // the hash code of a node: stored, or computed from its key
+  size_type hash_code(const cached_node* n) const { return n->hash_code; }
+  size_type hash_code(const uncached_node* n) const { return hash(get_key(n->val)); }
+  void store_hash_code(cached_node* n, size_type h) { n->hash_code = h; }
+  void store_hash_code(uncached_node*, size_type) {}
+  // whether the key of n may equal a key of hash code h
+  bool hash_code_matches(const cached_node* n, size_type h) const {
+    return n->hash_code == h;
   }
-  size_type bkt_num_key (const key_type& key, size_type bkt_num) const {
-    return hash(key) % bkt_num;
+  bool hash_code_matches(const uncached_node*, size_type) const { return true; }
+  // the stored hash code is compared before calling EqualKey
+  template <class K>
+  bool node_matches(const node* n, const K& key, size_type h) {
+    return hash_code_matches(n, h) && equals(get_key(n->val), key);
   }
-  // wrapper for hash function
-  size_type bkt_num(const value_type& val) const { return bkt_num_key(get_key(val)); }
-  size_type bkt_num(const value_type& val, size_type bkt_size) const 
-    { return bkt_num_key(get_key(val), bkt_size); }
+  // the node before the first node of key in the buckets bkts, or nullptr
+  template <class K>
+  node_base* find_before(const bucket_type& bkts, const bucket_policy& pol,
+                         const K& key, size_type h) {
+    const size_type bucket = pol.index(h);
+    node_base* before = bkts[bucket];
+    if (before == nullptr) return nullptr;
+    for (node* cur = static_cast<node*>(before->next);; cur = cur->next_node()) {
+      if (node_matches(cur, key, h)) return before;
+      // the end of the bucket
+      if (cur == new_tail || cur->next == nullptr ||
+          pol.index(hash_code(cur->next_node())) != bucket)
+        return nullptr;
+      before = cur;
+    }
+  }
+  // the node before the first node of key, or nullptr. The nodes of a key
+  // are all in the buckets or all in the previous buckets.
+  template <class K>
+  node_base* find_before(const K& key, size_type h) {
+    node_base* before = find_before(buckets, policy, key, h);
+    if (before == nullptr && rehashing())
+      before = find_before(old_buckets, old_policy, key, h);
+    return before;
+  }
+  // the first node of key, or nullptr
+  template <class K>
+  node* find_node(const K& key, size_type h) {
+    node_base* before = find_before(key, h);
+    return before == nullptr ? nullptr : static_cast<node*>(before->next);
+  }
+  template <class K>
+  size_type count_key(const K& key) {
+    const size_type h = hash(key);
+    node_base* before = find_before(key, h);
+    size_type num = 0;
+    // the elements of the same key are next to each other
+    for (; before != nullptr && before->next != nullptr &&
+           node_matches(static_cast<node*>(before->next), key, h);
+         before = before->next)
+      ++num;
+    return num;
+  }
+  // the elements of the same key are next to each other in one chain
+  template <class K>
+  std::pair<iterator, iterator> equal_range_key(const K& key) {
+    const size_type h = hash(key);
+    node* first = find_node(key, h);
+    if (first == nullptr)
+      return std::pair<iterator, iterator>(end(), end());
+    node* last = first;
+    while (last->next != nullptr && node_matches(last->next_node(), key, h)) {
+      last = last->next_node();
+    }
+    return std::pair<iterator, iterator>(iterator(first),
+                                         iterator(last->next_node()));
+  }
+  template <class K>
+  size_type erase_key(const K& key);
+  // link n as the first node of bucket
+  void insert_bucket_begin(size_type bucket, node* n) {
+    if (buckets[bucket] != nullptr) {
+      n->next = buckets[bucket]->next;
+      buckets[bucket]->next = n;
+    } else {
+      // the bucket moves to the head of the chain
+      n->next = before_begin.next;
+      before_begin.next = n;
+      if (new_tail == &before_begin) {
+        // the first node of buckets: the previous buckets follow it
+        if (n->next != nullptr)
+          old_buckets[old_policy.index(hash_code(n->next_node()))] = n;
+        new_tail = n;
+      } else if (n->next != nullptr) {
+        buckets[bkt_num_node(n->next_node())] = n;
+      }
+      buckets[bucket] = &before_begin;
+    }
+  }
+  // unlink & delete the node after before, which is in bucket of bkts
+  void erase_after(bucket_type& bkts, const bucket_policy& pol,
+                   node_base* before, size_type bucket) {
+    node* n = static_cast<node*>(before->next);
+    node* next = n->next_node();
+    if (n == new_tail) {
+      // the last node of buckets: the previous buckets follow before now
+      if (next != nullptr)
+        old_buckets[old_policy.index(hash_code(next))] = before;
+      if (before == bkts[bucket]) bkts[bucket] = nullptr;
+      new_tail = before;
+    } else {
+      const size_type next_bucket =
+          next == nullptr ? bucket : pol.index(hash_code(next));
+      if (next == nullptr || next_bucket != bucket) {
+        // n is the last node of its bucket: the next bucket starts after
+        // before now, and the bucket is empty if n was its only node
+        if (next != nullptr) bkts[next_bucket] = before;
+        if (before == bkts[bucket]) bkts[bucket] = nullptr;
+      }
+    }
+    before->next = next;
+    delete_node(n);
+    --num_of_elements;
+  }
+  void erase_node(const node* n);
+  // insertions once the buckets fit the element; h is its hash code
+  std::pair<iterator, bool> insert_unique_noresize(const value_type& val,
+                                                   size_type h) {
+    node* cur = find_node(get_key(val), h);
+    if (cur != nullptr)
+      return std::pair<iterator, bool>(iterator(cur), false);
+    cur = new_node(val, h);
+    insert_bucket_begin(bucket_index(h), cur);
+    ++num_of_elements;
+    return std::pair<iterator, bool>(iterator(cur), true);
+  }
+  iterator insert_equal_noresize(const value_type& val, size_type h);
+  // forward_iterator_tag for the forward iterators of sup & std, whose tags
+  // are different types; input_iterator_tag otherwise
+  template <class Iterator>
+  static typename std::conditional<
+      std::is_convertible<typename iterator_traits<Iterator>::iterator_category,
+                          forward_iterator_tag>::value ||
+          std::is_convertible<typename iterator_traits<Iterator>::iterator_category,
+                              std::forward_iterator_tag>::value,
+      forward_iterator_tag, input_iterator_tag>::type
+  range_category(const Iterator&) {
+    return {};
+  }
+  // the length of a forward range, walked through for any kind of iterator
+  template <class ForwardIterator>
+  static size_type range_size(ForwardIterator first, ForwardIterator last) {
+    size_type n = 0;
+    for (; first != last; ++first) ++n;
+    return n;
+  }
+  // range insertions: a forward range grows the buckets once
+  template <class InputIterator>
+  void insert_unique(InputIterator first, InputIterator last,
+                     input_iterator_tag) {
+    for (; first != last; ++first) insert_unique(*first);
+  }
+  template <class ForwardIterator>
+  void insert_unique(ForwardIterator first, ForwardIterator last,
+                     forward_iterator_tag) {
+    if (incremental) {
+      insert_unique(first, last, input_iterator_tag());
+      return;
+    }
+    grow_for(num_of_elements + range_size(first, last));
+    for (; first != last; ++first) {
+      const value_type& val = *first;
+      insert_unique_noresize(val, hash(get_key(val)));
+    }
+  }
+  template <class InputIterator>
+  void insert_equal(InputIterator first, InputIterator last,
+                    input_iterator_tag) {
+    for (; first != last; ++first) insert_equal(*first);
+  }
+  template <class ForwardIterator>
+  void insert_equal(ForwardIterator first, ForwardIterator last,
+                    forward_iterator_tag) {
+    if (incremental) {
+      insert_equal(first, last, input_iterator_tag());
+      return;
+    }
+    grow_for(num_of_elements + range_size(first, last));
+    for (; first != last; ++first) {
+      const value_type& val = *first;
+      insert_equal_noresize(val, hash(get_key(val)));
+    }
+  }
+  // a bulk insertion needs a second pass over the range
+  template <class InputIterator>
+  void bulk_insert(InputIterator first, InputIterator last, unsigned,
+                   bool unique, input_iterator_tag) {
+    if (unique) insert_unique(first, last, input_iterator_tag());
+    else insert_equal(first, last, input_iterator_tag());
+  }
+  template <class ForwardIterator>
+  void bulk_insert(ForwardIterator first, ForwardIterator last,
+                   unsigned threads, bool unique, forward_iterator_tag);
+  // the hash codes of the n values at values[i]; a thread hashes at least
+  // min_chunk of them
+  template <class ForwardIterator>
+  void hash_range(const ForwardIterator* values, size_type n, size_type* codes,
+                  unsigned threads) {
+    const size_type min_chunk = 1 << 15;
+    size_type workers = std::min<size_type>(threads, n / min_chunk);
+    if (workers < 1) workers = 1;
+    const size_type chunk = n / workers;
+    auto hash_chunk = [this, values, codes](size_type i, size_type end) {
+      for (; i < end; ++i) {
+        const value_type& val = *values[i];
+        codes[i] = hash(get_key(val));
+      }
+    };
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    size_type i = 0;
+    for (size_type w = 1; w < workers; ++w, i += chunk) {
+      pool.push_back(std::thread(hash_chunk, i, i + chunk));
+    }
+    hash_chunk(i, n);  // the last chunk on this thread
+    for (size_type w = 0; w < pool.size(); ++w) pool[w].join();
+  }
+  // grow the buckets once for num elements under max_load_factor(), and end
+  // the rehashing in progress, so that the next insertions need no resize
+  void grow_for(size_type num) {
+    const size_type n =
+        (size_type) std::ceil((float) num / max_load_factor_value);
+    if (n > buckets.size()) rehash_to(next_size(n));
+    else if (rehashing()) rehash_to(buckets.size());
+  }
+  // called before each insertion
   void resize(size_type num_of_element_hint) {
     if (((float) num_of_element_hint / buckets.size()) > max_load_factor_value) {
       // trigger resize
-      bucket_type new_buckets(next_size(buckets.size()));
-      
-      size_type bucket = 0;
-      while (bucket < buckets.size()) {
-        node* cur = buckets[bucket];
-        while (cur != nullptr) {
-          node* tmp = cur;
-          cur = cur->next;
-          insert_into_new_bucket(tmp, new_buckets);
-        }
-        buckets[bucket] = nullptr;
-        ++bucket;
+      if (incremental && !rehashing() && num_of_elements > 0) {
+        start_rehash(next_size(buckets.size()));
+        rehash_step();
+      } else {
+        rehash_to(next_size(buckets.size()));
       }
-      buckets.swap(new_buckets);
-      new_buckets.clear();
+    } else if (rehashing()) {
+      rehash_step();
     }
   }
-  // insert the new node into the corresponding bucket such that 
-  // the same keys are in a continuous range
-  inline void insert_into_new_bucket(node* position, bucket_type& new_buckets) {
-    size_type bucket = bkt_num(position->val, new_buckets.size());
-    node* cur = new_buckets[bucket];
-    if (cur == nullptr) {
-      new_buckets[bucket] = position;
-      position->next = nullptr;
-    } else {
-      // node* pre = cur;
-      // while (cur != nullptr && !equals(get_key(position->val), get_key(cur->val))) {
-      //   pre = cur;
-      //   cur = cur->next;
-      // }
-      // pre->next = position;
-      // position->next = cur;
-      position->next = new_buckets[bucket];
-      new_buckets[bucket] = position;
+  void rehash_to(size_type n);
+  void start_rehash(size_type n);
+  // move the first two of the previous buckets; the rehashing ends with the
+  // last one. Two per insertion empty them long before the buckets are full
+  // again, also when the next size is less than twice the previous one.
+  void rehash_step() {
+    for (int i = 0; i < 2 && new_tail->next != nullptr; ++i) {
+      move_old_bucket(
+          old_policy.index(hash_code(static_cast<node*>(new_tail->next))));
     }
+    if (new_tail->next == nullptr) end_rehash();
+  }
+  // move the previous bucket of hash code h, so that the nodes of its keys
+  // are in buckets
+  void move_old_bucket_of(size_type h) {
+    if (rehashing()) move_old_bucket(old_policy.index(h));
+  }
+  void move_old_bucket(size_type bucket);
+  void end_rehash() {
+    bucket_type empty(old_buckets.get_allocator());
+    old_buckets.swap(empty);
+    new_tail = nullptr;
   }
-  friend __hashtable_iterator<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>;
 };
 
 /**
@@ -438,34 +831,49 @@ typename hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::iterator
 hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::insert_equal(
   const typename hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::value_type& val) {
   resize(num_of_elements + 1);
-  
-  size_type bucket = bkt_num(val);
-  node* cur = buckets[bucket];
-  node* new_value_node = new_node(val);
-  if (cur == nullptr) {
-    buckets[bucket] = new_value_node;
+  return insert_equal_noresize(val, hash(get_key(val)));
+}
+
+/**
+ * @brief insert_equal once the buckets fit the element: no resize, only
+ *  the previous bucket of the key is moved while rehashing
+ * 
+ * @tparam Key - of the hashtable
+ * @tparam Value - of the hashtable
+ * @tparam HashFunc - of the hashtable
+ * @tparam ExtractKey - extract key from the value of Value type
+ * @tparam EqualKey - determine whether two keys are equal
+ * @tparam Alloc - allocator type
+ * @param val - the given value
+ * @param h - the hash code of its key
+ * @return hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::iterator 
+ *  to the inserted element
+ */
+template <class Key, class Value, class HashFunc, 
+          class ExtractKey, class EqualKey, class Alloc>
+typename hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::iterator 
+hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::insert_equal_noresize(
+  const typename hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::value_type& val,
+  size_type h) {
+  // the elements of the same key are moved to buckets first
+  move_old_bucket_of(h);
+  node* new_value_node = new_node(val, h);
+  node_base* before = find_before(buckets, policy, get_key(new_value_node->val), h);
+  if (before != nullptr) {
+    // ahead of the elements of the same key
+    new_value_node->next = before->next;
+    before->next = new_value_node;
   } else {
-    node* pre = cur;
-    while (cur != nullptr && !equals(get_key(new_value_node->val), get_key(cur->val))) {
-      pre = cur;
-      cur = cur->next;
-    }
-    if (pre != cur) {
-      pre->next = new_value_node;
-      new_value_node->next = cur;
-    } else {
-      new_value_node->next = buckets[bucket];
-      buckets[bucket] = new_value_node;
-    }
+    insert_bucket_begin(bucket_index(h), new_value_node);
   }
 
   ++num_of_elements;
-  return iterator(new_value_node, this);
+  return iterator(new_value_node);
 }
 
 /**
  * @brief given a range [first, last) of values to insert 
- *  (duplicate keys are allowed)
+ *  (duplicate keys are allowed). The buckets grow once for a forward range.
  * 
  * @tparam Key - of the hashtable
  * @tparam Value - of the hashtable
@@ -482,10 +890,7 @@ template <class Key, class Value, class HashFunc,
 template<class InputIterator>
 void hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::insert_equal(
   InputIterator first, InputIterator last) {
-  while (first != last) {
-    insert_equal(*first);
-    ++first;
-  }
+  insert_equal(first, last, range_category(first));
 }
 
 /**
@@ -512,32 +917,24 @@ template <class Key, class Value, class HashFunc,
 std::pair<typename hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::iterator, bool> 
 hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::insert_unique(
   const typename hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::value_type& val) {
+  const size_type h = hash(get_key(val));
+  node* cur = find_node(get_key(val), h);
+  // if element of the same key is found, just return
+  if (cur != nullptr)
+    return std::pair<iterator, bool>(iterator(cur), false);
+
   resize(num_of_elements + 1);
-  
-  size_type bucket = bkt_num(val);
-  node* cur = buckets[bucket];
-  node* new_value_node = nullptr;
-  if (cur == nullptr) {
-    buckets[bucket] = new_node(val);
-  } else {
-    while (cur != nullptr) {
-      // if element of the same key is found, just return
-      if (equals(get_key(val), get_key(cur->val)))
-        return std::pair<iterator, bool>(iterator(cur, this), false);
-      cur = cur->next;
-    }
-    new_value_node = new_node(val);
-    new_value_node->next = buckets[bucket];
-    buckets[bucket] = new_value_node;
-  }
+  node* new_value_node = new_node(val, h);
+  insert_bucket_begin(bucket_index(h), new_value_node);
 
   ++num_of_elements;
-  return std::pair<iterator, bool>(iterator(new_value_node, this), true);
+  return std::pair<iterator, bool>(iterator(new_value_node), true);
 }
 
 /**
  * @brief  given a range [first, last) of values to insert 
- *  (duplicate keys are not allowed)
+ *  (duplicate keys are not allowed). The buckets grow once for a forward
+ *  range.
  * 
  * @tparam Key - of the hashtable
  * @tparam Value - of the hashtable
@@ -554,15 +951,70 @@ template <class Key, class Value, class HashFunc,
 template<class InputIterator>
 void hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::insert_unique(
   InputIterator first, InputIterator last) {
-  while (first != last) {
-    insert_unique(*first);
-    ++first;
+  insert_unique(first, last, range_category(first));
+}
+
+/**
+ * @brief insert a range [first, last) in bulk. The buckets grow once; the
+ *  hash codes of the values are computed first (by up to threads threads),
+ *  then the values are sorted by block of buckets, and inserted a block
+ *  after the other: the buckets an insertion reads & writes are those of
+ *  the last insertions, in the cache, instead of anywhere in the array.
+ * 
+ * @tparam Key - of the hashtable
+ * @tparam Value - of the hashtable
+ * @tparam HashFunc - of the hashtable
+ * @tparam ExtractKey - extract key from the value of Value type
+ * @tparam EqualKey - determine whether two keys are equal
+ * @tparam Alloc - allocator type
+ * @tparam ForwardIterator - iterator type
+ * @param first - start of the range
+ * @param last - end of the range
+ * @param threads - the most threads computing the hash codes
+ * @param unique - whether the keys are unique (insert_unique) or not
+ *  (insert_equal)
+ */
+template <class Key, class Value, class HashFunc, 
+          class ExtractKey, class EqualKey, class Alloc>
+template <class ForwardIterator>
+void hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::bulk_insert(
+  ForwardIterator first, ForwardIterator last, unsigned threads, bool unique,
+  forward_iterator_tag) {
+  const size_type n = range_size(first, last);
+  if (n == 0) return;
+  grow_for(num_of_elements + n);
+
+  // the scratch space is not the table's: it does not come from Alloc
+  std::vector<ForwardIterator> values(n, first);
+  for (size_type i = 0; i < n; ++i, ++first) values[i] = first;
+  std::vector<size_type> codes(n, 0);
+  hash_range(&values[0], n, &codes[0], threads);
+
+  // counting sort by block of 1024 buckets (8 KB of bucket pointers): the
+  // values of block p are sorted[start[p], start[p + 1])
+  const int block_bits = 10;
+  const size_type blocks = (buckets.size() >> block_bits) + 1;
+  std::vector<size_type> start(blocks + 1, 0);
+  for (size_type i = 0; i < n; ++i)
+    ++start[(bucket_index(codes[i]) >> block_bits) + 1];
+  for (size_type p = 0; p < blocks; ++p) start[p + 1] += start[p];
+  typedef std::pair<ForwardIterator, size_type> hashed_value;
+  std::vector<hashed_value> sorted(n, hashed_value(first, 0));
+  for (size_type i = 0; i < n; ++i) {
+    sorted[start[bucket_index(codes[i]) >> block_bits]++] =
+        hashed_value(values[i], codes[i]);
+  }
+
+  for (size_type k = 0; k < n; ++k) {
+    const value_type& val = *sorted[k].first;
+    if (unique) insert_unique_noresize(val, sorted[k].second);
+    else insert_equal_noresize(val, sorted[k].second);
   }
 }
 
 /**
  * @brief erase elements with the given key. return the number of elements 
- *  erased
+ *  erased. While rehashing, two of the previous buckets are moved first.
  * 
  * @tparam Key - of the hashtable
  * @tparam Value - of the hashtable
@@ -570,41 +1022,39 @@ void hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::insert_unique
  * @tparam ExtractKey - extract key from the value of Value type
  * @tparam EqualKey - determine whether two keys are equal
  * @tparam Alloc - allocator type
+ * @tparam K - key_type, or a key of a heterogeneous erase
  * @param key - the given key
  * @return hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::size_type 
  *  - the number of elements removed
  */
 template <class Key, class Value, class HashFunc, 
           class ExtractKey, class EqualKey, class Alloc>
+template <class K>
 typename hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::size_type 
-hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::erase(
-  const key_type& key) {
-  size_type num_of_erased = 0;
-  size_type bucket = bkt_num_key(key);
-  node* first = buckets[bucket];
-
-  if (first != nullptr) {
-    // find the equal key
-    while (first != nullptr && !equals(get_key(first->val), key)) {
-      first = first->next;
-    }
-    if (first == nullptr)  // no such key
-      return num_of_erased;
-    
-    node* next = first->next;
-
-    // remove elements with the same key value 
-    while (equals(get_key(first->val), key)) {
-      delete_node(first);
-      ++num_of_erased;
-      --num_of_elements;
-      first = next;
-      if (first == nullptr)
-        break;
-      next = next->next;
-    }
+hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::erase_key(
+  const K& key) {
+  // a table that stops growing still empties its previous buckets
+  if (rehashing()) rehash_step();
 
-    buckets[bucket] = first;
+  size_type num_of_erased = 0;
+  const size_type h = hash(key);
+  bucket_type* bkts = &buckets;
+  const bucket_policy* pol = &policy;
+  node_base* before = find_before(buckets, policy, key, h);
+  if (before == nullptr && rehashing()) {
+    bkts = &old_buckets;
+    pol = &old_policy;
+    before = find_before(old_buckets, old_policy, key, h);
+  }
+  if (before == nullptr)  // no such key
+    return num_of_erased;
+
+  // remove elements with the same key value, which are consecutive
+  const size_type bucket = pol->index(h);
+  while (before->next != nullptr &&
+         node_matches(static_cast<node*>(before->next), key, h)) {
+    erase_after(*bkts, *pol, before, bucket);
+    ++num_of_erased;
   }
 
   return num_of_erased;
@@ -626,44 +1076,57 @@ template <class Key, class Value, class HashFunc,
           class ExtractKey, class EqualKey, class Alloc>
 void hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::erase(
   iterator& position) {
-  node* n = position.cur;
-  size_type bucket = bkt_num(*position);
-  node* first = buckets[bucket];
-  if (first != n) {
-    node* pre;
-    while (first != n) {
-      pre = first;
-      first = first->next;
-    }
-    pre->next = first->next;
-    delete_node(first);
-  } else {
-    buckets[bucket] = n->next;
-    delete_node(n);
-    --num_of_elements;
-  }
+  erase_node(position.cur);
 }
 
 template <class Key, class Value, class HashFunc, 
           class ExtractKey, class EqualKey, class Alloc>
 void hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::erase(
   const_iterator& position) {
-  const node* n = position.cur;
-  size_type bucket = bkt_num(*position);
-  node* first = buckets[bucket];
-  if (first != n) {
-    node* pre;
-    while (first != n) {
-      pre = first;
-      first = first->next;
+  erase_node(position.cur);
+}
+
+/**
+ * @brief unlink a node from the chain and delete it. Its bucket comes from
+ *  the stored hash code when there is one; the node before it is searched
+ *  from the start of the bucket, in the previous buckets first while
+ *  rehashing.
+ * 
+ * @tparam Key - of the hashtable
+ * @tparam Value - of the hashtable
+ * @tparam HashFunc - of the hashtable
+ * @tparam ExtractKey - extract key from the value of Value type
+ * @tparam EqualKey - determine whether two keys are equal
+ * @tparam Alloc - allocator type
+ * @param n - a node of the hashtable
+ */
+template <class Key, class Value, class HashFunc, 
+          class ExtractKey, class EqualKey, class Alloc>
+void hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::erase_node(
+  const node* n) {
+  const size_type h = hash_code(n);
+  if (rehashing()) {
+    const size_type bucket = old_policy.index(h);
+    node_base* before = old_buckets[bucket];
+    for (; before != nullptr; before = before->next) {
+      const node* cur = static_cast<const node*>(before->next);
+      if (cur == n) {
+        erase_after(old_buckets, old_policy, before, bucket);
+        return;
+      }
+      // the end of the bucket
+      if (cur->next == nullptr ||
+          old_policy.index(hash_code(cur->next_node())) != bucket)
+        break;
     }
-    pre->next = first->next;
-    delete_node(first);
-  } else {
-    buckets[bucket] = n->next;
-    delete_node(n);
-    --num_of_elements;
   }
+
+  const size_type bucket = bucket_index(h);
+  node_base* before = buckets[bucket];
+  while (before->next != n) {
+    before = before->next;
+  }
+  erase_after(buckets, policy, before, bucket);
 }
 
 /**
@@ -682,68 +1145,10 @@ template <class Key, class Value, class HashFunc,
           class ExtractKey, class EqualKey, class Alloc>
 void hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::erase(
   iterator first, iterator last) {
-  size_type start_bucket = bkt_num(*first);
-  size_type end_bucket = bkt_num(*last);
-  node * cur;
-  // remove concecutive elements within the same bucket
-  for (size_type bucket = start_bucket + 1; bucket < end_bucket; ++bucket) {
-    cur = buckets[bucket];
-    while (cur != nullptr) {
-      node * tmp = cur->next;
-      delete_node(cur);
-      --num_of_elements;
-      cur = tmp; 
-    }
-    buckets[bucket] = nullptr;
-  }
-
-  // remove elements after first but within the same bucket
-  cur = buckets[start_bucket];
-  if (cur != first.cur) {
-    while(cur->next != first.cur) {
-      cur = cur->next;
-    }
-
-    node* pre = cur;
-    node* next = cur->next;
-    while (cur != last.cur) {
-      delete_node(cur);
-      --num_of_elements;
-      cur = next;
-      if (cur == nullptr)
-        break;
-      next = next->next;
-    }
-    pre = next;
-  } else { // remove the entire bucket before last
-    node* next = cur->next;
-    while (cur != last.cur) {
-      delete_node(cur);
-      --num_of_elements;
-      cur = next;
-      if (cur == nullptr) 
-        break;
-      next = next->next;
-    }
-    buckets[start_bucket] = next;
-  }
-  
-  // remove elements before last but within the same bucket
-  cur = buckets[end_bucket];
-
-  if (cur == last.cur) {
-    return;
-  } else {
-    node* next = cur->next;
-    while (cur != last.cur) {
-      delete_node(cur);
-      --num_of_elements;
-      cur = next;
-      if (cur == nullptr) 
-        break;
-      next = next->next;
-    }
-    buckets[end_bucket] = next;
+  while (first != last) {
+    const node* n = first.cur;
+    ++first;  // the other nodes stay where they are
+    erase_node(n);
   }
 }
 
@@ -763,73 +1168,17 @@ template <class Key, class Value, class HashFunc,
           class ExtractKey, class EqualKey, class Alloc>
 void hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::erase(
   const_iterator first, const_iterator last) {
-size_type start_bucket = bkt_num(*first);
-  size_type end_bucket = bkt_num(*last);
-  node * cur;
-  // remove concecutive elements within the same bucket
-  for (size_type bucket = start_bucket + 1; bucket < end_bucket; ++bucket) {
-    cur = buckets[bucket];
-    while (cur != nullptr) {
-      node * tmp = cur->next;
-      delete_node(cur);
-      --num_of_elements;
-      cur = tmp; 
-    }
-    buckets[bucket] = nullptr;
-  }
-
-  // remove elements after first but within the same bucket
-  cur = buckets[start_bucket];
-  if (cur != first.cur) {
-    while(cur->next != first.cur) {
-      cur = cur->next;
-    }
-
-    node* pre = cur;
-    node* next = cur->next;
-    while (cur != last.cur) {
-      delete_node(cur);
-      --num_of_elements;
-      cur = next;
-      if (cur == nullptr)
-        break;
-      next = next->next;
-    }
-    pre = next;
-  } else { // remove the entire bucket before last
-    node* next = cur->next;
-    while (cur != last.cur) {
-      delete_node(cur);
-      --num_of_elements;
-      cur = next;
-      if (cur == nullptr) 
-        break;
-      next = next->next;
-    }
-    buckets[start_bucket] = next;
-  }
-  
-  // remove elements before last but within the same bucket
-  cur = buckets[end_bucket];
-
-  if (cur == last.cur) {
-    return;
-  } else {
-    node* next = cur->next;
-    while (cur != last.cur) {
-      delete_node(cur);
-      --num_of_elements;
-      cur = next;
-      if (cur == nullptr) 
-        break;
-      next = next->next;
-    }
-    buckets[end_bucket] = next;
+  while (first != last) {
+    const node* n = first.cur;
+    ++first;
+    erase_node(n);
   }
 }
 
 /**
- * @brief clear the hashtable; keep the buckets untouched
+ * @brief clear the hashtable; keep the buckets. Only the elements are
+ *  visited: the bucket of each node is reset when it is deleted (the
+ *  previous buckets of a rehashing are dropped).
  * 
  * @tparam Key - of the hashtable
  * @tparam Value - of the hashtable
@@ -842,25 +1191,136 @@ template <class Key, class Value, class HashFunc,
           class ExtractKey, class EqualKey, class Alloc>
 void hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::clear() {
   if (num_of_elements > 0) {
-    size_type bucket = 0;
-    while (bucket < buckets.size()) {
-      node* cur = buckets[bucket];
+    if (_alloc_skip_node_release<Alloc, Value>::value) {
+      // only the buckets are reset
+      std::fill(buckets.begin(), buckets.end(), (node_base*) nullptr);
+    } else {
+      node* cur = static_cast<node*>(before_begin.next);
       while (cur != nullptr) {
-        node* tmp = cur->next;
+        node* tmp = cur->next_node();
+        buckets[bkt_num_node(cur)] = nullptr;
         delete_node(cur);
         cur = tmp;
       }
-      buckets[bucket] = nullptr;
-      ++bucket;
     }
 
+    before_begin.next = nullptr;
     num_of_elements = 0;
   }
+  if (rehashing()) end_rehash();
 }
 
 /**
- * @brief have n buckets. If the hash table already has 
- *  more than n buckets, the function has no effect.
+ * @brief move every node into a new array of n buckets. The chain is
+ *  rebuilt in one pass: a node joins the start of its bucket, and a bucket
+ *  seen for the first time moves to the head of the chain.
+ * 
+ * @tparam Key - of the hashtable
+ * @tparam Value - of the hashtable
+ * @tparam HashFunc - of the hashtable
+ * @tparam ExtractKey - extract key from the value of Value type
+ * @tparam EqualKey - determine whether two keys are equal
+ * @tparam Alloc - allocator type
+ * @param n - the new number of buckets
+ */
+template <class Key, class Value, class HashFunc, 
+          class ExtractKey, class EqualKey, class Alloc>
+void hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::rehash_to(size_type n) {
+  bucket_type new_buckets(n, (node_base*) nullptr, buckets.get_allocator());
+  bucket_policy new_policy;
+  new_policy.reset(n);
+
+  node* cur = static_cast<node*>(before_begin.next);
+  before_begin.next = nullptr;
+  size_type head_bucket = 0;  // the bucket at the head of the new chain
+  while (cur != nullptr) {
+    node* next = cur->next_node();
+    const size_type bucket = new_policy.index(hash_code(cur));
+    if (new_buckets[bucket] == nullptr) {
+      cur->next = before_begin.next;
+      before_begin.next = cur;
+      new_buckets[bucket] = &before_begin;
+      if (cur->next != nullptr) new_buckets[head_bucket] = cur;
+      head_bucket = bucket;
+    } else {
+      // equal keys stay next to each other (in reverse order)
+      cur->next = new_buckets[bucket]->next;
+      new_buckets[bucket]->next = cur;
+    }
+    cur = next;
+  }
+  buckets.swap(new_buckets);
+  policy = new_policy;
+  if (rehashing()) end_rehash();
+}
+
+/**
+ * @brief start an incremental rehashing to n buckets: the buckets become the
+ *  previous buckets, and all the nodes stay where they are
+ * 
+ * @tparam Key - of the hashtable
+ * @tparam Value - of the hashtable
+ * @tparam HashFunc - of the hashtable
+ * @tparam ExtractKey - extract key from the value of Value type
+ * @tparam EqualKey - determine whether two keys are equal
+ * @tparam Alloc - allocator type
+ * @param n - the new number of buckets
+ */
+template <class Key, class Value, class HashFunc, 
+          class ExtractKey, class EqualKey, class Alloc>
+void hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::start_rehash(size_type n) {
+  bucket_type new_buckets(n, (node_base*) nullptr, buckets.get_allocator());
+  old_buckets.swap(buckets);
+  buckets.swap(new_buckets);
+  old_policy = policy;
+  policy.reset(n);
+  // the bucket at the head of the chain points to before_begin already
+  new_tail = &before_begin;
+}
+
+/**
+ * @brief move the nodes of a previous bucket to the buckets. They are next
+ *  to each other in the chain: they are unlinked at once, then each joins
+ *  the start of its new bucket.
+ * 
+ * @tparam Key - of the hashtable
+ * @tparam Value - of the hashtable
+ * @tparam HashFunc - of the hashtable
+ * @tparam ExtractKey - extract key from the value of Value type
+ * @tparam EqualKey - determine whether two keys are equal
+ * @tparam Alloc - allocator type
+ * @param bucket - the index of the bucket in old_buckets
+ */
+template <class Key, class Value, class HashFunc, 
+          class ExtractKey, class EqualKey, class Alloc>
+void hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::move_old_bucket(
+  size_type bucket) {
+  node_base* before = old_buckets[bucket];
+  if (before == nullptr) return;
+  node* first = static_cast<node*>(before->next);
+  node* last = first;
+  node* after;  // the first node of the next bucket
+  size_type after_bucket = bucket;
+  while ((after = last->next_node()) != nullptr &&
+         (after_bucket = old_policy.index(hash_code(after))) == bucket) {
+    last = after;
+  }
+  before->next = after;
+  if (after != nullptr) old_buckets[after_bucket] = before;
+  old_buckets[bucket] = nullptr;
+
+  // equal keys stay next to each other (in reverse order)
+  for (node* cur = first; cur != after;) {
+    node* next = cur->next_node();
+    insert_bucket_begin(bkt_num_node(cur), cur);
+    cur = next;
+  }
+}
+
+/**
+ * @brief have n buckets, or the next number of buckets the bucket policy
+ *  allows (a power of two). If the hash table already has more than n
+ *  buckets, only a rehashing in progress is finished.
  * 
  * @tparam Key - of the hashtable
  * @tparam Value - of the hashtable
@@ -873,28 +1333,14 @@ void hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::clear() {
 template <class Key, class Value, class HashFunc, 
           class ExtractKey, class EqualKey, class Alloc>
 void hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::rehash(size_type n) {
-  if (n > buckets.size()) {
-    bucket_type new_buckets(n);
-      size_type bucket = 0;
-      while (bucket < buckets.size()) {
-        node* cur = buckets[bucket];
-        while (cur != nullptr) {
-          node* tmp = cur;
-          cur = cur->next;
-          insert_into_new_bucket(tmp, new_buckets);
-        }
-        buckets[bucket] = nullptr;
-        ++bucket;
-      }
-      buckets.swap(new_buckets);
-      new_buckets.clear();
-  }
+  if (n > buckets.size()) rehash_to(bucket_policy::at_least(n));
+  else if (rehashing()) rehash_to(buckets.size());
 }
 
 /**
  * @brief reserve space for n elements.The bucket size would be
  *  next_size(n) If the hash table already has more than 
- *  next_size(n) buckets, the function has no effect.
+ *  next_size(n) buckets, only a rehashing in progress is finished.
  * 
  * @tparam Key - of the hashtable
  * @tparam Value - of the hashtable
@@ -907,26 +1353,32 @@ void hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::rehash(size_t
 template <class Key, class Value, class HashFunc, 
           class ExtractKey, class EqualKey, class Alloc>
 void hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::reserve(size_type n) {
-  if (next_size(n) > buckets.size()) {
-    bucket_type new_buckets(next_size(n));
-      size_type bucket = 0;
-      while (bucket < buckets.size()) {
-        node* cur = buckets[bucket];
-        while (cur != nullptr) {
-          node* tmp = cur;
-          cur = cur->next;
-          insert_into_new_bucket(tmp, new_buckets);
-        }
-        buckets[bucket] = nullptr;
-        ++bucket;
-      }
-      buckets.swap(new_buckets);
-      new_buckets.clear();
-  }
+  if (next_size(n) > buckets.size()) rehash_to(next_size(n));
+  else if (rehashing()) rehash_to(buckets.size());
 }
 
 /**
- * @brief assignment operator overloading
+ * @brief allocate spare nodes such that n insertions need no allocation
+ * 
+ * @tparam Key - of the hashtable
+ * @tparam Value - of the hashtable
+ * @tparam HashFunc - of the hashtable
+ * @tparam ExtractKey - extract key from the value of Value type
+ * @tparam EqualKey - determine whether two keys are equal
+ * @tparam Alloc - allocator type
+ * @param n - number of nodes
+ */
+template <class Key, class Value, class HashFunc, 
+          class ExtractKey, class EqualKey, class Alloc>
+void hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::reserve_nodes(size_type n) {
+  if (spare_nodes.max_size() < n) spare_nodes.max_size(n);
+  while (spare_nodes.size() < n)
+    spare_nodes.push(node_allocator::allocate());
+}
+
+/**
+ * @brief assignment operator overloading. The nodes of *this are reused for
+ *  the copies; the buckets and the order of the chain are those of table.
  * 
  * @tparam Key - of the hashtable
  * @tparam Value - of the hashtable
@@ -942,21 +1394,50 @@ template <class Key, class Value, class HashFunc,
           class ExtractKey, class EqualKey, class Alloc>
 hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>& 
 hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>::operator= 
-(hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>& table) {
+(const hashtable<Key, Value, HashFunc, ExtractKey, EqualKey, Alloc>& table) {
+  if (this == &table) return *this;
+
+  // keep every node of *this while clearing
+  const size_type max_spare = spare_nodes.max_size();
+  if (max_spare < num_of_elements + spare_nodes.size())
+    spare_nodes.max_size(num_of_elements + spare_nodes.size());
   clear();
-  if (bucket_count() > table.bucket_count()) {
-    iterator it = table.begin();
-    while(it != table.end())
-      insert_equal(*it);
-  } else {
-    buckets.reserve(table.buckets.size());
-    iterator it = table.begin();
-    while(it != table.end())
-      insert_equal(*it);
+
+  if (buckets.size() != table.buckets.size()) {
+    bucket_type new_buckets(table.buckets.size(), (node_base*) nullptr,
+                            buckets.get_allocator());
+    buckets.swap(new_buckets);
+    policy = table.policy;
+  }
+  hash = table.hash;
+  equals = table.equals;
+  max_load_factor_value = table.max_load_factor_value;
+  incremental = table.incremental;
+
+  try {
+    // the copies are chained in the same order; the first node of each
+    // bucket marks the bucket
+    node_base* last = &before_begin;
+    for (const node* cur = static_cast<const node*>(table.before_begin.next);
+         cur != nullptr; cur = cur->next_node()) {
+      node* n = new_node(cur->val, hash_code(cur));
+      last->next = n;
+      node_base*& bucket = buckets[bkt_num_node(n)];
+      if (bucket == nullptr) bucket = last;
+      last = n;
+      ++num_of_elements;
+    }
+    // a rehashing table is not in the order of its buckets: regroup
+    if (table.rehashing()) rehash_to(buckets.size());
+  } catch (...) {
+    clear();
+    max_spare_nodes(max_spare);
+    throw;
   }
+  max_spare_nodes(max_spare);
   return *this; 
 }
 
 }
 
-#endif
\ No newline at end of file
+#endif
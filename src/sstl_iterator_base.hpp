@@ -134,7 +134,7 @@ inline typename iterator_traits<InputIterator>::difference_type distance(
 // advance function
 template <class InputIterator, class Distance>
 inline void __advance(InputIterator& i, Distance n, input_iterator_tag) {
-  while (--n) ++i;
+  while (n--) ++i;
 }
 
 template <class BidirectionalIterator, class Distance>
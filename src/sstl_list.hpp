@@ -4,6 +4,7 @@
 #include "type_traits"
 
 #include "sstl_allocator.hpp"
+#include "sstl_node_cache.hpp"
 #include "sstl_construct.hpp"
 #include "sstl_iterator.hpp"
 #include "sstl_type_tratis.hpp"
@@ -97,7 +98,7 @@ struct _list_const_iterator {};
 **/
 
 template <class T, class Alloc=alloc>
-class list {
+class list : protected simple_alloc<_list_node<T>, Alloc> {
  protected:
   typedef sup::simple_alloc<_list_node<T>, Alloc> list_node_allocator;
   typedef typename std::allocator_traits<list_node_allocator> _T_alloc_traits;
@@ -126,9 +127,15 @@ class list {
     node->next = node;
     node->prev = node;
   }
+  explicit list(const allocator_type& a) : list_node_allocator(a) {
+    node = get_node();
+    node->next = node;
+    node->prev = node;
+  }
   ~list() {
     clear();
     list_node_allocator::deallocate(node, 1);
+    shrink_to_fit();
   }
 
   /******** Iterators ********/
@@ -169,6 +176,18 @@ class list {
 
   void clear();
 
+  /******** Spare nodes ********/
+  size_type spare_nodes_count() const { return spare_nodes.size(); }
+  size_type max_spare_nodes() const { return spare_nodes.max_size(); }
+  void max_spare_nodes(size_type n) {
+    spare_nodes.max_size(n);
+    spare_nodes.release(static_cast<list_node_allocator&>(*this), n);
+  }
+  void reserve_nodes(size_type n);
+  void shrink_to_fit() {
+    spare_nodes.release(static_cast<list_node_allocator&>(*this));
+  }
+
   /******** Operations ********/
   void splice(iterator position, list& x);
   void splice(iterator position, list& x, iterator i);
@@ -196,8 +215,13 @@ class list {
 
  protected:
   // these functions are for convenience & efficiency
-  link_type get_node() { return list_node_allocator::allocate(1); }
-  void put_node(link_type p) { list_node_allocator::deallocate(p, 1); }
+  link_type get_node() {
+    link_type p = spare_nodes.pop();
+    return p != nullptr ? p : list_node_allocator::allocate(1);
+  }
+  void put_node(link_type p) {
+    if (!spare_nodes.push(p)) list_node_allocator::deallocate(p, 1);
+  }
   link_type create_node(const T& x) {
     link_type p = get_node();
     sup::_construct(&p->data, x);
@@ -233,8 +257,23 @@ class list {
   void assign_aux(Size first, const T& last, std::__true_type);
 
   link_type node;
+  _node_cache<list_node> spare_nodes;  // erased nodes kept for reuse
 };
 
+/**
+ * @brief allocate spare nodes such that n insertions need no allocation
+ * 
+ * @tparam T - element type parameter
+ * @tparam Alloc - allocator type
+ * @param n - number of nodes
+ */
+template <class T, class Alloc>
+void list<T, Alloc>::reserve_nodes(size_type n) {
+  if (spare_nodes.max_size() < n) spare_nodes.max_size(n);
+  while (spare_nodes.size() < n)
+    spare_nodes.push(list_node_allocator::allocate(1));
+}
+
 /**
  * @brief get allocator
  * 
@@ -244,7 +283,7 @@ class list {
  */
 template <class T, class Alloc>
 typename list<T, Alloc>::allocator_type list<T, Alloc>::get_allocator() const {
-  return allocator_type();
+  return list_node_allocator::get_alloc();
 }
 
 /**
@@ -565,6 +604,9 @@ void list<T, Alloc>::swap(list& x) {
   link_type temp = x.node;
   x.node = this->node;
   this->node = temp;
+  spare_nodes.swap(x.spare_nodes);
+
+  _alloc_swap<list_node_allocator>::_swap(*this, x);
 }
 
 /**
@@ -592,8 +634,8 @@ void list<T, Alloc>::resize(size_type n, value_type val) {
  */
 template <class T, class Alloc>
 void list<T, Alloc>::clear() {
-  link_type curr = node->next;
-  while (curr != node->prev) {
+  link_type curr = _alloc_skip_node_release<Alloc, T>::value ? node : node->next;
+  while (curr != node) {
     link_type tmp = curr;
     curr = curr->next;
     destory_node(tmp);
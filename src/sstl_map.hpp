@@ -52,10 +52,12 @@ public:
   typedef typename container_type::const_reverse_iterator const_reverse_iterator;
   typedef typename container_type::size_type size_type;
   typedef typename container_type::difference_type difference_type;
+  typedef typename container_type::allocator_type allocator_type;
 
   /************ De-construcotrs ************/
   map(): t(Compare()) {}
   explicit map(const Compare& comp): t(comp) {}
+  map(const Compare& comp, const allocator_type& a): t(comp, a) {}
 
   template<class InputIterator>
   map(InputIterator first, InputIterator last): t(Compare()) {
@@ -66,13 +68,14 @@ public:
     t.insert_unique(first, last);
   }
   map(const map<Key, Value, Compare, Alloc>& m): t(m.t) {}
-  map<Key, Value, Compare, Alloc>& operator= (map<Key, Value, Compare, Alloc>& c) {
+  map<Key, Value, Compare, Alloc>& operator= (const map<Key, Value, Compare, Alloc>& c) {
     t = c.t;
     return *this;
   }
 
   /************** Accessors **************/
   key_compare key_comp() { return t.key_comp(); }
+  allocator_type get_allocator() const { return t.get_allocator(); }
   value_compare value_comp() { return value_compare(t.key_comp()); }
   iterator begin() { return t.begin(); }
   const_iterator begin() const { return t.begin(); }
@@ -104,6 +107,28 @@ public:
   std::pair<const_iterator, const_iterator> 
   equal_range(const key_type& k) const { return t.equal_range(k); }
 
+  // heterogeneous lookup (transparent Compare only)
+  template <class K, class C = Compare, class = __enable_if_transparent<C>>
+  iterator find(const K& k) { return t.find(k); }
+  template <class K, class C = Compare, class = __enable_if_transparent<C>>
+  const_iterator find(const K& k) const { return t.find(k); }
+  template <class K, class C = Compare, class = __enable_if_transparent<C>>
+  size_type count(const K& k) { return t.count(k); }
+  template <class K, class C = Compare, class = __enable_if_transparent<C>>
+  iterator lower_bound(const K& k) { return t.lower_bound(k); }
+  template <class K, class C = Compare, class = __enable_if_transparent<C>>
+  const_iterator lower_bound(const K& k) const { return t.lower_bound(k); }
+  template <class K, class C = Compare, class = __enable_if_transparent<C>>
+  iterator upper_bound(const K& k) { return t.upper_bound(k); }
+  template <class K, class C = Compare, class = __enable_if_transparent<C>>
+  const_iterator upper_bound(const K& k) const { return t.upper_bound(k); }
+  template <class K, class C = Compare, class = __enable_if_transparent<C>>
+  std::pair<iterator, iterator> 
+  equal_range(const K& k) { return t.equal_range(k); }
+  template <class K, class C = Compare, class = __enable_if_transparent<C>>
+  std::pair<const_iterator, const_iterator> 
+  equal_range(const K& k) const { return t.equal_range(k); }
+
   /************** Modifiers **************/
   std::pair<iterator, bool> insert(const pair_type& pair_val) {
     return t.insert_unique(pair_val); 
@@ -120,9 +145,20 @@ public:
     t.erase(position); 
   }
   size_type erase(const key_type& key) { return t.erase(key); } 
+  template <class K, class C = Compare, class = __enable_if_transparent<C>,
+            class = typename std::enable_if<
+                !std::is_convertible<K, iterator>::value &&
+                !std::is_convertible<K, const_iterator>::value>::type>
+  size_type erase(const K& key) { return t.erase(key); }
   void erase(iterator first, iterator last) { t.erase(first, last); }
   void clear() { t.clear(); }
 
+  // spare nodes
+  size_type max_spare_nodes() const { return t.max_spare_nodes(); }
+  void max_spare_nodes(size_type n) { t.max_spare_nodes(n); }
+  void reserve_nodes(size_type n) { t.reserve_nodes(n); }
+  void shrink_to_fit() { t.shrink_to_fit(); }
+
   template<class Key_, class Value_, class Compare_, class Alloc_>
   friend bool operator == (const map<Key_, Value_, Compare_, Alloc_>& m1, 
                            const map<Key_, Value_, Compare_, Alloc_>& m2);
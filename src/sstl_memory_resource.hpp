@@ -0,0 +1,332 @@
+#ifndef _SSTL_MEMORY_RESOURCE_H
+#define _SSTL_MEMORY_RESOURCE_H
+
+#include <atomic>
+#include <cstddef>
+
+#include "sstl_allocator.hpp"
+
+/**
+ * @author Xiaoxi Sun
+ **/
+
+/**
+ * Concepts:
+ *  memory resource - an object that hands out raw memory through virtual
+ *   functions (std::pmr::memory_resource since C++17). The allocator given to
+ *   a container only keeps a pointer to a resource, so containers of the same
+ *   type can take memory from different places (a pool, an arena, a counting
+ *   resource in tests...) without changing the container type.
+ *
+ *  non-virtual interface - allocate(), deallocate() and is_equal() are public
+ *   non-virtual functions calling the protected virtual do_xxx() functions.
+ *
+ *  default resource - the resource used by a default constructed
+ *   polymorphic_alloc. It is the pool of sup::alloc unless replaced by
+ *   set_default_resource().
+ *
+ *  monotonic (bump) allocation - memory is carved from large chunks by moving
+ *   a pointer forward. deallocate() does nothing; everything is given back at
+ *   once by release() or the destructor of the arena. It suits containers
+ *   that are built, used and then destroyed as a whole.
+ **/
+
+/**
+ * Questions:
+ *  - alignment is accepted but not yet honored by alloc_resource: the pool
+ *    aligns every block to __SSTL_ALIGN and malloc to max_align_t.
+ *  - std::atomic used for the default resource
+ **/
+
+namespace sup {
+
+/**
+ * @brief the abstract interface of a memory resource
+ */
+class memory_resource {
+ public:
+  virtual ~memory_resource() {}
+
+  /**
+   * @brief allocate bytes bytes
+   *
+   * @param bytes - number of bytes
+   * @param alignment - alignment of the block
+   * @return void* - the allocated block
+   */
+  void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+    return do_allocate(bytes, alignment);
+  }
+
+  /**
+   * @brief return a block allocated by this resource
+   *
+   * @param p - the block
+   * @param bytes - the size passed to allocate()
+   * @param alignment - the alignment passed to allocate()
+   */
+  void deallocate(void* p, size_t bytes,
+                  size_t alignment = alignof(std::max_align_t)) {
+    do_deallocate(p, bytes, alignment);
+  }
+
+  /**
+   * @brief whether the memory allocated from this can be deallocated by other
+   *
+   * @param other - another resource
+   * @return true - they are interchangeable
+   * @return false - they are not
+   */
+  bool is_equal(const memory_resource& other) const {
+    return do_is_equal(other);
+  }
+
+ protected:
+  virtual void* do_allocate(size_t bytes, size_t alignment) = 0;
+  virtual void do_deallocate(void* p, size_t bytes, size_t alignment) = 0;
+  virtual bool do_is_equal(const memory_resource& other) const = 0;
+};
+
+inline bool operator==(const memory_resource& a, const memory_resource& b) {
+  return &a == &b || a.is_equal(b);
+}
+inline bool operator!=(const memory_resource& a, const memory_resource& b) {
+  return !(a == b);
+}
+
+/**
+ * @brief a memory resource on top of a stateless allocator such as alloc or
+ *  malloc_alloc
+ *
+ * @tparam Alloc - the underlying (static) allocator
+ */
+template <class Alloc>
+class alloc_resource : public memory_resource {
+ protected:
+  void* do_allocate(size_t bytes, size_t) override {
+    return (void*) Alloc::allocate(bytes);
+  }
+  void do_deallocate(void* p, size_t bytes, size_t) override {
+    Alloc::deallocate((char*) p, bytes);
+  }
+  // all instances share the same static allocator
+  bool do_is_equal(const memory_resource& other) const override {
+    return dynamic_cast<const alloc_resource*>(&other) != nullptr;
+  }
+};
+
+typedef alloc_resource<alloc> pool_resource;
+
+/**
+ * @brief the resource backed by the pool of sup::alloc
+ *
+ * @return memory_resource* - a static pool_resource
+ */
+inline memory_resource* pool_memory_resource() {
+  static pool_resource resource;
+  return &resource;
+}
+
+inline std::atomic<memory_resource*>& __default_resource() {
+  static std::atomic<memory_resource*> resource(pool_memory_resource());
+  return resource;
+}
+
+/**
+ * @brief get the resource used by default constructed polymorphic_alloc
+ *
+ * @return memory_resource* - the default resource
+ */
+inline memory_resource* get_default_resource() {
+  return __default_resource().load(std::memory_order_acquire);
+}
+
+/**
+ * @brief replace the default resource; nullptr restores the pool resource
+ *
+ * @param r - the new default resource
+ * @return memory_resource* - the previous default resource
+ */
+inline memory_resource* set_default_resource(memory_resource* r) {
+  if (r == nullptr) r = pool_memory_resource();
+  return __default_resource().exchange(r, std::memory_order_acq_rel);
+}
+
+/**
+ * @brief a monotonic arena: bump allocation from chunks taken from malloc,
+ *  where each new chunk is twice as large as the previous one. An optional
+ *  initial buffer (e.g. on the stack) is used before any chunk.
+ */
+class monotonic_buffer_resource : public memory_resource {
+ public:
+  explicit monotonic_buffer_resource(size_t initial_size = 1024)
+    : chunks(nullptr), initial_buffer(nullptr), initial_buffer_size(0),
+      cur(nullptr), end(nullptr),
+      initial_chunk_size(initial_size < 64 ? 64 : initial_size),
+      next_chunk_size(initial_chunk_size) {}
+
+  monotonic_buffer_resource(void* buffer, size_t buffer_size)
+    : chunks(nullptr), initial_buffer((char*) buffer),
+      initial_buffer_size(buffer_size), cur((char*) buffer),
+      end((char*) buffer + buffer_size),
+      initial_chunk_size(buffer_size < 64 ? 128 : 2 * buffer_size),
+      next_chunk_size(initial_chunk_size) {}
+
+  monotonic_buffer_resource(const monotonic_buffer_resource&) = delete;
+  monotonic_buffer_resource& operator=(const monotonic_buffer_resource&) = delete;
+
+  ~monotonic_buffer_resource() { release(); }
+
+  /**
+   * @brief give back all the chunks; the initial buffer is reused
+   */
+  void release() {
+    while (chunks != nullptr) {
+      chunk_header* next = chunks->next;
+      malloc_alloc::deallocate((char*) chunks, chunks->size);
+      chunks = next;
+    }
+    cur = initial_buffer;
+    end = initial_buffer + initial_buffer_size;
+    next_chunk_size = initial_chunk_size;
+  }
+
+  /**
+   * @brief the non-virtual allocation used by monotonic_alloc
+   *
+   * @param bytes - number of bytes
+   * @param alignment - a power of two
+   * @return void* - the allocated block
+   */
+  void* bump(size_t bytes, size_t alignment) {
+    char* p = align_up(cur, alignment);
+    if (p == nullptr || p > end || bytes > size_t(end - p)) {
+      p = align_up(new_chunk(bytes + alignment), alignment);
+    }
+    cur = p + bytes;
+    return p;
+  }
+
+ protected:
+  void* do_allocate(size_t bytes, size_t alignment) override {
+    return bump(bytes, alignment);
+  }
+  void do_deallocate(void*, size_t, size_t) override {}
+  bool do_is_equal(const memory_resource& other) const override {
+    return this == &other;
+  }
+
+ private:
+  struct chunk_header {
+    chunk_header* next;
+    size_t size;
+  };
+
+  chunk_header* chunks;
+  char* initial_buffer;
+  size_t initial_buffer_size;
+  char* cur;
+  char* end;
+  size_t initial_chunk_size;
+  size_t next_chunk_size;
+
+  static char* align_up(char* p, size_t alignment) {
+    return (char*) (((size_t) p + alignment - 1) & ~(alignment - 1));
+  }
+
+  // get a chunk holding at least bytes bytes and return its first byte
+  char* new_chunk(size_t bytes) {
+    size_t size = sizeof(chunk_header) + bytes;
+    if (size < next_chunk_size) size = next_chunk_size;
+    chunk_header* chunk = (chunk_header*) malloc_alloc::allocate(size);
+    chunk->next = chunks;
+    chunk->size = size;
+    chunks = chunk;
+    next_chunk_size = 2 * size;
+
+    end = (char*) chunk + size;
+    return (char*) (chunk + 1);
+  }
+};
+
+/**
+ * @brief the allocator of a monotonic arena. Allocation bumps a pointer
+ *  (without virtual calls) and deallocation does nothing, so node containers
+ *  of trivially destructible values skip visiting their nodes on clear() and
+ *  destruction. The arena must outlive the containers using it.
+ */
+class monotonic_alloc {
+ public:
+  // implicit, so the arena can be given to containers directly
+  monotonic_alloc(monotonic_buffer_resource* r) : arena(r) {}
+
+  char* allocate(size_t n) {
+    return n == 0 ? nullptr : (char*) arena->bump(round_up(n), __SSTL_ALIGN);
+  }
+
+  void deallocate(char*, size_t) {}
+
+  // blocks are bumped in multiples of __SSTL_ALIGN
+  size_t usable_size(void*, size_t n) const { return round_up(n); }
+
+  size_t max_size() const { return size_t(-1); }
+
+  monotonic_buffer_resource* resource() const { return arena; }
+
+ private:
+  monotonic_buffer_resource* arena;
+
+  static size_t round_up(size_t n) {
+    return (n + __SSTL_ALIGN - 1) & ~(size_t(__SSTL_ALIGN) - 1);
+  }
+};
+
+inline bool operator==(const monotonic_alloc& a, const monotonic_alloc& b) {
+  return a.resource() == b.resource();
+}
+inline bool operator!=(const monotonic_alloc& a, const monotonic_alloc& b) {
+  return !(a == b);
+}
+
+template <>
+struct _alloc_bulk_release<monotonic_alloc> {
+  static const bool value = true;
+};
+
+/**
+ * @brief a stateful allocator that forwards to a memory resource. It has the
+ *  same interface as the other allocators (allocate & deallocate bytes), so
+ *  it can be the Alloc parameter of every container.
+ */
+class polymorphic_alloc {
+ public:
+  polymorphic_alloc() : res(get_default_resource()) {}
+  // implicit, same as std::pmr::polymorphic_allocator
+  polymorphic_alloc(memory_resource* r) : res(r) {}
+
+  char* allocate(size_t n) {
+    return n == 0 ? nullptr : (char*) res->allocate(n);
+  }
+
+  void deallocate(char* p, size_t n) {
+    if (p != nullptr) res->deallocate(p, n);
+  }
+
+  size_t max_size() const { return size_t(-1); }
+
+  memory_resource* resource() const { return res; }
+
+ private:
+  memory_resource* res;
+};
+
+inline bool operator==(const polymorphic_alloc& a, const polymorphic_alloc& b) {
+  return *a.resource() == *b.resource();
+}
+inline bool operator!=(const polymorphic_alloc& a, const polymorphic_alloc& b) {
+  return !(a == b);
+}
+
+}  // namespace sup
+
+#endif
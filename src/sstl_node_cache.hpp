@@ -0,0 +1,100 @@
+#ifndef _SSTL_NODE_CACHE_H
+#define _SSTL_NODE_CACHE_H
+
+#include <cstddef>
+
+/**
+ * @author Xiaoxi Sun
+ **/
+
+/**
+ * Concepts:
+ *  node recycling - node containers (rb_tree, list, hashtable) keep a few
+ *   spare nodes that were erased instead of giving them back to the
+ *   allocator at once. The next insertion takes a spare node, so erase &
+ *   insert churn never reaches the allocator. A spare node holds no value;
+ *   its first bytes link it to the next spare node (like the free lists of
+ *   the pool).
+ *
+ *  bounded - at most max_spare_nodes() nodes are kept per container
+ *   (__SSTL_NODE_CACHE_SIZE by default); the others are deallocated.
+ **/
+
+namespace sup {
+
+// the default number of spare nodes kept by each node container
+#ifndef __SSTL_NODE_CACHE_SIZE
+#  define __SSTL_NODE_CACHE_SIZE 64
+#endif
+
+/**
+ * @brief a bounded stack of spare (unconstructed) nodes
+ *
+ * @tparam Node - node type of the container
+ */
+template <class Node>
+class _node_cache {
+public:
+  _node_cache()
+    : head(nullptr), count(0), limit(__SSTL_NODE_CACHE_SIZE) {}
+
+  size_t size() const { return count; }
+  size_t max_size() const { return limit; }
+  void max_size(size_t n) { limit = n; }
+
+  // take a spare node, or nullptr if there is none
+  Node* pop() {
+    spare* p = head;
+    if (p == nullptr) return nullptr;
+    head = p->next;
+    --count;
+    return (Node*) p;
+  }
+
+  // keep p as a spare node; false if the cache is full
+  bool push(Node* p) {
+    if (count >= limit) return false;
+    spare* s = (spare*) p;
+    s->next = head;
+    head = s;
+    ++count;
+    return true;
+  }
+
+  /**
+   * @brief deallocate spare nodes until no more than keep are left
+   *
+   * @tparam Allocator - simple_alloc of Node
+   * @param a - the allocator of the nodes
+   * @param keep - number of nodes kept
+   */
+  template <class Allocator>
+  void release(Allocator& a, size_t keep = 0) {
+    while (count > keep) a.deallocate(pop());
+  }
+
+  void swap(_node_cache& c) {
+    spare* tmp_head = head;
+    head = c.head;
+    c.head = tmp_head;
+    size_t tmp_count = count;
+    count = c.count;
+    c.count = tmp_count;
+    size_t tmp_limit = limit;
+    limit = c.limit;
+    c.limit = tmp_limit;
+  }
+
+private:
+  struct spare {
+    spare* next;
+  };
+
+  spare* head;
+  size_t count;
+  size_t limit;
+};
+
+}  // namespace sup
+
+#endif
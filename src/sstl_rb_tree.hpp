@@ -6,8 +6,10 @@
 #include "sstl_allocator.hpp"
 #include "sstl_construct.hpp"
 #include "sstl_iterator_base.hpp"
+#include "sstl_node_cache.hpp"
 #include "sstl_stack.hpp"
 #include "sstl_iterator.hpp"
+#include "sstl_type_tratis.hpp"
 
 #include <iostream>
 
@@ -19,6 +21,10 @@
  * Concepts:
  *  - _STL_TRY in create_node
  *  - uses utility library in std
+ *  - heterogeneous lookup: with a transparent comparator (std::less<>),
+ *    find, count, lower_bound, upper_bound, equal_range & erase take any
+ *    key the comparator compares with Key; a std::string key is then found
+ *    from a const char* without building a string
  **/
 
 namespace sup {
@@ -347,7 +353,7 @@ inline void __rb_tree_erase_rebalance(
 
 template <class Key, class Value, class KeyOfValue, 
   class Compare, class Alloc=alloc>
-class rb_tree {
+class rb_tree : protected simple_alloc<__rb_tree_node<Value>, Alloc> {
 protected:
   typedef void* void_pointer;
   typedef __rb_tree_node_base* base_ptr;
@@ -365,6 +371,7 @@ public:
   typedef rb_tree_node* link_type;
   typedef size_t size_type;
   typedef ptrdiff_t difference_type;
+  typedef Alloc allocator_type;
 
   typedef __rb_tree_iterator<value_type, reference, pointer> iterator;
   typedef typename iterator::const_iterator const_iterator;
@@ -375,11 +382,13 @@ protected:
   // helper functions for node
   // create a node
   link_type get_node() {
-    return rb_tree_node_allocator::allocate(1);
+    link_type p = spare_nodes.pop();
+    return p != nullptr ? p : rb_tree_node_allocator::allocate(1);
   }
-  // deallocate the space of a node
+  // keep the space of a node for reuse, or deallocate it
   void put_node(link_type p) {
-    rb_tree_node_allocator::deallocate(p, 1);
+    if (!spare_nodes.push(p))
+      rb_tree_node_allocator::deallocate(p, 1);
   }
   // create a node init with val
   link_type create_node(const value_type& val) {
@@ -416,8 +425,37 @@ protected:
   size_type node_count; 
   link_type header; // a node "above" root
   Compare comp; // a function for comparing keys  
+  _node_cache<rb_tree_node> spare_nodes; // erased nodes kept for reuse
 
   link_type& root() const { return (link_type&) header->parent;}
+  // the first node whose key is not less than k, or header
+  template <class K>
+  link_type lower_bound_node(const K& k) const {
+    link_type pre = header;
+    link_type cur = (link_type) header->parent;
+    while(cur != nullptr) {
+      if (!comp(KeyOfValue() (cur->value_field), k)) {
+        pre = cur;
+        cur = (link_type) cur->left;
+      } else 
+        cur = (link_type) cur->right;
+    }
+    return pre;
+  }
+  // the first node whose key is greater than k, or header
+  template <class K>
+  link_type upper_bound_node(const K& k) const {
+    link_type pre = header;
+    link_type cur = (link_type) header->parent;
+    while (cur != nullptr) {
+      if (comp(k, KeyOfValue() (cur->value_field))) {
+        pre = cur;
+        cur = (link_type) cur->left;
+      } else 
+        cur = (link_type) cur->right;
+    }
+    return pre;
+  }
   link_type& left_most() const { return (link_type&) header->left;}
   link_type& right_most() const { return (link_type&) header->right;}
   // traversal methods:
@@ -522,7 +560,6 @@ private:
     link_type x = (link_type) x_;
     link_type y = (link_type) y_;
     link_type z;
-    bool comp_result = comp(KeyOfValue()(val), key(y));
     z = create_node(val);
 
     // no x != 0
@@ -646,7 +683,12 @@ public:
   rb_tree(const Compare& comp = Compare()): node_count(0), comp(comp) { 
     init(); 
   }
-  rb_tree(const rb_tree<Key, Value, KeyOfValue, Compare, Alloc>& t) {
+  rb_tree(const Compare& comp, const allocator_type& a)
+    : rb_tree_node_allocator(a), node_count(0), comp(comp) {
+    init();
+  }
+  rb_tree(const rb_tree<Key, Value, KeyOfValue, Compare, Alloc>& t)
+    : rb_tree_node_allocator(t.get_allocator()), node_count(0) {
     init();
     comp = t.comp;
 
@@ -674,10 +716,14 @@ public:
   ~rb_tree() {
     clear();
     put_node(header);
+    spare_nodes.release(static_cast<rb_tree_node_allocator&>(*this));
   }
 
   /********* Accessors *********/
   Compare key_comp() const { return comp;}
+  allocator_type get_allocator() const {
+    return rb_tree_node_allocator::get_alloc();
+  }
   iterator begin() const { return left_most(); }
   iterator end() const { return header; }
   reverse_iterator rbegin() const { return iterator(header); }
@@ -685,15 +731,35 @@ public:
   bool empty() const { return node_count == 0; }
   size_type size() const { return node_count; }
   size_type max_size() const { return size_type(-1); }
+
+  /********* Spare nodes *********/
+  size_type spare_nodes_count() const { return spare_nodes.size(); }
+  size_type max_spare_nodes() const { return spare_nodes.max_size(); }
+  void max_spare_nodes(size_type n) {
+    spare_nodes.max_size(n);
+    spare_nodes.release(static_cast<rb_tree_node_allocator&>(*this), n);
+  }
+  // allocate spare nodes such that n insertions need no allocation
+  void reserve_nodes(size_type n) {
+    if (spare_nodes.max_size() < n) spare_nodes.max_size(n);
+    while (spare_nodes.size() < n)
+      spare_nodes.push(rb_tree_node_allocator::allocate(1));
+  }
+  // give all the spare nodes back to the allocator
+  void shrink_to_fit() {
+    spare_nodes.release(static_cast<rb_tree_node_allocator&>(*this));
+  }
+
   void swap(rb_tree<Key, Value, KeyOfValue, Compare, Alloc>& t) {
     link_type temp_header = t.header;
     t.header = this->header;
-    this->header = t.header;
+    this->header = temp_header;
     size_type temp_node_count = t.node_count;
     t.node_count = node_count;
     node_count = temp_node_count; 
-    link_type header; // a node "above" root
     // no need to swap key_comp
+    spare_nodes.swap(t.spare_nodes);
+    _alloc_swap<rb_tree_node_allocator>::_swap(*this, t);
   }
 
   iterator find(const Key& k);
@@ -706,6 +772,51 @@ public:
   std::pair<iterator, iterator> equal_range(const Key& k);
   std::pair<const_iterator, const_iterator> equal_range(const Key& k) const;
 
+  const_iterator find(const Key& k) const {
+    return const_cast<rb_tree*>(this)->find(k);
+  }
+
+  // heterogeneous lookup (transparent Compare only): k is any key that comp
+  // compares with Key
+  template <class K, class C = Compare, class = __enable_if_transparent<C>>
+  iterator find(const K& k) {
+    iterator lower(lower_bound_node(k));
+    return (lower == end() || comp(k, KeyOfValue() (*lower))) ? end(): lower;
+  }
+  template <class K, class C = Compare, class = __enable_if_transparent<C>>
+  const_iterator find(const K& k) const {
+    return const_cast<rb_tree*>(this)->find(k);
+  }
+  template <class K, class C = Compare, class = __enable_if_transparent<C>>
+  size_type count(const K& k) {
+    size_type num = 0;
+    for (std::pair<iterator, iterator> p = equal_range(k); p.first != p.second; ++p.first)
+      ++num;
+    return num;
+  }
+  template <class K, class C = Compare, class = __enable_if_transparent<C>>
+  iterator lower_bound(const K& k) { return iterator(lower_bound_node(k)); }
+  template <class K, class C = Compare, class = __enable_if_transparent<C>>
+  const_iterator lower_bound(const K& k) const {
+    return const_iterator(lower_bound_node(k));
+  }
+  template <class K, class C = Compare, class = __enable_if_transparent<C>>
+  iterator upper_bound(const K& k) { return iterator(upper_bound_node(k)); }
+  template <class K, class C = Compare, class = __enable_if_transparent<C>>
+  const_iterator upper_bound(const K& k) const {
+    return const_iterator(upper_bound_node(k));
+  }
+  template <class K, class C = Compare, class = __enable_if_transparent<C>>
+  std::pair<iterator, iterator> equal_range(const K& k) {
+    return std::make_pair(iterator(lower_bound_node(k)),
+                          iterator(upper_bound_node(k)));
+  }
+  template <class K, class C = Compare, class = __enable_if_transparent<C>>
+  std::pair<const_iterator, const_iterator> equal_range(const K& k) const {
+    return std::make_pair(const_iterator(lower_bound_node(k)),
+                          const_iterator(upper_bound_node(k)));
+  }
+
   /********* Modifiers *********/
   iterator insert_equal(iterator position, const value_type& val);
   iterator insert_equal(const value_type& val);
@@ -720,11 +831,23 @@ public:
   iterator erase(iterator position);
   size_type erase(const Key& k);
   iterator erase(iterator first, iterator last);
+  // heterogeneous erase (transparent Compare only); not for iterators
+  template <class K, class C = Compare, class = __enable_if_transparent<C>,
+            class = typename std::enable_if<
+                !std::is_convertible<K, iterator>::value &&
+                !std::is_convertible<K, const_iterator>::value>::type>
+  size_type erase(const K& k) {
+    iterator position = find(k);
+    if (position == end())
+      return 0;
+    erase(position);
+    return 1;
+  }
 
   void clear();
 
   rb_tree<Key, Value, KeyOfValue, Compare, Alloc>& operator= 
-    (rb_tree<Key, Value, KeyOfValue, Compare, Alloc>& t);
+    (const rb_tree<Key, Value, KeyOfValue, Compare, Alloc>& t);
   
   template <class Key_, class Value_, class KeyOfValue_, 
   class Compare_, class Alloc_>
@@ -750,7 +873,7 @@ typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
   rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::find(const Key& k) {
   iterator lower = lower_bound(k);
 
-  return (lower == end() || comp(KeyOfValue() (*lower), k)) ? end(): lower; 
+  return (lower == end() || comp(k, KeyOfValue() (*lower))) ? end(): lower; 
 }
 
 /**
@@ -796,16 +919,7 @@ template <class Key, class Value, class KeyOfValue,
   class Compare, class Alloc>
 typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
   rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::upper_bound(const Key& k) {
-  link_type pre = header;
-  link_type cur = (link_type) header->parent;
-  while (cur != nullptr) {
-    if (comp(k, KeyOfValue() (cur->value_field))) {
-      pre = cur;
-      cur = (link_type) cur->left;
-    } else 
-    cur = (link_type) cur->right;
-  }
-  return iterator(pre);
+  return iterator(upper_bound_node(k));
 }
 
 /**
@@ -826,16 +940,7 @@ template <class Key, class Value, class KeyOfValue,
   class Compare, class Alloc>
 typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::const_iterator
   rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::upper_bound(const Key& k) const {
-  link_type pre = header;
-  link_type cur = (link_type) header->parent;
-  while (cur != nullptr) {
-    if (comp(k, KeyOfValue() (cur->value_field))) {
-      pre = cur;
-      cur = (link_type) cur->left;
-    } else 
-    cur = (link_type) cur->right;
-  }
-  return const_iterator(pre);
+  return const_iterator(upper_bound_node(k));
 }
 
 /**
@@ -858,16 +963,7 @@ template <class Key, class Value, class KeyOfValue,
   class Compare, class Alloc>
 typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
   rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::lower_bound(const Key& k) {
-  link_type pre = header;
-  link_type cur = (link_type) header->parent;
-  while(cur != nullptr) {
-    if (!comp(KeyOfValue() (cur->value_field), k)) {
-      pre = cur;
-      cur = (link_type) cur->left;
-    } else 
-      cur = (link_type) cur->right;
-  }
-  return iterator(pre);
+  return iterator(lower_bound_node(k));
 }
 
 /**
@@ -890,16 +986,7 @@ template <class Key, class Value, class KeyOfValue,
   class Compare, class Alloc>
 typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::const_iterator
   rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::lower_bound(const Key& k) const {
-  link_type pre = header;
-  link_type cur = (link_type) header->parent;
-  while(cur != nullptr) {
-    if (!comp(KeyOfValue() (cur->value_field), k)) {
-      pre = cur;
-      cur = (link_type) cur->left;
-    } else 
-      cur = (link_type) cur->right;
-  }
-  return const_iterator(pre);
+  return const_iterator(lower_bound_node(k));
 }
 
 /**
@@ -1232,14 +1319,31 @@ template <class Key, class Value, class KeyOfValue,
   class Compare, class Alloc>
 rb_tree<Key, Value, KeyOfValue, Compare, Alloc>&
   rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::operator= 
-  (rb_tree<Key, Value, KeyOfValue, Compare, Alloc>& t) {
+  (const rb_tree<Key, Value, KeyOfValue, Compare, Alloc>& t) {
+  if (this == &t)
+    return *this;
+
+  // keep all the current nodes, so copying t reuses them instead of
+  // deallocating and allocating every node
+  const size_type max_spare = spare_nodes.max_size();
+  if (max_spare < node_count + spare_nodes.size())
+    spare_nodes.max_size(node_count + spare_nodes.size());
   this->clear();
+  comp = t.comp;
 
-  if (t.empty())
+  if (t.empty()) {
+    max_spare_nodes(max_spare);
     return *this;
+  }
 
   // copy subtree
-  header->parent = (base_ptr) __copy_subtree((link_type) t.header->parent);
+  try {
+    header->parent = (base_ptr) __copy_subtree((link_type) t.header->parent);
+  } catch (...) {
+    max_spare_nodes(max_spare);
+    throw;
+  }
+  max_spare_nodes(max_spare);
   header->parent->parent = header;
   node_count = t.node_count;
 
@@ -1273,6 +1377,8 @@ void rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::clear() {
   sup::stack<base_ptr> stk; 
   base_ptr cur = header->parent;
   base_ptr pre = nullptr;
+  if (_alloc_skip_node_release<Alloc, Value>::value) 
+    cur = nullptr;
   while(cur != nullptr || !stk.empty()) {
     while( cur != nullptr) {
       stk.push(cur);
@@ -1281,7 +1387,7 @@ void rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::clear() {
 
     cur = stk.top();
     if (cur->right == nullptr || cur->right == pre) {
-      put_node((link_type) cur);
+      destroy_node((link_type) cur);
       stk.pop();
       pre = cur;
       cur = nullptr;
@@ -1293,6 +1399,7 @@ void rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::clear() {
   root() = nullptr;
   left_most() = header;
   right_most() = header;
+  node_count = 0;
 }
 
 template <class Key, class Value, class KeyOfValue, 
@@ -41,10 +41,12 @@ public:
   typedef typename container_type::const_reverse_iterator const_reverse_iterator;
   typedef typename container_type::size_type size_type;
   typedef typename container_type::difference_type difference_type;
+  typedef typename container_type::allocator_type allocator_type;
 
   /*************** De-Constructors ***************/
   set(): t(Compare()) {}
   explicit set(const Compare& cmp): t(cmp) {}  
+  set(const Compare& cmp, const allocator_type& a): t(cmp, a) {}
   template<class InputIterator>
   set(InputIterator first, InputIterator last)
     :t(Compare()) { t.insert_unique(first, last); }
@@ -65,6 +67,7 @@ public:
   size_type size() { return t.size(); }
   size_type max_size() { return t.max_size(); }
   key_compare key_comp() { return t.key_comp(); }
+  allocator_type get_allocator() const { return t.get_allocator(); }
   value_type value_comp() { return t.key_comp(); }
   void swap(set<Key, Compare, Alloc>& s) { t.swap(*this, s); }
 
@@ -81,6 +84,28 @@ public:
   std::pair<const_iterator, const_iterator> 
   equal_range(const Key& k) const { return t.equal_range(k); }
 
+  // heterogeneous lookup (transparent Compare only)
+  template <class K, class C = Compare, class = __enable_if_transparent<C>>
+  iterator find(const K& k) { return t.find(k); }
+  template <class K, class C = Compare, class = __enable_if_transparent<C>>
+  const_iterator find(const K& k) const { return t.find(k); }
+  template <class K, class C = Compare, class = __enable_if_transparent<C>>
+  size_type count(const K& k) { return t.count(k); }
+  template <class K, class C = Compare, class = __enable_if_transparent<C>>
+  iterator lower_bound(const K& k) { return t.lower_bound(k); }
+  template <class K, class C = Compare, class = __enable_if_transparent<C>>
+  const_iterator lower_bound(const K& k) const { return t.lower_bound(k); }
+  template <class K, class C = Compare, class = __enable_if_transparent<C>>
+  iterator upper_bound(const K& k) { return t.upper_bound(k); }
+  template <class K, class C = Compare, class = __enable_if_transparent<C>>
+  const_iterator upper_bound(const K& k) const { return t.upper_bound(k); }
+  template <class K, class C = Compare, class = __enable_if_transparent<C>>
+  std::pair<iterator, iterator> 
+  equal_range(const K& k) { return t.equal_range(k); }
+  template <class K, class C = Compare, class = __enable_if_transparent<C>>
+  std::pair<const_iterator, const_iterator> 
+  equal_range(const K& k) const { return t.equal_range(k); }
+
   /*************** Modifiers ***************/
   std::pair<iterator, bool> insert(const value_type& val) {
     std::pair<typename container_type::iterator, bool> result = t.insert_unique(val);
@@ -98,8 +123,20 @@ public:
     t.insert_unique(first, last);
   }
 
+  size_type erase(const Key& k) { return t.erase(k); }
+  template <class K, class C = Compare, class = __enable_if_transparent<C>,
+            class = typename std::enable_if<
+                !std::is_convertible<K, iterator>::value &&
+                !std::is_convertible<K, const_iterator>::value>::type>
+  size_type erase(const K& key) { return t.erase(key); }
   void clear() { t.clear(); }
 
+  // spare nodes
+  size_type max_spare_nodes() const { return t.max_spare_nodes(); }
+  void max_spare_nodes(size_type n) { t.max_spare_nodes(n); }
+  void reserve_nodes(size_type n) { t.reserve_nodes(n); }
+  void shrink_to_fit() { t.shrink_to_fit(); }
+
   /*************** Overloading ***************/
   set<Key, Compare, Alloc>& operator=(const set<Key, Compare, Alloc>&s) {
     t = s.t;
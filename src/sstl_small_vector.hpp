@@ -0,0 +1,723 @@
+#ifndef _SSTL_SMALL_VECTOR_H
+#define _SSTL_SMALL_VECTOR_H
+
+#include <algorithm>    // std::rotate, std::swap_ranges
+#include <type_traits>  // std::aligned_storage
+#include <utility>      // std::move
+
+#include "sstl_allocator.hpp"
+#include "sstl_iterator.hpp"
+#include "sstl_uninitialized.hpp"
+
+/**
+ * @author Xiaoxi Sun
+ **/
+
+/**
+ * Concepts:
+ *  - small buffer optimization: the first N elements live in a buffer inside
+ *    the object, so a small_vector that never holds more than N elements
+ *    never allocates. The elements go to the heap once the buffer overflows
+ *    and stay there.
+ *  - the interface of vector: start, finish & end_of_storage point either to
+ *    the inline buffer or to a heap block, so everything but growth, move &
+ *    swap works as in vector
+ *  - moving or swapping an inline small_vector relocates its elements (and
+ *    invalidates the iterators); a heap block is handed over as in vector.
+ *    For the same reason a small_vector is not trivially relocatable: start
+ *    may point into the object itself.
+ **/
+
+/**
+ * Questions:
+ *  - insert constructs the new elements at the end and rotates them into
+ *    place (std::rotate): few elements are shifted in a small vector
+ *  - std::aligned_storage used for the inline buffer
+ *  - std::swap_ranges used
+ *  - std::__is_integer, std::__true_type, and std::__false_type used
+ **/
+
+namespace sup {
+
+template <class T, size_t N = 8, class Alloc = alloc>
+class small_vector : protected simple_alloc<T, Alloc> {
+  static_assert(N > 0, "small_vector needs an inline buffer");
+
+  /******** Public types and methods ********/
+ public:
+  typedef T value_type;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+
+  typedef T* iterator;  // use pointers as iterators
+  typedef const T* const_iterator;
+  typedef sup::reverse_iterator<iterator> reverse_iterator;
+  typedef sup::reverse_iterator<const_iterator> const_reverse_iterator;
+
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+  typedef sup::simple_alloc<T, Alloc> allocator_type;
+
+  // the number of elements held without allocation
+  static constexpr size_type inline_capacity() { return N; }
+
+  /******** Constructors ********/
+  small_vector();
+  explicit small_vector(const allocator_type& a);
+  explicit small_vector(size_type n);
+  small_vector(size_type n, const_reference value,
+               const allocator_type& a = allocator_type());
+  template <class InputIterator1, class InputIterator2>
+  small_vector(InputIterator1 first, InputIterator2 last,
+               const allocator_type& a = allocator_type());
+  small_vector(const small_vector& x);
+  small_vector(small_vector&& x) noexcept(
+      std::is_nothrow_move_constructible<T>::value);
+  // Destructors
+  ~small_vector();
+
+  small_vector& operator=(const small_vector& x);
+  small_vector& operator=(small_vector&& x) noexcept(
+      std::is_nothrow_move_constructible<T>::value);
+
+  /******** Sizes ********/
+  size_type size() const { return size_type(finish - start); }
+  size_type capacity() const { return size_type(end_of_storage - start); }
+  bool empty() const { return start == finish; }
+  // whether the elements are in the inline buffer
+  bool is_inline() const { return start == inline_start(); }
+  // bytes allocated on the heap (the inline buffer is part of the object)
+  size_type memory_usage() const {
+    return is_inline() ? 0 : capacity() * sizeof(T);
+  }
+  void resize(size_type new_size, const_reference value);
+  void resize(size_type new_size);
+  void resize_for_overwrite(size_type new_size);
+  iterator append_uninitialized(size_type n);
+
+  /******** Iterators ********/
+  iterator begin() { return start; }
+  iterator end() { return finish; }
+  const_iterator begin() const { return start; }
+  const_iterator end() const { return finish; }
+  reverse_iterator rbegin() { return reverse_iterator(finish); }
+  reverse_iterator rend() { return reverse_iterator(start); }
+
+  /******** Element access ********/
+  reference operator[](size_type n) { return *(start + n); }
+  const_reference operator[](size_type n) const { return *(start + n); }
+  reference front() { return *start; }
+  const_reference front() const { return *start; }
+  reference back() { return *(finish - 1); }
+  const_reference back() const { return *(finish - 1); }
+
+  void push_back(const_reference value);
+  void push_back(value_type&& value);
+  template <class... Args>
+  void emplace_back(Args&&... args);
+  void pop_back();
+
+  iterator erase(iterator position);
+  iterator erase(iterator first, iterator last);
+
+  void reserve(size_type n);
+  void shrink_to_fit();
+  void clear();
+
+  template <class InputIterator1, class InputIterator2>
+  void assign(InputIterator1 first, InputIterator2 last);
+
+  iterator insert(iterator position, const_reference value);
+  iterator insert(iterator position, value_type&& value);
+  template <class... Args>
+  iterator emplace(iterator position, Args&&... args);
+  void insert(iterator position, size_type n, const_reference value);
+  template <class InputIterator>
+  void insert(iterator position, InputIterator first, InputIterator last);
+
+  void swap(small_vector& x);
+
+  allocator_type get_allocator() const { return *this; }
+
+ protected:
+  typedef simple_alloc<T, Alloc> data_allocator;
+  iterator start;
+  iterator finish;
+  iterator end_of_storage;
+  typename std::aligned_storage<N * sizeof(T), alignof(T)>::type buffer;
+
+  T* inline_start() { return reinterpret_cast<T*>(&buffer); }
+  const T* inline_start() const { return reinterpret_cast<const T*>(&buffer); }
+
+  // point to the empty inline buffer
+  void reset_to_inline() {
+    start = finish = inline_start();
+    end_of_storage = start + N;
+  }
+
+  void deallocate() {
+    if (!is_inline()) data_allocator::deallocate(start, capacity());
+  }
+
+  // move the elements to block (of at least size() objects) on the heap
+  void relocate_to(allocation_result<T*> block);
+  // make room for n more elements
+  void grow(size_type n);
+  // move the elements of [first_new, finish) to position
+  void rotate_into(iterator position, iterator first_new) {
+    if (position != first_new) std::rotate(position, first_new, finish);
+  }
+
+  template <class InputIterator1, class InputIterator2>
+  void assign_aux(InputIterator1 first, InputIterator2 last, std::__false_type);
+  template <class Size>
+  void assign_aux(Size n, const T& value, std::__true_type);
+  template <class InputIterator>
+  void insert_aux(iterator position, InputIterator first, InputIterator last,
+                  std::false_type);
+  template <class Integer>
+  void insert_aux(iterator position, Integer n, const_reference value,
+                  std::true_type);
+
+  // swap the elements of two inline small_vectors
+  static void swap_inline(small_vector& a, small_vector& b);
+};
+
+/************** Constructors & Destructor **************/
+
+template <class T, size_t N, class Alloc>
+small_vector<T, N, Alloc>::small_vector() {
+  reset_to_inline();
+}
+
+/**
+ * @brief Construct an empty small_vector; heap blocks come from a
+ *
+ * @tparam T - element type parameter
+ * @tparam N - number of inline elements
+ * @tparam Alloc - allocator type
+ * @param a - the allocator instance used by this small_vector
+ */
+template <class T, size_t N, class Alloc>
+small_vector<T, N, Alloc>::small_vector(const allocator_type& a)
+    : data_allocator(a) {
+  reset_to_inline();
+}
+
+template <class T, size_t N, class Alloc>
+small_vector<T, N, Alloc>::small_vector(size_type n) {
+  reset_to_inline();
+  resize(n);
+}
+
+/**
+ * @brief Construct a small_vector with n copies of value
+ *
+ * @tparam T - element type parameter
+ * @tparam N - number of inline elements
+ * @tparam Alloc - allocator type
+ * @param n - number of elements
+ * @param value - the value to be filled
+ * @param a - the allocator instance used by this small_vector
+ */
+template <class T, size_t N, class Alloc>
+small_vector<T, N, Alloc>::small_vector(size_type n, const_reference value,
+                                        const allocator_type& a)
+    : data_allocator(a) {
+  reset_to_inline();
+  insert(finish, n, value);
+}
+
+/**
+ * @brief Construct a small_vector from a range, or from n copies of a value
+ *  when both parameters are integers (same as vector)
+ *
+ * @tparam T - element type parameter
+ * @tparam N - number of inline elements
+ * @tparam Alloc - allocator type
+ * @param first - start of the range
+ * @param last - end of the range
+ * @param a - the allocator instance used by this small_vector
+ */
+template <class T, size_t N, class Alloc>
+template <class InputIterator1, class InputIterator2>
+small_vector<T, N, Alloc>::small_vector(InputIterator1 first,
+                                        InputIterator2 last,
+                                        const allocator_type& a)
+    : data_allocator(a) {
+  reset_to_inline();
+  assign(first, last);
+}
+
+template <class T, size_t N, class Alloc>
+small_vector<T, N, Alloc>::small_vector(const small_vector& x)
+    : data_allocator(x.get_allocator()) {
+  reset_to_inline();
+  assign(x.begin(), x.end());
+}
+
+/**
+ * @brief Construct a small_vector from x, which is left empty. A heap block
+ *  is taken over; inline elements are relocated.
+ *
+ * @tparam T - element type parameter
+ * @tparam N - number of inline elements
+ * @tparam Alloc - allocator type
+ * @param x - another small_vector
+ */
+template <class T, size_t N, class Alloc>
+small_vector<T, N, Alloc>::small_vector(small_vector&& x) noexcept(
+    std::is_nothrow_move_constructible<T>::value)
+    : data_allocator(x.get_allocator()) {
+  if (x.is_inline()) {
+    reset_to_inline();
+    finish = sup::uninitialized_relocate(x.start, x.finish, start);
+    x.finish = x.start;
+  } else {
+    start = x.start;
+    finish = x.finish;
+    end_of_storage = x.end_of_storage;
+    x.reset_to_inline();
+  }
+}
+
+template <class T, size_t N, class Alloc>
+small_vector<T, N, Alloc>::~small_vector() {
+  sup::_destroy(start, finish);
+  deallocate();
+}
+
+/**
+ * @brief copy the elements of x; the allocator is kept
+ *
+ * @tparam T - element type parameter
+ * @tparam N - number of inline elements
+ * @tparam Alloc - allocator type
+ * @param x - another small_vector
+ * @return small_vector<T, N, Alloc>& - reference to *this
+ */
+template <class T, size_t N, class Alloc>
+small_vector<T, N, Alloc>& small_vector<T, N, Alloc>::operator=(
+    const small_vector& x) {
+  if (this != &x) assign(x.begin(), x.end());
+  return *this;
+}
+
+/**
+ * @brief take the elements (and the allocator) of x; the old elements of
+ *  this are destroyed
+ *
+ * @tparam T - element type parameter
+ * @tparam N - number of inline elements
+ * @tparam Alloc - allocator type
+ * @param x - another small_vector, left empty
+ * @return small_vector<T, N, Alloc>& - reference to *this
+ */
+template <class T, size_t N, class Alloc>
+small_vector<T, N, Alloc>& small_vector<T, N, Alloc>::operator=(
+    small_vector&& x) noexcept(std::is_nothrow_move_constructible<T>::value) {
+  small_vector tmp(std::move(x));
+  swap(tmp);
+  return *this;
+}
+
+/**************   Size   **************/
+
+template <class T, size_t N, class Alloc>
+void small_vector<T, N, Alloc>::resize(size_type new_size,
+                                       const_reference value) {
+  if (new_size < size())
+    erase(start + new_size, finish);
+  else
+    insert(finish, new_size - size(), value);
+}
+
+// value initialized elements, constructed in place
+template <class T, size_t N, class Alloc>
+void small_vector<T, N, Alloc>::resize(size_type new_size) {
+  if (new_size < size()) {
+    erase(start + new_size, finish);
+  } else {
+    const size_type n = new_size - size();
+    if (size_type(end_of_storage - finish) < n) grow(n);
+    finish = sup::uninitialized_value_construct_n(finish, n);
+  }
+}
+
+// default initialized elements: trivial ones are left uninitialized
+template <class T, size_t N, class Alloc>
+void small_vector<T, N, Alloc>::resize_for_overwrite(size_type new_size) {
+  if (new_size < size()) {
+    erase(start + new_size, finish);
+  } else {
+    append_uninitialized(new_size - size());
+  }
+}
+
+template <class T, size_t N, class Alloc>
+typename small_vector<T, N, Alloc>::iterator
+small_vector<T, N, Alloc>::append_uninitialized(size_type n) {
+  if (size_type(end_of_storage - finish) < n) grow(n);
+  iterator first = finish;
+  finish = sup::uninitialized_default_construct_n(finish, n);
+  return first;
+}
+
+/**
+ * @brief reserve capacity of at least n. Nothing is allocated while n fits
+ *  into the inline buffer.
+ *
+ * @tparam T - element type parameter
+ * @tparam N - number of inline elements
+ * @tparam Alloc - allocator type
+ * @param n - the capacity must be greater than this after reserve
+ */
+template <class T, size_t N, class Alloc>
+void small_vector<T, N, Alloc>::reserve(size_type n) {
+  if (capacity() < n) {
+    allocation_result<T*> block;
+    block.ptr = data_allocator::allocate(n);
+    block.count = n;
+    relocate_to(block);
+  }
+}
+
+/**
+ * @brief give back the unused heap capacity; the elements go back to the
+ *  inline buffer if they fit
+ *
+ * @tparam T - element type parameter
+ * @tparam N - number of inline elements
+ * @tparam Alloc - allocator type
+ */
+template <class T, size_t N, class Alloc>
+void small_vector<T, N, Alloc>::shrink_to_fit() {
+  if (is_inline() || capacity() == size()) return;
+
+  if (size() <= N) {
+    iterator old_start = start;
+    iterator old_finish = finish;
+    const size_type old_capacity = capacity();
+    reset_to_inline();
+    try {
+      finish = sup::uninitialized_relocate(old_start, old_finish, start);
+    } catch (...) {  // the elements were copied: the old ones are intact
+      start = old_start;
+      finish = old_finish;
+      end_of_storage = old_start + old_capacity;
+      throw;
+    }
+    data_allocator::deallocate(old_start, old_capacity);
+  } else {
+    allocation_result<T*> block;
+    block.ptr = data_allocator::allocate(size());
+    block.count = size();
+    relocate_to(block);
+  }
+}
+
+/************** Modification **************/
+
+template <class T, size_t N, class Alloc>
+void small_vector<T, N, Alloc>::push_back(const_reference value) {
+  emplace_back(value);
+}
+
+template <class T, size_t N, class Alloc>
+void small_vector<T, N, Alloc>::push_back(value_type&& value) {
+  emplace_back(std::move(value));
+}
+
+/**
+ * @brief construct an element at the back from args
+ *
+ * @tparam T - element type parameter
+ * @tparam N - number of inline elements
+ * @tparam Alloc - allocator type
+ * @tparam Args - types of the arguments of a constructor of T
+ * @param args - the arguments
+ */
+template <class T, size_t N, class Alloc>
+template <class... Args>
+void small_vector<T, N, Alloc>::emplace_back(Args&&... args) {
+  if (finish != end_of_storage) {
+    sup::_construct(finish, std::forward<Args>(args)...);
+  } else {
+    // args might refer to an element that is about to be relocated
+    T value_copy(std::forward<Args>(args)...);
+    grow(1);
+    sup::_construct(finish, std::move(value_copy));
+  }
+  ++finish;
+}
+
+template <class T, size_t N, class Alloc>
+void small_vector<T, N, Alloc>::pop_back() {
+  --finish;
+  sup::_destroy(finish);
+}
+
+/**
+ * @brief erase the element at position
+ *
+ * @tparam T - element type parameter
+ * @tparam N - number of inline elements
+ * @tparam Alloc - allocator type
+ * @param position - the position of the element to be erased
+ * @return small_vector<T, N, Alloc>::iterator - iterator pointing to position
+ */
+template <class T, size_t N, class Alloc>
+typename small_vector<T, N, Alloc>::iterator small_vector<T, N, Alloc>::erase(
+    iterator position) {
+  return erase(position, position + 1);
+}
+
+/**
+ * @brief erase the element in the given range [first, last)
+ *
+ * @tparam T - element type parameter
+ * @tparam N - number of inline elements
+ * @tparam Alloc - allocator type
+ * @param first - start the range (inclusive)
+ * @param last - end of the range (exclusive)
+ * @return small_vector<T, N, Alloc>::iterator - start iterator
+ */
+template <class T, size_t N, class Alloc>
+typename small_vector<T, N, Alloc>::iterator small_vector<T, N, Alloc>::erase(
+    iterator first, iterator last) {
+  if (__is_trivially_relocatable<T>::value) {
+    sup::_destroy(first, last);
+    finish = sup::uninitialized_relocate(last, finish, first);
+    return first;
+  }
+
+  iterator temp_end = std::move(last, finish, first);
+  sup::_destroy(temp_end, finish);
+  finish = temp_end;
+  return first;
+}
+
+/**
+ * @brief destroy the elements; the heap block (if any) is kept
+ *
+ * @tparam T - element type parameter
+ * @tparam N - number of inline elements
+ * @tparam Alloc - allocator type
+ */
+template <class T, size_t N, class Alloc>
+void small_vector<T, N, Alloc>::clear() {
+  sup::_destroy(start, finish);
+  finish = start;
+}
+
+template <class T, size_t N, class Alloc>
+template <class InputIterator1, class InputIterator2>
+void small_vector<T, N, Alloc>::assign(InputIterator1 first,
+                                       InputIterator2 last) {
+  typedef typename std::__is_integer<InputIterator1>::__type _Integral;
+
+  assign_aux(first, last, _Integral());
+}
+
+template <class T, size_t N, class Alloc>
+template <class InputIterator1, class InputIterator2>
+void small_vector<T, N, Alloc>::assign_aux(InputIterator1 first,
+                                           InputIterator2 last,
+                                           std::__false_type) {
+  clear();
+  reserve(size_type(last - first));
+  finish = sup::uninitialized_copy(first, last, start);
+}
+
+template <class T, size_t N, class Alloc>
+template <class Size>
+void small_vector<T, N, Alloc>::assign_aux(Size n, const T& value,
+                                           std::__true_type) {
+  // value might be an element
+  T value_copy = value;
+  clear();
+  reserve(size_type(n));
+  finish = sup::uninitialized_fill_n(start, size_type(n), value_copy);
+}
+
+template <class T, size_t N, class Alloc>
+typename small_vector<T, N, Alloc>::iterator small_vector<T, N, Alloc>::insert(
+    iterator position, const_reference value) {
+  return emplace(position, value);
+}
+
+template <class T, size_t N, class Alloc>
+typename small_vector<T, N, Alloc>::iterator small_vector<T, N, Alloc>::insert(
+    iterator position, value_type&& value) {
+  return emplace(position, std::move(value));
+}
+
+/**
+ * @brief construct an element at position from args
+ *
+ * @tparam T - element type parameter
+ * @tparam N - number of inline elements
+ * @tparam Alloc - allocator type
+ * @tparam Args - types of the arguments of a constructor of T
+ * @param position - where the element is constructed
+ * @param args - the arguments
+ * @return small_vector<T, N, Alloc>::iterator - the inserted element
+ */
+template <class T, size_t N, class Alloc>
+template <class... Args>
+typename small_vector<T, N, Alloc>::iterator small_vector<T, N, Alloc>::emplace(
+    iterator position, Args&&... args) {
+  const size_type offset = position - start;
+  emplace_back(std::forward<Args>(args)...);
+  rotate_into(start + offset, finish - 1);
+  return start + offset;
+}
+
+/**
+ * @brief insert n elements with value, starting from position.
+ *
+ * @tparam T - element type parameter
+ * @tparam N - number of inline elements
+ * @tparam Alloc - allocator type
+ * @param position - start position
+ * @param n - number of elements
+ * @param value - value to be inserted
+ */
+template <class T, size_t N, class Alloc>
+void small_vector<T, N, Alloc>::insert(iterator position, size_type n,
+                                       const_reference value) {
+  insert_aux(position, n, value, std::true_type());
+}
+
+/**
+ * @brief insert the elements in range [first, last)
+ *
+ * @tparam T - element type parameter
+ * @tparam N - number of inline elements
+ * @tparam Alloc - allocator type
+ * @tparam InputIterator - iterators to values to be copied
+ * @param position - start point of insertion
+ * @param first - start of the iterator
+ * @param last - end of the iterator
+ */
+template <class T, size_t N, class Alloc>
+template <class InputIterator>
+void small_vector<T, N, Alloc>::insert(iterator position, InputIterator first,
+                                       InputIterator last) {
+  insert_aux(position, first, last,
+             typename std::is_integral<InputIterator>::type());
+}
+
+template <class T, size_t N, class Alloc>
+template <class InputIterator>
+void small_vector<T, N, Alloc>::insert_aux(iterator position,
+                                           InputIterator first,
+                                           InputIterator last,
+                                           std::false_type) {
+  const size_type offset = position - start;
+  const size_type n = size_type(last - first);
+  if (size_type(end_of_storage - finish) < n) grow(n);
+
+  iterator old_finish = finish;
+  finish = sup::uninitialized_copy(first, last, finish);
+  rotate_into(start + offset, old_finish);
+}
+
+template <class T, size_t N, class Alloc>
+template <class Integer>
+void small_vector<T, N, Alloc>::insert_aux(iterator position, Integer n,
+                                           const_reference value,
+                                           std::true_type) {
+  if (n == 0) return;
+
+  const size_type offset = position - start;
+  // value might refer to an element
+  T value_copy = value;
+  if (size_type(end_of_storage - finish) < size_type(n)) grow(n);
+
+  iterator old_finish = finish;
+  finish = sup::uninitialized_fill_n(finish, size_type(n), value_copy);
+  rotate_into(start + offset, old_finish);
+}
+
+/**
+ * @brief swap this with x. Heap blocks are exchanged; inline elements are
+ *  swapped or relocated. The allocators follow the heap blocks.
+ *
+ * @tparam T - element type parameter
+ * @tparam N - number of inline elements
+ * @tparam Alloc - allocator type
+ * @param x - the small_vector to be swapped
+ */
+template <class T, size_t N, class Alloc>
+void small_vector<T, N, Alloc>::swap(small_vector& x) {
+  if (this == &x) return;
+
+  if (!is_inline() && !x.is_inline()) {
+    std::swap(start, x.start);
+    std::swap(finish, x.finish);
+    std::swap(end_of_storage, x.end_of_storage);
+  } else if (is_inline() && x.is_inline()) {
+    swap_inline(*this, x);
+  } else {
+    small_vector& heap = is_inline() ? x : *this;
+    small_vector& small = is_inline() ? *this : x;
+    iterator heap_start = heap.start;
+    iterator heap_finish = heap.finish;
+    iterator heap_end_of_storage = heap.end_of_storage;
+
+    heap.reset_to_inline();
+    heap.finish =
+        sup::uninitialized_relocate(small.start, small.finish, heap.start);
+    small.start = heap_start;
+    small.finish = heap_finish;
+    small.end_of_storage = heap_end_of_storage;
+  }
+
+  _alloc_swap<data_allocator>::_swap(*this, x);
+}
+
+/************** Private (helper) methods **************/
+
+template <class T, size_t N, class Alloc>
+void small_vector<T, N, Alloc>::relocate_to(allocation_result<T*> block) {
+  iterator new_finish;
+  try {
+    new_finish = sup::uninitialized_relocate(start, finish, block.ptr);
+  } catch (...) {  // the elements were copied: the old ones are intact
+    data_allocator::deallocate(block.ptr, block.count);
+    throw;
+  }
+  deallocate();
+
+  start = block.ptr;
+  finish = new_finish;
+  end_of_storage = block.ptr + block.count;
+}
+
+template <class T, size_t N, class Alloc>
+void small_vector<T, N, Alloc>::grow(size_type n) {
+  const size_type old_capacity = capacity();
+  const size_type new_size = size() + n;
+  relocate_to(data_allocator::allocate_at_least(
+      2 * old_capacity >= new_size ? 2 * old_capacity : new_size));
+}
+
+template <class T, size_t N, class Alloc>
+void small_vector<T, N, Alloc>::swap_inline(small_vector& a, small_vector& b) {
+  small_vector& longer = a.size() >= b.size() ? a : b;
+  small_vector& shorter = a.size() >= b.size() ? b : a;
+  const size_type common = shorter.size();
+
+  std::swap_ranges(shorter.start, shorter.finish, longer.start);
+  shorter.finish = sup::uninitialized_relocate(
+      longer.start + common, longer.finish, shorter.finish);
+  longer.finish = longer.start + common;
+}
+
+}  // namespace sup
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef _SSTL_TYPE_TRAITS_H
 #define _SSTL_TYPE_TRAITS_H
 
+#include <type_traits>  // integral_constant
+
 /**
  * @author Xiaoxi Sun
  **/
@@ -8,6 +10,14 @@
 /**
  * Concepts:
  *  Can use this header directly
+ *
+ *  trivially relocatable - moving an object to a new address and destroying
+ *   the old one has the same effect as copying its bytes (memcpy / memmove).
+ *   Trivially copyable types always are; most types that only own heap
+ *   memory (a handle struct, sup::vector) are as well, but a type holding a
+ *   pointer into itself is not. The trait is opt-in: declare
+ *     typedef sup::__true_type is_trivially_relocatable;
+ *   in the class, or specialize __type_traits for it.
  **/
 
 /**
@@ -20,6 +30,36 @@ namespace sup {
 class __true_type {};
 class __false_type{};
 
+template <class>
+struct __sstl_void { typedef void type; };
+
+// the member typedef is_trivially_relocatable of type, or __false_type
+template <class type, class = void>
+struct __relocatable_member {
+  typedef __false_type is_trivially_relocatable;
+};
+template <class type>
+struct __relocatable_member<
+    type, typename __sstl_void<typename type::is_trivially_relocatable>::type> {
+  typedef typename type::is_trivially_relocatable is_trivially_relocatable;
+};
+
+// Whether a hash function, key equality or comparator is transparent: it
+// defines the member typedef is_transparent (std::less<>, ...), and so
+// takes any type of key comparable with the key type. The lookups of the
+// containers then accept such keys without converting them.
+template <class type, class = void>
+struct __is_transparent : std::false_type {};
+template <class type>
+struct __is_transparent<
+    type, typename __sstl_void<typename type::is_transparent>::type>
+    : std::true_type {};
+
+// SFINAE: enables the heterogeneous lookups of a container
+template <class type>
+using __enable_if_transparent =
+    typename std::enable_if<__is_transparent<type>::value>::type;
+
 template <class type>
 class __type_traits {
  public:
@@ -31,6 +71,8 @@ class __type_traits {
   typedef __false_type has_trivial_assignment_operator;
   typedef __false_type has_trivial_destructor;
   typedef __false_type is_POD_type;
+  typedef typename __relocatable_member<type>::is_trivially_relocatable
+      is_trivially_relocatable;
 };
 
 // template specialization for buildin types (scalars)
@@ -45,6 +87,7 @@ class __type_traits<char> {
   typedef __true_type has_trivial_assignment_operator;
   typedef __true_type has_trivial_destructor;
   typedef __true_type is_POD_type;
+  typedef __true_type is_trivially_relocatable;
 };
 
 template <>
@@ -58,6 +101,7 @@ class __type_traits<signed char> {
   typedef __true_type has_trivial_assignment_operator;
   typedef __true_type has_trivial_destructor;
   typedef __true_type is_POD_type;
+  typedef __true_type is_trivially_relocatable;
 };
 
 template <>
@@ -71,6 +115,7 @@ class __type_traits<unsigned char> {
   typedef __true_type has_trivial_assignment_operator;
   typedef __true_type has_trivial_destructor;
   typedef __true_type is_POD_type;
+  typedef __true_type is_trivially_relocatable;
 };
 
 template <>
@@ -83,6 +128,7 @@ class __type_traits<short> {
   typedef __true_type has_trivial_assignment_operator;
   typedef __true_type has_trivial_destructor;
   typedef __true_type is_POD_type;
+  typedef __true_type is_trivially_relocatable;
 };
 
 template <>
@@ -95,6 +141,7 @@ class __type_traits<unsigned short> {
   typedef __true_type has_trivial_assignment_operator;
   typedef __true_type has_trivial_destructor;
   typedef __true_type is_POD_type;
+  typedef __true_type is_trivially_relocatable;
 };
 
 template <>
@@ -107,6 +154,7 @@ class __type_traits<int> {
   typedef __true_type has_trivial_assignment_operator;
   typedef __true_type has_trivial_destructor;
   typedef __true_type is_POD_type;
+  typedef __true_type is_trivially_relocatable;
 };
 
 template <>
@@ -119,6 +167,7 @@ class __type_traits<unsigned int> {
   typedef __true_type has_trivial_assignment_operator;
   typedef __true_type has_trivial_destructor;
   typedef __true_type is_POD_type;
+  typedef __true_type is_trivially_relocatable;
 };
 
 template <>
@@ -132,6 +181,7 @@ class __type_traits<long> {
   typedef __true_type has_trivial_assignment_operator;
   typedef __true_type has_trivial_destructor;
   typedef __true_type is_POD_type;
+  typedef __true_type is_trivially_relocatable;
 };
 
 template <>
@@ -144,6 +194,7 @@ class __type_traits<unsigned long> {
   typedef __true_type has_trivial_assignment_operator;
   typedef __true_type has_trivial_destructor;
   typedef __true_type is_POD_type;
+  typedef __true_type is_trivially_relocatable;
 };
 
 template <>
@@ -156,6 +207,7 @@ class __type_traits<float> {
   typedef __true_type has_trivial_assignment_operator;
   typedef __true_type has_trivial_destructor;
   typedef __true_type is_POD_type;
+  typedef __true_type is_trivially_relocatable;
 };
 
 
@@ -169,6 +221,7 @@ class __type_traits<double> {
   typedef __true_type has_trivial_assignment_operator;
   typedef __true_type has_trivial_destructor;
   typedef __true_type is_POD_type;
+  typedef __true_type is_trivially_relocatable;
 };
 
 template <>
@@ -181,11 +234,13 @@ class __type_traits<long double> {
   typedef __true_type has_trivial_assignment_operator;
   typedef __true_type has_trivial_destructor;
   typedef __true_type is_POD_type;
+  typedef __true_type is_trivially_relocatable;
 };
 
 // native pointers 
 template <class T>
 class __type_traits<T*> {
+ public:
   typedef __true_type this_dummy_member_must_be_first;
 
   typedef __true_type has_trivial_default_constructor;
@@ -193,8 +248,33 @@ class __type_traits<T*> {
   typedef __true_type has_trivial_assignment_operator;
   typedef __true_type has_trivial_destructor;
   typedef __true_type is_POD_type;
+  typedef __true_type is_trivially_relocatable;
 };
 
+template <class type>
+struct __is_true_type {
+  static const bool value = false;
+};
+template <>
+struct __is_true_type<__true_type> {
+  static const bool value = true;
+};
+
+/**
+ * @brief whether objects of type can be relocated by memcpy / memmove
+ *
+ * @tparam type - the value type
+ */
+template <class type>
+struct __is_trivially_relocatable {
+  static const bool value =
+      (__is_trivially_copyable(type) && __has_trivial_destructor(type)) ||
+      __is_true_type<
+          typename __type_traits<type>::is_trivially_relocatable>::value;
+};
+template <class type>
+const bool __is_trivially_relocatable<type>::value;
+
 }  // namespace sup
 
 #endif
\ No newline at end of file
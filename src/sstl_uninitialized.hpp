@@ -3,6 +3,10 @@
 
 // after c++11 (inclusive) will have this header
 
+#include <cstring>      // memmove
+#include <type_traits>  // is_nothrow_move_constructible
+#include <utility>      // std::move
+
 #include "sstl_type_tratis.hpp"
 #include "sstl_construct.hpp"
 #include "sstl_iterator_base.hpp"
@@ -17,6 +21,18 @@
  *  Behaviors of "rollback or commit".
  *
  *  try-catch that would not be optimized: __try __catch
+ *
+ *  move_if_noexcept - relocating elements into a new buffer moves them only
+ *   when moving cannot throw. Otherwise they are copied, so an exception in
+ *   the middle leaves the old buffer intact.
+ *
+ *  relocation - move an object to a new place and destroy the old one.
+ *   Trivially relocatable objects (see __type_traits) are relocated as a
+ *   whole by a single memmove, and relocating them cannot throw.
+ *
+ *  default & value initialization - `new T` leaves a trivial T
+ *   uninitialized while `new T()` zeroes it. uninitialized_default_construct
+ *   writes nothing for trivial types, for buffers about to be overwritten.
  **/
 
 /**
@@ -39,6 +55,9 @@
  *  __throw_exception_again ????
  *
  *  why (void) ++curr ????
+ *
+ *  uninitialized_relocate() only takes pointers: memmove needs contiguous
+ *  memory.
  **/
 
 namespace sup {
@@ -107,6 +126,149 @@ inline ForwardIterator uninitialized_copy(InputIterator first,
       __is_trivial(_value_type2))>::_uninit_copy(first, last, result);
 }
 
+/******** Initialize Based on Range by Moving ********/
+
+template <bool TrivialValueTypes>
+struct __uninitialized_move {
+  template <class InputIterator, class ForwardIterator>
+  static ForwardIterator _uninit_move(InputIterator first, InputIterator last,
+                                      ForwardIterator result) {
+    ForwardIterator curr = result;
+    __try {
+      for (; first != last; ++first, ++result) {
+        sup::_construct(std::__addressof(*result), std::move(*first));
+      }
+      return result;
+    }
+    __catch(...) {
+      sup::_destroy(curr, result);
+      __throw_exception_again;
+    }
+  }
+};
+// moving a trivial value is copying it
+template <>
+struct __uninitialized_move<true> {
+  template <class InputIterator, class ForwardIterator>
+  static ForwardIterator _uninit_move(InputIterator first, InputIterator last,
+                                      ForwardIterator result) {
+    return std::copy(first, last, result);
+  }
+};
+
+/**
+ * Initialize (construct) elements starting from result by moving the
+ * elements in [first, last). The source elements are left moved-from.
+ *
+ * @tparam InputIterator - source iterator
+ * @tparam ForwardIterator - destination iterator
+ * @param first - starting position of the source
+ * @param last - end position
+ * @param result - the starting place to be initialized
+ *
+ * @return the iterator after the last initialized element
+ **/
+template <class InputIterator, class ForwardIterator>
+inline ForwardIterator uninitialized_move(InputIterator first,
+                                          InputIterator last,
+                                          ForwardIterator result) {
+  typedef
+      typename sup::iterator_traits<ForwardIterator>::value_type _value_type;
+
+  return sup::__uninitialized_move<__is_trivial(_value_type)>::_uninit_move(
+      first, last, result);
+}
+
+// move (true) or copy (false) during relocation
+template <bool MoveValues>
+struct __uninitialized_move_if_noexcept {
+  template <class InputIterator, class ForwardIterator>
+  static ForwardIterator _uninit_move(InputIterator first, InputIterator last,
+                                      ForwardIterator result) {
+    return sup::uninitialized_move(first, last, result);
+  }
+};
+template <>
+struct __uninitialized_move_if_noexcept<false> {
+  template <class InputIterator, class ForwardIterator>
+  static ForwardIterator _uninit_move(InputIterator first, InputIterator last,
+                                      ForwardIterator result) {
+    return sup::uninitialized_copy(first, last, result);
+  }
+};
+
+/**
+ * Move the elements of [first, last) to result when the move constructor
+ * cannot throw (or there is no copy constructor), otherwise copy them. A
+ * throwing copy then leaves the source untouched (strong guarantee of
+ * reallocation, as std::move_if_noexcept).
+ *
+ * @tparam InputIterator - source iterator
+ * @tparam ForwardIterator - destination iterator
+ * @param first - starting position of the source
+ * @param last - end position
+ * @param result - the starting place to be initialized
+ *
+ * @return the iterator after the last initialized element
+ **/
+template <class InputIterator, class ForwardIterator>
+inline ForwardIterator uninitialized_move_if_noexcept(InputIterator first,
+                                                      InputIterator last,
+                                                      ForwardIterator result) {
+  typedef
+      typename sup::iterator_traits<ForwardIterator>::value_type _value_type;
+
+  return sup::__uninitialized_move_if_noexcept<
+      std::is_nothrow_move_constructible<_value_type>::value ||
+      !std::is_copy_constructible<_value_type>::value>::_uninit_move(
+          first, last, result);
+}
+
+/******** Relocate Based on Range ********/
+
+// move (or copy) each element, then destroy the source
+template <bool TriviallyRelocatable>
+struct __uninitialized_relocate {
+  template <class T>
+  static T* _uninit_relocate(T* first, T* last, T* result) {
+    T* new_last = sup::uninitialized_move_if_noexcept(first, last, result);
+    sup::_destroy(first, last);
+    return new_last;
+  }
+};
+// copy the bytes; the source is not destroyed
+template <>
+struct __uninitialized_relocate<true> {
+  template <class T>
+  static T* _uninit_relocate(T* first, T* last, T* result) {
+    if (first != last) {
+      memmove((void*) result, (const void*) first, (last - first) * sizeof(T));
+    }
+    return result + (last - first);
+  }
+};
+
+/**
+ * Relocate the elements of [first, last) to the uninitialized memory
+ * starting from result: afterwards [first, last) holds no object. Trivially
+ * relocatable elements are moved by one memmove, so the ranges may overlap;
+ * the others are moved (or copied) and destroyed one by one, so the ranges
+ * must not overlap.
+ *
+ * @tparam T - value type
+ * @param first - starting position of the source
+ * @param last - end position
+ * @param result - the starting place to be initialized
+ *
+ * @return the pointer after the last relocated element
+ **/
+template <class T>
+inline T* uninitialized_relocate(T* first, T* last, T* result) {
+  return sup::__uninitialized_relocate<
+      sup::__is_trivially_relocatable<T>::value>::_uninit_relocate(first, last,
+                                                                   result);
+}
+
 /******** Initialize Based on Range and a Value ********/
 
 // non-trivial value type
@@ -218,6 +380,128 @@ inline ForwardIterator uninitialized_fill_n(ForwardIterator first, Size n,
       _value_type)>::__uninit_fill_n(first, n, value);
 }
 
+
+/******** Initialize Based on Number of Elements without a Value ********/
+
+// non-trivial value type: construct each element, then roll back on throw
+template <bool TrivialValueType>
+struct __uninitialized_construct_n {
+  template <class ForwardIterator, class Size>
+  static ForwardIterator __uninit_default_n(ForwardIterator first, Size n) {
+    ForwardIterator curr = first;
+    __try {
+      for (; n > 0; --n, ++curr) {
+        sup::_construct_novalue(std::__addressof(*curr));
+      }
+      return curr;
+    }
+    __catch(...) {
+      sup::_destroy(first, curr);
+      __throw_exception_again;
+    }
+  }
+
+  template <class ForwardIterator, class Size>
+  static ForwardIterator __uninit_value_n(ForwardIterator first, Size n) {
+    ForwardIterator curr = first;
+    __try {
+      for (; n > 0; --n, ++curr) {
+        sup::_construct(std::__addressof(*curr));
+      }
+      return curr;
+    }
+    __catch(...) {
+      sup::_destroy(first, curr);
+      __throw_exception_again;
+    }
+  }
+};
+// trivial value type: default initialization does nothing and value
+// initialization is zeroing (a memset for the compiler)
+template <>
+struct __uninitialized_construct_n<true> {
+  template <class ForwardIterator, class Size>
+  static ForwardIterator __uninit_default_n(ForwardIterator first, Size n) {
+    sup::advance(first, n);
+    return first;
+  }
+
+  template <class ForwardIterator, class Size>
+  static ForwardIterator __uninit_value_n(ForwardIterator first, Size n) {
+    typedef typename sup::iterator_traits<ForwardIterator>::value_type
+        _value_type;
+    return std::fill_n(first, n, _value_type());
+  }
+};
+
+/**
+ * Default initialize n elements starting from first (as `new T`). Trivial
+ * elements are left uninitialized, so nothing is written to the memory.
+ *
+ * @tparam ForwardIterator - iterator type
+ * @tparam Size - size type
+ * @param first - starting position of initialization
+ * @param n - number of elements
+ *
+ * @return the iterator after the last initialized element
+ **/
+template <class ForwardIterator, class Size>
+inline ForwardIterator uninitialized_default_construct_n(ForwardIterator first,
+                                                         Size n) {
+  typedef
+      typename sup::iterator_traits<ForwardIterator>::value_type _value_type;
+
+  return sup::__uninitialized_construct_n<__is_trivial(
+      _value_type)>::__uninit_default_n(first, n);
+}
+
+/**
+ * Default initialize the elements of [first, last).
+ *
+ * @tparam ForwardIterator - iterator type
+ * @param first - start position
+ * @param last - end position
+ **/
+template <class ForwardIterator>
+inline void uninitialized_default_construct(ForwardIterator first,
+                                            ForwardIterator last) {
+  sup::uninitialized_default_construct_n(first, sup::distance(first, last));
+}
+
+/**
+ * Value initialize n elements starting from first (as `new T()`). Trivial
+ * elements are zeroed.
+ *
+ * @tparam ForwardIterator - iterator type
+ * @tparam Size - size type
+ * @param first - starting position of initialization
+ * @param n - number of elements
+ *
+ * @return the iterator after the last initialized element
+ **/
+template <class ForwardIterator, class Size>
+inline ForwardIterator uninitialized_value_construct_n(ForwardIterator first,
+                                                       Size n) {
+  typedef
+      typename sup::iterator_traits<ForwardIterator>::value_type _value_type;
+
+  return sup::__uninitialized_construct_n<__is_trivial(
+      _value_type)>::__uninit_value_n(first, n);
+}
+
+/**
+ * Value initialize the elements of [first, last).
+ *
+ * @tparam ForwardIterator - iterator type
+ * @param first - start position
+ * @param last - end position
+ **/
+template <class ForwardIterator>
+inline void uninitialized_value_construct(ForwardIterator first,
+                                          ForwardIterator last) {
+  sup::uninitialized_value_construct_n(first, sup::distance(first, last));
+}
+
 }  // namespace sup
 
 #endif
\ No newline at end of file
@@ -0,0 +1,141 @@
+#ifndef _SSTL_UNORDERED_FLAT_MAP_H
+#define _SSTL_UNORDERED_FLAT_MAP_H
+
+#include <functional>
+
+#include "sstl_flat_hashtable.hpp"
+
+namespace sup {
+
+// unordered_map on an open-addressing table (see sstl_flat_hashtable.hpp):
+// insertions may move the elements
+template <class Key, class Value, class HashFunc=std::hash<Key>, 
+          class EqualKey=std::equal_to<Key>, class Alloc=alloc>
+class unordered_flat_map {
+private:
+  // underlying data structure: flat hash table
+  typedef sup::flat_hashtable<Key, std::pair<Key, Value>, HashFunc, 
+    std::_Select1st<std::pair<Key, Value>>, EqualKey, Alloc> container_type;
+  container_type ht; 
+
+public: 
+  typedef typename container_type::key_type key_type;
+  typedef typename container_type::value_type value_type;
+  typedef typename container_type::hasher hasher;
+  typedef typename container_type::key_equal key_equal;
+  typedef typename container_type::size_type size_type;
+  typedef typename container_type::difference_type difference_type;
+  typedef typename container_type::allocator_type allocator_type;
+
+  // allowed to modify Value
+  typedef typename container_type::pointer pointer;
+  typedef typename container_type::const_pointer const_pointer;
+  typedef typename container_type::reference reference;
+  typedef typename container_type::const_reference const_reference;
+  typedef typename container_type::iterator iterator;
+  typedef typename container_type::const_iterator const_iterator;
+
+  /*************** de-constructors ***************/
+  // no slots are allocated until the first insertion
+  unordered_flat_map(): ht(0, hasher(), key_equal()) {}
+  explicit unordered_flat_map(size_type n): ht(n, hasher(), key_equal()) {}
+  unordered_flat_map(size_type n, const hasher& hf): ht(n, hf, key_equal()) {}
+  unordered_flat_map(size_type n, const hasher& hf, const key_equal& eq)
+    : ht(n, hf, eq) {}
+  unordered_flat_map(size_type n, const hasher& hf, const key_equal& eq,
+    const allocator_type& a)
+    : ht(n, hf, eq, a) {}
+
+  template <class InputIterator>
+  unordered_flat_map(InputIterator first, InputIterator last)
+    : ht(0, hasher(), key_equal()) {
+    ht.insert_unique(first, last);
+  }
+
+  template <class InputIterator>
+  unordered_flat_map(InputIterator first, InputIterator last, size_type n)
+    : ht(n, hasher(), key_equal()) {
+    ht.insert_unique(first, last);
+  }
+
+  template <class InputIterator>
+  unordered_flat_map(InputIterator first, InputIterator last, 
+    size_type n, const hasher& hf) 
+    : ht(n, hf, key_equal()) {
+    ht.insert_unique(first, last);
+  }
+
+  template <class InputIterator>
+  unordered_flat_map(InputIterator first, InputIterator last, 
+    size_type n, const hasher& hf, const key_equal& eq) 
+    : ht(n, hf, eq) {
+    ht.insert_unique(first, last);
+  }
+
+  /*************** Accessors ***************/
+  // size
+  size_type size() const { return ht.size(); }
+  size_type max_size() const { return ht.max_size(); }
+  bool empty() const { return ht.empty(); }
+  size_type count(const key_type& key) const { return ht.count(key); }
+  bool contains(const key_type& key) const { return ht.count(key) != 0; }
+
+  // iterators
+  iterator begin() { return ht.begin(); }
+  iterator end() { return ht.end(); }
+  const_iterator begin() const { return ht.begin(); }
+  const_iterator end() const { return ht.end(); }
+  iterator find(const key_type& key) { return ht.find(key); }
+  const_iterator find(const key_type& key) const { return ht.find(key); } 
+
+  std::pair<iterator, iterator> equal_range(const key_type& key) 
+    { return ht.equal_range(key); }
+  std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const
+    { return ht.equal_range(key); }
+
+  // the value of key; a value initialized one is inserted if key is absent
+  Value& operator[](const key_type& key) {
+    return ht.emplace_unique_key(key, key, Value()).first->second;
+  }
+
+  // load factor
+  float load_factor() const { return ht.load_factor(); }
+  float max_load_factor() const { return ht.max_load_factor(); }
+  void max_load_factor(float max_factor) { ht.max_load_factor(max_factor); }
+  size_type bucket_count() const { return ht.bucket_count(); }
+
+  hasher hash_function () const { return ht.hash_function(); }
+  key_equal key_eq () const { return ht.key_eq(); }
+  allocator_type get_allocator() const { return ht.get_allocator(); }
+
+  /*************** Modifiers ***************/
+  // insert
+  std::pair<iterator, bool> insert(const value_type& val) {
+    return ht.insert_unique(val);
+  }
+  std::pair<iterator, bool> insert(value_type&& val) {
+    return ht.insert_unique(std::move(val));
+  }
+
+  template <class InputIterator>
+  void insert(InputIterator first, InputIterator last) {
+    ht.insert_unique(first, last);
+  }
+  
+  // erase
+  size_type erase(const key_type& key) { return ht.erase(key); }
+  void erase(const_iterator it) { ht.erase(it); }
+  void erase(const_iterator first, const_iterator last) { ht.erase(first, last); }
+  void clear() { ht.clear(); }
+  void swap(unordered_flat_map& m) { ht.swap(m.ht); }
+
+  // hashtable space
+  void rehash(size_type n) { ht.rehash(n); }
+  void reserve(size_type n) { ht.reserve(n); }
+  void shrink_to_fit() { ht.shrink_to_fit(); }
+  size_type memory_usage() const { return ht.memory_usage(); }
+};
+
+}
+
+#endif
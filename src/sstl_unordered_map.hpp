@@ -23,6 +23,7 @@ public:
   typedef typename container_type::key_equal key_equal;
   typedef typename container_type::size_type size_type;
   typedef typename container_type::difference_type difference_type;
+  typedef typename container_type::allocator_type allocator_type;
 
   // allowed to modify Value
   typedef typename container_type::pointer pointer;
@@ -40,6 +41,9 @@ public:
   unordered_map(size_type n, const hasher& hf): ht(n, hf, key_equal()) {}
   unordered_map(size_type n, const hasher& hf, const key_equal& eq)
     : ht(n, hf, eq) {}
+  unordered_map(size_type n, const hasher& hf, const key_equal& eq,
+    const allocator_type& a)
+    : ht(n, hf, eq, a) {}
   
   template <class InputIterator>
   unordered_map(InputIterator first, InputIterator last)
@@ -85,15 +89,37 @@ public:
   std::pair<iterator, iterator> equal_range(const key_type& key) 
     { return ht.equal_range(key); }
 
+  // heterogeneous lookup (transparent hasher & key_equal only)
+  template <class K, class H = HashFunc, class E = EqualKey,
+            class = __enable_if_transparent<H>, class = __enable_if_transparent<E>>
+  size_type count(const K& key) { return ht.count(key); }
+  template <class K, class H = HashFunc, class E = EqualKey,
+            class = __enable_if_transparent<H>, class = __enable_if_transparent<E>>
+  iterator find(const K& key) { return ht.find(key); }
+  template <class K, class H = HashFunc, class E = EqualKey,
+            class = __enable_if_transparent<H>, class = __enable_if_transparent<E>>
+  const_iterator find(const K& key) const { return ht.find(key); }
+  template <class K, class H = HashFunc, class E = EqualKey,
+            class = __enable_if_transparent<H>, class = __enable_if_transparent<E>>
+  std::pair<iterator, iterator> equal_range(const K& key)
+    { return ht.equal_range(key); }
+
   // load factor
   float load_factor() const { return ht.load_factor(); }
   float max_load_factor() const { return ht.max_load_factor(); }
   void max_load_factor(float max_factor) { ht.max_load_factor(max_factor); }
+  size_type bucket_count() const { return ht.bucket_count(); }
 
   hasher hash_function () const { return ht.hash_function(); }
   key_equal key_eq () const { return ht.key_eq(); }
+  allocator_type get_allocator() const { return ht.get_allocator(); }
 
   /*************** Modifiers ***************/
+  // the value of key, default constructed and inserted if there is none
+  Value& operator[](const key_type& key) {
+    return ht.find_or_insert(value_type(key, Value())).second;
+  }
+
   // insert
   std::pair<iterator, bool> insert(const value_type& val) {
     std::pair<typename container_type::iterator, bool> result = ht.insert_unique(val);
@@ -104,9 +130,22 @@ public:
   void insert(InputIterator first, InputIterator last) {
     ht.insert_unique(first, last);
   }
+  // insert a large range in bulk: up to threads threads hash the elements,
+  // which are then linked in order of blocks of 1024 buckets
+  template <class InputIterator>
+  void bulk_insert(InputIterator first, InputIterator last,
+                   unsigned threads = 1) {
+    ht.bulk_insert_unique(first, last, threads);
+  }
   
   // erase
-  size_type erase(const value_type& val) { ht.erase(val); }
+  size_type erase(const key_type& key) { return ht.erase(key); }
+  template <class K, class H = HashFunc, class E = EqualKey,
+            class = __enable_if_transparent<H>, class = __enable_if_transparent<E>,
+            class = typename std::enable_if<
+                !std::is_convertible<K, iterator>::value &&
+                !std::is_convertible<K, const_iterator>::value>::type>
+  size_type erase(const K& key) { return ht.erase(key); }
   void erase(iterator it) { ht.erase(it); }
   void erase(iterator first, iterator last) { ht.erase(first, last); }
   void clear() { ht.clear(); }
@@ -114,6 +153,16 @@ public:
   // hashtable space
   void rehash(size_type n) { ht.rehash(n); }
   void reserve(size_type n) { ht.reserve(n); }
+  // growing moves the elements a few at a time, at each insertion
+  bool incremental_rehash() const { return ht.incremental_rehash(); }
+  void incremental_rehash(bool on) { ht.incremental_rehash(on); }
+
+  // spare nodes
+  size_type max_spare_nodes() const { return ht.max_spare_nodes(); }
+  void max_spare_nodes(size_type n) { ht.max_spare_nodes(n); }
+  void reserve_nodes(size_type n) { ht.reserve_nodes(n); }
+  void shrink_to_fit() { ht.shrink_to_fit(); }
+  size_type memory_usage() const { return ht.memory_usage(); }
 };
 
 }
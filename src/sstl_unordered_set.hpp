@@ -22,6 +22,7 @@ public:
   typedef typename container_type::key_equal key_equal;
   typedef typename container_type::size_type size_type;
   typedef typename container_type::difference_type difference_type;
+  typedef typename container_type::allocator_type allocator_type;
 
   // not allowed to modify key
   typedef typename container_type::const_pointer pointer;
@@ -37,6 +38,9 @@ public:
   unordered_set(size_type n, const hasher& hf): ht(n, hf, key_equal()) {}
   unordered_set(size_type n, const hasher& hf, const key_equal& eq)
     : ht(n, hf, eq) {}
+  unordered_set(size_type n, const hasher& hf, const key_equal& eq,
+    const allocator_type& a)
+    : ht(n, hf, eq, a) {}
   
   template <class InputIterator>
   unordered_set(InputIterator first, InputIterator last)
@@ -82,13 +86,30 @@ public:
   std::pair<iterator, iterator> equal_range(const key_type& key) 
     { return ht.equal_range(key); }
 
+  // heterogeneous lookup (transparent hasher & key_equal only)
+  template <class K, class H = HashFunc, class E = EqualKey,
+            class = __enable_if_transparent<H>, class = __enable_if_transparent<E>>
+  size_type count(const K& key) { return ht.count(key); }
+  template <class K, class H = HashFunc, class E = EqualKey,
+            class = __enable_if_transparent<H>, class = __enable_if_transparent<E>>
+  iterator find(const K& key) { return ht.find(key); }
+  template <class K, class H = HashFunc, class E = EqualKey,
+            class = __enable_if_transparent<H>, class = __enable_if_transparent<E>>
+  const_iterator find(const K& key) const { return ht.find(key); }
+  template <class K, class H = HashFunc, class E = EqualKey,
+            class = __enable_if_transparent<H>, class = __enable_if_transparent<E>>
+  std::pair<iterator, iterator> equal_range(const K& key)
+    { return ht.equal_range(key); }
+
   // load factor
   float load_factor() const { return ht.load_factor(); }
   float max_load_factor() const { return ht.max_load_factor(); }
   void max_load_factor(float max_factor) { ht.max_load_factor(max_factor); }
+  size_type bucket_count() const { return ht.bucket_count(); }
 
   hasher hash_function () const { return ht.hash_function(); }
   key_equal key_eq () const { return ht.key_eq(); }
+  allocator_type get_allocator() const { return ht.get_allocator(); }
 
   /*************** Modifiers ***************/
   // insert
@@ -101,8 +122,21 @@ public:
   void insert(InputIterator first, InputIterator last) {
     ht.insert_unique(first, last);
   }
+  // insert a large range in bulk: up to threads threads hash the elements,
+  // which are then linked in order of blocks of 1024 buckets
+  template <class InputIterator>
+  void bulk_insert(InputIterator first, InputIterator last,
+                   unsigned threads = 1) {
+    ht.bulk_insert_unique(first, last, threads);
+  }
   // erase
-  size_type erase(const value_type& val) { ht.erase(val); }
+  size_type erase(const value_type& val) { return ht.erase(val); }
+  template <class K, class H = HashFunc, class E = EqualKey,
+            class = __enable_if_transparent<H>, class = __enable_if_transparent<E>,
+            class = typename std::enable_if<
+                !std::is_convertible<K, iterator>::value &&
+                !std::is_convertible<K, const_iterator>::value>::type>
+  size_type erase(const K& key) { return ht.erase(key); }
   void erase(iterator it) { ht.erase(it); }
   void erase(iterator first, iterator last) { ht.erase(first, last); }
   void clear() { ht.clear(); }
@@ -110,6 +144,16 @@ public:
   // hashtable space
   void rehash(size_type n) { ht.rehash(n); }
   void reserve(size_type n) { ht.reserve(n); }
+  // growing moves the elements a few at a time, at each insertion
+  bool incremental_rehash() const { return ht.incremental_rehash(); }
+  void incremental_rehash(bool on) { ht.incremental_rehash(on); }
+
+  // spare nodes
+  size_type max_spare_nodes() const { return ht.max_spare_nodes(); }
+  void max_spare_nodes(size_type n) { ht.max_spare_nodes(n); }
+  void reserve_nodes(size_type n) { ht.reserve_nodes(n); }
+  void shrink_to_fit() { ht.shrink_to_fit(); }
+  size_type memory_usage() const { return ht.memory_usage(); }
 };
 
 }
@@ -1,7 +1,9 @@
 #ifndef _SSTL_VECTOR_H
 #define _SSTL_VECTOR_H
 
+#include "./algorithms/sstl_remove.hpp"
 #include "sstl_allocator.hpp"
+#include "sstl_growth_policy.hpp"
 #include "sstl_iterator.hpp"
 #include "sstl_uninitialized.hpp"
 
@@ -14,6 +16,26 @@
  *  - vector
  *  - range [first, last)
  *  - separation of construct & allocation
+ *  - move semantics: a moved vector hands over its buffer; growth moves the
+ *    elements into the new buffer when their move constructor is noexcept
+ *    (uninitialized_move_if_noexcept), and copies them otherwise
+ *  - emplace: the element is constructed in place from the arguments
+ *  - relocation: trivially relocatable elements (see __type_traits) are
+ *    moved by memmove when the buffer grows and when insert & erase shift
+ *    them, instead of being moved and destroyed one by one
+ *  - growth (push_back & insert) keeps all the objects the allocator block
+ *    can hold as capacity (allocate_at_least); reserve, assign and the
+ *    constructors keep the exact capacity asked for
+ *  - shrink_to_fit gives back the unused capacity; memory_usage tells how
+ *    many bytes the buffer takes
+ *  - default initialization: resize_for_overwrite & append_uninitialized
+ *    only move finish for trivial elements, the caller writes them after
+ *  - erase_if & erase(vector, value) compact the vector in one pass; on
+ *    trivially copyable elements remove_if does not branch
+ *  - vector<bool> is a specialization packing the bits into words
+ *    (sstl_bit_vector.hpp)
+ *  - the Growth policy (sstl_growth_policy.hpp) decides how much growth asks
+ *    for: doubling by default, growth_factor_1_5 or growth_size_class
  **/
 
 /**
@@ -25,14 +47,22 @@
  *  - std::copy_backward used
  *  - std::is_integral<> used
  *  - std::fill used
- *  - const overload not implemented
+ *  - const overload not implemented (except begin & end)
  *  - std::__is_integer, std::__true_type, and std::__false_type used
  **/
 
 namespace sup {
 
-template <class T, class Alloc=alloc>
-class vector {
+/**
+ * @brief the dynamic array
+ *
+ * @tparam T - element type
+ * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy (sstl_growth_policy.hpp), deciding the
+ *  capacity when the vector grows
+ */
+template <class T, class Alloc=alloc, class Growth=growth_factor_2>
+class vector : protected simple_alloc<T, Alloc> {
   /******** Public types and methods ********/
  public:
   typedef T value_type;
@@ -51,52 +81,78 @@ class vector {
 
   typedef sup::simple_alloc<T, Alloc> allocator_type;
 
+  // the buffer does not point back to the vector, so a vector<vector<T>>
+  // relocates its elements by memmove
+  typedef __true_type is_trivially_relocatable;
+
   /******** Constructors ********/
   vector();
+  explicit vector(const allocator_type& a);
   explicit vector(size_type n);
+  vector(size_type n, const_reference value, const allocator_type& a);
   template<class InputIterator1, class InputIterator2>
   vector(InputIterator1 first, InputIterator2 last);
-  vector(vector& x);
+  template<class InputIterator1, class InputIterator2>
+  vector(InputIterator1 first, InputIterator2 last, const allocator_type& a);
+  vector(const vector& x);
+  vector(vector&& x) noexcept;
   // Destructors
   ~vector();
 
+  vector& operator=(const vector& x);
+  vector& operator=(vector&& x) noexcept;
+
   /******** Sizes ********/
   size_type size() const;
   size_type capacity() const;
+  // bytes allocated by the vector
+  size_type memory_usage() const { return capacity() * sizeof(T); }
   bool empty() const;
   void resize(size_type new_size, const_reference value);
   void resize(size_type new_size);
+  void resize_for_overwrite(size_type new_size);
+  iterator append_uninitialized(size_type n);
 
   /******** Iterators ********/
   iterator begin();
   iterator end();
+  const_iterator begin() const { return start; }
+  const_iterator end() const { return finish; }
   reverse_iterator rbegin();
   reverse_iterator rend();
 
   /******** Element access ********/
   reference operator[](size_type n);
+  const_reference operator[](size_type n) const;
   reference front();
   const_reference front() const;
   reference back();
 
   void push_back(const_reference value);
+  void push_back(value_type&& value);
+  template <class... Args>
+  void emplace_back(Args&&... args);
   void pop_back();
 
   iterator erase(iterator position);
   iterator erase(iterator first, iterator last);
 
   void reserve(size_type n);
+  void shrink_to_fit();
   void clear();
 
   template<class InputIterator1, class InputIterator2>
   void assign(InputIterator1 first, InputIterator2 last);
 
   iterator insert(iterator position, const_reference value);
+  iterator insert(iterator position, value_type&& value);
+  template <class... Args>
+  iterator emplace(iterator position, Args&&... args);
   void insert(iterator position, size_type n, const_reference value);
   template <class InputIterator>
   void insert(iterator position, InputIterator first, InputIterator last);
 
-  void swap(vector<T>& x);
+  void swap(vector& x);
 
   allocator_type get_allocator() const;
 
@@ -106,8 +162,9 @@ class vector {
   iterator finish;
   iterator end_of_storage;
 
-  // helper function when inserting into a full vector
-  void insert_aux(iterator position, const_reference value);
+  // helper function when constructing one element at position
+  template <class... Args>
+  void emplace_aux(iterator position, Args&&... args);
   template <class InputIterator>
   void insert_aux(iterator position, InputIterator first, InputIterator last,
                   std::false_type);
@@ -115,6 +172,8 @@ class vector {
   void insert_aux(iterator position, Integer n, const_reference value,
                   std::true_type);
   void deallocate();
+  // make room for n more elements at the end, growing by Growth
+  void reserve_for_append(size_type n);
 
   template<class InputIterator1, class InputIterator2>
   void assign_aux(InputIterator1 first, InputIterator2 last, std::__false_type);
@@ -123,30 +182,85 @@ class vector {
 
   iterator allocate_and_fill(size_type n, const T& value);
 
+  // trivially relocatable elements can be moved by their bytes: the buffer
+  // is resized by data_allocator::reallocate (realloc & mremap for large
+  // buffers) instead of allocate, move & deallocate, and insert & erase
+  // shift the elements after position by one memmove
+  static constexpr bool relocatable() {
+    return __is_trivially_relocatable<T>::value;
+  }
+  // move the elements to a buffer of n objects. The buffer is resized by
+  // data_allocator::reallocate only for relocatable elements, so that
+  // byte copies are never instantiated for the others.
+  void reallocate_storage(size_type n) {
+    reallocate_storage(n, std::integral_constant<bool, relocatable()>());
+  }
+  void reallocate_storage(size_type n, std::true_type);
+  void reallocate_storage(size_type n, std::false_type);
+
   void fill_initialize(size_type n, const T& value);
 };
 
 /************** Constructors & Destructor **************/
 
 /**
- * @brief Construct a new vector<T, Alloc>::vector object
+ * @brief Construct a new vector<T, Alloc, Growth>::vector object
+ *
+ * @tparam T - element type  parameter
+ * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
+ */
+template <class T, class Alloc, class Growth>
+vector<T, Alloc, Growth>::vector() : start(0), finish(0), end_of_storage(0) {}
+
+/**
+ * @brief Construct a new empty vector object allocating from a
+ *
+ * @tparam T - element type  parameter
+ * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
+ * @param a - the allocator instance used by this vector
+ */
+template <class T, class Alloc, class Growth>
+vector<T, Alloc, Growth>::vector(const allocator_type& a)
+    : data_allocator(a), start(0), finish(0), end_of_storage(0) {}
+
+/**
+ * @brief Construct a new vector<T, Alloc, Growth>::vector object
  *
  * @tparam T - element type  parameter
  * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
+ * @param n - number of elements
  */
-template <class T, class Alloc>
-vector<T, Alloc>::vector() : start(0), finish(0), end_of_storage(0) {}
+template <class T, class Alloc, class Growth>
+vector<T, Alloc, Growth>::vector(size_type n) {
+  start = data_allocator::allocate(n);
+  try {
+    sup::uninitialized_value_construct_n(start, n);
+  } catch (...) {
+    data_allocator::deallocate(start, n);
+    throw;
+  }
+  finish = start + n;
+  end_of_storage = finish;
+}
 
 /**
- * @brief Construct a new vector<T, Alloc>::vector object
+ * @brief Construct a new vector object with n copies of value
  *
  * @tparam T - element type  parameter
  * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
  * @param n - number of elements
+ * @param value - the value to be filled
+ * @param a - the allocator instance used by this vector
  */
-template <class T, class Alloc>
-vector<T, Alloc>::vector(size_type n) {
-  fill_initialize(n, T());
+template <class T, class Alloc, class Growth>
+vector<T, Alloc, Growth>::vector(size_type n, const_reference value,
+                         const allocator_type& a)
+    : data_allocator(a) {
+  fill_initialize(n, value);
 }
 
 /**
@@ -155,14 +269,15 @@ vector<T, Alloc>::vector(size_type n) {
  * 
  * @tparam T 
  * @tparam Alloc 
+ * @tparam Growth 
  * @tparam InputIterator1 
  * @tparam InputIterator2 
  * @param first 
  * @param last 
  */
-template <class T, class Alloc>
+template <class T, class Alloc, class Growth>
 template<class InputIterator1, class InputIterator2>
-vector<T, Alloc>::vector(InputIterator1 first, InputIterator2 last) {
+vector<T, Alloc, Growth>::vector(InputIterator1 first, InputIterator2 last) {
   start = nullptr;
   finish = nullptr;
   end_of_storage = nullptr;
@@ -171,31 +286,127 @@ vector<T, Alloc>::vector(InputIterator1 first, InputIterator2 last) {
 }
 
 /**
- * @brief Construct a new vector<T, Alloc>::vector object
+ * @brief Same as above, but allocating from a
+ *
+ * @tparam T
+ * @tparam Alloc
+ * @tparam Growth
+ * @tparam InputIterator1
+ * @tparam InputIterator2
+ * @param first
+ * @param last
+ * @param a - the allocator instance used by this vector
+ */
+template <class T, class Alloc, class Growth>
+template<class InputIterator1, class InputIterator2>
+vector<T, Alloc, Growth>::vector(InputIterator1 first, InputIterator2 last,
+                         const allocator_type& a)
+    : data_allocator(a), start(nullptr), finish(nullptr),
+      end_of_storage(nullptr) {
+  assign(first, last);
+}
+
+/**
+ * @brief Construct a new vector<T, Alloc, Growth>::vector object
  *
  * @tparam T - element type  parameter
  * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
  * @param x - another vector
  */
-template <class T, class Alloc>
-vector<T, Alloc>::vector(vector& x) {
+template <class T, class Alloc, class Growth>
+vector<T, Alloc, Growth>::vector(const vector& x) : data_allocator(x.get_allocator()) {
   start = data_allocator::allocate(x.size());
   end_of_storage = start + x.size();
-  finish = uninitialized_copy(x.begin(), x.end(), start);
+  finish = sup::uninitialized_copy(x.start, x.finish, start);
+}
+
+/**
+ * @brief Construct a new vector object taking the buffer of x, which is
+ *  left empty
+ *
+ * @tparam T - element type  parameter
+ * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
+ * @param x - another vector
+ */
+template <class T, class Alloc, class Growth>
+vector<T, Alloc, Growth>::vector(vector&& x) noexcept
+    : data_allocator(x.get_allocator()), start(x.start), finish(x.finish),
+      end_of_storage(x.end_of_storage) {
+  x.start = nullptr;
+  x.finish = nullptr;
+  x.end_of_storage = nullptr;
 }
 
 /**
- * @brief Destroy the vector<T, Alloc>::vector object
+ * @brief Destroy the vector<T, Alloc, Growth>::vector object
  *
  * @tparam T - element type parameter
  * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
  */
-template <class T, class Alloc>
-vector<T, Alloc>::~vector() {
+template <class T, class Alloc, class Growth>
+vector<T, Alloc, Growth>::~vector() {
   sup::_destroy(start, finish);
   deallocate();
 }
 
+/**
+ * @brief copy the elements of x. The buffer is reused if it is large enough;
+ *  the allocator is kept.
+ *
+ * @tparam T - element type parameter
+ * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
+ * @param x - another vector
+ * @return vector<T, Alloc, Growth>& - reference to *this
+ */
+template <class T, class Alloc, class Growth>
+vector<T, Alloc, Growth>& vector<T, Alloc, Growth>::operator=(const vector& x) {
+  if (this == &x) return *this;
+
+  const size_type n = x.size();
+  if (n > capacity()) {
+    iterator new_start = data_allocator::allocate(n);
+    try {
+      sup::uninitialized_copy(x.start, x.finish, new_start);
+    } catch (...) {
+      data_allocator::deallocate(new_start, n);
+      throw;
+    }
+    sup::_destroy(start, finish);
+    deallocate();
+    start = new_start;
+    end_of_storage = new_start + n;
+  } else if (n <= size()) {
+    iterator new_finish = std::copy(x.start, x.finish, start);
+    sup::_destroy(new_finish, finish);
+  } else {
+    std::copy(x.start, x.start + size(), start);
+    sup::uninitialized_copy(x.start + size(), x.finish, finish);
+  }
+  finish = start + n;
+  return *this;
+}
+
+/**
+ * @brief take the buffer (and the allocator) of x; the old elements of this
+ *  are destroyed
+ *
+ * @tparam T - element type parameter
+ * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
+ * @param x - another vector, left empty
+ * @return vector<T, Alloc, Growth>& - reference to *this
+ */
+template <class T, class Alloc, class Growth>
+vector<T, Alloc, Growth>& vector<T, Alloc, Growth>::operator=(vector&& x) noexcept {
+  vector tmp(std::move(x));
+  swap(tmp);
+  return *this;
+}
+
 /**************   Iterators   **************/
 
 /**
@@ -203,10 +414,11 @@ vector<T, Alloc>::~vector() {
  *
  * @tparam T - element type  parameter
  * @tparam Alloc - allocator type
- * @return vector<T, Alloc>::iterator - iterator at the start
+ * @tparam Growth - growth policy
+ * @return vector<T, Alloc, Growth>::iterator - iterator at the start
  */
-template <class T, class Alloc>
-typename vector<T, Alloc>::iterator vector<T, Alloc>::begin() {
+template <class T, class Alloc, class Growth>
+typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::begin() {
   return start;
 }
 
@@ -215,10 +427,11 @@ typename vector<T, Alloc>::iterator vector<T, Alloc>::begin() {
  *
  * @tparam T - element type  parameter
  * @tparam Alloc - allocator type
- * @return vector<T, Alloc>::iterator - iterator at the end
+ * @tparam Growth - growth policy
+ * @return vector<T, Alloc, Growth>::iterator - iterator at the end
  */
-template <class T, class Alloc>
-typename vector<T, Alloc>::iterator vector<T, Alloc>::end() {
+template <class T, class Alloc, class Growth>
+typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::end() {
   return finish;
 }
 
@@ -227,10 +440,11 @@ typename vector<T, Alloc>::iterator vector<T, Alloc>::end() {
  *
  * @tparam T - element type  parameter
  * @tparam Alloc - allocator type
- * @return vector<T, Alloc>::iterator - iterator at the reverse start
+ * @tparam Growth - growth policy
+ * @return vector<T, Alloc, Growth>::iterator - iterator at the reverse start
  */
-template <class T, class Alloc>
-typename vector<T, Alloc>::reverse_iterator vector<T, Alloc>::rbegin() {
+template <class T, class Alloc, class Growth>
+typename vector<T, Alloc, Growth>::reverse_iterator vector<T, Alloc, Growth>::rbegin() {
   return sup::reverse_iterator<iterator>(finish);
 }
 
@@ -239,10 +453,11 @@ typename vector<T, Alloc>::reverse_iterator vector<T, Alloc>::rbegin() {
  *
  * @tparam T - element type  parameter
  * @tparam Alloc - allocator type
- * @return vector<T, Alloc>::iterator - iterator at the reverse end
+ * @tparam Growth - growth policy
+ * @return vector<T, Alloc, Growth>::iterator - iterator at the reverse end
  */
-template <class T, class Alloc>
-typename vector<T, Alloc>::reverse_iterator vector<T, Alloc>::rend() {
+template <class T, class Alloc, class Growth>
+typename vector<T, Alloc, Growth>::reverse_iterator vector<T, Alloc, Growth>::rend() {
   return sup::reverse_iterator<iterator>(start);
 }
 
@@ -253,10 +468,11 @@ typename vector<T, Alloc>::reverse_iterator vector<T, Alloc>::rend() {
  *
  * @tparam T - element type paramter
  * @tparam Alloc - allocator type
- * @return vector<T, Alloc>::size_type - size
+ * @tparam Growth - growth policy
+ * @return vector<T, Alloc, Growth>::size_type - size
  */
-template <class T, class Alloc>
-typename vector<T, Alloc>::size_type vector<T, Alloc>::size() const {
+template <class T, class Alloc, class Growth>
+typename vector<T, Alloc, Growth>::size_type vector<T, Alloc, Growth>::size() const {
   return size_type(finish - start);
 }
 
@@ -265,10 +481,11 @@ typename vector<T, Alloc>::size_type vector<T, Alloc>::size() const {
  *
  * @tparam T - element type  parameter
  * @tparam Alloc - alocator type
- * @return vector<T, Alloc>::size_type - capacity
+ * @tparam Growth - growth policy
+ * @return vector<T, Alloc, Growth>::size_type - capacity
  */
-template <class T, class Alloc>
-typename vector<T, Alloc>::size_type vector<T, Alloc>::capacity() const {
+template <class T, class Alloc, class Growth>
+typename vector<T, Alloc, Growth>::size_type vector<T, Alloc, Growth>::capacity() const {
   return size_type(end_of_storage - start);
 }
 
@@ -277,11 +494,12 @@ typename vector<T, Alloc>::size_type vector<T, Alloc>::capacity() const {
  *
  * @tparam T - element type  parameter
  * @tparam Alloc - alocator type
+ * @tparam Growth - growth policy
  * @return true - is empty
  * @return false - is not empty
  */
-template <class T, class Alloc>
-bool vector<T, Alloc>::empty() const {
+template <class T, class Alloc, class Growth>
+bool vector<T, Alloc, Growth>::empty() const {
   return start == finish;
 }
 
@@ -290,11 +508,12 @@ bool vector<T, Alloc>::empty() const {
  *
  * @tparam T - element type parameter
  * @tparam Alloc - alocator type
+ * @tparam Growth - growth policy
  * @param new_size - new size
  * @param value - values to be filled in if the size is larger
  */
-template <class T, class Alloc>
-void vector<T, Alloc>::resize(size_type new_size, const_reference value) {
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::resize(size_type new_size, const_reference value) {
   if (new_size < size())
     erase(start + new_size, finish);
   else
@@ -302,15 +521,62 @@ void vector<T, Alloc>::resize(size_type new_size, const_reference value) {
 }
 
 /**
- * @brief resize with 0 filled in
+ * @brief resize with value initialized elements (0 for trivial types)
+ *  filled in. They are constructed in place, without a temporary T().
+ *
+ * @tparam T - element type parameter
+ * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
+ * @param new_size - new size
+ */
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::resize(size_type new_size) {
+  if (new_size < size()) {
+    erase(start + new_size, finish);
+  } else {
+    const size_type n = new_size - size();
+    reserve_for_append(n);
+    finish = sup::uninitialized_value_construct_n(finish, n);
+  }
+}
+
+/**
+ * @brief resize with default initialized elements filled in: trivial
+ *  elements are left uninitialized, so a buffer that is overwritten right
+ *  after (by read(), a decoder...) is not zeroed first. Others are default
+ *  constructed.
  *
  * @tparam T - element type parameter
  * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
  * @param new_size - new size
  */
-template <class T, class Alloc>
-void vector<T, Alloc>::resize(size_type new_size) {
-  resize(new_size, T());
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::resize_for_overwrite(size_type new_size) {
+  if (new_size < size()) {
+    erase(start + new_size, finish);
+  } else {
+    append_uninitialized(new_size - size());
+  }
+}
+
+/**
+ * @brief append n default initialized elements (see resize_for_overwrite)
+ *
+ * @tparam T - element type parameter
+ * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
+ * @param n - number of elements
+ * @return vector<T, Alloc, Growth>::iterator - the first appended element,
+ *  the place to write them
+ */
+template <class T, class Alloc, class Growth>
+typename vector<T, Alloc, Growth>::iterator
+vector<T, Alloc, Growth>::append_uninitialized(size_type n) {
+  reserve_for_append(n);
+  iterator first = finish;
+  finish = sup::uninitialized_default_construct_n(finish, n);
+  return first;
 }
 
 /************** Element Access **************/
@@ -320,11 +586,18 @@ void vector<T, Alloc>::resize(size_type new_size) {
  *
  * @tparam T - element type parameter
  * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
  * @param n - index
- * @return vector<T, Alloc>::reference - the element reference at n + start
+ * @return vector<T, Alloc, Growth>::reference - the element reference at n + start
  */
-template <class T, class Alloc>
-typename vector<T, Alloc>::reference vector<T, Alloc>::operator[](size_type n) {
+template <class T, class Alloc, class Growth>
+typename vector<T, Alloc, Growth>::reference vector<T, Alloc, Growth>::operator[](size_type n) {
+  return *(start + n);
+}
+
+template <class T, class Alloc, class Growth>
+typename vector<T, Alloc, Growth>::const_reference
+vector<T, Alloc, Growth>::operator[](size_type n) const {
   return *(start + n);
 }
 
@@ -333,10 +606,11 @@ typename vector<T, Alloc>::reference vector<T, Alloc>::operator[](size_type n) {
  *
  * @tparam T - element type parameter
  * @tparam Alloc - allocator type
- * @return vector<T, Alloc>::reference - the element reference at the front
+ * @tparam Growth - growth policy
+ * @return vector<T, Alloc, Growth>::reference - the element reference at the front
  */
-template <class T, class Alloc>
-typename vector<T, Alloc>::reference vector<T, Alloc>::front() {
+template <class T, class Alloc, class Growth>
+typename vector<T, Alloc, Growth>::reference vector<T, Alloc, Growth>::front() {
   return *start;
 }
 
@@ -345,10 +619,11 @@ typename vector<T, Alloc>::reference vector<T, Alloc>::front() {
  *
  * @tparam T - element type parameter
  * @tparam Alloc - allocator type
- * @return vector<T, Alloc>::reference - the element reference at the front
+ * @tparam Growth - growth policy
+ * @return vector<T, Alloc, Growth>::reference - the element reference at the front
  */
-template <class T, class Alloc>
-typename vector<T, Alloc>::const_reference vector<T, Alloc>::front() const {
+template <class T, class Alloc, class Growth>
+typename vector<T, Alloc, Growth>::const_reference vector<T, Alloc, Growth>::front() const {
   return *start;
 }
 
@@ -357,10 +632,11 @@ typename vector<T, Alloc>::const_reference vector<T, Alloc>::front() const {
  *
  * @tparam T - element type parameter
  * @tparam Alloc - allocator type
- * @return vector<T, Alloc>::reference - the element reference at the end
+ * @tparam Growth - growth policy
+ * @return vector<T, Alloc, Growth>::reference - the element reference at the end
  */
-template <class T, class Alloc>
-typename vector<T, Alloc>::reference vector<T, Alloc>::back() {
+template <class T, class Alloc, class Growth>
+typename vector<T, Alloc, Growth>::reference vector<T, Alloc, Growth>::back() {
   return *(finish - 1);
 }
 
@@ -371,15 +647,54 @@ typename vector<T, Alloc>::reference vector<T, Alloc>::back() {
  *
  * @tparam T - element type parameter
  * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
  * @param value - to be pushed
  */
-template <class T, class Alloc>
-void vector<T, Alloc>::push_back(const_reference value) {
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::push_back(const_reference value) {
   if (finish != end_of_storage) {
     _construct(finish, value);
     ++finish;
   } else {
-    insert_aux(finish, value);
+    emplace_aux(finish, value);
+  }
+}
+
+/**
+ * @brief move the parameter into the vector from the back.
+ *
+ * @tparam T - element type parameter
+ * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
+ * @param value - to be moved
+ */
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::push_back(value_type&& value) {
+  if (finish != end_of_storage) {
+    _construct(finish, std::move(value));
+    ++finish;
+  } else {
+    emplace_aux(finish, std::move(value));
+  }
+}
+
+/**
+ * @brief construct an element at the back from args
+ *
+ * @tparam T - element type parameter
+ * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
+ * @tparam Args - types of the arguments of a constructor of T
+ * @param args - the arguments
+ */
+template <class T, class Alloc, class Growth>
+template <class... Args>
+void vector<T, Alloc, Growth>::emplace_back(Args&&... args) {
+  if (finish != end_of_storage) {
+    _construct(finish, std::forward<Args>(args)...);
+    ++finish;
+  } else {
+    emplace_aux(finish, std::forward<Args>(args)...);
   }
 }
 
@@ -388,9 +703,10 @@ void vector<T, Alloc>::push_back(const_reference value) {
  *
  * @tparam T - element type parameter
  * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
  */
-template <class T, class Alloc>
-void vector<T, Alloc>::pop_back() {
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::pop_back() {
   --finish;
   sup::_destroy(finish);
 }
@@ -401,13 +717,21 @@ void vector<T, Alloc>::pop_back() {
  *
  * @tparam T - element type parameter
  * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
  * @param position - the position of the element to be erased
- * @return vector<T, Alloc>::iterator - iterator pointing to position
+ * @return vector<T, Alloc, Growth>::iterator - iterator pointing to position
  */
-template <class T, class Alloc>
-typename vector<T, Alloc>::iterator vector<T, Alloc>::erase(iterator position) {
+template <class T, class Alloc, class Growth>
+typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::erase(iterator position) {
+  if (relocatable()) {
+    sup::_destroy(position);
+    sup::uninitialized_relocate(position + 1, finish, position);
+    --finish;
+    return position;
+  }
+
   if (position + 1 != finish) {
-    std::copy(position + 1, finish, position);
+    std::move(position + 1, finish, position);
   }
   --finish;
   sup::_destroy(finish);
@@ -420,14 +744,21 @@ typename vector<T, Alloc>::iterator vector<T, Alloc>::erase(iterator position) {
  *
  * @tparam T - element type parameter
  * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
  * @param first - start the range (inclusive)
  * @param last - end of the range (exclusive)
- * @return vector<T, Alloc>::iterator - start iterator
+ * @return vector<T, Alloc, Growth>::iterator - start iterator
  */
-template <class T, class Alloc>
-typename vector<T, Alloc>::iterator vector<T, Alloc>::erase(iterator first,
+template <class T, class Alloc, class Growth>
+typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::erase(iterator first,
                                                             iterator last) {
-  iterator temp_end = std::copy(last, finish, first);
+  if (relocatable()) {
+    sup::_destroy(first, last);
+    finish = sup::uninitialized_relocate(last, finish, first);
+    return first;
+  }
+
+  iterator temp_end = std::move(last, finish, first);
   sup::_destroy(temp_end, finish);
   finish = temp_end;
   return first;
@@ -438,22 +769,72 @@ typename vector<T, Alloc>::iterator vector<T, Alloc>::erase(iterator first,
  * 
  * @tparam T - element type parameter
  * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
  * @param n - the capacity must be greater than this after reserve
  */
-template <class T, class Alloc>
-void vector<T, Alloc>::reserve(size_type n) {
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::reserve(size_type n) {
   if (capacity() < n) {
-    iterator new_start = data_allocator::allocate(n);
-    iterator new_end_of_storage = new_start + n;
-    iterator new_finish = sup::uninitialized_copy(begin(), end(), new_start);
+    reallocate_storage(n);
+    end_of_storage = start + n;
+  }
+}
+
+/**
+ * @brief give back the unused capacity. Trivially relocatable elements are
+ *  kept in place by data_allocator::reallocate; the others are moved to a
+ *  block of size() objects.
+ *
+ * @tparam T - element type parameter
+ * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
+ */
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::shrink_to_fit() {
+  const size_type n = size();
+  if (capacity() == n) return;
 
-    clear();
+  if (n == 0) {
     deallocate();
+    start = finish = end_of_storage = nullptr;
+  } else {
+    reallocate_storage(n);
+    end_of_storage = finish;
+  }
+}
 
-    start = new_start;
-    end_of_storage = new_end_of_storage;
-    finish = new_finish;
+/**
+ * @brief move the elements to a buffer of n (>= size()) objects. The caller
+ *  sets end_of_storage.
+ *
+ * @tparam T - element type parameter
+ * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
+ * @param n - the number of objects of the new buffer
+ */
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::reallocate_storage(size_type n,
+                                                  std::true_type) {
+  const size_type old_size = size();
+  start = data_allocator::reallocate(start, capacity(), n);
+  finish = start + old_size;
+}
+
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::reallocate_storage(size_type n,
+                                                  std::false_type) {
+  iterator new_start = data_allocator::allocate(n);
+  iterator new_finish = new_start;
+  try {
+    new_finish = sup::uninitialized_move_if_noexcept(start, finish, new_start);
+  } catch (...) {
+    data_allocator::deallocate(new_start, n);
+    throw;
   }
+  sup::_destroy(start, finish);
+  deallocate();
+  start = new_start;
+  finish = new_finish;
 }
 
 /**
@@ -461,16 +842,17 @@ void vector<T, Alloc>::reserve(size_type n) {
  *
  * @tparam T - element type parameter
  * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
  */
-template <class T, class Alloc>
-void vector<T, Alloc>::clear() {
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::clear() {
   erase(start, finish);
 }
 
 // assign vector to the current vector based on input types
-template <class T, class Alloc>
+template <class T, class Alloc, class Growth>
 template<class InputIterator1, class InputIterator2>
-void vector<T, Alloc>::assign(InputIterator1 first, InputIterator2 last) {
+void vector<T, Alloc, Growth>::assign(InputIterator1 first, InputIterator2 last) {
   typedef typename std::__is_integer<InputIterator1>::__type _Integral;
 
   assign_aux(first, last, _Integral());
@@ -481,19 +863,20 @@ void vector<T, Alloc>::assign(InputIterator1 first, InputIterator2 last) {
  * 
  * @tparam T - element type parameter
  * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
  * @tparam InputIterator - input iterator
  * @param first - start of input iterator
  * @param last - end of input iterator
  */
-template <class T, class Alloc>
+template <class T, class Alloc, class Growth>
 template <class InputIterator1, class InputIterator2>
-void vector<T, Alloc>::assign_aux(InputIterator1 first, InputIterator2 last, std::__false_type) {
-  if (!empty()) {
-    data_allocator::deallocate(start, this->size());
-  }
+void vector<T, Alloc, Growth>::assign_aux(InputIterator1 first, InputIterator2 last, std::__false_type) {
+  // the whole block must be returned: the pool allocator relies on the size
+  sup::_destroy(start, finish);
+  deallocate();
   size_type n = last - first;
   start = data_allocator::allocate(n);
-  finish = uninitialized_copy(first, last, start);
+  finish = sup::uninitialized_copy(first, last, start);
   end_of_storage = start + n;
 }
 
@@ -502,17 +885,17 @@ void vector<T, Alloc>::assign_aux(InputIterator1 first, InputIterator2 last, std
  * 
  * @tparam T - element type parameter
  * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
  * @param n - number of elements
  * @param val - value
  */
-template <class T, class Alloc>
+template <class T, class Alloc, class Growth>
 template<class Size>
-void vector<T, Alloc>::assign_aux(Size n, const T& value, std::__true_type) {
-  if (!empty()) {
-    data_allocator::deallocate(start, this->size());
-  }
+void vector<T, Alloc, Growth>::assign_aux(Size n, const T& value, std::__true_type) {
+  sup::_destroy(start, finish);
+  deallocate();
   start = data_allocator::allocate(n);
-  finish = uninitialized_fill_n(start, n, value);
+  finish = sup::uninitialized_fill_n(start, n, value);
   end_of_storage = start + n;
 }
 
@@ -522,15 +905,51 @@ void vector<T, Alloc>::assign_aux(Size n, const T& value, std::__true_type) {
  *
  * @tparam T - element type parameter
  * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
  * @param position - where value to be inserted
  * @param value - to be inserted
- * @return vector<T, Alloc>::iterator - position
+ * @return vector<T, Alloc, Growth>::iterator - position
  */
-template <class T, class Alloc>
-typename vector<T, Alloc>::iterator vector<T, Alloc>::insert(
+template <class T, class Alloc, class Growth>
+typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::insert(
     iterator position, const_reference value) {
-  insert(position, 1, value);
-  return position;
+  return emplace(position, value);
+}
+
+/**
+ * @brief move an element into position
+ *
+ * @tparam T - element type parameter
+ * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
+ * @param position - where value to be inserted
+ * @param value - to be moved
+ * @return vector<T, Alloc, Growth>::iterator - the inserted element
+ */
+template <class T, class Alloc, class Growth>
+typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::insert(
+    iterator position, value_type&& value) {
+  return emplace(position, std::move(value));
+}
+
+/**
+ * @brief construct an element at position from args
+ *
+ * @tparam T - element type parameter
+ * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
+ * @tparam Args - types of the arguments of a constructor of T
+ * @param position - where the element is constructed
+ * @param args - the arguments
+ * @return vector<T, Alloc, Growth>::iterator - the inserted element
+ */
+template <class T, class Alloc, class Growth>
+template <class... Args>
+typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::emplace(
+    iterator position, Args&&... args) {
+  const size_type offset = position - start;
+  emplace_aux(position, std::forward<Args>(args)...);
+  return start + offset;
 }
 
 /**
@@ -538,12 +957,13 @@ typename vector<T, Alloc>::iterator vector<T, Alloc>::insert(
  *
  * @tparam T - element type parameter
  * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
  * @param position - start position
  * @param n - number of elements
  * @param value - value to be inserted
  */
-template <class T, class Alloc>
-void vector<T, Alloc>::insert(iterator position, size_type n,
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::insert(iterator position, size_type n,
                               const_reference value) {
   insert_aux(position, n, value, typename std::is_integral<size_type>::type());
 }
@@ -553,14 +973,15 @@ void vector<T, Alloc>::insert(iterator position, size_type n,
  *
  * @tparam T - element type parameter
  * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
  * @tparam InputIterator - iterators to values to be copied
  * @param position - start point of insertion
  * @param first - start of the iterator
  * @param last - end of the iterator
  */
-template <class T, class Alloc>
+template <class T, class Alloc, class Growth>
 template <class InputIterator>
-void vector<T, Alloc>::insert(iterator position, InputIterator first,
+void vector<T, Alloc, Growth>::insert(iterator position, InputIterator first,
                               InputIterator last) {
   insert_aux(position, first, last,
              typename std::is_integral<InputIterator>::type());
@@ -571,10 +992,11 @@ void vector<T, Alloc>::insert(iterator position, InputIterator first,
  *
  * @tparam T - element type parameter
  * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
  * @param x - the vector to be swapped
  */
-template <class T, class Alloc>
-void vector<T, Alloc>::swap(vector<T>& x) {
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::swap(vector& x) {
   iterator temp_start = x.start;
   iterator temp_finish = x.finish;
   iterator temp_end_of_storage = x.end_of_storage;
@@ -586,65 +1008,139 @@ void vector<T, Alloc>::swap(vector<T>& x) {
   this->start = temp_start;
   this->finish = temp_finish;
   this->end_of_storage = temp_end_of_storage;
+
+  _alloc_swap<data_allocator>::_swap(*this, x);
 }
 /**
  * @brief return a allocator of the vector
  * 
  * @tparam T - element type parameter
  * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
  * @return allocator_type 
  */
-template <class T, class Alloc>
-typename vector<T, Alloc>::allocator_type vector<T, Alloc>::get_allocator() const {
-  return data_allocator();
+template <class T, class Alloc, class Growth>
+typename vector<T, Alloc, Growth>::allocator_type vector<T, Alloc, Growth>::get_allocator() const {
+  return *this;
 }
 
 /************** Private (helper) methods **************/
 
-template <class T, class Alloc>
-void vector<T, Alloc>::deallocate() {
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::deallocate() {
   if (start)
     data_allocator::deallocate(start, size_type(end_of_storage - start));
 }
 
-template <class T, class Alloc>
-typename vector<T, Alloc>::iterator vector<T, Alloc>::allocate_and_fill(
+template <class T, class Alloc, class Growth>
+typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::allocate_and_fill(
     size_type n, const T& value) {
   iterator result = data_allocator::allocate(n);
   sup::uninitialized_fill_n(result, n, value);
   return result;
 }
 
-template <class T, class Alloc>
-void vector<T, Alloc>::fill_initialize(size_type n, const T& value) {
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::fill_initialize(size_type n, const T& value) {
   start = data_allocator::allocate(n);
   sup::uninitialized_fill_n(start, n, value);
   finish = start + n;
   end_of_storage = finish;
 }
 
-template <class T, class Alloc>
-void vector<T, Alloc>::insert_aux(iterator position, const_reference& value) {
-  if (finish != end_of_storage) {  // enough capacity
-    // construct a value at the expended place with value value
-    sup::_construct(finish, *(finish - 1));  // this is for destroy
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::reserve_for_append(size_type n) {
+  if (size_type(end_of_storage - finish) >= n) return;
 
+  const size_type old_size = size();
+  const size_type new_size =
+      Growth::next_capacity(old_size, old_size + n, sizeof(T));
+  if (relocatable()) {
+    reallocate_storage(new_size);
+    end_of_storage = start + data_allocator::usable_size(start, new_size);
+  } else {
+    allocation_result<T*> block = data_allocator::allocate_at_least(new_size);
+    iterator new_finish = block.ptr;
+    try {
+      new_finish = sup::uninitialized_move_if_noexcept(start, finish, block.ptr);
+    } catch (...) {
+      data_allocator::deallocate(block.ptr, block.count);
+      throw;
+    }
+
+    sup::_destroy(start, finish);
+    deallocate();
+
+    start = block.ptr;
+    finish = new_finish;
+    end_of_storage = start + block.count;
+  }
+}
+
+template <class T, class Alloc, class Growth>
+template <class... Args>
+void vector<T, Alloc, Growth>::emplace_aux(iterator position, Args&&... args) {
+  if (finish != end_of_storage && position == finish) {  // at the end
+    sup::_construct(finish, std::forward<Args>(args)...);
+    ++finish;
+  } else if (finish != end_of_storage && relocatable()) {  // enough capacity
+    // args might refer to an element being shifted
+    T value_copy(std::forward<Args>(args)...);
+    sup::uninitialized_relocate(position, finish, position + 1);
+    try {
+      sup::_construct(position, std::move(value_copy));
+    } catch (...) {
+      sup::uninitialized_relocate(position + 1, finish + 1, position);
+      throw;
+    }
     ++finish;
-    std::copy_backward(position, finish - 2, finish - 1);
-    *position = value;
+  } else if (finish != end_of_storage) {  // enough capacity
+    // args might refer to an element being shifted
+    T value_copy(std::forward<Args>(args)...);
+    // construct a value at the expended place by moving the last one
+    sup::_construct(finish, std::move(*(finish - 1)));
+
+    ++finish;
+    std::move_backward(position, finish - 2, finish - 1);
+    *position = std::move(value_copy);
+  } else if (relocatable()) {  // not enough capacity
+    const size_type old_size = size();
+    const size_type new_size =
+        Growth::next_capacity(old_size, old_size + 1, sizeof(T));
+    const size_type offset = position - start;
+    // args might refer to the old buffer
+    T value_copy(std::forward<Args>(args)...);
+
+    reallocate_storage(new_size);
+    end_of_storage = start + data_allocator::usable_size(start, new_size);
+    position = start + offset;
+
+    // there is room now
+    emplace_aux(position, std::move(value_copy));
   } else {  // not enough capacity
     const size_type old_size = size();
-    const size_type new_size = (old_size == 0 ? 1 : 2 * old_size);
+    allocation_result<T*> block =
+      data_allocator::allocate_at_least(
+          Growth::next_capacity(old_size, old_size + 1, sizeof(T)));
+    const size_type new_size = block.count;
 
-    iterator new_start = data_allocator::allocate(new_size);
+    iterator new_start = block.ptr;
+    iterator new_position = new_start + (position - start);
     iterator new_finish = new_start;
+    bool constructed = false;
 
-    try {  // copy everything in the original vector
-      new_finish = sup::uninitialized_copy(start, position, new_start);
-      sup::_construct(new_finish, value);
-      new_finish = sup::uninitialized_copy(position, finish, new_finish + 1);
+    try {
+      // construct the new element first: args might refer to an element
+      // that is about to be moved
+      sup::_construct(new_position, std::forward<Args>(args)...);
+      constructed = true;
+      // move (or copy) everything in the original vector
+      new_finish = sup::uninitialized_move_if_noexcept(start, position, new_start);
+      new_finish = sup::uninitialized_move_if_noexcept(position, finish,
+                                                       new_position + 1);
     } catch (...) {  // roll back or commit
       sup::_destroy(new_start, new_finish);
+      if (constructed) sup::_destroy(new_position);
       data_allocator::deallocate(new_start, new_size);
       throw;
     }
@@ -658,23 +1154,34 @@ void vector<T, Alloc>::insert_aux(iterator position, const_reference& value) {
   }
 }
 
-template <class T, class Alloc>
+template <class T, class Alloc, class Growth>
 template <class InputIterator>
-void vector<T, Alloc>::insert_aux(iterator position, InputIterator first,
+void vector<T, Alloc, Growth>::insert_aux(iterator position, InputIterator first,
                                   InputIterator last, std::false_type) {
+  if (first == last) return;
+
   typename sup::iterator_traits<InputIterator>::difference_type n =
       last - first;
   size_type old_size = size();
   difference_type ele_after = finish - position;
 
-  if (n + old_size <= end_of_storage - start) {
+  if (size_type(n) + old_size <= capacity() && relocatable()) {
+    sup::uninitialized_relocate(position, finish, position + n);
+    try {
+      sup::uninitialized_copy(first, last, position);
+    } catch (...) {
+      sup::uninitialized_relocate(position + n, finish + n, position);
+      throw;
+    }
+    finish += n;
+  } else if (size_type(n) + old_size <= capacity()) {
     difference_type num_of_elem_after = finish - position;
 
     if (num_of_elem_after >= n) {
       // perhaps call (non-trivial) destructors for
       // num_of_elem_after times
-      sup::uninitialized_copy(finish - n, finish, finish);
-      std::copy_backward(position, finish - n, finish);
+      sup::uninitialized_move(finish - n, finish, finish);
+      std::move_backward(position, finish - n, finish);
       std::copy(first, last, position);
 
       finish += n;
@@ -683,7 +1190,7 @@ void vector<T, Alloc>::insert_aux(iterator position, InputIterator first,
       // times;
       // a better writing would be: finish + n - num_of_elem_after; but this
       // could cause overflow
-      sup::uninitialized_copy(position, finish, finish - num_of_elem_after + n);
+      sup::uninitialized_move(position, finish, finish - num_of_elem_after + n);
       std::copy(first, first + num_of_elem_after, position);
       sup::uninitialized_copy(first + num_of_elem_after, last,
                               position + num_of_elem_after);
@@ -691,18 +1198,33 @@ void vector<T, Alloc>::insert_aux(iterator position, InputIterator first,
       finish += n;
     }
   } else {
-    size_type new_capacity =
-        2 * old_size >= (old_size + n) ? 2 * old_size : (old_size + n);
-    iterator new_start = data_allocator::allocate(new_capacity);
+    allocation_result<T*> block = data_allocator::allocate_at_least(
+        Growth::next_capacity(old_size, old_size + n, sizeof(T)));
+    size_type new_capacity = block.count;
+    iterator new_start = block.ptr;
     iterator new_finish = new_start;
-    try {
-      new_finish = sup::uninitialized_copy(start, position, new_start);
-      new_finish = sup::uninitialized_copy(first, last, new_finish);
-      new_finish = sup::uninitialized_copy(position, finish, new_finish);
-    } catch (...) {
-      sup::_destroy(new_start, new_finish);
-      data_allocator::deallocate(new_start, new_capacity);
-      throw;
+    if (relocatable()) {
+      // copy the new elements first: relocating the old ones cannot throw
+      iterator new_position = new_start + (position - start);
+      try {
+        sup::uninitialized_copy(first, last, new_position);
+      } catch (...) {
+        data_allocator::deallocate(new_start, new_capacity);
+        throw;
+      }
+      sup::uninitialized_relocate(start, position, new_start);
+      new_finish = sup::uninitialized_relocate(position, finish, new_position + n);
+    } else {
+      try {
+        new_finish = sup::uninitialized_move_if_noexcept(start, position, new_start);
+        new_finish = sup::uninitialized_copy(first, last, new_finish);
+        new_finish = sup::uninitialized_move_if_noexcept(position, finish, new_finish);
+      } catch (...) {
+        sup::_destroy(new_start, new_finish);
+        data_allocator::deallocate(new_start, new_capacity);
+        throw;
+      }
+      sup::_destroy(start, finish);
     }
     this->deallocate();
 
@@ -712,50 +1234,77 @@ void vector<T, Alloc>::insert_aux(iterator position, InputIterator first,
   }
 }
 
-template <class T, class Alloc>
+template <class T, class Alloc, class Growth>
 template <class Integer>
-void vector<T, Alloc>::insert_aux(iterator position, Integer n,
+void vector<T, Alloc, Growth>::insert_aux(iterator position, Integer n,
                                   const_reference value, std::true_type) {
   if (n == 0) return;
 
-  if (end_of_storage - finish >= n) {  // enough capacity
+  if (size_type(end_of_storage - finish) >= size_type(n)) {  // enough capacity
     difference_type num_of_elem_after = finish - position;
-
-    if (num_of_elem_after >= n) {
+    // value might refer to an element being shifted
+    T value_copy = value;
+
+    if (relocatable()) {
+      sup::uninitialized_relocate(position, finish, position + n);
+      try {
+        sup::uninitialized_fill_n(position, n, value_copy);
+      } catch (...) {
+        sup::uninitialized_relocate(position + n, finish + n, position);
+        throw;
+      }
+      finish += n;
+    } else if (num_of_elem_after >= difference_type(n)) {
       // perhaps call (non-trivial) destructors for
       // num_of_elem_after times
-      sup::uninitialized_copy(finish - n, finish, finish);
-      std::copy_backward(position, finish - n, finish);
-      std::fill(position, position + n, value);
+      sup::uninitialized_move(finish - n, finish, finish);
+      std::move_backward(position, finish - n, finish);
+      std::fill(position, position + n, value_copy);
 
       finish += n;
     } else {
       // would call (non-trivial) destructors for num_of_elem_after
       // times
-      sup::uninitialized_copy(position, finish, finish - num_of_elem_after + n);
-      std::fill(position, position + num_of_elem_after, value);
-      sup::uninitialized_fill(finish, finish - num_of_elem_after + n, value);
+      sup::uninitialized_move(position, finish, finish - num_of_elem_after + n);
+      std::fill(position, position + num_of_elem_after, value_copy);
+      sup::uninitialized_fill(finish, finish - num_of_elem_after + n, value_copy);
 
       finish += n;
     }
   } else {  // not enough capacity
     size_type old_size = this->size();
 
-    size_type new_capacity =
-        2 * old_size >= (old_size + n) ? 2 * old_size : (old_size + n);
-    iterator new_start = data_allocator::allocate(new_capacity);
+    allocation_result<T*> block = data_allocator::allocate_at_least(
+        Growth::next_capacity(old_size, old_size + n, sizeof(T)));
+    size_type new_capacity = block.count;
+    iterator new_start = block.ptr;
+    iterator new_position = new_start + (position - start);
     iterator new_finish = new_start;
+    bool filled = false;
 
     try {
-      // use uninitialized_copy at the new space
-      new_finish = sup::uninitialized_copy(start, position, new_finish);
-      new_finish = sup::uninitialized_fill_n(new_finish, n, value);
-      new_finish = sup::uninitialized_copy(position, finish, new_finish);
+      // fill first: value might refer to an element that is about to be
+      // moved
+      sup::uninitialized_fill_n(new_position, n, value);
+      filled = true;
+      // move (or copy) the old elements to the new space
+      if (!relocatable()) {
+        new_finish = sup::uninitialized_move_if_noexcept(start, position, new_start);
+        new_finish = sup::uninitialized_move_if_noexcept(position, finish,
+                                                         new_position + n);
+      }
     } catch (...) {
       sup::_destroy(new_start, new_finish);
+      if (filled) sup::_destroy(new_position, new_position + n);
       data_allocator::deallocate(new_start, new_capacity);
       throw;
     }
+    if (relocatable()) {  // cannot throw
+      sup::uninitialized_relocate(start, position, new_start);
+      new_finish = sup::uninitialized_relocate(position, finish, new_position + n);
+    } else {
+      sup::_destroy(start, finish);
+    }
     this->deallocate();
 
     start = new_start;
@@ -764,5 +1313,53 @@ void vector<T, Alloc>::insert_aux(iterator position, Integer n,
   }
 }
 
+/************** Erasure **************/
+
+/**
+ * @brief erase the elements satisfying pred in one pass (compaction by
+ *  remove_if, then one erase of the tail)
+ *
+ * @tparam T - element type parameter
+ * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
+ * @tparam Predicate - predicate type
+ * @param c - the vector
+ * @param pred - true for the elements to erase
+ * @return vector<T, Alloc, Growth>::size_type - number of erased elements
+ */
+template <class T, class Alloc, class Growth, class Predicate>
+typename vector<T, Alloc, Growth>::size_type erase_if(
+    vector<T, Alloc, Growth>& c, Predicate pred) {
+  typename vector<T, Alloc, Growth>::iterator new_end =
+      sup::remove_if(c.begin(), c.end(), pred);
+  typename vector<T, Alloc, Growth>::size_type n = c.end() - new_end;
+  c.erase(new_end, c.end());
+  return n;
+}
+
+/**
+ * @brief erase the elements equal to value in one pass
+ *
+ * @tparam T - element type parameter
+ * @tparam Alloc - allocator type
+ * @tparam Growth - growth policy
+ * @param c - the vector
+ * @param value - the value to erase
+ * @return vector<T, Alloc, Growth>::size_type - number of erased elements
+ */
+template <class T, class Alloc, class Growth, class U>
+typename vector<T, Alloc, Growth>::size_type erase(
+    vector<T, Alloc, Growth>& c, const U& value) {
+  typename vector<T, Alloc, Growth>::iterator new_end =
+      sup::remove(c.begin(), c.end(), value);
+  typename vector<T, Alloc, Growth>::size_type n = c.end() - new_end;
+  c.erase(new_end, c.end());
+  return n;
+}
+
 }  // namespace sup
-#endif
\ No newline at end of file
+
+// the bit-packed vector<bool>
+#include "sstl_bit_vector.hpp"
+
+#endif
@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+#include <string>
+
+#include "../../src/algorithms/sstl_remove.hpp"
+#include "../../src/sstl_list.hpp"
+
+namespace algorithm_remove_test {
+
+bool is_odd(int x) { return x % 2 != 0; }
+
+TEST(remove_if_int_test, return_value_test) {
+  int array[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  // pointers to trivially copyable elements: branchless
+  int* new_end = sup::remove_if(array, array + 10, is_odd);
+  EXPECT_TRUE(new_end == array + 5);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_TRUE(array[i] == 2 * i);
+  }
+
+  // nothing or everything removed
+  EXPECT_TRUE(sup::remove_if(array, array + 5, is_odd) == array + 5);
+  EXPECT_TRUE(sup::remove(array, array + 1, 0) == array);
+  EXPECT_TRUE(sup::remove(array, array, 0) == array);
+
+  int same[6] = {3, 3, 1, 3, 2, 3};
+  EXPECT_TRUE(sup::remove(same, same + 6, 3) == same + 2);
+  EXPECT_TRUE(same[0] == 1 && same[1] == 2);
+}
+
+TEST(remove_if_string_test, return_value_test) {
+  std::string array[6] = {"a", "bb", "c", "dd", "ee", "f"};
+  std::string* new_end = sup::remove_if(
+      array, array + 6, [](const std::string& s) { return s.size() == 2; });
+  EXPECT_TRUE(new_end == array + 3);
+  EXPECT_TRUE(array[0] == "a" && array[1] == "c" && array[2] == "f");
+  EXPECT_TRUE(sup::remove(array, array + 3, "c") == array + 2);
+  EXPECT_TRUE(array[1] == "f");
+}
+
+TEST(remove_if_list_test, return_value_test) {
+  // not a pointer: elements are moved one by one
+  sup::list<int> l;
+  for (int i = 0; i < 10; ++i) {
+    l.push_back(i);
+  }
+  sup::list<int>::iterator new_end = sup::remove_if(l.begin(), l.end(), is_odd);
+  int expected = 0;
+  for (sup::list<int>::iterator it = l.begin(); it != new_end; ++it) {
+    EXPECT_TRUE(*it == expected);
+    expected += 2;
+  }
+  EXPECT_TRUE(expected == 10);
+}
+
+}  // namespace algorithm_remove_test
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <functional>
+
+#include "../../src/sstl_alloc_telemetry.hpp"
+#include "../../src/sstl_vector.hpp"
+#include "../../src/sstl_deque.hpp"
+#include "../../src/sstl_map.hpp"
+#include "../../src/sstl_unordered_map.hpp"
+
+namespace alloc_telemetry_test {
+
+struct vector_tag {};
+struct deque_tag {};
+struct map_tag {};
+struct hash_tag {};
+
+TEST(alloc_telemetry_test, size_class) {
+  EXPECT_TRUE(sup::alloc_stats::size_class(1) == 0);
+  EXPECT_TRUE(sup::alloc_stats::size_class(16) == 4);
+  EXPECT_TRUE(sup::alloc_stats::size_class(31) == 4);
+  EXPECT_TRUE(sup::alloc_stats::size_class(size_t(1) << 40) ==
+              sup::__SSTL_TELEMETRY_BUCKETS - 1);
+}
+
+TEST(alloc_telemetry_test, vector_growth) {
+  typedef sup::telemetry_alloc<sup::alloc, vector_tag> alloc_type;
+  sup::alloc_telemetry<vector_tag>::reset();
+  {
+    sup::vector<int, alloc_type> v;
+    for (int i = 0; i < 1000; ++i) {
+      v.push_back(i);
+    }
+    sup::alloc_stats_snapshot s = sup::alloc_telemetry<vector_tag>::snapshot();
+    // capacity doubles from 4 (the smallest block of the pool) to at least
+    // 1024: 9 buffers
+    EXPECT_TRUE(s.allocations == 9);
+    EXPECT_TRUE(s.deallocations == 8);
+    EXPECT_TRUE(s.live_bytes == v.capacity() * sizeof(int));
+    // int buffers are resized by reallocate: the old and the new buffers
+    // are never counted together
+    EXPECT_TRUE(s.peak_bytes == v.capacity() * sizeof(int));
+    EXPECT_TRUE(s.allocated_bytes < 2 * v.capacity() * sizeof(int));
+    EXPECT_TRUE(s.histogram[sup::alloc_stats::size_class(4096)] == 1);
+  }
+  sup::alloc_stats_snapshot s = sup::alloc_telemetry<vector_tag>::snapshot();
+  EXPECT_TRUE(s.live_bytes == 0);
+  EXPECT_TRUE(s.allocations == s.deallocations);
+}
+
+TEST(alloc_telemetry_test, tags_are_separate) {
+  sup::alloc_telemetry<deque_tag>::reset();
+  sup::alloc_telemetry<map_tag>::reset();
+  sup::alloc_telemetry<hash_tag>::reset();
+  {
+    sup::deque<int, sup::telemetry_alloc<sup::alloc, deque_tag>> d;
+    sup::map<int, int, std::less<int>,
+             sup::telemetry_alloc<sup::alloc, map_tag>> m;
+    sup::unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+                       sup::telemetry_alloc<sup::alloc, hash_tag>> um;
+    for (int i = 0; i < 500; ++i) {
+      d.push_back(i);
+      m.insert(std::pair<const int, int>(i, i));
+      um.insert(std::pair<int, int>(i, i));
+    }
+    sup::alloc_stats_snapshot sm = sup::alloc_telemetry<map_tag>::snapshot();
+    // one header and one node per element
+    EXPECT_TRUE(sm.allocations == 501);
+    EXPECT_TRUE(sup::alloc_telemetry<deque_tag>::snapshot().live_bytes > 0);
+    // nodes and buckets (with rehashes) of the hash table
+    EXPECT_TRUE(sup::alloc_telemetry<hash_tag>::snapshot().allocations > 500);
+
+    char buffer[4096];
+    FILE* out = fmemopen(buffer, sizeof(buffer), "w");
+    sup::alloc_telemetry<map_tag>::report("map", out);
+    std::fclose(out);
+    EXPECT_TRUE(std::string(buffer).find("map: 501 allocations") == 0);
+  }
+  EXPECT_TRUE(sup::alloc_telemetry<deque_tag>::snapshot().live_bytes == 0);
+  EXPECT_TRUE(sup::alloc_telemetry<map_tag>::snapshot().live_bytes == 0);
+  EXPECT_TRUE(sup::alloc_telemetry<hash_tag>::snapshot().live_bytes == 0);
+}
+
+TEST(alloc_telemetry_test, usable_size_is_a_query) {
+  typedef sup::telemetry_alloc<sup::alloc, vector_tag> alloc_type;
+  sup::alloc_telemetry<vector_tag>::reset();
+  alloc_type a;
+  void* p = a.allocate(1000);
+  size_t usable = a.usable_size(p, 1000);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(a.usable_size(p, 1000) == usable);
+  }
+  sup::alloc_stats_snapshot s = sup::alloc_telemetry<vector_tag>::snapshot();
+  EXPECT_TRUE(s.allocated_bytes == usable);
+  EXPECT_TRUE(s.live_bytes == usable);
+
+  // deallocated with the requested size, counted by the usable size
+  a.deallocate((char*) p, 1000);
+  EXPECT_TRUE(sup::alloc_telemetry<vector_tag>::snapshot().live_bytes == 0);
+}
+
+// a stateless allocator stays stateless
+TEST(alloc_telemetry_test, no_space_in_containers) {
+  EXPECT_TRUE(sizeof(sup::vector<int, sup::telemetry_alloc<>>) ==
+              sizeof(sup::vector<int>));
+}
+
+}  // namespace alloc_telemetry_test
@@ -1,6 +1,15 @@
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
 
 #include "../../src/sstl_allocator.hpp"
+#include "../../src/sstl_deque.hpp"
+#include "../../src/sstl_list.hpp"
+#include "../../src/sstl_map.hpp"
+#include "../../src/sstl_vector.hpp"
 
 // Need to implement: Tests for range construct & destruct
 
@@ -38,4 +47,249 @@ TEST(allocator_base_test, not_call_constructor) {
   EXPECT_TRUE(ClassForTest::destroy_times_ == 0);
 }
 
-}  // namespace allocator_base_test
\ No newline at end of file
+typedef sup::__simple_default_allocator_template<false, 1> pool_alloc;
+const int num_of_blocks = 1000;
+
+// test small blocks are aligned and can be written
+TEST(allocator_base_test, pool_small_blocks) {
+  char* blocks[num_of_blocks];
+  for (int i = 0; i < num_of_blocks; ++i) {
+    size_t n = i % 256 + 1;
+    blocks[i] = (char*) pool_alloc::allocate(n);
+    EXPECT_TRUE((uintptr_t) blocks[i] % sup::__SSTL_ALIGN == 0);
+    for (size_t j = 0; j < n; ++j) blocks[i][j] = (char) i;
+  }
+  for (int i = 0; i < num_of_blocks; ++i) {
+    size_t n = i % 256 + 1;
+    for (size_t j = 0; j < n; ++j) EXPECT_TRUE(blocks[i][j] == (char) i);
+  }
+  for (int i = 0; i < num_of_blocks; ++i) {
+    pool_alloc::deallocate(blocks[i], i % 256 + 1);
+  }
+}
+
+// test a freed block is reused by the next allocation of the same size class
+TEST(allocator_base_test, pool_reuse_freed_block) {
+  char* p = (char*) pool_alloc::allocate(24);
+  pool_alloc::deallocate(p, 24);
+  // 24 and 32 are in the same size class
+  char* q = (char*) pool_alloc::allocate(32);
+  EXPECT_TRUE(p == q);
+  pool_alloc::deallocate(q, 32);
+}
+
+// test large blocks go to the first level allocator
+TEST(allocator_base_test, pool_large_blocks) {
+  char* p = (char*) pool_alloc::allocate(4096);
+  EXPECT_TRUE(p != nullptr);
+  for (int i = 0; i < 4096; ++i) p[i] = 'a';
+  pool_alloc::deallocate(p, 4096);
+  EXPECT_TRUE(pool_alloc::allocate(0) == nullptr);
+}
+
+typedef sup::__simple_default_allocator_template<true, 1> thread_pool_alloc;
+
+// test blocks allocated by one thread can be freed by another thread
+TEST(allocator_base_test, thread_pool_cross_thread_free) {
+  std::vector<char*> blocks(num_of_blocks);
+  std::thread producer([&blocks]() {
+    for (int i = 0; i < num_of_blocks; ++i) {
+      blocks[i] = (char*) thread_pool_alloc::allocate(48);
+      blocks[i][0] = (char) i;
+    }
+  });
+  producer.join();
+
+  std::thread consumer([&blocks]() {
+    for (int i = 0; i < num_of_blocks; ++i) {
+      EXPECT_TRUE(blocks[i][0] == (char) i);
+      thread_pool_alloc::deallocate(blocks[i], 48);
+    }
+  });
+  consumer.join();
+
+  // the objects returned by the exited threads can be allocated again
+  char* p = (char*) thread_pool_alloc::allocate(48);
+  EXPECT_TRUE(p != nullptr);
+  thread_pool_alloc::deallocate(p, 48);
+}
+
+// test no block is handed out twice while several threads allocate
+TEST(allocator_base_test, thread_pool_concurrent) {
+  const int num_of_threads = 4;
+  std::vector<std::thread> workers;
+  for (int t = 0; t < num_of_threads; ++t) {
+    workers.push_back(std::thread([t]() {
+      std::vector<int*> blocks;
+      for (int round = 0; round < 10; ++round) {
+        for (int i = 0; i < num_of_blocks; ++i) {
+          int* p = (int*) thread_pool_alloc::allocate(sizeof(int) * (i % 8 + 1));
+          *p = t;
+          blocks.push_back(p);
+        }
+        for (size_t i = 0; i < blocks.size(); ++i) {
+          EXPECT_TRUE(*blocks[i] == t);
+          thread_pool_alloc::deallocate((char*) blocks[i], sizeof(int) * (i % 8 + 1));
+        }
+        blocks.clear();
+      }
+    }));
+  }
+  for (int t = 0; t < num_of_threads; ++t) workers[t].join();
+}
+
+typedef sup::__simple_default_allocator_template<true, 2> late_pool_alloc;
+
+// frees its block when the thread exits, after the thread cache is gone
+struct late_user {
+  char* block = nullptr;
+  ~late_user() {
+    late_pool_alloc::deallocate(block, 48);
+    char* p = (char*) late_pool_alloc::allocate(48);
+    late_pool_alloc::deallocate(p, 48);
+  }
+};
+
+// test blocks freed during thread exit go back to the central pool
+TEST(allocator_base_test, thread_pool_late_free) {
+  char* late_block = nullptr;
+  std::thread worker([&late_block]() {
+    // constructed before the thread cache, so destroyed after it
+    static thread_local late_user user;
+    user.block = (char*) late_pool_alloc::allocate(48);
+    late_block = user.block;
+  });
+  worker.join();
+
+  std::vector<char*> blocks;
+  for (int i = 0; i < 2 * sup::__SSTL_NOBJS; ++i)
+    blocks.push_back((char*) late_pool_alloc::allocate(48));
+  EXPECT_TRUE(std::find(blocks.begin(), blocks.end(), late_block) !=
+              blocks.end());
+  for (size_t i = 0; i < blocks.size(); ++i)
+    late_pool_alloc::deallocate(blocks[i], 48);
+}
+
+struct alignas(64) simd_block {
+  float lanes[16];
+  simd_block() {}
+  simd_block(float f) { lanes[0] = f; }
+};
+
+template <class T>
+bool aligned_to(const T* p, size_t alignment) {
+  return (uintptr_t) p % alignment == 0;
+}
+
+// blocks respect alignof(T), even above what the pool gives
+TEST(allocator_base_test, over_aligned_types) {
+  sup::simple_alloc<simd_block> a;
+  simd_block* blocks[num_of_blocks];
+  for (int i = 0; i < num_of_blocks; ++i) {
+    blocks[i] = a.allocate(i % 5 + 1);
+    EXPECT_TRUE(aligned_to(blocks[i], 64));
+  }
+  for (int i = 0; i < num_of_blocks; ++i) {
+    a.deallocate(blocks[i], i % 5 + 1);
+  }
+
+  sup::vector<simd_block> v;
+  sup::deque<simd_block> d;
+  sup::list<simd_block> l;
+  sup::map<int, simd_block> m;
+  for (int i = 0; i < 100; ++i) {
+    v.push_back(simd_block((float) i));
+    d.push_back(simd_block((float) i));
+    l.push_back(simd_block((float) i));
+    m.insert(std::pair<const int, simd_block>(i, simd_block((float) i)));
+    EXPECT_TRUE(aligned_to(&v[0], 64));
+    EXPECT_TRUE(aligned_to(&d.back(), 64));
+    EXPECT_TRUE(aligned_to(&l.back(), 64));
+    EXPECT_TRUE(aligned_to(&m.find(i)->second, 64));
+  }
+}
+
+// cache_aligned_alloc puts every block on a cache line boundary
+TEST(allocator_base_test, cache_aligned_blocks) {
+  typedef sup::cache_aligned_alloc<> cache_alloc;
+  sup::simple_alloc<char, cache_alloc> a;
+  EXPECT_TRUE(a.alignment() == __SSTL_CACHE_LINE_SIZE);
+  for (int n = 1; n < 1000; n += 37) {
+    char* p = a.allocate(n);
+    EXPECT_TRUE(aligned_to(p, __SSTL_CACHE_LINE_SIZE));
+    a.deallocate(p, n);
+  }
+
+  sup::vector<int, cache_alloc> v;
+  for (int i = 0; i < 1000; ++i) {
+    v.push_back(i);
+    EXPECT_TRUE(aligned_to(&v[0], __SSTL_CACHE_LINE_SIZE));
+  }
+  sup::deque<int, cache_alloc> d;
+  d.push_back(1);
+  EXPECT_TRUE(aligned_to(&d.front(), __SSTL_CACHE_LINE_SIZE));
+
+  // plain types keep the default alignment and cost nothing
+  EXPECT_TRUE(sup::simple_alloc<int>::alignment() == sup::__SSTL_ALIGN);
+}
+
+// blocks above __SSTL_MMAP_THRESHOLD are mapped and resized by mremap
+TEST(allocator_base_test, large_block_reallocate) {
+  size_t n = 4 << 20;
+  char* p = (char*) sup::malloc_alloc::allocate(n);
+  for (size_t i = 0; i < n; i += 4096) p[i] = (char) (i >> 12);
+  p = (char*) sup::malloc_alloc::reallocate(p, n, 4 * n);
+  bool same = true;
+  for (size_t i = 0; i < n; i += 4096) same = same && p[i] == (char) (i >> 12);
+  EXPECT_TRUE(same);
+  p[4 * n - 1] = 1;
+
+  // back to a malloc block
+  p = (char*) sup::malloc_alloc::reallocate(p, 4 * n, 1000);
+  EXPECT_TRUE(p[0] == 0 && p[999] == (char) 0);
+  sup::malloc_alloc::deallocate(p, 1000);
+
+  // small blocks of the pool
+  char* q = (char*) pool_alloc::allocate(20);
+  memset(q, 3, 20);
+  q = (char*) pool_alloc::reallocate(q, 20, 500);
+  EXPECT_TRUE(q[0] == 3 && q[19] == 3);
+  q = (char*) pool_alloc::reallocate(q, 500, 40);
+  EXPECT_TRUE(q[0] == 3 && q[19] == 3);
+  pool_alloc::deallocate(q, 40);
+}
+
+TEST(allocator_base_test, usable_size) {
+  // the size class of the pool
+  char* p = (char*) pool_alloc::allocate(20);
+  EXPECT_TRUE(pool_alloc::usable_size(p, 20) == 32);
+  pool_alloc::deallocate(p, 32);
+
+  // whole pages of a mapped block
+  size_t n = (4 << 20) + 1;
+  char* q = (char*) sup::malloc_alloc::allocate(n);
+  size_t usable = sup::malloc_alloc::usable_size(q, n);
+  EXPECT_TRUE(usable >= n && usable % 4096 == 0);
+  q[usable - 1] = 1;
+  sup::malloc_alloc::deallocate(q, usable);
+
+  // malloc blocks are at least as large as asked for
+  char* r = (char*) sup::malloc_alloc::allocate(1000);
+  usable = sup::malloc_alloc::usable_size(r, 1000);
+  EXPECT_TRUE(usable >= 1000 && usable < 2000);
+  memset(r, 1, usable);
+  sup::malloc_alloc::deallocate(r, usable);
+
+  sup::simple_alloc<int> a;
+  sup::allocation_result<int*> block = a.allocate_at_least(5);
+  EXPECT_TRUE(block.ptr != nullptr && block.count == 8);
+  a.deallocate(block.ptr, block.count);
+
+  // over-aligned blocks are exact
+  sup::simple_alloc<int, sup::cache_aligned_alloc<>> aligned;
+  block = aligned.allocate_at_least(5);
+  EXPECT_TRUE(block.count == 5);
+  aligned.deallocate(block.ptr, block.count);
+}
+
+}  // namespace allocator_base_test
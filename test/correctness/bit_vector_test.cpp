@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "../../src/sstl_vector.hpp"
+
+namespace bit_vector_test {
+
+TEST(bit_vector_test, push_back_and_access) {
+  sup::vector<bool> vec;
+  std::vector<bool> expected;
+  for (int i = 0; i < 1000; ++i) {
+    vec.push_back(i % 3 == 0);
+    expected.push_back(i % 3 == 0);
+  }
+  EXPECT_TRUE(vec.size() == 1000 && vec.capacity() >= 1000);
+  // one bit per element
+  EXPECT_TRUE(vec.memory_usage() < 1000 / 8 * 2);
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_TRUE(vec[i] == expected[i]);
+  }
+
+  vec[1] = true;
+  vec[0] = vec[2];
+  EXPECT_TRUE(vec[1] && !vec[0] && vec.front() == false);
+  vec[1].flip();
+  EXPECT_TRUE(!vec[1]);
+  vec.pop_back();
+  EXPECT_TRUE(vec.size() == 999 && vec.back() == false);
+
+  const sup::vector<bool>& cvec = vec;
+  int n = 0;
+  for (sup::vector<bool>::const_iterator it = cvec.begin(); it != cvec.end();
+       ++it) {
+    n += *it;
+  }
+  EXPECT_TRUE(n == 332 && cvec[3]);
+
+  // backwards through the const vector
+  sup::vector<bool>::const_reverse_iterator rit = cvec.rbegin();
+  EXPECT_TRUE(*rit == cvec[998] && *(cvec.rend() - 1) == cvec[0]);
+  int m = 0;
+  for (; rit != cvec.rend(); ++rit) m += *rit;
+  EXPECT_TRUE(m == n);
+}
+
+TEST(bit_vector_test, constructors) {
+  sup::vector<bool> ones(130, true);
+  EXPECT_TRUE(ones.size() == 130 && ones.count() == 130 && ones.all());
+  sup::vector<bool> zeros(70);
+  EXPECT_TRUE(zeros.size() == 70 && zeros.none());
+
+  bool array[5] = {true, false, true, true, false};
+  sup::vector<bool> vec(array, array + 5);
+  EXPECT_TRUE(vec.size() == 5 && vec[0] && !vec[1] && vec[3]);
+  sup::vector<bool> filled(3, 1);
+  EXPECT_TRUE(filled.size() == 3 && filled.count() == 3);
+
+  sup::vector<bool> copy(ones);
+  EXPECT_TRUE(copy.size() == 130 && copy.count() == 130);
+  copy = vec;
+  EXPECT_TRUE(copy.size() == 5 && copy.count() == 3);
+  sup::vector<bool> moved(std::move(copy));
+  EXPECT_TRUE(moved.size() == 5 && copy.empty());
+  moved.swap(ones);
+  EXPECT_TRUE(moved.size() == 130 && ones.size() == 5);
+}
+
+TEST(bit_vector_test, resize_keeps_tail_clear) {
+  sup::vector<bool> vec(100, true);
+  vec.resize(10);
+  // the bits after size() are cleared, growing again gives the new value
+  vec.resize(100, false);
+  EXPECT_TRUE(vec.count() == 10 && vec.find_next(9) == 100);
+  vec.resize(200, true);
+  EXPECT_TRUE(vec.count() == 110 && vec.find_next(9) == 100);
+  vec.flip();
+  EXPECT_TRUE(vec.count() == 90 && vec.find_first() == 10);
+  vec.clear();
+  vec.push_back(false);
+  EXPECT_TRUE(vec.size() == 1 && vec.none());
+  vec.shrink_to_fit();
+  EXPECT_TRUE(vec.memory_usage() == sizeof(unsigned long));
+}
+
+TEST(bit_vector_test, insert_and_erase) {
+  sup::vector<bool> vec;
+  for (int i = 0; i < 100; ++i) {
+    vec.push_back(i % 2 == 0);
+  }
+  sup::vector<bool>::iterator it = vec.insert(vec.begin() + 1, 3, true);
+  EXPECT_TRUE(it == vec.begin() + 1 && vec.size() == 103);
+  EXPECT_TRUE(vec[0] && vec[1] && vec[2] && vec[3] && !vec[4] && vec[5]);
+  EXPECT_TRUE(vec[102] == false);
+
+  vec.erase(vec.begin() + 1, vec.begin() + 4);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(vec[i] == (i % 2 == 0));
+  }
+  vec.erase(vec.begin());
+  EXPECT_TRUE(vec.size() == 99 && !vec[0] && vec[1] && vec.count() == 49);
+  vec.insert(vec.end(), false);
+  EXPECT_TRUE(vec.size() == 100 && !vec.back());
+}
+
+TEST(bit_vector_test, find) {
+  sup::vector<bool> vec(1000);
+  EXPECT_TRUE(vec.find_first() == 1000 && !vec.any());
+  size_t positions[] = {3, 64, 65, 511, 999};
+  for (size_t p : positions) {
+    vec[p] = true;
+  }
+  size_t i = 0;
+  for (size_t p = vec.find_first(); p != vec.size(); p = vec.find_next(p)) {
+    EXPECT_TRUE(p == positions[i++]);
+  }
+  EXPECT_TRUE(i == 5 && vec.count() == 5 && vec.any());
+  EXPECT_TRUE(vec.find_next(999) == 1000 && vec.find_next(2) == 3);
+}
+
+TEST(bit_vector_test, bulk_operations) {
+  sup::vector<bool> a(200), b(200);
+  for (size_t i = 0; i < 200; ++i) {
+    a[i] = i % 2 == 0;
+    b[i] = i % 3 == 0;
+  }
+  sup::vector<bool> and_ab(a), or_ab(a), xor_ab(a);
+  and_ab &= b;
+  or_ab |= b;
+  xor_ab ^= b;
+  for (size_t i = 0; i < 200; ++i) {
+    EXPECT_TRUE(and_ab[i] == (a[i] && b[i]));
+    EXPECT_TRUE(or_ab[i] == (a[i] || b[i]));
+    EXPECT_TRUE(xor_ab[i] == (a[i] != b[i]));
+  }
+  EXPECT_TRUE(and_ab.count() == 34 && or_ab.count() == 133);
+
+  // a shorter operand: and clears the rest
+  sup::vector<bool> ones(200, true), short_ones(70, true);
+  ones &= short_ones;
+  EXPECT_TRUE(ones.count() == 70 && ones.size() == 200);
+}
+
+}  // namespace bit_vector_test
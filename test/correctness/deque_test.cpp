@@ -1,4 +1,6 @@
 #include <gtest/gtest.h>
+#include <string>
+#include <type_traits>
 
 #include "../../src/sstl_deque.hpp"
 
@@ -142,4 +144,119 @@ TEST(deque_int_test, insert) {
   EXPECT_TRUE(dq.size() == 19);
 }
 
-}
\ No newline at end of file
+TEST(deque_move_test, emplace_and_move) {
+  sup::deque<std::string> dq;
+  for (int i = 0; i < 300; ++i) {
+    dq.emplace_back(3, (char) ('a' + i % 26));
+    dq.emplace_front(std::to_string(i));
+  }
+  EXPECT_TRUE(dq.size() == 600);
+  EXPECT_TRUE(dq.front() == "299" && dq.back() == "nnn");
+
+  std::string s(50, 'x');
+  dq.push_back(std::move(s));
+  dq.push_front(std::string(50, 'y'));
+  EXPECT_TRUE(dq.back() == std::string(50, 'x'));
+  EXPECT_TRUE(dq.front() == std::string(50, 'y'));
+
+  // in the middle, closer to either end
+  sup::deque<std::string>::iterator it = dq.emplace(dq.begin() + 10, "ten");
+  EXPECT_TRUE(*it == "ten" && dq[10] == "ten" && dq[11] == "290");
+  it = dq.emplace(dq.end() - 10, 2, 'z');
+  EXPECT_TRUE(*it == "zz" && dq[dq.size() - 11] == "zz");
+  it = dq.insert(dq.begin() + 300, dq[10]);  // the value lives in dq
+  EXPECT_TRUE(*it == "ten" && dq.size() == 605);
+
+  sup::deque<std::string> moved(std::move(dq));
+  EXPECT_TRUE(dq.empty() && moved.size() == 605);
+  dq.push_back("reused");
+  EXPECT_TRUE(dq.size() == 1 && dq.front() == "reused");
+
+  sup::deque<std::string> copied(moved);
+  EXPECT_TRUE(copied.size() == 605 && copied[10] == "ten");
+  copied = dq;
+  EXPECT_TRUE(copied.size() == 1 && copied.front() == "reused");
+  copied = std::move(moved);
+  EXPECT_TRUE(copied.size() == 605 && copied.back() == std::string(50, 'x'));
+}
+
+// a moved deque gives its map away and creates a new one when it is used
+TEST(deque_move_test, moved_from) {
+  static_assert(std::is_nothrow_move_constructible<sup::deque<int>>::value,
+                "moving a deque allocates nothing");
+  sup::deque<int> dq;
+  for (int i = 0; i < 1000; ++i) dq.push_back(i);
+
+  sup::deque<int> moved(std::move(dq));
+  EXPECT_TRUE(dq.empty() && dq.size() == 0 && dq.begin() == dq.end());
+  EXPECT_TRUE(dq.memory_usage() == 0);
+  EXPECT_TRUE(sup::erase_if(dq, [](int) { return true; }) == 0);
+  dq.clear();
+  dq.shrink_to_fit();
+  dq.push_front(1);
+  dq.push_back(2);
+  EXPECT_TRUE(dq.size() == 2 && dq.front() == 1 && dq.back() == 2);
+
+  sup::deque<int> moved_again(std::move(dq));
+  dq.insert(dq.begin(), 3);
+  EXPECT_TRUE(dq.size() == 1 && dq.front() == 3);
+  EXPECT_TRUE(moved.size() == 1000 && moved_again.size() == 2);
+}
+
+// many insertions in the middle grow the map on both sides
+TEST(deque_move_test, insert_in_middle_grows_map) {
+  sup::deque<int> dq;
+  for (int i = 0; i < 5000; ++i) {
+    dq.insert(dq.begin() + dq.size() / 2, i);
+  }
+  EXPECT_TRUE(dq.size() == 5000);
+  EXPECT_TRUE(dq[2499] == 4999 && dq[0] == 1 && dq[4999] == 0);
+}
+
+TEST(deque_int_test, shrink_to_fit) {
+  sup::deque<int> dq;
+  size_t empty_usage = dq.memory_usage();
+  for (int i = 0; i < 100000; ++i) {
+    dq.push_back(i);
+  }
+  size_t peak_usage = dq.memory_usage();
+  EXPECT_TRUE(peak_usage >= 100000 * sizeof(int));
+
+  while (dq.size() > 10) {
+    dq.pop_front();
+  }
+  // the buffers are given back at once, the map is not
+  EXPECT_TRUE(dq.memory_usage() < peak_usage / 10);
+  size_t usage = dq.memory_usage();
+  dq.shrink_to_fit();
+  EXPECT_TRUE(dq.memory_usage() < usage);
+  EXPECT_TRUE(dq.size() == 10 && dq.front() == 99990 && dq.back() == 99999);
+
+  dq.clear();
+  dq.shrink_to_fit();
+  EXPECT_TRUE(dq.memory_usage() <= empty_usage);
+  for (int i = 0; i < 1000; ++i) {
+    dq.push_front(i);
+  }
+  EXPECT_TRUE(dq.size() == 1000 && dq.front() == 999 && dq.back() == 0);
+}
+
+TEST(deque_int_test, erase_if) {
+  sup::deque<int> dq;
+  for (int i = 0; i < 10000; ++i) {
+    dq.push_back(i);
+  }
+  size_t usage = dq.memory_usage();
+  EXPECT_TRUE(sup::erase_if(dq, [](int x) { return x % 4 != 0; }) == 7500);
+  EXPECT_TRUE(dq.size() == 2500 && dq.front() == 0 && dq.back() == 9996);
+  for (size_t i = 0; i < dq.size(); ++i) {
+    EXPECT_TRUE(dq[i] == 4 * (int) i);
+  }
+  // the buffers after the new end are given back
+  EXPECT_TRUE(dq.memory_usage() < usage);
+  EXPECT_TRUE(sup::erase(dq, 0) == 1 && dq.front() == 4);
+  dq.push_back(-1);
+  EXPECT_TRUE(dq.size() == 2500 && dq.back() == -1);
+}
+
+}
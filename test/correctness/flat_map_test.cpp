@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <utility>
+
+#include "../../src/sstl_flat_map.hpp"
+
+namespace flat_map_int_str_test {
+
+TEST(flat_map_int_str_test, bulk_construct) {
+  std::pair<int, std::string> pairs[] = {
+      {6, "6"}, {4, "4"}, {8, "8"}, {4, "duplicate"}, {1, "1"}, {6, "x"}};
+  sup::flat_map<int, std::string> m(pairs, pairs + 6);
+  EXPECT_TRUE(m.size() == 4);
+
+  // sorted, and the first of the duplicates is kept
+  int keys[] = {1, 4, 6, 8};
+  int i = 0;
+  for (sup::flat_map<int, std::string>::iterator it = m.begin(); it != m.end();
+       ++it, ++i) {
+    EXPECT_TRUE((*it).first == keys[i]);
+    EXPECT_TRUE(it->second == std::to_string(keys[i]));
+  }
+  EXPECT_TRUE(i == 4);
+  EXPECT_TRUE(m.key_sequence()[2] == 6 && m.value_sequence()[2] == "6");
+}
+
+TEST(flat_map_int_str_test, insert_and_lookup) {
+  sup::flat_map<int, std::string> m;
+  for (int i = 9; i >= 0; --i) {
+    EXPECT_TRUE(m.insert(std::make_pair(2 * i, std::to_string(i))).second);
+  }
+  std::pair<sup::flat_map<int, std::string>::iterator, bool> result =
+      m.insert(std::make_pair(4, std::string("again")));
+  EXPECT_TRUE(!result.second && result.first->second == "2");
+  EXPECT_TRUE(m.size() == 10);
+
+  EXPECT_TRUE(m.find(6)->second == "3" && m.find(7) == m.end());
+  EXPECT_TRUE(m.count(18) == 1 && m.count(19) == 0 && m.contains(0));
+  EXPECT_TRUE(m.lower_bound(7)->first == 8 && m.upper_bound(8)->first == 10);
+  EXPECT_TRUE(m.lower_bound(19) == m.end());
+  std::pair<sup::flat_map<int, std::string>::iterator,
+            sup::flat_map<int, std::string>::iterator>
+      range = m.equal_range(10);
+  EXPECT_TRUE(range.second - range.first == 1 && range.first->second == "5");
+  range = m.equal_range(11);
+  EXPECT_TRUE(range.first == range.second);
+
+  // operator[] inserts a default value
+  m[5] = "five";
+  EXPECT_TRUE(m.size() == 11 && m[5] == "five" && m[4] == "2");
+  m.find(4)->second = "two";
+  EXPECT_TRUE(m[4] == "two");
+
+  const sup::flat_map<int, std::string>& cm = m;
+  EXPECT_TRUE(cm.find(5)->second == "five" && cm.find(1) == cm.end());
+  sup::flat_map<int, std::string>::const_iterator cit = m.begin();
+  EXPECT_TRUE(cit->first == 0);
+  EXPECT_TRUE((*m.rbegin()).first == 18);
+}
+
+TEST(flat_map_int_str_test, insert_range) {
+  sup::flat_map<int, std::string> m;
+  m[1] = "1";
+  m[5] = "5";
+  std::pair<int, std::string> more[] = {
+      {7, "7"}, {5, "ignored"}, {0, "0"}, {3, "3"}, {3, "ignored"}};
+  m.insert(more, more + 5);
+  EXPECT_TRUE(m.size() == 5);
+  int keys[] = {0, 1, 3, 5, 7};
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_TRUE(m.key_sequence()[i] == keys[i]);
+    EXPECT_TRUE(m.value_sequence()[i] == std::to_string(keys[i]));
+  }
+
+  // merging with the entries of another map
+  sup::flat_map<int, std::string> other(m.begin(), m.begin() + 2);
+  other[-1] = "-1";
+  other.insert(m.begin(), m.end());
+  EXPECT_TRUE(other.size() == 6 && other.begin()->first == -1);
+}
+
+TEST(flat_map_int_str_test, erase) {
+  sup::flat_map<int, std::string> m;
+  for (int i = 0; i < 10; ++i) {
+    m[i] = std::to_string(i);
+  }
+  EXPECT_TRUE(m.erase(3) == 1 && m.erase(3) == 0);
+  sup::flat_map<int, std::string>::iterator it = m.erase(m.find(5));
+  EXPECT_TRUE(it->first == 6 && m.size() == 8);
+  it = m.erase(m.begin(), m.lower_bound(6));
+  EXPECT_TRUE(it == m.begin() && it->second == "6" && m.size() == 4);
+
+  sup::flat_map<int, std::string> copy(m);
+  EXPECT_TRUE(copy == m);
+  copy[100];
+  EXPECT_TRUE(!(copy == m));
+  copy.swap(m);
+  EXPECT_TRUE(m.size() == 5 && copy.size() == 4);
+  m.clear();
+  m.shrink_to_fit();
+  EXPECT_TRUE(m.empty() && m.memory_usage() == 0);
+}
+
+TEST(flat_map_int_str_test, comparator) {
+  sup::flat_map<int, int, std::greater<int>> m;
+  for (int i = 0; i < 5; ++i) {
+    m[i] = i * i;
+  }
+  EXPECT_TRUE(m.begin()->first == 4 && m.lower_bound(2)->second == 4);
+}
+
+}  // namespace flat_map_int_str_test
+
+namespace flat_map_int_bool_test {
+
+TEST(flat_map_int_bool_test, bool_values) {
+  std::pair<int, bool> pairs[] = {{3, true}, {1, false}, {2, true}};
+  sup::flat_map<int, bool> m(pairs, pairs + 3);
+  EXPECT_TRUE(m.size() == 3 && m.find(2)->second && !m.find(1)->second);
+
+  // the values are bools in memory: operator[] & the iterators give bool&
+  bool& b = m[1];
+  b = true;
+  EXPECT_TRUE(m.find(1)->second);
+  m[5] = false;
+  m.insert(std::make_pair(4, true));
+  for (sup::flat_map<int, bool>::iterator it = m.begin(); it != m.end(); ++it)
+    it->second = !it->second;
+  int expected_keys[] = {1, 2, 3, 4, 5};
+  bool expected_values[] = {false, false, false, false, true};
+  int i = 0;
+  for (sup::flat_map<int, bool>::const_iterator it = m.begin(); it != m.end();
+       ++it, ++i) {
+    EXPECT_TRUE((*it).first == expected_keys[i] &&
+                (*it).second == expected_values[i]);
+  }
+  EXPECT_TRUE(i == 5);
+  EXPECT_TRUE(m.erase(5) == 1 && m.size() == 4 && !(*m.rbegin()).second);
+
+  sup::flat_map<int, bool> copy(m);
+  EXPECT_TRUE(copy == m);
+  copy[2] = true;
+  EXPECT_TRUE(!(copy == m));
+}
+
+TEST(flat_map_int_bool_test, bool_keys) {
+  std::pair<bool, int> pairs[] = {{true, 1}, {false, 2}, {true, 3}};
+  sup::flat_map<bool, int> m(pairs, pairs + 3);
+  EXPECT_TRUE(m.size() == 2 && m.begin()->first == false);
+  EXPECT_TRUE(m.find(true)->second == 1 && m.find(false)->second == 2);
+  m[true] = 10;
+  EXPECT_TRUE(m.count(true) == 1 && (*m.rbegin()).second == 10);
+  EXPECT_TRUE(m.erase(false) == 1 && m.find(false) == m.end());
+  EXPECT_TRUE(m.lower_bound(false)->first == true);
+}
+
+}  // namespace flat_map_int_bool_test
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include <string>
+
+#include "../../src/sstl_flat_set.hpp"
+
+namespace flat_set_test {
+
+TEST(flat_set_int_test, bulk_construct) {
+  int a[] = {6, 4, 8, 5, 7, 2, 9, 1, 0, 3, 4, 6, 0};
+  sup::flat_set<int> s(a, a + 13);
+  EXPECT_TRUE(s.size() == 10);
+  int i = 0;
+  for (sup::flat_set<int>::iterator it = s.begin(); it != s.end(); ++it) {
+    EXPECT_TRUE(*it == i++);
+  }
+  EXPECT_TRUE(*s.rbegin() == 9);
+}
+
+TEST(flat_set_int_test, insert_and_lookup) {
+  sup::flat_set<int> s;
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(s.insert(2 * i).second);
+  }
+  EXPECT_TRUE(!s.insert(4).second && s.size() == 10);
+  EXPECT_TRUE(*s.find(6) == 6 && s.find(7) == s.end());
+  EXPECT_TRUE(s.count(18) == 1 && s.count(19) == 0 && s.contains(0));
+  EXPECT_TRUE(*s.lower_bound(7) == 8 && *s.upper_bound(8) == 10);
+  EXPECT_TRUE(s.equal_range(10).second - s.equal_range(10).first == 1);
+  EXPECT_TRUE(s.equal_range(11).first == s.equal_range(11).second);
+
+  int more[] = {5, 3, 4, 100, 3};
+  s.insert(more, more + 5);
+  EXPECT_TRUE(s.size() == 13 && s.sequence()[2] == 3 && s.sequence()[4] == 5);
+  EXPECT_TRUE(*s.rbegin() == 100);
+}
+
+TEST(flat_set_string_test, erase) {
+  std::string a[] = {"d", "b", "a", "c", "e"};
+  sup::flat_set<std::string> s(a, a + 5);
+  EXPECT_TRUE(s.erase("c") == 1 && s.erase("c") == 0);
+  sup::flat_set<std::string>::iterator it = s.erase(s.begin());
+  EXPECT_TRUE(*it == "b" && s.size() == 3);
+  s.erase(s.begin(), s.find("e"));
+  EXPECT_TRUE(s.size() == 1 && *s.begin() == "e");
+
+  sup::flat_set<std::string> other;
+  other.insert("x");
+  other.swap(s);
+  EXPECT_TRUE(*s.begin() == "x" && *other.begin() == "e");
+  EXPECT_TRUE(!(s == other));
+  other.clear();
+  EXPECT_TRUE(other.empty());
+}
+
+TEST(flat_set_bool_test, bool_keys) {
+  bool a[] = {true, false, true, true};
+  sup::flat_set<bool> s(a, a + 4);
+  EXPECT_TRUE(s.size() == 2 && *s.begin() == false && *s.rbegin() == true);
+  EXPECT_TRUE(s.contains(true) && *s.find(true) == true);
+  EXPECT_TRUE(!s.insert(false).second);
+  EXPECT_TRUE(s.erase(false) == 1 && s.size() == 1 && !s.contains(false));
+  sup::flat_set<bool>::iterator it = s.insert(false).first;
+  EXPECT_TRUE(it == s.begin() && !*it);
+
+  sup::flat_set<bool> other(a, a + 1);
+  EXPECT_TRUE(!(s == other));
+  other.insert(false);
+  EXPECT_TRUE(s == other);
+}
+
+}  // namespace flat_set_test
@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
+#include <random>
 #include <string> 
+#include <unordered_set>
+#include <vector>
 
 #include "../../src/sstl_hashtable.hpp"
 
@@ -140,12 +143,20 @@ TEST(hashtable_int_string_test, iterator_test) {
   sup::hashtable<int, int, identity<int>, identity<int>, equal<int>> ::iterator 
     it = ht.begin();
 
-  for (int i = 0; it != ht.end(); ++it, ++i) {
-    EXPECT_TRUE(*it == i);
+  // the order is that of the chain, not of the buckets: every element is
+  // visited once
+  std::vector<int> visits(n, 0);
+  int count = 0;
+  for (; it != ht.end(); ++it, ++count) {
+    ++visits[*it];
+  }
+  EXPECT_TRUE(count == n);
+  for (int i = 0; i < n; ++i) {
+    EXPECT_TRUE(visits[i] == 1);
   }
 }
 
-TEST(hashtable_int_string_test, index_operator_overloading_test) {
+TEST(hashtable_int_string_test, find_or_insert) {
   identity<int> id;
   equal<int> eq;
   sup::hashtable<int, std::string, identity<int>, extract_key<std::string>, equal<int>> 
@@ -153,11 +164,11 @@ TEST(hashtable_int_string_test, index_operator_overloading_test) {
 
   int n = 1000;
   for (int i = 0; i < n; ++i) {
-    // still the same key, but use 
-    // [] to insert
-    // note this operation is very dangerous as 
-    // the key might rely on the value.
-    ht[i] = std::to_string(i);
+    ht.find_or_insert(std::to_string(i));
+  }
+  // the elements already there are found, not inserted again
+  for (int i = 0; i < n; ++i) {
+    EXPECT_TRUE(&ht.find_or_insert(std::to_string(i)) == &*ht.find(i));
   }
 
   // test whether 
@@ -176,16 +187,14 @@ TEST(hashtable_int_string_test, equal_range) {
     ht(10, id, eq);
 
   int n = 20;
-  // insert 20 "10"s. 
+  // insert 20 "10"s.
   for (int i = 0; i < n; ++i) {
-    // still the same key, but use 
-    // [] to insert
-    ht[i] = std::to_string(10);
+    ht.insert_equal(std::to_string(10));
   }
 
   // insert some other elements
   for (int i = 20; i < 1000; ++i) {
-    ht[i] = std::to_string(i);
+    ht.find_or_insert(std::to_string(i));
   }
 
   // get the equal range of key 10
@@ -301,14 +310,21 @@ TEST(hashtable_int_string_test, erase_given_range) {
   sup::hashtable<int, std::string, identity<int>, extract_key<std::string>, equal<int>>::iterator
     last = ht.find(6);
   
-  // remvove elements of key 3, 4, 5
+  // the range follows the iteration order, which is not the key order
+  std::vector<bool> in_range(n, false);
+  int num_in_range = 0;
+  for (auto it = first; it != last; ++it) {
+    in_range[std::stoi(*it)] = true;
+    ++num_in_range;
+  }
+
   ht.erase(first, last);
-  EXPECT_TRUE(ht.size() == 7);
+  EXPECT_TRUE(ht.size() == n - num_in_range);
 
   for (int i = 0; i < n; ++i) {
     sup::hashtable<int, std::string, identity<int>, extract_key<std::string>, equal<int>>::iterator
       it = ht.find(i);
-    if ( i < 3 || i >= 6) {
+    if (!in_range[i]) {
       EXPECT_TRUE(*it == std::to_string(i));
     } else {
       EXPECT_TRUE(it == ht.end());
@@ -326,14 +342,12 @@ TEST(hashtable_int_string_test, clear) {
   int n = 20;
   // insert 10 "10"s. 
   for (int i = 0; i < n; ++i) {
-    // still the same key, but use 
-    // [] to insert
-    ht[i] = std::to_string(10);
+    ht.insert_equal(std::to_string(10));
   }
 
   // insert some other elements
   for (int i = 20; i < 1000; ++i) {
-    ht[i] = std::to_string(i);
+    ht.find_or_insert(std::to_string(i));
   }
   ht.clear();
 
@@ -357,14 +371,12 @@ TEST(hashtable_int_string_test, rehash) {
   int n = 20;
   // insert 10 "10"s. 
   for (int i = 0; i < n; ++i) {
-    // still the same key, but use 
-    // [] to insert
-    ht[i] = std::to_string(10);
+    ht.insert_equal(std::to_string(10));
   }
 
   // insert some other elements
   for (int i = 20; i < 1000; ++i) {
-    ht[i] = std::to_string(i);
+    ht.find_or_insert(std::to_string(i));
   }
   ht.clear();
 
@@ -390,14 +402,12 @@ TEST(hashtable_int_string_test, reserve) {
   int n = 20;
   // insert 10 "10"s. 
   for (int i = 0; i < n; ++i) {
-    // still the same key, but use 
-    // [] to insert
-    ht[i] = std::to_string(10);
+    ht.insert_equal(std::to_string(10));
   }
 
   // insert some other elements
   for (int i = 20; i < 1000; ++i) {
-    ht[i] = std::to_string(i);
+    ht.find_or_insert(std::to_string(i));
   }
   ht.clear();
 
@@ -406,4 +416,551 @@ TEST(hashtable_int_string_test, reserve) {
 
 }
 
-}
\ No newline at end of file
+TEST(hashtable_int_string_test, shrink_to_fit) {
+  identity<int> id;
+  equal<int> eq;
+  sup::hashtable<int, std::string, identity<int>, extract_key<std::string>, equal<int>>
+    ht(10, id, eq);
+
+  for (int i = 0; i < 1000; ++i) {
+    ht.insert_unique(std::to_string(i));
+  }
+  size_t peak_buckets = ht.bucket_count();
+  size_t peak_usage = ht.memory_usage();
+  EXPECT_TRUE(peak_buckets >= 1000);
+  EXPECT_TRUE(peak_usage >= peak_buckets * sizeof(void*) + 1000 * sizeof(std::string));
+
+  // the burst is over
+  for (int i = 10; i < 1000; ++i) {
+    ht.erase(i);
+  }
+  EXPECT_TRUE(ht.size() == 10 && ht.bucket_count() == peak_buckets);
+  ht.shrink_to_fit();
+  EXPECT_TRUE(ht.bucket_count() == 53 && ht.spare_nodes_count() == 0);
+  EXPECT_TRUE(ht.memory_usage() < peak_usage / 10);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(*ht.find(i) == std::to_string(i));
+  }
+  EXPECT_TRUE(ht.find(10) == ht.end());
+
+  // a lower max load factor keeps more buckets
+  ht.max_load_factor(0.1f);
+  for (int i = 10; i < 100; ++i) {
+    ht.insert_unique(std::to_string(i));
+  }
+  ht.shrink_to_fit();
+  EXPECT_TRUE(ht.bucket_count() >= 1000);
+}
+
+}
+
+namespace hashtable_hash_code_test {
+
+// counts the calls, to check which operations hash again
+struct counting_hash {
+  static size_t calls;
+  size_t operator()(const std::string& s) const {
+    ++calls;
+    return std::hash<std::string>()(s);
+  }
+};
+size_t counting_hash::calls = 0;
+
+// the same, with the hash codes not stored
+struct uncached_hash : counting_hash {};
+
+}
+
+namespace sup {
+template <>
+struct _hashtable_cache_hash_code<std::string,
+                                  hashtable_hash_code_test::uncached_hash>
+    : std::false_type {};
+}
+
+namespace hashtable_hash_code_test {
+
+typedef sup::hashtable<std::string, std::string, counting_hash,
+                       std::_Identity<std::string>, std::equal_to<std::string>>
+  string_table;
+typedef sup::hashtable<std::string, std::string, uncached_hash,
+                       std::_Identity<std::string>, std::equal_to<std::string>>
+  uncached_string_table;
+
+TEST(hashtable_hash_code_test, default_option) {
+  EXPECT_TRUE((sup::_hashtable_cache_hash_code<std::string,
+                                               std::hash<std::string>>::value));
+  EXPECT_FALSE((sup::_hashtable_cache_hash_code<int, std::hash<int>>::value));
+}
+
+TEST(hashtable_hash_code_test, hashed_once) {
+  string_table ht(10, counting_hash(), std::equal_to<std::string>());
+  counting_hash::calls = 0;
+  for (int i = 0; i < 1000; ++i) {
+    ht.insert_unique(std::to_string(i));
+  }
+  // several rehashes on the way
+  EXPECT_TRUE(ht.bucket_count() > 1000 && counting_hash::calls == 1000);
+
+  counting_hash::calls = 0;
+  size_t visited = 0;
+  for (string_table::iterator it = ht.begin(); it != ht.end(); ++it) {
+    ++visited;
+  }
+  ht.rehash(5000);
+  EXPECT_TRUE(visited == 1000 && counting_hash::calls == 0);
+
+  // one hash per lookup
+  EXPECT_TRUE(ht.count("10") == 1 && *ht.find("20") == "20");
+  std::pair<string_table::iterator, string_table::iterator> range =
+      ht.equal_range("30");
+  EXPECT_TRUE(*range.first == "30" && ++range.first == range.second);
+  EXPECT_TRUE(counting_hash::calls == 3);
+
+  // erasing by position finds the bucket from the node
+  string_table::iterator it = ht.find("40");
+  counting_hash::calls = 0;
+  ht.erase(it);
+  EXPECT_TRUE(counting_hash::calls == 0 && ht.size() == 999);
+  EXPECT_TRUE(ht.find("40") == ht.end());
+
+  // copies keep the codes
+  string_table copy(ht);
+  EXPECT_TRUE(counting_hash::calls == 1 && copy.size() == 999);
+  EXPECT_TRUE(copy.erase("50") == 1 && copy.find("50") == copy.end());
+}
+
+TEST(hashtable_hash_code_test, equal_keys) {
+  string_table ht(10, counting_hash(), std::equal_to<std::string>());
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < 200; ++i) {
+      ht.insert_equal(std::to_string(i));
+    }
+  }
+  EXPECT_TRUE(ht.size() == 600 && ht.count("7") == 3);
+  EXPECT_TRUE(ht.erase("7") == 3 && ht.count("7") == 0 && ht.count("8") == 3);
+  EXPECT_TRUE(ht.size() == 597);
+}
+
+TEST(hashtable_hash_code_test, opt_out) {
+  uncached_string_table ht(10, uncached_hash(), std::equal_to<std::string>());
+  for (int i = 0; i < 100; ++i) {
+    ht.insert_unique(std::to_string(i));
+  }
+  counting_hash::calls = 0;
+  size_t visited = 0;
+  for (uncached_string_table::iterator it = ht.begin(); it != ht.end(); ++it) {
+    ++visited;
+  }
+  // iteration follows the element chain, nothing is hashed
+  EXPECT_TRUE(visited == 100 && counting_hash::calls == 0);
+  // a lookup hashes the following keys to find the end of its bucket
+  EXPECT_TRUE(*ht.find("42") == "42" && counting_hash::calls > 0);
+  EXPECT_TRUE(ht.erase("42") == 1 && ht.find("42") == ht.end());
+}
+
+}  // namespace hashtable_hash_code_test
+
+namespace hashtable_bucket_policy_test {
+
+// std::hash, with power of two buckets
+struct power2_hash : std::hash<int> {};
+
+}
+
+namespace sup {
+template <>
+struct _hashtable_bucket_policy<int, hashtable_bucket_policy_test::power2_hash> {
+  typedef __hashtable_power2_buckets type;
+};
+}
+
+namespace hashtable_bucket_policy_test {
+
+typedef sup::hashtable<int, int, power2_hash, std::_Identity<int>,
+                       std::equal_to<int>>
+  power2_table;
+
+TEST(hashtable_bucket_policy_test, fastmod) {
+  size_t divisors[] = {1, 5, 53, 97, 65536, 12582917ul, 4294967291ul};
+  size_t codes[] = {0, 1, 52, 53, 12345, 65535, 0x7fffffff, 0xffffffff};
+  for (size_t d : divisors) {
+    sup::__hashtable_prime_buckets policy;
+    policy.reset(d);
+    for (size_t h : codes) {
+      EXPECT_TRUE(policy.index(h) == h % d);
+    }
+    // the high half of a code is folded into the low half
+    EXPECT_TRUE(policy.index(0x100000000ull | 7) == 6 % d);
+  }
+}
+
+TEST(hashtable_bucket_policy_test, power2) {
+  sup::__hashtable_power2_buckets policy;
+  policy.reset(1024);
+  bool all_in_range = true;
+  for (size_t h = 0; h < 100000; ++h) {
+    all_in_range = all_in_range && policy.index(h) < 1024;
+  }
+  EXPECT_TRUE(all_in_range);
+  // consecutive codes are spread out
+  EXPECT_TRUE(policy.index(0) != policy.index(1));
+
+  power2_table ht(10, power2_hash(), std::equal_to<int>());
+  EXPECT_TRUE(ht.bucket_count() == 16);
+  for (int i = 0; i < 10000; ++i) {
+    ht.insert_unique(i * 64);
+  }
+  size_t buckets = ht.bucket_count();
+  EXPECT_TRUE(ht.size() == 10000 && buckets >= 10000 &&
+              (buckets & (buckets - 1)) == 0);
+  for (int i = 0; i < 10000; ++i) {
+    EXPECT_TRUE(*ht.find(i * 64) == i * 64);
+  }
+  EXPECT_TRUE(ht.find(1) == ht.end());
+
+  // a request is rounded up to a power of two
+  ht.rehash(buckets + 1);
+  EXPECT_TRUE(ht.bucket_count() == 2 * buckets);
+  for (int i = 0; i < 10000; i += 2) {
+    ht.erase(i * 64);
+  }
+  power2_table copy(ht);
+  EXPECT_TRUE(copy.size() == 5000 && copy.bucket_count() == 2 * buckets);
+  EXPECT_TRUE(copy.count(64) == 1 && copy.count(128) == 0);
+  copy.shrink_to_fit();
+  EXPECT_TRUE(copy.bucket_count() == 8192 && *copy.find(64) == 64);
+}
+
+}  // namespace hashtable_bucket_policy_test
+
+namespace hashtable_incremental_rehash_test {
+
+typedef sup::hashtable<int, int, std::hash<int>, std::_Identity<int>,
+                       std::equal_to<int>>
+  int_table;
+typedef sup::hashtable<std::string, std::string, std::hash<std::string>,
+                       std::_Identity<std::string>, std::equal_to<std::string>>
+  string_table;
+
+// the table holds the elements of expected, each once in the iteration
+template <class Table, class Multiset>
+bool same_elements(Table& ht, const Multiset& expected) {
+  if (ht.size() != expected.size()) return false;
+  size_t visited = 0;
+  for (typename Table::iterator it = ht.begin(); it != ht.end(); ++it) {
+    ++visited;
+  }
+  if (visited != expected.size()) return false;
+  for (typename Multiset::const_iterator it = expected.begin();
+       it != expected.end(); ++it) {
+    if (ht.count(*it) != expected.count(*it)) return false;
+  }
+  return true;
+}
+
+TEST(hashtable_incremental_rehash_test, grow) {
+  int_table ht(10, std::hash<int>(), std::equal_to<int>());
+  ht.incremental_rehash(true);
+  EXPECT_TRUE(ht.incremental_rehash() && !ht.rehashing());
+  size_t buckets = ht.bucket_count();
+  int i = 0;
+  for (; ht.bucket_count() == buckets; ++i) {
+    ht.insert_unique(i);
+  }
+  // the buckets have grown, most nodes are still in the previous ones
+  EXPECT_TRUE(ht.rehashing() && ht.bucket_count() > buckets);
+  for (int j = 0; j < i; ++j) {
+    EXPECT_TRUE(*ht.find(j) == j);
+  }
+  EXPECT_TRUE(ht.find(i) == ht.end());
+
+  // each insertion moves a bucket: done before the next growth
+  buckets = ht.bucket_count();
+  for (; ht.rehashing(); ++i) {
+    ht.insert_unique(i);
+  }
+  EXPECT_TRUE(ht.bucket_count() == buckets);
+  for (int j = 0; j < i; ++j) {
+    EXPECT_TRUE(ht.count(j) == 1);
+  }
+
+  // turning it off finishes the rehashing
+  for (; !ht.rehashing(); ++i) {
+    ht.insert_unique(i);
+  }
+  ht.incremental_rehash(false);
+  EXPECT_TRUE(!ht.rehashing() && ht.size() == (size_t) i);
+  for (int j = 0; j < i; ++j) {
+    EXPECT_TRUE(ht.count(j) == 1);
+  }
+}
+
+// a table that stops growing still ends its rehashing
+TEST(hashtable_incremental_rehash_test, end_without_insertions) {
+  int_table ht(10, std::hash<int>(), std::equal_to<int>());
+  ht.incremental_rehash(true);
+  size_t buckets = ht.bucket_count();
+  int i = 0;
+  for (; ht.bucket_count() == buckets; ++i) {
+    ht.insert_unique(i);
+  }
+  EXPECT_TRUE(ht.rehashing());
+  // lookups move nothing
+  for (int j = 0; j < i; ++j) {
+    EXPECT_TRUE(ht.count(j) == 1);
+  }
+  EXPECT_TRUE(ht.rehashing());
+
+  // erasures by key do, even of missing keys
+  size_t erased = 0;
+  for (int j = 0; ht.rehashing(); j += 2) {
+    erased += ht.erase(j);
+  }
+  EXPECT_TRUE(ht.size() == i - erased);
+  for (int j = 0; j < i; ++j) {
+    EXPECT_TRUE(ht.count(j) == (j % 2 == 0 && (size_t) j < 2 * erased ? 0 : 1));
+  }
+
+  // shrink_to_fit, rehash & reserve end it at once
+  for (; !ht.rehashing(); ++i) {
+    ht.insert_unique(i);
+  }
+  ht.shrink_to_fit();
+  EXPECT_TRUE(!ht.rehashing());
+  for (; !ht.rehashing(); ++i) {
+    ht.insert_unique(i);
+  }
+  ht.rehash(1);
+  EXPECT_TRUE(!ht.rehashing());
+  for (; !ht.rehashing(); ++i) {
+    ht.insert_unique(i);
+  }
+  ht.reserve(1);
+  EXPECT_TRUE(!ht.rehashing());
+  EXPECT_TRUE(ht.size() == i - erased);
+}
+
+int int_key(unsigned i) { return (int) i; }
+std::string string_key(unsigned i) { return std::to_string(i); }
+
+// insertions & erasures of all kinds, checked against expected
+template <class Table, class Key>
+void random_operations(Table& ht, Key (*make_key)(unsigned)) {
+  std::mt19937 gen(11);
+  ht.incremental_rehash(true);
+  std::unordered_multiset<Key> expected;
+  int rehashing = 0;
+  for (int round = 0; round < 20000; ++round) {
+    Key key = make_key(gen() % 3000);
+    switch (gen() % 8) {
+      case 0: case 1:
+        if (ht.insert_unique(key).second) expected.insert(key);
+        break;
+      case 2:
+        if (expected.count(key) == 0) expected.insert(key);
+        EXPECT_TRUE(ht.find_or_insert(key) == key);
+        break;
+      case 3: case 4:
+        ht.insert_equal(key);
+        expected.insert(key);
+        break;
+      case 5:
+        EXPECT_TRUE(ht.erase(key) == expected.erase(key));
+        break;
+      case 6: {
+        typename Table::iterator it = ht.find(key);
+        if (it != ht.end()) {
+          ht.erase(it);
+          expected.erase(expected.find(key));
+        }
+        break;
+      }
+      default: {
+        // erase a range of the iteration, up to 3 elements
+        typename Table::iterator first = ht.find(key), last = first;
+        for (int k = 0; k < 3 && last != ht.end(); ++k) {
+          expected.erase(expected.find(*last));
+          ++last;
+        }
+        ht.erase(first, last);
+        break;
+      }
+    }
+    rehashing += ht.rehashing();
+    if (round % 1000 == 0) {
+      EXPECT_TRUE(same_elements(ht, expected));
+    }
+  }
+  EXPECT_TRUE(rehashing > 0 && same_elements(ht, expected));
+
+  // copies of a rehashing table
+  for (unsigned i = 3000; !ht.rehashing(); ++i) {
+    ht.insert_unique(make_key(i));
+    expected.insert(make_key(i));
+  }
+  Table copy(ht);
+  EXPECT_TRUE(!copy.rehashing() && same_elements(copy, expected));
+  EXPECT_TRUE(ht.rehashing() && same_elements(ht, expected));
+
+  ht.clear();
+  EXPECT_TRUE(!ht.rehashing() && ht.size() == 0 && ht.begin() == ht.end());
+  ht.insert_unique(make_key(1));
+  EXPECT_TRUE(ht.count(make_key(1)) == 1 && ht.size() == 1);
+}
+
+TEST(hashtable_incremental_rehash_test, random_operations) {
+  int_table ints(10, std::hash<int>(), std::equal_to<int>());
+  random_operations(ints, int_key);
+  string_table strings(10, std::hash<std::string>(),
+                       std::equal_to<std::string>());
+  random_operations(strings, string_key);
+}
+
+}  // namespace hashtable_incremental_rehash_test
+
+namespace hashtable_bulk_insert_test {
+
+// counts the calls; int keys store no hash code
+struct counting_hash {
+  static size_t calls;
+  size_t operator()(int i) const {
+    ++calls;
+    return std::hash<int>()(i);
+  }
+};
+size_t counting_hash::calls = 0;
+
+typedef sup::hashtable<int, int, counting_hash, std::_Identity<int>,
+                       std::equal_to<int>>
+  counted_table;
+typedef sup::hashtable<int, int, std::hash<int>, std::_Identity<int>,
+                       std::equal_to<int>>
+  int_table;
+typedef sup::hashtable<std::string, std::string, std::hash<std::string>,
+                       std::_Identity<std::string>, std::equal_to<std::string>>
+  string_table;
+
+// the table holds the elements of expected, the equal ones next to each
+// other, and each bucket is found from its elements
+template <class Table, class Multiset>
+bool same_elements(Table& ht, const Multiset& expected) {
+  if (ht.size() != expected.size()) return false;
+  size_t visited = 0;
+  for (typename Table::iterator it = ht.begin(); it != ht.end(); ++it) {
+    ++visited;
+    if (ht.find(*it) == ht.end()) return false;
+  }
+  if (visited != expected.size()) return false;
+  for (typename Multiset::const_iterator it = expected.begin();
+       it != expected.end(); ++it) {
+    const size_t n = expected.count(*it);
+    std::pair<typename Table::iterator, typename Table::iterator> range =
+        ht.equal_range(*it);
+    size_t in_range = 0;
+    for (; range.first != range.second; ++range.first) ++in_range;
+    if (ht.count(*it) != n || in_range != n) return false;
+  }
+  return true;
+}
+
+TEST(hashtable_bulk_insert_test, range_grows_once) {
+  std::vector<int> keys;
+  for (int i = 0; i < 5000; ++i) keys.push_back(i);
+
+  // an element at a time: every growth hashes all the elements again
+  counted_table one_by_one(10, counting_hash(), std::equal_to<int>());
+  counting_hash::calls = 0;
+  for (size_t i = 0; i < keys.size(); ++i) one_by_one.insert_unique(keys[i]);
+  const size_t calls = counting_hash::calls;
+  counted_table reserved(10, counting_hash(), std::equal_to<int>());
+  reserved.reserve(keys.size());
+  counting_hash::calls = 0;
+  for (size_t i = 0; i < keys.size(); ++i) reserved.insert_unique(keys[i]);
+  const size_t reserved_calls = counting_hash::calls;
+
+  // a range: the empty buckets grow once, as if reserved
+  counted_table ht(10, counting_hash(), std::equal_to<int>());
+  counting_hash::calls = 0;
+  ht.insert_unique(&keys[0], &keys[0] + keys.size());
+  EXPECT_TRUE(counting_hash::calls <= reserved_calls &&
+              reserved_calls < calls);
+  EXPECT_TRUE(ht.size() == keys.size() && ht.load_factor() <= 1.0f);
+
+  // duplicates are found in the range too
+  ht.insert_equal(&keys[0], &keys[0] + 100);
+  ht.insert_unique(&keys[0], &keys[0] + 200);
+  EXPECT_TRUE(ht.size() == keys.size() + 100);
+  EXPECT_TRUE(ht.count(99) == 2 && ht.count(100) == 1);
+
+  // under a lower max load factor
+  int_table low(10, std::hash<int>(), std::equal_to<int>());
+  low.max_load_factor(0.25f);
+  low.insert_equal(&keys[0], &keys[0] + keys.size());
+  EXPECT_TRUE(low.size() == keys.size() && low.load_factor() <= 0.25f);
+}
+
+TEST(hashtable_bulk_insert_test, unique) {
+  std::mt19937 gen(5);
+  std::vector<std::string> keys;
+  for (int i = 0; i < 20000; ++i) keys.push_back(std::to_string(gen() % 8000));
+
+  string_table ht(10, std::hash<std::string>(), std::equal_to<std::string>());
+  ht.bulk_insert_unique(&keys[0], &keys[0] + keys.size());
+  std::unordered_set<std::string> unique(keys.begin(), keys.end());
+  EXPECT_TRUE(same_elements(ht, unique));
+  EXPECT_TRUE(ht.load_factor() <= ht.max_load_factor());
+
+  // into the buckets of a table in use, while it rehashes
+  string_table more(10, std::hash<std::string>(), std::equal_to<std::string>());
+  more.incremental_rehash(true);
+  for (int i = 0; !more.rehashing(); ++i) {
+    more.insert_unique(std::to_string(i));
+    unique.insert(std::to_string(i));
+  }
+  more.bulk_insert_unique(&keys[0], &keys[0] + keys.size());
+  EXPECT_TRUE(!more.rehashing() && same_elements(more, unique));
+
+  // the chain stays whole for later insertions & erasures
+  more.insert_unique("new");
+  unique.insert("new");
+  EXPECT_TRUE(more.erase(keys[0]) == 1 && unique.erase(keys[0]) == 1);
+  EXPECT_TRUE(same_elements(more, unique));
+
+  // an empty range
+  more.bulk_insert_unique(&keys[0], &keys[0]);
+  EXPECT_TRUE(same_elements(more, unique));
+}
+
+TEST(hashtable_bulk_insert_test, equal) {
+  std::mt19937 gen(9);
+  std::vector<int> keys;
+  for (int i = 0; i < 20000; ++i) keys.push_back((int) (gen() % 5000));
+
+  int_table ht(10, std::hash<int>(), std::equal_to<int>());
+  for (int i = 0; i < 3000; i += 3) ht.insert_equal(i);
+  std::unordered_multiset<int> expected;
+  for (int i = 0; i < 3000; i += 3) expected.insert(i);
+
+  ht.bulk_insert_equal(&keys[0], &keys[0] + keys.size());
+  expected.insert(keys.begin(), keys.end());
+  EXPECT_TRUE(same_elements(ht, expected));
+  EXPECT_TRUE(ht.load_factor() <= ht.max_load_factor());
+}
+
+TEST(hashtable_bulk_insert_test, threads) {
+  std::vector<int> keys;
+  for (int i = 0; i < (1 << 18); ++i) keys.push_back(i * 7 % 100003);
+
+  int_table ht(10, std::hash<int>(), std::equal_to<int>());
+  ht.bulk_insert_unique(&keys[0], &keys[0] + keys.size(), 4);
+  std::unordered_set<int> expected(keys.begin(), keys.end());
+  EXPECT_TRUE(same_elements(ht, expected));
+
+  int_table multi(10, std::hash<int>(), std::equal_to<int>());
+  multi.bulk_insert_equal(&keys[0], &keys[0] + keys.size(), 4);
+  std::unordered_multiset<int> all(keys.begin(), keys.end());
+  EXPECT_TRUE(same_elements(multi, all));
+}
+
+}  // namespace hashtable_bulk_insert_test
@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include "../../src/sstl_map.hpp"
+#include "transparent_keys.hpp"
 #include <utility>
 #include <string>
 
@@ -53,4 +54,40 @@ TEST(map_int_str_test, equal_range) {
 
 }
 
+namespace map_transparent_test {
 
+using transparent_keys::name;
+using transparent_keys::name_less;
+
+TEST(map_transparent_test, lookup) {
+  EXPECT_TRUE(sup::__is_transparent<name_less>::value);
+  EXPECT_FALSE(sup::__is_transparent<std::less<std::string>>::value);
+
+  sup::map<std::string, int, name_less> m;
+  m.insert(std::make_pair(std::string("apple"), 1));
+  m.insert(std::make_pair(std::string("banana"), 2));
+  m.insert(std::make_pair(std::string("cherry"), 3));
+
+  const char buffer[] = "banana split";
+  name banana = {buffer, 6}, bana = {buffer, 4};
+  EXPECT_TRUE(m.find(banana)->second == 2 && m.count(banana) == 1);
+  EXPECT_TRUE(m.find(bana) == m.end() && m.count(bana) == 0);
+  EXPECT_TRUE(m.lower_bound(bana)->first == "banana");
+  EXPECT_TRUE(m.upper_bound(banana)->first == "cherry");
+  std::pair<sup::map<std::string, int, name_less>::iterator,
+            sup::map<std::string, int, name_less>::iterator>
+    range = m.equal_range(banana);
+  EXPECT_TRUE(range.first->first == "banana" && ++range.first == range.second);
+  // keys of key_type still work
+  EXPECT_TRUE(m.find(std::string("apple"))->second == 1);
+
+  EXPECT_TRUE(m.erase(bana) == 0 && m.erase(banana) == 1 && m.size() == 2);
+  EXPECT_TRUE(m.find(banana) == m.end());
+
+  // std::less<> compares std::string with const char*
+  sup::map<std::string, int, std::less<>> fruits;
+  fruits.insert(std::make_pair(std::string("pear"), 4));
+  EXPECT_TRUE(fruits.find("pear")->second == 4 && fruits.count("plum") == 0);
+}
+
+}
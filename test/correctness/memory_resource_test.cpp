@@ -0,0 +1,226 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <functional>
+
+#include "../../src/sstl_memory_resource.hpp"
+#include "../../src/sstl_vector.hpp"
+#include "../../src/sstl_deque.hpp"
+#include "../../src/sstl_list.hpp"
+#include "../../src/sstl_forward_list.hpp"
+#include "../../src/sstl_map.hpp"
+#include "../../src/sstl_unordered_map.hpp"
+
+namespace memory_resource_test {
+
+// a resource that counts what goes through it
+class counting_resource : public sup::memory_resource {
+public:
+  size_t allocations = 0;
+  size_t deallocations = 0;
+  size_t live_bytes = 0;
+
+protected:
+  void* do_allocate(size_t bytes, size_t) override {
+    ++allocations;
+    live_bytes += bytes;
+    return std::malloc(bytes);
+  }
+  void do_deallocate(void* p, size_t bytes, size_t) override {
+    ++deallocations;
+    live_bytes -= bytes;
+    std::free(p);
+  }
+  bool do_is_equal(const sup::memory_resource& other) const override {
+    return this == &other;
+  }
+};
+
+typedef sup::polymorphic_alloc palloc;
+
+// stateless allocators take no space in containers
+TEST(memory_resource_test, stateless_allocator_takes_no_space) {
+  EXPECT_TRUE(sizeof(sup::vector<int>) == 3 * sizeof(int*));
+  EXPECT_TRUE(sizeof(sup::vector<int, palloc>) == 4 * sizeof(int*));
+}
+
+TEST(memory_resource_test, vector_uses_given_resource) {
+  counting_resource res;
+  {
+    sup::vector<int, palloc> v{palloc(&res)};
+    for (int i = 0; i < 100; ++i) {
+      v.push_back(i);
+    }
+    EXPECT_TRUE(res.allocations > 0);
+    EXPECT_TRUE(res.live_bytes == v.capacity() * sizeof(int));
+    EXPECT_TRUE(v.get_allocator().get_alloc().resource() == &res);
+
+    // copy shares the resource
+    sup::vector<int, palloc> copy(v);
+    EXPECT_TRUE(copy.get_allocator().get_alloc().resource() == &res);
+    for (int i = 0; i < 100; ++i) {
+      EXPECT_TRUE(copy[i] == i);
+    }
+  }
+  EXPECT_TRUE(res.live_bytes == 0);
+  EXPECT_TRUE(res.allocations == res.deallocations);
+}
+
+TEST(memory_resource_test, swap_exchanges_resources) {
+  counting_resource res1, res2;
+  {
+    sup::vector<int, palloc> v1{palloc(&res1)};
+    sup::vector<int, palloc> v2{palloc(&res2)};
+    v1.push_back(1);
+    v2.push_back(2);
+    v2.push_back(3);
+
+    v1.swap(v2);
+    EXPECT_TRUE(v1.get_allocator().get_alloc().resource() == &res2);
+    EXPECT_TRUE(v2.get_allocator().get_alloc().resource() == &res1);
+    // growing v2 gives memory back to the right resource
+    for (int i = 0; i < 10; ++i) {
+      v2.push_back(i);
+      v1.push_back(i);
+    }
+  }
+  EXPECT_TRUE(res1.live_bytes == 0);
+  EXPECT_TRUE(res2.live_bytes == 0);
+}
+
+TEST(memory_resource_test, containers_share_resource) {
+  counting_resource res;
+  {
+    sup::deque<int, palloc> d{palloc(&res)};
+    sup::list<int, palloc> l(&res);
+    sup::map<int, int, std::less<int>, palloc> m(std::less<int>(), &res);
+    sup::unordered_map<int, int, std::hash<int>, std::equal_to<int>, palloc>
+      um(10, std::hash<int>(), std::equal_to<int>(), &res);
+
+    for (int i = 0; i < 1000; ++i) {
+      d.push_back(i);
+      l.push_back(i);
+      m.insert(std::pair<const int, int>(i, i));
+      um.insert(std::pair<int, int>(i, i));
+    }
+    EXPECT_TRUE(res.allocations > 3 * 1000);
+    EXPECT_TRUE(l.get_allocator().resource() == &res);
+    EXPECT_TRUE(m.get_allocator().resource() == &res);
+    EXPECT_TRUE(um.get_allocator().resource() == &res);
+    EXPECT_TRUE(m.size() == 1000 && um.size() == 1000);
+  }
+  EXPECT_TRUE(res.live_bytes == 0);
+}
+
+TEST(memory_resource_test, default_resource) {
+  counting_resource res;
+  EXPECT_TRUE(sup::get_default_resource() == sup::pool_memory_resource());
+
+  sup::memory_resource* old = sup::set_default_resource(&res);
+  EXPECT_TRUE(old == sup::pool_memory_resource());
+  {
+    sup::vector<int, palloc> v;
+    v.push_back(1);
+    EXPECT_TRUE(res.allocations == 1);
+  }
+  EXPECT_TRUE(res.live_bytes == 0);
+
+  sup::set_default_resource(nullptr);
+  EXPECT_TRUE(sup::get_default_resource() == sup::pool_memory_resource());
+}
+
+TEST(memory_resource_test, allocator_equality) {
+  counting_resource res1, res2;
+  EXPECT_TRUE(palloc(&res1) == palloc(&res1));
+  EXPECT_TRUE(palloc(&res1) != palloc(&res2));
+  sup::simple_alloc<int, palloc> a1(&res1), a2(&res2);
+  EXPECT_TRUE(a1 != a2);
+  EXPECT_TRUE(sup::simple_alloc<int>() == sup::simple_alloc<int>());
+  // pool resources are interchangeable
+  sup::pool_resource pool;
+  EXPECT_TRUE(*sup::pool_memory_resource() == pool);
+}
+
+TEST(memory_resource_test, monotonic_bump_allocation) {
+  sup::monotonic_buffer_resource arena(64);
+  char* p1 = (char*) arena.allocate(10);
+  char* p2 = (char*) arena.allocate(10, 8);
+  EXPECT_TRUE(p2 >= p1 + 10 && (size_t) p2 % 8 == 0);
+  // larger than the current chunk
+  char* big = (char*) arena.allocate(10000, 64);
+  EXPECT_TRUE((size_t) big % 64 == 0);
+  for (int i = 0; i < 10000; ++i) big[i] = (char) i;
+  arena.deallocate(big, 10000);
+  arena.release();
+
+  // the initial buffer is used first and reused after release
+  alignas(16) char buffer[256];
+  sup::monotonic_buffer_resource local(buffer, sizeof(buffer));
+  char* p3 = (char*) local.allocate(100);
+  EXPECT_TRUE(p3 == buffer);
+  local.allocate(200);
+  local.release();
+  EXPECT_TRUE(local.allocate(100) == buffer);
+}
+
+typedef sup::monotonic_alloc arena_alloc;
+
+TEST(memory_resource_test, monotonic_node_containers) {
+  sup::monotonic_buffer_resource arena;
+  {
+    sup::map<int, int, std::less<int>, arena_alloc> m(std::less<int>(), &arena);
+    sup::unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+      arena_alloc> um(10, std::hash<int>(), std::equal_to<int>(), &arena);
+    sup::list<int, arena_alloc> l(&arena);
+    sup::forward_list<int, arena_alloc> fl(&arena);
+
+    for (int round = 0; round < 3; ++round) {
+      for (int i = 0; i < 1000; ++i) {
+        m.insert(std::pair<const int, int>(i, i));
+        um.insert(std::pair<int, int>(i, i));
+        l.push_back(i);
+        fl.push_front(i);
+      }
+      EXPECT_TRUE(m.size() == 1000 && um.size() == 1000);
+      EXPECT_TRUE(l.size() == 1000 && fl.size() == 1000);
+      EXPECT_TRUE(m.find(500)->second == 500);
+      EXPECT_TRUE(um.find(500)->second == 500);
+      EXPECT_TRUE(l.back() == 999 && fl.front() == 999);
+
+      m.clear();
+      um.clear();
+      l.clear();
+      fl.clear();
+      EXPECT_TRUE(m.empty() && um.empty() && l.empty() && fl.empty());
+      EXPECT_TRUE(m.begin() == m.end() && um.begin() == um.end());
+    }
+  }
+  arena.release();
+}
+
+class counted {
+public:
+  static int alive;
+  int value;
+  counted(int v) : value(v) { ++alive; }
+  counted(const counted& c) : value(c.value) { ++alive; }
+  ~counted() { --alive; }
+};
+int counted::alive = 0;
+
+// values with destructors are still destroyed one by one
+TEST(memory_resource_test, monotonic_non_trivial_values) {
+  sup::monotonic_buffer_resource arena;
+  {
+    sup::list<counted, arena_alloc> l(&arena);
+    for (int i = 0; i < 100; ++i) {
+      l.push_back(counted(i));
+    }
+    EXPECT_TRUE(counted::alive == 100);
+    l.clear();
+    EXPECT_TRUE(counted::alive == 0);
+    l.push_back(counted(1));
+  }
+  EXPECT_TRUE(counted::alive == 0);
+}
+
+}  // namespace memory_resource_test
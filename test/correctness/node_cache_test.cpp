@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+#include <functional>
+
+#include "../../src/sstl_alloc_telemetry.hpp"
+#include "../../src/sstl_list.hpp"
+#include "../../src/sstl_map.hpp"
+#include "../../src/sstl_set.hpp"
+#include "../../src/sstl_unordered_map.hpp"
+
+namespace node_cache_test {
+
+struct map_tag {};
+struct list_tag {};
+struct hash_tag {};
+
+typedef sup::telemetry_alloc<sup::alloc, map_tag> map_alloc;
+typedef sup::telemetry_alloc<sup::alloc, list_tag> list_alloc;
+typedef sup::telemetry_alloc<sup::alloc, hash_tag> hash_alloc;
+
+typedef sup::map<int, int, std::less<int>, map_alloc> counted_map;
+typedef sup::list<int, list_alloc> counted_list;
+typedef sup::unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+                           hash_alloc> counted_unordered_map;
+
+TEST(node_cache_test, cache_push_pop) {
+  struct node { void* next; int val; };
+  sup::_node_cache<node> cache;
+  EXPECT_TRUE(cache.size() == 0 && cache.pop() == nullptr);
+  EXPECT_TRUE(cache.max_size() == __SSTL_NODE_CACHE_SIZE);
+
+  cache.max_size(2);
+  node a, b, c;
+  EXPECT_TRUE(cache.push(&a) && cache.push(&b));
+  EXPECT_TRUE(!cache.push(&c));
+  EXPECT_TRUE(cache.size() == 2);
+  EXPECT_TRUE(cache.pop() == &b && cache.pop() == &a);
+  EXPECT_TRUE(cache.pop() == nullptr);
+}
+
+// erase & insert churn is served by the spare nodes
+TEST(node_cache_test, map_churn_reuses_nodes) {
+  counted_map m;
+  for (int i = 0; i < 32; ++i) {
+    m.insert(std::pair<const int, int>(i, i));
+  }
+  sup::alloc_telemetry<map_tag>::reset();
+  for (int round = 0; round < 100; ++round) {
+    for (int i = 0; i < 32; ++i) m.erase(i);
+    for (int i = 0; i < 32; ++i) m.insert(std::pair<const int, int>(i, round));
+  }
+  sup::alloc_stats_snapshot s = sup::alloc_telemetry<map_tag>::snapshot();
+  EXPECT_TRUE(s.allocations == 0 && s.deallocations == 0);
+  EXPECT_TRUE(m.size() == 32 && m.find(7)->second == 99);
+}
+
+TEST(node_cache_test, map_assignment_reuses_nodes) {
+  counted_map m1, m2;
+  for (int i = 0; i < 100; ++i) {
+    m1.insert(std::pair<const int, int>(i, i));
+    m2.insert(std::pair<const int, int>(-i, -i));
+  }
+  sup::alloc_telemetry<map_tag>::reset();
+  m2 = m1;
+  sup::alloc_stats_snapshot s = sup::alloc_telemetry<map_tag>::snapshot();
+  EXPECT_TRUE(s.allocations == 0 && s.deallocations == 0);
+
+  EXPECT_TRUE(m2.size() == 100);
+  int expected = 0;
+  for (counted_map::iterator it = m2.begin(); it != m2.end(); ++it) {
+    EXPECT_TRUE(it->first == expected && it->second == expected);
+    ++expected;
+  }
+  EXPECT_TRUE(m1.size() == 100 && m1.find(42)->second == 42);
+
+  m2 = m2;
+  EXPECT_TRUE(m2.size() == 100);
+}
+
+TEST(node_cache_test, set_assignment) {
+  sup::set<int> s1, s2;
+  for (int i = 0; i < 50; ++i) {
+    s1.insert(i);
+  }
+  s2.insert(1000);
+  s2 = s1;
+  EXPECT_TRUE(s2.size() == 50);
+  EXPECT_TRUE(*s2.begin() == 0 && s2.find(1000) == s2.end());
+}
+
+TEST(node_cache_test, reserve_nodes_and_shrink) {
+  counted_map m;
+  sup::alloc_telemetry<map_tag>::reset();
+  m.reserve_nodes(200);
+  EXPECT_TRUE(m.max_spare_nodes() == 200);
+  sup::alloc_stats_snapshot s = sup::alloc_telemetry<map_tag>::snapshot();
+  EXPECT_TRUE(s.allocations == 200);
+
+  for (int i = 0; i < 200; ++i) {
+    m.insert(std::pair<const int, int>(i, i));
+  }
+  s = sup::alloc_telemetry<map_tag>::snapshot();
+  EXPECT_TRUE(s.allocations == 200);
+
+  m.clear();
+  m.shrink_to_fit();
+  s = sup::alloc_telemetry<map_tag>::snapshot();
+  EXPECT_TRUE(s.deallocations == 200);
+
+  // no spare node is kept when the cache is disabled
+  m.max_spare_nodes(0);
+  m.insert(std::pair<const int, int>(1, 1));
+  m.erase(1);
+  s = sup::alloc_telemetry<map_tag>::snapshot();
+  EXPECT_TRUE(s.allocations == 201 && s.deallocations == 201);
+}
+
+TEST(node_cache_test, list_reuses_nodes) {
+  counted_list l;
+  for (int i = 0; i < 10; ++i) {
+    l.push_back(i);
+  }
+  sup::alloc_telemetry<list_tag>::reset();
+  for (int round = 0; round < 100; ++round) {
+    l.pop_front();
+    l.push_back(round);
+  }
+  sup::alloc_stats_snapshot s = sup::alloc_telemetry<list_tag>::snapshot();
+  EXPECT_TRUE(s.allocations == 0 && s.deallocations == 0);
+  EXPECT_TRUE(l.size() == 10 && l.front() == 90 && l.back() == 99);
+
+  l.clear();
+  EXPECT_TRUE(l.spare_nodes_count() == 10);
+  l.shrink_to_fit();
+  EXPECT_TRUE(l.spare_nodes_count() == 0);
+
+  l.reserve_nodes(20);
+  sup::alloc_telemetry<list_tag>::reset();
+  for (int i = 0; i < 20; ++i) {
+    l.push_front(i);
+  }
+  s = sup::alloc_telemetry<list_tag>::snapshot();
+  EXPECT_TRUE(s.allocations == 0);
+}
+
+TEST(node_cache_test, unordered_map_reuses_nodes) {
+  counted_unordered_map m(100, std::hash<int>(), std::equal_to<int>());
+  for (int i = 0; i < 50; ++i) {
+    m.insert(std::pair<int, int>(i, i));
+  }
+  sup::alloc_telemetry<hash_tag>::reset();
+  for (int round = 0; round < 10; ++round) {
+    m.clear();
+    for (int i = 0; i < 50; ++i) m.insert(std::pair<int, int>(i, round));
+  }
+  sup::alloc_stats_snapshot s = sup::alloc_telemetry<hash_tag>::snapshot();
+  EXPECT_TRUE(s.allocations == 0 && s.deallocations == 0);
+  EXPECT_TRUE(m.size() == 50 && m.find(20)->second == 9);
+}
+
+TEST(node_cache_test, unordered_map_assignment) {
+  counted_unordered_map m1(10, std::hash<int>(), std::equal_to<int>());
+  counted_unordered_map m2(10, std::hash<int>(), std::equal_to<int>());
+  for (int i = 0; i < 40; ++i) {
+    m1.insert(std::pair<int, int>(i, 2 * i));
+    m2.insert(std::pair<int, int>(i + 100, i));
+  }
+  sup::alloc_telemetry<hash_tag>::reset();
+  m2 = m1;
+  sup::alloc_stats_snapshot s = sup::alloc_telemetry<hash_tag>::snapshot();
+  EXPECT_TRUE(s.allocations == 0 && s.deallocations == 0);
+  EXPECT_TRUE(m2.size() == 40);
+  for (int i = 0; i < 40; ++i) {
+    EXPECT_TRUE(m2.find(i)->second == 2 * i);
+    EXPECT_TRUE(m2.find(i + 100) == m2.end());
+  }
+
+  // a copy owns its nodes
+  counted_unordered_map m3(m1);
+  m1.clear();
+  EXPECT_TRUE(m3.size() == 40 && m3.find(39)->second == 78);
+}
+
+}  // namespace node_cache_test
@@ -401,4 +401,17 @@ TEST(rb_tree_int_str_test, equal_equal_operator_overloading) {
 
   EXPECT_TRUE(t1 == t2);
 }
-}
\ No newline at end of file
+}
+namespace rb_tree_find_test {
+
+TEST(rb_tree_find_test, absent_key) {
+  sup::rb_tree<int, int, std::_Identity<int>, std::less<int>> t;
+  for (int i = 0; i < 10; i += 2) {
+    t.insert_unique(i);
+  }
+  // the next key is not a match
+  EXPECT_TRUE(t.find(3) == t.end() && t.find(11) == t.end());
+  EXPECT_TRUE(*t.find(4) == 4 && t.erase(3) == 0 && t.size() == 5);
+}
+
+}
@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 
 #include "../../src/sstl_set.hpp"
+#include "transparent_keys.hpp"
+#include <string>
 
 // As most of the methods are wrapper methods for 
 // the RB tree, the test is mainly to ensure successfuly 
@@ -50,4 +52,29 @@ TEST(set_int_test, insert) {
   }
   EXPECT_TRUE(s.size() == n);
 }
-}
\ No newline at end of file
+}
+
+namespace set_transparent_test {
+
+using transparent_keys::name;
+using transparent_keys::name_less;
+
+TEST(set_transparent_test, lookup) {
+  sup::set<std::string, name_less> s;
+  s.insert("apple");
+  s.insert("banana");
+  s.insert("cherry");
+
+  const char buffer[] = "cherry pie";
+  name cherry = {buffer, 6}, cher = {buffer, 4};
+  EXPECT_TRUE(*s.find(cherry) == "cherry" && s.count(cherry) == 1);
+  EXPECT_TRUE(s.find(cher) == s.end() && s.count(cher) == 0);
+  EXPECT_TRUE(*s.lower_bound(cher) == "cherry");
+  EXPECT_TRUE(s.upper_bound(cherry) == s.end());
+  EXPECT_TRUE(s.equal_range(cher).first == s.equal_range(cher).second);
+
+  EXPECT_TRUE(s.erase(cherry) == 1 && s.size() == 2 && s.count(cherry) == 0);
+  EXPECT_TRUE(s.erase(std::string("apple")) == 1 && s.size() == 1);
+}
+
+}
@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+#include <string>
+
+#include "../../src/sstl_alloc_telemetry.hpp"
+#include "../../src/sstl_small_vector.hpp"
+
+namespace small_vector_test {
+
+struct small_tag {};
+typedef sup::telemetry_alloc<sup::alloc, small_tag> counted_alloc;
+
+TEST(small_vector_test, inline_until_overflow) {
+  sup::alloc_telemetry<small_tag>::reset();
+  {
+    sup::small_vector<int, 4, counted_alloc> vec;
+    EXPECT_TRUE(vec.empty() && vec.capacity() == 4 && vec.is_inline());
+    for (int i = 0; i < 4; ++i) {
+      vec.push_back(i);
+    }
+    EXPECT_TRUE(vec.is_inline());
+    EXPECT_TRUE(sup::alloc_telemetry<small_tag>::snapshot().allocations == 0);
+
+    vec.push_back(4);
+    EXPECT_TRUE(!vec.is_inline() && vec.capacity() >= 8);
+    EXPECT_TRUE(sup::alloc_telemetry<small_tag>::snapshot().allocations == 1);
+    for (int i = 0; i < 5; ++i) {
+      EXPECT_TRUE(vec[i] == i);
+    }
+
+    // the heap block is kept
+    vec.clear();
+    EXPECT_TRUE(vec.empty() && !vec.is_inline());
+  }
+  sup::alloc_stats_snapshot s = sup::alloc_telemetry<small_tag>::snapshot();
+  EXPECT_TRUE(s.live_bytes == 0 && s.deallocations == 1);
+}
+
+TEST(small_vector_test, constructors) {
+  sup::small_vector<int, 4> vec1(3, 7);
+  EXPECT_TRUE(vec1.size() == 3 && vec1.is_inline() && vec1[2] == 7);
+
+  sup::small_vector<int, 4> vec2(10);
+  EXPECT_TRUE(vec2.size() == 10 && !vec2.is_inline() && vec2[9] == 0);
+
+  int array[6] = {0, 1, 2, 3, 4, 5};
+  sup::small_vector<int, 4> vec3(array, array + 6);
+  EXPECT_TRUE(vec3.size() == 6 && vec3[5] == 5);
+
+  sup::small_vector<int, 4> vec4(vec3);
+  EXPECT_TRUE(vec4.size() == 6 && vec4[3] == 3);
+  vec4 = vec1;
+  EXPECT_TRUE(vec4.size() == 3 && vec4[0] == 7);
+}
+
+TEST(small_vector_test, insert_and_erase) {
+  sup::small_vector<std::string, 4> vec;
+  vec.push_back("b");
+  vec.insert(vec.begin(), "a");
+  vec.emplace_back(2, 'd');
+  sup::small_vector<std::string, 4>::iterator it =
+      vec.emplace(vec.begin() + 2, "c");
+  EXPECT_TRUE(it == vec.begin() + 2 && *it == "c");
+  EXPECT_TRUE(vec.is_inline() && vec.size() == 4);
+
+  // overflows in the middle
+  vec.insert(vec.begin() + 1, 2, vec[0]);
+  EXPECT_TRUE(!vec.is_inline() && vec.size() == 6);
+  std::string expected[6] = {"a", "a", "a", "b", "c", "dd"};
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_TRUE(vec[i] == expected[i]);
+  }
+
+  std::string more[2] = {"x", "y"};
+  vec.insert(vec.end(), more, more + 2);
+  vec.erase(vec.begin(), vec.begin() + 2);
+  vec.erase(vec.begin() + 1);
+  EXPECT_TRUE(vec.size() == 5);
+  EXPECT_TRUE(vec[0] == "a" && vec[1] == "c" && vec.back() == "y");
+
+  vec.resize(2);
+  EXPECT_TRUE(vec.size() == 2 && vec[1] == "c");
+  vec.resize(3, "z");
+  EXPECT_TRUE(vec[2] == "z");
+  vec.pop_back();
+  EXPECT_TRUE(vec.size() == 2 && vec.front() == "a");
+}
+
+TEST(small_vector_test, push_back_own_element) {
+  sup::small_vector<std::string, 2> vec;
+  vec.push_back(std::string(50, 'a'));
+  for (int i = 0; i < 10; ++i) {
+    vec.push_back(vec.back());  // the argument lives in the old buffer
+  }
+  EXPECT_TRUE(vec.size() == 11);
+  for (size_t i = 0; i < vec.size(); ++i) {
+    EXPECT_TRUE(vec[i] == std::string(50, 'a'));
+  }
+}
+
+TEST(small_vector_test, move) {
+  sup::small_vector<std::string, 4> small;
+  small.push_back("inline");
+  sup::small_vector<std::string, 4> large;
+  for (int i = 0; i < 10; ++i) {
+    large.push_back(std::to_string(i));
+  }
+  const std::string* data = &large[0];
+
+  // a heap block is handed over
+  sup::small_vector<std::string, 4> moved_large(std::move(large));
+  EXPECT_TRUE(&moved_large[0] == data && moved_large.size() == 10);
+  EXPECT_TRUE(large.empty() && large.is_inline());
+
+  // inline elements are relocated
+  sup::small_vector<std::string, 4> moved_small(std::move(small));
+  EXPECT_TRUE(moved_small.is_inline() && moved_small[0] == "inline");
+  EXPECT_TRUE(small.empty());
+
+  moved_small = std::move(moved_large);
+  EXPECT_TRUE(&moved_small[0] == data && moved_large.empty());
+  moved_large = std::move(moved_small);
+  EXPECT_TRUE(&moved_large[0] == data && moved_large[9] == "9");
+}
+
+TEST(small_vector_test, swap) {
+  typedef sup::small_vector<std::string, 4> vector_type;
+  vector_type a, b, heap1, heap2;
+  a.push_back("a1");
+  a.push_back("a2");
+  a.push_back("a3");
+  b.push_back("b1");
+  for (int i = 0; i < 6; ++i) {
+    heap1.push_back("h" + std::to_string(i));
+    heap2.push_back("g" + std::to_string(i));
+  }
+
+  // both inline, of different sizes
+  a.swap(b);
+  EXPECT_TRUE(a.size() == 1 && a[0] == "b1");
+  EXPECT_TRUE(b.size() == 3 && b[0] == "a1" && b[2] == "a3");
+  EXPECT_TRUE(a.is_inline() && b.is_inline());
+
+  // inline & heap
+  const std::string* data = &heap1[0];
+  b.swap(heap1);
+  EXPECT_TRUE(&b[0] == data && b.size() == 6 && !b.is_inline());
+  EXPECT_TRUE(heap1.is_inline() && heap1.size() == 3 && heap1[1] == "a2");
+  heap1.swap(b);
+  EXPECT_TRUE(&heap1[0] == data && b.is_inline() && b[2] == "a3");
+
+  // both on the heap
+  heap1.swap(heap2);
+  EXPECT_TRUE(heap1[0] == "g0" && heap2[0] == "h0" && &heap2[0] == data);
+}
+
+TEST(small_vector_test, reserve) {
+  sup::small_vector<int, 8> vec;
+  vec.reserve(8);
+  EXPECT_TRUE(vec.is_inline());
+  vec.push_back(1);
+  vec.reserve(100);
+  EXPECT_TRUE(!vec.is_inline() && vec.capacity() == 100 && vec[0] == 1);
+}
+
+TEST(small_vector_test, shrink_to_fit) {
+  sup::small_vector<std::string, 4> vec;
+  for (int i = 0; i < 20; ++i) {
+    vec.push_back(std::to_string(i));
+  }
+  EXPECT_TRUE(vec.memory_usage() == vec.capacity() * sizeof(std::string));
+  vec.erase(vec.begin() + 6, vec.end());
+  vec.shrink_to_fit();
+  EXPECT_TRUE(vec.capacity() == 6 && vec[5] == "5");
+
+  // back to the inline buffer
+  vec.erase(vec.begin() + 3, vec.end());
+  vec.shrink_to_fit();
+  EXPECT_TRUE(vec.is_inline() && vec.memory_usage() == 0);
+  EXPECT_TRUE(vec.size() == 3 && vec[0] == "0" && vec[2] == "2");
+}
+
+TEST(small_vector_test, resize_for_overwrite) {
+  sup::small_vector<int, 4> vec;
+  vec.resize(3);
+  EXPECT_TRUE(vec.is_inline() && vec[2] == 0);
+  vec[2] = 7;
+  vec.resize(2);
+  vec.resize_for_overwrite(3);
+  EXPECT_TRUE(vec.size() == 3 && vec[2] == 7);
+
+  int* it = vec.append_uninitialized(10);
+  EXPECT_TRUE(!vec.is_inline() && vec.size() == 13 && it == &vec[3]);
+  EXPECT_TRUE(vec[2] == 7);
+}
+
+}  // namespace small_vector_test
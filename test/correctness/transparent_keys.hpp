@@ -0,0 +1,57 @@
+#ifndef _SSTL_TRANSPARENT_KEYS_H
+#define _SSTL_TRANSPARENT_KEYS_H
+
+#include <cstddef>
+#include <string>
+
+// Function objects for the heterogeneous lookup tests: std::string keys
+// looked up from a name, a key in a buffer that is not convertible to
+// std::string.
+
+namespace transparent_keys {
+
+struct name {
+  const char* data;
+  size_t size;
+};
+
+struct name_less {
+  typedef void is_transparent;
+  bool operator()(const std::string& a, const std::string& b) const {
+    return a < b;
+  }
+  bool operator()(const std::string& a, const name& b) const {
+    return a.compare(0, a.size(), b.data, b.size) < 0;
+  }
+  bool operator()(const name& a, const std::string& b) const {
+    return b.compare(0, b.size(), a.data, a.size) > 0;
+  }
+};
+
+// FNV-1a of the characters, for both key types
+struct name_hash {
+  typedef void is_transparent;
+  static size_t hash(const char* p, size_t n) {
+    size_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < n; ++i) {
+      h = (h ^ (unsigned char) p[i]) * 1099511628211ull;
+    }
+    return h;
+  }
+  size_t operator()(const std::string& s) const { return hash(s.data(), s.size()); }
+  size_t operator()(const name& s) const { return hash(s.data, s.size); }
+};
+
+struct name_equal {
+  typedef void is_transparent;
+  bool operator()(const std::string& a, const std::string& b) const {
+    return a == b;
+  }
+  bool operator()(const std::string& a, const name& b) const {
+    return a.compare(0, a.size(), b.data, b.size) == 0;
+  }
+};
+
+}  // namespace transparent_keys
+
+#endif
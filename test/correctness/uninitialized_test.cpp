@@ -83,4 +83,64 @@ TEST(uninitialized_fill_n, write_to_string_array) {
     EXPECT_TRUE(s[i] == "abc");
   }
 }
-}
\ No newline at end of file
+TEST(uninitialized_relocate, overlapping_ints) {
+  int array[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  // shift right by two
+  EXPECT_TRUE(sup::uninitialized_relocate(array, array + 8, array + 2) ==
+              array + 10);
+  for (int i = 2; i < 10; ++i) {
+    EXPECT_TRUE(array[i] == i - 2);
+  }
+}
+
+TEST(uninitialized_relocate, string_array) {
+  std::vector<std::string> from(10, std::string(100, 'a'));
+  std::allocator<std::string> a;
+  std::string* to = a.allocate(10);
+
+  // std::string is not trivially relocatable: move and destroy
+  EXPECT_TRUE(sup::uninitialized_relocate(&from[0], &from[0] + 10, to) ==
+              to + 10);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(to[i] == std::string(100, 'a'));
+    // give the vector objects to destroy again
+    new (&from[i]) std::string();
+  }
+  sup::_destroy(to, to + 10);
+  a.deallocate(to, 10);
+}
+
+TEST(uninitialized_default_construct, int_and_string_arrays) {
+  int array[4] = {1, 2, 3, 4};
+  // nothing is written to trivial elements
+  EXPECT_TRUE(sup::uninitialized_default_construct_n(array, 4) == array + 4);
+  sup::uninitialized_default_construct(array, array + 4);
+  EXPECT_TRUE(array[0] == 1 && array[3] == 4);
+
+  std::allocator<std::string> a;
+  std::string* s = a.allocate(10);
+  EXPECT_TRUE(sup::uninitialized_default_construct_n(s, 10) == s + 10);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(s[i].empty());
+  }
+  sup::_destroy(s, s + 10);
+  a.deallocate(s, 10);
+}
+
+TEST(uninitialized_value_construct, int_and_string_arrays) {
+  int array[4] = {1, 2, 3, 4};
+  EXPECT_TRUE(sup::uninitialized_value_construct_n(array, 2) == array + 2);
+  EXPECT_TRUE(array[0] == 0 && array[1] == 0 && array[2] == 3);
+  sup::uninitialized_value_construct(array + 2, array + 4);
+  EXPECT_TRUE(array[2] == 0 && array[3] == 0);
+
+  std::allocator<std::string> a;
+  std::string* s = a.allocate(10);
+  sup::uninitialized_value_construct(s, s + 10);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(s[i].empty());
+  }
+  sup::_destroy(s, s + 10);
+  a.deallocate(s, 10);
+}
+}
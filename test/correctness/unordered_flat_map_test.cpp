@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include <map>
+#include <string>
+#include <type_traits>
+
+#include "../../src/sstl_unordered_flat_map.hpp"
+
+namespace unordered_flat_map_test {
+
+// every key in the same group: probes pass full groups, erasures leave
+// tombstones
+struct constant_hash {
+  size_t operator()(int) const { return 0; }
+};
+
+TEST(unordered_flat_map_test, construct) {
+  sup::unordered_flat_map<int, std::string> mp1;
+  EXPECT_TRUE(mp1.size() == 0 && mp1.bucket_count() == 0);
+  EXPECT_TRUE(mp1.begin() == mp1.end() && mp1.find(3) == mp1.end());
+
+  std::string strings[] = {"123", "456", "789", "111"};
+  std::pair<int, std::string> pairs[4];
+  for (int i = 0; i < 4; ++i) {
+    pairs[i] = std::make_pair(i, strings[i]);
+  }
+  sup::unordered_flat_map<int, std::string> mp2(pairs, pairs + 4);
+  EXPECT_TRUE(mp2.size() == 4 && mp2.bucket_count() == 16);
+  EXPECT_TRUE(mp2.find(2)->second == "789");
+
+  sup::unordered_flat_map<int, std::string> mp3(mp2);
+  EXPECT_TRUE(mp3.size() == 4 && mp3.find(3)->second == "111");
+  static_assert(std::is_nothrow_move_constructible<
+                    sup::unordered_flat_map<int, std::string>>::value,
+                "moving a table allocates nothing");
+  sup::unordered_flat_map<int, std::string> mp4(std::move(mp3));
+  EXPECT_TRUE(mp4.size() == 4 && mp3.empty() && mp3.find(3) == mp3.end());
+  mp1 = mp4;
+  EXPECT_TRUE(mp1.size() == 4 && mp1.count(0) == 1);
+}
+
+TEST(unordered_flat_map_test, insert_and_find) {
+  sup::unordered_flat_map<int, std::string> mp;
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_TRUE(mp.insert(std::make_pair(i, std::to_string(i))).second);
+  }
+  std::pair<sup::unordered_flat_map<int, std::string>::iterator, bool> result =
+      mp.insert(std::make_pair(7, "seven"));
+  EXPECT_TRUE(!result.second && result.first->second == "7");
+  EXPECT_TRUE(mp.size() == 1000 && mp.load_factor() <= mp.max_load_factor());
+
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_TRUE(mp.find(i) != mp.end() && mp.find(i)->second == std::to_string(i));
+  }
+  EXPECT_TRUE(mp.find(1000) == mp.end() && !mp.contains(-1));
+
+  size_t visited = 0;
+  long long sum = 0;
+  for (sup::unordered_flat_map<int, std::string>::iterator it = mp.begin();
+       it != mp.end(); ++it) {
+    ++visited;
+    sum += it->first;
+  }
+  EXPECT_TRUE(visited == 1000 && sum == 999 * 1000 / 2);
+
+  mp[5] = "five";
+  mp[2000] += "new";
+  EXPECT_TRUE(mp[5] == "five" && mp.find(2000)->second == "new");
+  EXPECT_TRUE(mp.size() == 1001);
+}
+
+TEST(unordered_flat_map_test, erase) {
+  sup::unordered_flat_map<int, int> mp;
+  for (int i = 0; i < 100; ++i) mp[i] = i * i;
+  EXPECT_TRUE(mp.erase(50) == 1 && mp.erase(50) == 0);
+  EXPECT_TRUE(mp.size() == 99 && mp.find(50) == mp.end());
+
+  mp.erase(mp.find(10));
+  mp.erase(mp.begin(), mp.end());
+  EXPECT_TRUE(mp.empty() && mp.begin() == mp.end());
+
+  // slots are reused
+  size_t slots = mp.bucket_count();
+  for (int i = 0; i < 100; ++i) mp[i] = i;
+  EXPECT_TRUE(mp.bucket_count() == slots && mp[99] == 99);
+  mp.clear();
+  EXPECT_TRUE(mp.empty() && mp.bucket_count() == slots);
+}
+
+TEST(unordered_flat_map_test, tombstones) {
+  sup::unordered_flat_map<int, std::string, constant_hash> mp;
+  std::map<int, std::string> expected;
+  // 40 keys fill the first two groups of the probe sequence
+  for (int i = 0; i < 40; ++i) {
+    mp[i] = std::to_string(i);
+    expected[i] = std::to_string(i);
+  }
+  // keys of the full groups become tombstones; lookups go past them
+  for (int i = 0; i < 40; i += 3) {
+    EXPECT_TRUE(mp.erase(i) == 1);
+    expected.erase(i);
+  }
+  for (int i = 0; i < 40; ++i) {
+    EXPECT_TRUE(mp.count(i) == expected.count(i));
+  }
+  // churn: the tombstones are reused or dropped by rehashing in place
+  for (int round = 0; round < 50; ++round) {
+    int key = 100 + round;
+    mp[key] = "x";
+    mp.erase(key - 1);
+    expected[key] = "x";
+    expected.erase(key - 1);
+  }
+  EXPECT_TRUE(mp.size() == expected.size());
+  for (std::map<int, std::string>::iterator it = expected.begin();
+       it != expected.end(); ++it) {
+    EXPECT_TRUE(mp.find(it->first) != mp.end() && mp[it->first] == it->second);
+  }
+}
+
+TEST(unordered_flat_map_test, capacity) {
+  sup::unordered_flat_map<int, int> mp;
+  mp.reserve(1000);
+  size_t slots = mp.bucket_count();
+  EXPECT_TRUE(slots == 2048 && mp.memory_usage() == slots * (sizeof(std::pair<int, int>) + 1) + 1);
+  for (int i = 0; i < 1000; ++i) mp[i] = i;
+  EXPECT_TRUE(mp.bucket_count() == slots);
+
+  mp.rehash(5000);
+  EXPECT_TRUE(mp.bucket_count() == 8192 && mp[999] == 999);
+
+  for (int i = 10; i < 1000; ++i) mp.erase(i);
+  mp.shrink_to_fit();
+  EXPECT_TRUE(mp.bucket_count() == 16 && mp.size() == 10 && mp[9] == 9);
+  mp.clear();
+  mp.shrink_to_fit();
+  EXPECT_TRUE(mp.bucket_count() == 0 && mp.memory_usage() == 0);
+  mp[1] = 1;
+  EXPECT_TRUE(mp.size() == 1);
+}
+
+}  // namespace unordered_flat_map_test
@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+#include <set>
+#include <string>
+
+#include "../../src/sstl_unordered_flat_set.hpp"
+
+namespace unordered_flat_set_test {
+
+TEST(unordered_flat_set_test, insert_find_erase) {
+  std::string strings[] = {"a", "b", "c", "a"};
+  sup::unordered_flat_set<std::string> st(strings, strings + 4);
+  EXPECT_TRUE(st.size() == 3 && st.count("a") == 1 && st.count("d") == 0);
+
+  std::pair<sup::unordered_flat_set<std::string>::iterator, bool> result =
+      st.insert("d");
+  EXPECT_TRUE(result.second && *result.first == "d");
+  EXPECT_TRUE(!st.insert("b").second && st.size() == 4);
+
+  EXPECT_TRUE(st.erase("a") == 1 && st.erase("a") == 0);
+  st.erase(st.find("b"));
+  EXPECT_TRUE(st.size() == 2 && st.contains("c") && !st.contains("b"));
+}
+
+TEST(unordered_flat_set_test, random_operations) {
+  sup::unordered_flat_set<int> st;
+  std::set<int> expected;
+  unsigned x = 12345;
+  for (int i = 0; i < 20000; ++i) {
+    x = x * 1103515245u + 12345u;
+    int key = (int) ((x >> 8) % 3000);
+    if ((x >> 4) & 1) {
+      EXPECT_TRUE(st.insert(key).second == expected.insert(key).second);
+    } else {
+      EXPECT_TRUE(st.erase(key) == expected.erase(key));
+    }
+  }
+  EXPECT_TRUE(st.size() == expected.size());
+  size_t visited = 0;
+  for (sup::unordered_flat_set<int>::iterator it = st.begin(); it != st.end();
+       ++it) {
+    EXPECT_TRUE(expected.count(*it) == 1);
+    ++visited;
+  }
+  EXPECT_TRUE(visited == expected.size());
+}
+
+TEST(unordered_flat_set_test, swap) {
+  int a[] = {1, 2, 3};
+  int b[] = {4};
+  sup::unordered_flat_set<int> s1(a, a + 3), s2(b, b + 1);
+  s1.swap(s2);
+  EXPECT_TRUE(s1.size() == 1 && s1.count(4) == 1);
+  EXPECT_TRUE(s2.size() == 3 && s2.count(2) == 1);
+}
+
+}  // namespace unordered_flat_set_test
@@ -1,7 +1,10 @@
 #include <gtest/gtest.h>
+#include <map>
+#include <random>
 #include <string>
 
 #include "../../src/sstl_unordered_map.hpp"
+#include "transparent_keys.hpp"
 
 namespace unordered_map_int_string_test {
 
@@ -74,4 +77,57 @@ TEST(unordered_map_int_string_test, erase) {
   }
 }
 
-}
\ No newline at end of file
+TEST(unordered_map_int_string_test, index_operator) {
+  // operator[] mixed with erasures, checked against std::map
+  std::mt19937 gen(3);
+  sup::unordered_map<int, std::string> mp;
+  std::map<int, std::string> expected;
+  for (int round = 0; round < 20000; ++round) {
+    int key = (int) (gen() % 500);
+    if (gen() % 4 == 0) {
+      EXPECT_TRUE(mp.erase(key) == expected.erase(key));
+    } else {
+      mp[key] += 'a';
+      expected[key] += 'a';
+    }
+  }
+  EXPECT_TRUE(mp.size() == expected.size());
+  for (std::map<int, std::string>::iterator it = expected.begin();
+       it != expected.end(); ++it) {
+    EXPECT_TRUE(mp.find(it->first) != mp.end() && mp[it->first] == it->second);
+  }
+  EXPECT_TRUE(mp.size() == expected.size());
+}
+
+}
+
+namespace unordered_map_transparent_test {
+
+using transparent_keys::name;
+using transparent_keys::name_hash;
+using transparent_keys::name_equal;
+
+TEST(unordered_map_transparent_test, lookup) {
+  typedef sup::unordered_map<std::string, int, name_hash, name_equal> map_type;
+  map_type mp;
+  for (int i = 0; i < 100; ++i) {
+    mp.insert(std::make_pair("key" + std::to_string(i), i));
+  }
+
+  const char buffer[] = "key42key7";
+  name key42 = {buffer, 5}, key4 = {buffer, 4};
+  EXPECT_TRUE(mp.find(key42)->second == 42 && mp.count(key42) == 1);
+  EXPECT_TRUE(mp.find(key4)->second == 4);
+  name absent = {buffer + 3, 4};  // "42ke"
+  EXPECT_TRUE(mp.find(absent) == mp.end() && mp.count(absent) == 0);
+  const map_type& const_mp = mp;
+  EXPECT_TRUE(const_mp.find(key42)->first == "key42");
+  std::pair<map_type::iterator, map_type::iterator> range = mp.equal_range(key42);
+  EXPECT_TRUE(range.first->second == 42 && ++range.first == range.second);
+
+  EXPECT_TRUE(mp.erase(absent) == 0 && mp.erase(key42) == 1);
+  EXPECT_TRUE(mp.size() == 99 && mp.count(key42) == 0);
+  EXPECT_TRUE(mp.erase(std::string("key7")) == 1 && mp.size() == 98);
+}
+
+}
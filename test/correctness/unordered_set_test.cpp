@@ -2,6 +2,7 @@
 #include <string>
 
 #include "../../src/sstl_unordered_set.hpp"
+#include "transparent_keys.hpp"
 
 namespace unordered_set_string_test {
 
@@ -53,4 +54,31 @@ TEST(unordered_set_string_test, erase) {
   }
 }
 
-}
\ No newline at end of file
+}
+
+namespace unordered_set_transparent_test {
+
+using transparent_keys::name;
+using transparent_keys::name_hash;
+using transparent_keys::name_equal;
+
+TEST(unordered_set_transparent_test, lookup) {
+  sup::unordered_set<std::string, name_hash, name_equal> set;
+  set.incremental_rehash(true);
+  for (int i = 0; i < 1000; ++i) {
+    set.insert(std::to_string(i));
+  }
+
+  const char buffer[] = "9876";
+  for (size_t n = 1; n <= 3; ++n) {
+    name key = {buffer, n};
+    EXPECT_TRUE(set.count(key) == 1 && *set.find(key) == std::string(buffer, n));
+  }
+  name absent = {buffer, 4};
+  EXPECT_TRUE(set.find(absent) == set.end() && set.erase(absent) == 0);
+
+  name key = {buffer, 2};
+  EXPECT_TRUE(set.erase(key) == 1 && set.count(key) == 0 && set.size() == 999);
+}
+
+}
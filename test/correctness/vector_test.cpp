@@ -1,4 +1,6 @@
 #include <gtest/gtest.h>
+#include <memory>
+#include <string>
 
 #include "../../src/sstl_vector.hpp"
 
@@ -416,4 +418,430 @@ TEST (vector_int_test, get_allocator) {
   int *p = a.allocate(10);
   EXPECT_TRUE(p != nullptr);
 }
+class small_value {
+public:
+  char c;
+  small_value(char v = 0) : c(v) {}
+  small_value(const small_value& v) : c(v.c) {}
+};
+
+// growth takes the whole block of the allocator as capacity
+TEST(vector_int_test, grow_to_usable_size) {
+  sup::vector<int> vec;
+  vec.push_back(1);
+  EXPECT_TRUE(vec.capacity() == 4);  // the 16 bytes block of the pool
+  for (int i = 0; i < 4; ++i) {
+    vec.push_back(i);
+  }
+  EXPECT_TRUE(vec.size() == 5 && vec.capacity() == 8);
+
+  sup::vector<small_value> chars;
+  chars.push_back(small_value('a'));
+  EXPECT_TRUE(chars.capacity() == 16);
+  chars.insert(chars.end(), 20, small_value('b'));
+  EXPECT_TRUE(chars.size() == 21 && chars.capacity() == 32);
+  EXPECT_TRUE(chars[0].c == 'a' && chars[20].c == 'b');
+
+  // reserve is exact
+  sup::vector<int> exact;
+  exact.reserve(5);
+  EXPECT_TRUE(exact.capacity() == 5);
+}
+
+// int buffers grow by reallocate (realloc & mremap)
+TEST(vector_int_test, grow_by_reallocate) {
+  sup::vector<int> vec;
+  vec.push_back(7);
+  for (int i = 1; i < 100; ++i) {
+    vec.push_back(vec[0]);  // the value lives in the buffer being resized
+  }
+  EXPECT_TRUE(vec.size() == 100 && vec.capacity() >= 128);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(vec[i] == 7);
+  }
+
+  sup::vector<int> vec2(4, 1);
+  vec2.insert(vec2.begin() + 1, 2);  // grows in the middle
+  EXPECT_TRUE(vec2.size() == 5 && vec2.capacity() == 8);
+  EXPECT_TRUE(vec2[0] == 1 && vec2[1] == 2 && vec2[2] == 1 && vec2[4] == 1);
+
+  // large enough for the mmap path
+  const int n = 3 << 20;
+  sup::vector<int> big;
+  big.reserve(1 << 19);
+  for (int i = 0; i < n; ++i) {
+    big.push_back(i);
+  }
+  big.reserve(2 * n);
+  EXPECT_TRUE(big.capacity() == 2 * n);
+  bool same = true;
+  for (int i = 0; i < n; ++i) {
+    same = same && big[i] == i;
+  }
+  EXPECT_TRUE(same);
+}
+
+/******** Move semantics *******/
+// counts how its objects were made
+class tracked {
+public:
+  static int copies;
+  static int moves;
+  int value;
+  explicit tracked(int v = 0) : value(v) {}
+  tracked(int a, int b) : value(a + b) {}
+  tracked(const tracked& t) : value(t.value) { ++copies; }
+  tracked(tracked&& t) noexcept : value(t.value) { t.value = -1; ++moves; }
+  tracked& operator=(const tracked& t) { value = t.value; ++copies; return *this; }
+  tracked& operator=(tracked&& t) noexcept {
+    value = t.value;
+    t.value = -1;
+    ++moves;
+    return *this;
+  }
+};
+int tracked::copies = 0;
+int tracked::moves = 0;
+
+// a move constructor that may throw is not used for relocation
+class throwing_move {
+public:
+  static int moves;
+  int value;
+  explicit throwing_move(int v = 0) : value(v) {}
+  throwing_move(const throwing_move& t) : value(t.value) {}
+  throwing_move(throwing_move&& t) : value(t.value) { ++moves; }
+  throwing_move& operator=(const throwing_move& t) = default;
+};
+int throwing_move::moves = 0;
+
+TEST(vector_move_test, growth_moves_elements) {
+  tracked::copies = 0;
+  sup::vector<tracked> vec;
+  for (int i = 0; i < 100; ++i) {
+    vec.push_back(tracked(i));
+  }
+  EXPECT_TRUE(tracked::copies == 0);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(vec[i].value == i);
+  }
+
+  throwing_move::moves = 0;
+  sup::vector<throwing_move> other;
+  for (int i = 0; i < 100; ++i) {
+    other.push_back(throwing_move(i));
+  }
+  // only the pushed temporaries are moved, growth copies
+  EXPECT_TRUE(throwing_move::moves == 100);
+  EXPECT_TRUE(other[99].value == 99);
+}
+
+TEST(vector_move_test, emplace) {
+  tracked::copies = 0;
+  tracked::moves = 0;
+  sup::vector<tracked> vec;
+  vec.reserve(10);
+  vec.emplace_back(1, 2);
+  vec.emplace_back(5);
+  EXPECT_TRUE(tracked::copies == 0 && tracked::moves == 0);
+  EXPECT_TRUE(vec[0].value == 3 && vec[1].value == 5);
+
+  sup::vector<tracked>::iterator it = vec.emplace(vec.begin(), 7);
+  EXPECT_TRUE(it == vec.begin() && it->value == 7);
+  EXPECT_TRUE(vec.size() == 3 && vec[1].value == 3 && vec[2].value == 5);
+  EXPECT_TRUE(tracked::copies == 0);
+
+  // grows in the middle
+  while (vec.size() < vec.capacity()) {
+    vec.emplace_back(0);
+  }
+  it = vec.emplace(vec.begin() + 1, 4, 4);
+  EXPECT_TRUE(it == vec.begin() + 1 && it->value == 8);
+  EXPECT_TRUE(vec[0].value == 7 && vec[2].value == 3 && vec[3].value == 5);
+  EXPECT_TRUE(tracked::copies == 0);
+}
+
+TEST(vector_move_test, move_construct_and_assign) {
+  sup::vector<std::string> vec;
+  for (int i = 0; i < 10; ++i) {
+    vec.push_back(std::to_string(i));
+  }
+  const std::string* data = &vec[0];
+
+  sup::vector<std::string> moved(std::move(vec));
+  EXPECT_TRUE(vec.size() == 0 && vec.capacity() == 0);
+  EXPECT_TRUE(moved.size() == 10 && &moved[0] == data);
+
+  sup::vector<std::string> assigned(3, "x", moved.get_allocator());
+  assigned = std::move(moved);
+  EXPECT_TRUE(assigned.size() == 10 && &assigned[0] == data);
+  EXPECT_TRUE(moved.size() == 0);
+
+  sup::vector<std::string> copied;
+  copied = assigned;
+  EXPECT_TRUE(copied.size() == 10 && copied[9] == "9");
+  copied = sup::vector<std::string>(2, "y", copied.get_allocator());
+  EXPECT_TRUE(copied.size() == 2 && copied[1] == "y");
+  copied = assigned;
+  EXPECT_TRUE(copied.size() == 10 && copied[5] == "5");
+  const sup::vector<std::string>& self = copied;
+  copied = self;
+  EXPECT_TRUE(copied.size() == 10 && copied[5] == "5");
+}
+
+TEST(vector_move_test, push_back_own_element) {
+  sup::vector<std::string> vec;
+  vec.push_back(std::string(100, 'a'));
+  for (int i = 0; i < 20; ++i) {
+    vec.push_back(vec[0]);  // the argument lives in the old buffer
+  }
+  vec.insert(vec.begin(), vec[3]);
+  vec.insert(vec.begin() + 1, 2, vec[0]);
+  EXPECT_TRUE(vec.size() == 24);
+  for (size_t i = 0; i < vec.size(); ++i) {
+    EXPECT_TRUE(vec[i] == std::string(100, 'a'));
+  }
+
+  sup::vector<std::string> strings;
+  std::string s = "moved";
+  strings.push_back(std::move(s));
+  strings.insert(strings.begin(), std::string("first"));
+  EXPECT_TRUE(strings[0] == "first" && strings[1] == "moved");
+}
+
+TEST(vector_move_test, insert_empty_range) {
+  sup::vector<std::string> vec;
+  vec.reserve(4);
+  vec.push_back("0");
+  vec.push_back("1");
+  std::string empty[1];
+  vec.insert(vec.begin(), empty, empty);  // nothing is shifted
+  EXPECT_TRUE(vec.size() == 2 && vec[0] == "0" && vec[1] == "1");
+  vec.insert(vec.end(), empty, empty);
+  EXPECT_TRUE(vec.size() == 2 && vec[0] == "0" && vec[1] == "1");
+}
+/******** Relocation *******/
+// owns a heap int; opts in to be moved by memmove
+class handle {
+public:
+  typedef sup::__true_type is_trivially_relocatable;
+  static int copies;
+  static int moves;
+  int* p;
+  explicit handle(int v = 0) : p(new int(v)) {}
+  handle(const handle& h) : p(new int(*h.p)) { ++copies; }
+  handle(handle&& h) noexcept : p(h.p) { h.p = nullptr; ++moves; }
+  handle& operator=(const handle& h) { *p = *h.p; ++copies; return *this; }
+  handle& operator=(handle&& h) noexcept {
+    std::swap(p, h.p);
+    ++moves;
+    return *this;
+  }
+  ~handle() { delete p; }
+};
+int handle::copies = 0;
+int handle::moves = 0;
+
+TEST(vector_relocate_test, trait) {
+  EXPECT_TRUE(sup::__is_trivially_relocatable<int>::value);
+  EXPECT_TRUE(sup::__is_trivially_relocatable<double*>::value);
+  EXPECT_TRUE(sup::__is_trivially_relocatable<handle>::value);
+  EXPECT_TRUE(sup::__is_trivially_relocatable<sup::vector<int> >::value);
+  EXPECT_TRUE(!sup::__is_trivially_relocatable<tracked>::value);
+  EXPECT_TRUE(!sup::__is_trivially_relocatable<std::string>::value);
+}
+
+TEST(vector_relocate_test, no_moves_on_growth_insert_and_erase) {
+  sup::vector<handle> vec;
+  for (int i = 0; i < 1000; ++i) {
+    vec.emplace_back(i);
+  }
+  handle::copies = 0;
+  handle::moves = 0;
+
+  vec.emplace(vec.begin(), -1);
+  vec.erase(vec.begin() + 500);
+  vec.erase(vec.begin() + 100, vec.begin() + 200);
+  handle h(-2);
+  vec.insert(vec.begin() + 10, 3, h);
+  // only the new elements are made (and the copy of the filled value)
+  EXPECT_TRUE(handle::copies == 4 && handle::moves == 1);
+
+  EXPECT_TRUE(vec.size() == 903);
+  EXPECT_TRUE(*vec[0].p == -1 && *vec[1].p == 0 && *vec[9].p == 8);
+  EXPECT_TRUE(*vec[10].p == -2 && *vec[12].p == -2 && *vec[13].p == 9);
+  EXPECT_TRUE(*vec[102].p == 98 && *vec[103].p == 199);
+  EXPECT_TRUE(*vec[402].p == 498 && *vec[403].p == 500);
+  EXPECT_TRUE(*vec[902].p == 999);
+
+  // range insertion into a full vector
+  sup::vector<handle> other(vec.begin(), vec.begin() + 5);
+  handle::copies = 0;
+  handle::moves = 0;
+  while (vec.size() < vec.capacity()) {
+    vec.emplace_back(1);
+  }
+  vec.insert(vec.begin() + 1, other.begin(), other.end());
+  EXPECT_TRUE(handle::copies == 5 && handle::moves == 0);
+  EXPECT_TRUE(*vec[0].p == -1 && *vec[1].p == -1 && *vec[5].p == 3);
+  EXPECT_TRUE(*vec[6].p == 0);
+}
+
+TEST(vector_relocate_test, nested_vectors) {
+  sup::vector<sup::vector<int> > vec;
+  for (int i = 0; i < 100; ++i) {
+    vec.push_back(sup::vector<int>(i + 1, i));
+  }
+  vec.insert(vec.begin() + 50, sup::vector<int>(3, -1));
+  vec.erase(vec.begin());
+  EXPECT_TRUE(vec.size() == 100);
+  EXPECT_TRUE(vec[0].size() == 2 && vec[0][1] == 1);
+  EXPECT_TRUE(vec[49].size() == 3 && vec[49][2] == -1);
+  EXPECT_TRUE(vec[99].size() == 100 && vec[99][99] == 99);
+}
+/******** Growth policies *******/
+TEST(vector_growth_test, policies) {
+  EXPECT_TRUE(sup::growth_factor_2::next_capacity(0, 1, 4) == 1);
+  EXPECT_TRUE(sup::growth_factor_2::next_capacity(8, 9, 4) == 16);
+  EXPECT_TRUE(sup::growth_factor_2::next_capacity(8, 20, 4) == 20);
+  EXPECT_TRUE(sup::growth_factor_1_5::next_capacity(1, 2, 4) == 2);
+  EXPECT_TRUE(sup::growth_factor_1_5::next_capacity(8, 9, 4) == 12);
+
+  EXPECT_TRUE(sup::growth_size_class::size_class(1) == 16);
+  EXPECT_TRUE(sup::growth_size_class::size_class(256) == 256);
+  EXPECT_TRUE(sup::growth_size_class::size_class(257) == 320);
+  EXPECT_TRUE(sup::growth_size_class::size_class(4096) == 4096);
+  EXPECT_TRUE(sup::growth_size_class::size_class(4097) == 5120);
+  // 8 ints fill a 48 byte class: 12
+  EXPECT_TRUE(sup::growth_size_class::next_capacity(8, 9, 4) == 12);
+}
+
+// the capacities a push_back loop goes through (naive_allocator gives the
+// exact size asked for)
+template <class Growth>
+sup::vector<size_t> capacities(size_t n) {
+  sup::vector<size_t> result;
+  sup::vector<int, sup::naive_allocator, Growth> vec;
+  for (size_t i = 0; i < n; ++i) {
+    vec.push_back((int) i);
+    if (result.empty() || result.back() != vec.capacity()) {
+      result.push_back(vec.capacity());
+    }
+  }
+  return result;
+}
+
+TEST(vector_growth_test, push_back) {
+  sup::vector<size_t> doubling = capacities<sup::growth_factor_2>(100);
+  EXPECT_TRUE(doubling.size() == 8 && doubling[7] == 128);
+
+  size_t expected[] = {1, 2, 3, 4, 6, 9, 13, 19, 28, 42, 63, 94, 141};
+  sup::vector<size_t> by_half = capacities<sup::growth_factor_1_5>(100);
+  EXPECT_TRUE(by_half.size() == 13);
+  for (size_t i = 0; i < by_half.size(); ++i) {
+    EXPECT_TRUE(by_half[i] == expected[i]);
+  }
+
+  sup::vector<size_t> classes = capacities<sup::growth_size_class>(10000);
+  for (size_t i = 0; i < classes.size(); ++i) {
+    size_t bytes = classes[i] * sizeof(int);
+    EXPECT_TRUE(sup::growth_size_class::size_class(bytes) == bytes);
+    if (i > 0) EXPECT_TRUE(2 * classes[i] >= 3 * classes[i - 1]);
+  }
+
+  // range insertion asks for at least the new size
+  sup::vector<int, sup::naive_allocator, sup::growth_factor_1_5> vec(4, 1);
+  int array[10] = {0};
+  vec.insert(vec.end(), array, array + 10);
+  EXPECT_TRUE(vec.size() == 14 && vec.capacity() == 14);
+  vec.insert(vec.begin(), 3, 2);
+  EXPECT_TRUE(vec.capacity() == 21 && vec[0] == 2 && vec[3] == 1);
+}
+
+/******** Capacity management *******/
+TEST(vector_int_test, shrink_to_fit) {
+  sup::vector<int> vec;
+  for (int i = 0; i < 1000; ++i) {
+    vec.push_back(i);
+  }
+  EXPECT_TRUE(vec.memory_usage() == vec.capacity() * sizeof(int));
+  vec.erase(vec.begin() + 10, vec.end());
+  vec.shrink_to_fit();
+  EXPECT_TRUE(vec.capacity() == 10 && vec.memory_usage() == 10 * sizeof(int));
+  EXPECT_TRUE(vec[9] == 9);
+  vec.push_back(10);
+  EXPECT_TRUE(vec.size() == 11 && vec[10] == 10);
+
+  sup::vector<std::string> strings(100, std::string(50, 's'),
+                                   sup::vector<std::string>::allocator_type());
+  strings.erase(strings.begin() + 2, strings.end());
+  strings.shrink_to_fit();
+  EXPECT_TRUE(strings.capacity() == 2 && strings[1] == std::string(50, 's'));
+  strings.clear();
+  strings.shrink_to_fit();
+  EXPECT_TRUE(strings.capacity() == 0 && strings.memory_usage() == 0);
+}
+
+/******** Default initialization *******/
+TEST(vector_int_test, resize_for_overwrite) {
+  sup::vector<int> vec;
+  for (int i = 0; i < 100; ++i) {
+    vec.push_back(i);
+  }
+  vec.resize(10);
+  // trivial elements are not written: the old values are still there
+  vec.resize_for_overwrite(100);
+  EXPECT_TRUE(vec.size() == 100 && vec[50] == 50 && vec[99] == 99);
+  vec.resize(10);
+  vec.resize(100);
+  EXPECT_TRUE(vec[50] == 0 && vec[99] == 0);
+
+  sup::vector<int>::iterator it = vec.append_uninitialized(1000);
+  EXPECT_TRUE(it == vec.begin() + 100 && vec.size() == 1100);
+  for (int i = 0; i < 1000; ++i) {
+    it[i] = i;
+  }
+  EXPECT_TRUE(vec[99] == 0 && vec[100] == 0 && vec.back() == 999);
+  vec.resize_for_overwrite(5);
+  EXPECT_TRUE(vec.size() == 5);
+
+  // other types are default constructed
+  sup::vector<std::string> strings(2, "s", sup::vector<std::string>::allocator_type());
+  strings.resize_for_overwrite(4);
+  strings.append_uninitialized(2);
+  EXPECT_TRUE(strings.size() == 6 && strings[1] == "s" && strings[5].empty());
+}
+
+TEST(vector_int_test, resize_move_only) {
+  sup::vector<std::unique_ptr<int>> vec(3);
+  EXPECT_TRUE(vec.size() == 3 && vec[2] == nullptr);
+  vec[0].reset(new int(1));
+  vec.resize(100);
+  EXPECT_TRUE(*vec[0] == 1 && vec[99] == nullptr);
+  vec.resize(1);
+  EXPECT_TRUE(vec.size() == 1 && *vec[0] == 1);
+}
+
+/******** Erasure *******/
+TEST(vector_int_test, erase_if) {
+  sup::vector<int> vec;
+  for (int i = 0; i < 1000; ++i) {
+    vec.push_back(i % 10);
+  }
+  EXPECT_TRUE(sup::erase_if(vec, [](int x) { return x >= 5; }) == 500);
+  EXPECT_TRUE(vec.size() == 500 && vec[4] == 4 && vec[5] == 0);
+  EXPECT_TRUE(sup::erase(vec, 0) == 100 && vec.size() == 400);
+  EXPECT_TRUE(vec.front() == 1 && vec.back() == 4);
+  EXPECT_TRUE(sup::erase(vec, 7) == 0 && vec.size() == 400);
+
+  sup::vector<std::string> strings;
+  for (int i = 0; i < 100; ++i) {
+    strings.push_back(std::to_string(i));
+  }
+  EXPECT_TRUE(sup::erase_if(strings, [](const std::string& s) {
+                return s.size() == 2;
+              }) == 90);
+  EXPECT_TRUE(strings.size() == 10 && strings[9] == "9");
+}
+
 }  // namespace vector_int_test
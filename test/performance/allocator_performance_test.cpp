@@ -0,0 +1,237 @@
+#include <gtest/gtest.h>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../src/sstl_forward_list.hpp"
+#include "../../src/sstl_list.hpp"
+#include "../../src/sstl_map.hpp"
+#include "../../src/sstl_memory_resource.hpp"
+#include "../../src/sstl_unordered_map.hpp"
+#include "performance_timer.hpp"
+
+// Node containers allocate one node per element, so their insert & erase
+// throughput is dominated by the allocator. Compare the new & delete wrapper
+// (naive_allocator) with the default pool allocator (alloc).
+
+namespace allocator_performance_test {
+
+using performance_test::report;
+using performance_test::scaled;
+using performance_test::timer;
+
+template <class Alloc>
+double map_insert_erase(size_t n) {
+  sup::map<int, int, std::less<int>, Alloc> m;
+  timer t;
+  for (int round = 0; round < 4; ++round) {
+    for (size_t i = 0; i < n; ++i) m.insert(std::make_pair((int) i, (int) i));
+    for (size_t i = 0; i < n; ++i) m.erase((int) i);
+  }
+  double ms = t.elapsed();
+  EXPECT_TRUE(m.empty());
+  return ms;
+}
+
+template <class Alloc>
+double unordered_map_insert_clear(size_t n) {
+  sup::unordered_map<int, int, std::hash<int>, std::equal_to<int>, Alloc> m;
+  m.reserve(n);
+  timer t;
+  for (int round = 0; round < 4; ++round) {
+    for (size_t i = 0; i < n; ++i) m.insert(std::make_pair((int) i, (int) i));
+    m.clear();
+  }
+  double ms = t.elapsed();
+  EXPECT_TRUE(m.empty());
+  return ms;
+}
+
+template <class Alloc>
+double list_push_pop(size_t n) {
+  sup::list<int, Alloc> l;
+  timer t;
+  for (int round = 0; round < 4; ++round) {
+    for (size_t i = 0; i < n; ++i) l.push_back((int) i);
+    for (size_t i = 0; i < n; ++i) l.pop_front();
+  }
+  double ms = t.elapsed();
+  EXPECT_TRUE(l.empty());
+  return ms;
+}
+
+TEST(allocator_performance_test, map_insert_erase) {
+  size_t n = scaled(100000);
+  report("map insert/erase (naive_allocator)", 8 * n,
+         map_insert_erase<sup::naive_allocator>(n));
+  report("map insert/erase (alloc)", 8 * n, map_insert_erase<sup::alloc>(n));
+}
+
+TEST(allocator_performance_test, unordered_map_insert_clear) {
+  size_t n = scaled(100000);
+  report("unordered_map insert/clear (naive_allocator)", 8 * n,
+         unordered_map_insert_clear<sup::naive_allocator>(n));
+  report("unordered_map insert/clear (alloc)", 8 * n,
+         unordered_map_insert_clear<sup::alloc>(n));
+}
+
+TEST(allocator_performance_test, list_push_pop) {
+  size_t n = scaled(100000);
+  report("list push/pop (naive_allocator)", 8 * n,
+         list_push_pop<sup::naive_allocator>(n));
+  report("list push/pop (alloc)", 8 * n, list_push_pop<sup::alloc>(n));
+}
+
+// Build a container of n elements and destroy it, many times. With the
+// monotonic arena the nodes are bumped from chunks and dropped at once by
+// release(); int values let clear() skip visiting the nodes.
+template <class Container>
+struct build_destroy;
+
+template <class Alloc>
+struct build_destroy<sup::map<int, int, std::less<int>, Alloc>> {
+  template <class A>
+  static size_t run(size_t n, const A& a) {
+    sup::map<int, int, std::less<int>, Alloc> m(std::less<int>(), a);
+    for (size_t i = 0; i < n; ++i) m.insert(std::make_pair((int) i, (int) i));
+    return m.size();
+  }
+};
+
+template <class Alloc>
+struct build_destroy<
+  sup::unordered_map<int, int, std::hash<int>, std::equal_to<int>, Alloc>> {
+  template <class A>
+  static size_t run(size_t n, const A& a) {
+    sup::unordered_map<int, int, std::hash<int>, std::equal_to<int>, Alloc> m(
+      n, std::hash<int>(), std::equal_to<int>(), a);
+    for (size_t i = 0; i < n; ++i) m.insert(std::make_pair((int) i, (int) i));
+    return m.size();
+  }
+};
+
+template <class Alloc>
+struct build_destroy<sup::list<int, Alloc>> {
+  template <class A>
+  static size_t run(size_t n, const A& a) {
+    sup::list<int, Alloc> l(a);
+    for (size_t i = 0; i < n; ++i) l.push_back((int) i);
+    return n;
+  }
+};
+
+template <class Alloc>
+struct build_destroy<sup::forward_list<int, Alloc>> {
+  template <class A>
+  static size_t run(size_t n, const A& a) {
+    sup::forward_list<int, Alloc> l(a);
+    for (size_t i = 0; i < n; ++i) l.push_front((int) i);
+    return n;
+  }
+};
+
+template <template <class> class Container>
+void build_destroy_cycles(const char* name, size_t n, size_t cycles) {
+  std::string prefix = std::string(name) + " build/destroy ";
+  timer t;
+  for (size_t c = 0; c < cycles; ++c)
+    EXPECT_TRUE(build_destroy<Container<sup::alloc>>::run(n, sup::alloc()) == n);
+  report((prefix + "(alloc)").c_str(), n * cycles, t.elapsed());
+
+  sup::monotonic_buffer_resource arena;
+  t.reset();
+  for (size_t c = 0; c < cycles; ++c) {
+    EXPECT_TRUE(build_destroy<Container<sup::monotonic_alloc>>::run(
+      n, sup::monotonic_alloc(&arena)) == n);
+    arena.release();
+  }
+  report((prefix + "(monotonic_alloc)").c_str(), n * cycles, t.elapsed());
+}
+
+template <class Alloc>
+using int_map = sup::map<int, int, std::less<int>, Alloc>;
+template <class Alloc>
+using int_unordered_map =
+  sup::unordered_map<int, int, std::hash<int>, std::equal_to<int>, Alloc>;
+template <class Alloc>
+using int_list = sup::list<int, Alloc>;
+template <class Alloc>
+using int_forward_list = sup::forward_list<int, Alloc>;
+
+TEST(allocator_performance_test, build_destroy_cycles) {
+  size_t n = 2000;
+  size_t cycles = scaled(50);
+  build_destroy_cycles<int_map>("map", n, cycles);
+  build_destroy_cycles<int_unordered_map>("unordered_map", n, cycles);
+  build_destroy_cycles<int_list>("list", n, cycles);
+  build_destroy_cycles<int_forward_list>("forward_list", n, cycles);
+}
+
+// a single pool guarded by one lock: every allocation takes the lock
+struct locked_pool_alloc {
+  typedef sup::__simple_default_allocator_template<false, 3> pool;
+  static std::mutex lock;
+
+  static void* allocate(size_t n) {
+    std::lock_guard<std::mutex> guard(lock);
+    return pool::allocate(n);
+  }
+  static void deallocate(char* p, size_t n) {
+    std::lock_guard<std::mutex> guard(lock);
+    pool::deallocate(p, n);
+  }
+};
+std::mutex locked_pool_alloc::lock;
+
+// every thread allocates a batch of node sized blocks and frees them
+template <class Alloc>
+double threaded_allocate(int num_of_threads, size_t rounds) {
+  const int batch = 64;
+  timer t;
+  std::vector<std::thread> workers;
+  for (int i = 0; i < num_of_threads; ++i) {
+    workers.push_back(std::thread([rounds]() {
+      char* blocks[batch];
+      for (size_t round = 0; round < rounds; ++round) {
+        for (int j = 0; j < batch; ++j) {
+          blocks[j] = (char*) Alloc::allocate(16 * (j % 8 + 1));
+          blocks[j][0] = (char) j;
+        }
+        for (int j = 0; j < batch; ++j) {
+          Alloc::deallocate(blocks[j], 16 * (j % 8 + 1));
+        }
+      }
+    }));
+  }
+  for (int i = 0; i < num_of_threads; ++i) workers[i].join();
+  return t.elapsed();
+}
+
+TEST(allocator_performance_test, multi_threaded_allocation) {
+  size_t rounds = scaled(2000);
+  for (int num_of_threads = 1; num_of_threads <= 8; num_of_threads *= 2) {
+    size_t ops = 2 * 64 * rounds * num_of_threads;
+    std::string suffix = " x" + std::to_string(num_of_threads) + " threads";
+    report(("locked pool" + suffix).c_str(), ops,
+           threaded_allocate<locked_pool_alloc>(num_of_threads, rounds));
+    report(("malloc_alloc" + suffix).c_str(), ops,
+           threaded_allocate<sup::malloc_alloc>(num_of_threads, rounds));
+    report(("thread caching pool" + suffix).c_str(), ops,
+           threaded_allocate<sup::__simple_default_allocator_template<true, 2>>(
+               num_of_threads, rounds));
+  }
+}
+
+TEST(allocator_performance_test, single_threaded_allocation) {
+  size_t rounds = scaled(8000);
+  size_t ops = 2 * 64 * rounds;
+  report("pool without lock (threads = false)", ops,
+         threaded_allocate<sup::__simple_default_allocator_template<false, 2>>(
+             1, rounds));
+  report("thread caching pool (threads = true)", ops,
+         threaded_allocate<sup::__simple_default_allocator_template<true, 2>>(
+             1, rounds));
+}
+
+}  // namespace allocator_performance_test
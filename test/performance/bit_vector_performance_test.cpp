@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include "../../src/sstl_vector.hpp"
+#include "performance_timer.hpp"
+
+// Scanning a 100M-bit vector<bool> (12.5 MB): the word-level kernels
+// against a loop reading one bit at a time, and against a vector<char> of
+// the same flags (one byte each, 100 MB). Throughput is in bits per second.
+
+namespace bit_vector_performance_test {
+
+using performance_test::report;
+using performance_test::scaled;
+using performance_test::timer;
+
+TEST(bit_vector_performance_test, scan_100m_bits) {
+  size_t n = scaled(100000000);
+  sup::vector<bool> bits(n);
+  sup::vector<char> bytes(n);
+  // about one flag in 1000
+  for (size_t i = 0; i < n; i += 997) {
+    bits[i] = true;
+    bytes[i] = 1;
+  }
+  size_t expected = (n + 996) / 997;
+
+  timer t;
+  size_t count = 0;
+  for (size_t i = 0; i < n; ++i) count += bits[i];
+  report("vector<bool> count, bit by bit", n, t.elapsed());
+  EXPECT_TRUE(count == expected);
+
+  t.reset();
+  count = 0;
+  for (size_t i = 0; i < n; ++i) count += bytes[i];
+  report("vector<char> count", n, t.elapsed());
+  EXPECT_TRUE(count == expected);
+
+  t.reset();
+  count = bits.count();
+  report("vector<bool> count()", n, t.elapsed());
+  EXPECT_TRUE(count == expected);
+
+  t.reset();
+  count = 0;
+  for (size_t i = bits.find_first(); i != n; i = bits.find_next(i)) ++count;
+  report("vector<bool> find_first & find_next", n, t.elapsed());
+  EXPECT_TRUE(count == expected);
+
+  sup::vector<bool> mask(n, true);
+  t.reset();
+  mask &= bits;
+  mask ^= bits;
+  report("vector<bool> &= and ^= (2 passes)", 2 * n, t.elapsed());
+  EXPECT_TRUE(mask.none());
+
+  t.reset();
+  mask.flip();
+  report("vector<bool> flip()", n, t.elapsed());
+  EXPECT_TRUE(mask.all());
+
+  std::printf("[   PERF   ]   vector<bool> %zu KB, vector<char> %zu KB\n",
+              bits.memory_usage() >> 10, bytes.memory_usage() >> 10);
+}
+
+}  // namespace bit_vector_performance_test
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "../../src/sstl_alloc_telemetry.hpp"
+#include "../../src/sstl_flat_map.hpp"
+#include "../../src/sstl_map.hpp"
+#include "performance_timer.hpp"
+
+// A read-mostly table of n int -> int entries: map (red-black tree nodes)
+// against flat_map (a sorted key vector and a value vector). Reported per
+// container: the time to build it from unsorted pairs, to look up n random
+// keys, to iterate all the values, and the bytes it holds.
+
+namespace flat_map_performance_test {
+
+using performance_test::report;
+using performance_test::scaled;
+using performance_test::timer;
+
+struct map_tag {};
+struct flat_map_tag {};
+
+typedef sup::telemetry_alloc<sup::alloc, map_tag> map_alloc;
+typedef sup::telemetry_alloc<sup::alloc, flat_map_tag> flat_map_alloc;
+
+// a fixed permutation of [0, n), n a power of two
+inline int scramble(size_t i, size_t n) {
+  return (int) ((i * 2654435761u) & (n - 1));
+}
+
+template <class Map, class Tag>
+void lookup_table(const char* name, size_t n, size_t lookups) {
+  std::vector<std::pair<int, int>> pairs;
+  for (size_t i = 0; i < n; ++i) {
+    int k = scramble(i, n);
+    pairs.push_back(std::make_pair(2 * k, k));
+  }
+  char line[64];
+  sup::alloc_telemetry<Tag>::reset();
+
+  timer t;
+  Map m(pairs.begin(), pairs.end());
+  std::snprintf(line, sizeof(line), "%s build", name);
+  report(line, n, t.elapsed());
+  EXPECT_TRUE(m.size() == n);
+
+  t.reset();
+  size_t found = 0;
+  for (size_t i = 0; i < lookups; ++i) {
+    // half of the keys are odd: not found
+    found += m.find(scramble(i, 2 * n)) != m.end();
+  }
+  std::snprintf(line, sizeof(line), "%s lookup", name);
+  report(line, lookups, t.elapsed());
+  EXPECT_TRUE(found > 0 && found < lookups);
+
+  t.reset();
+  long long sum = 0;
+  for (typename Map::iterator it = m.begin(); it != m.end(); ++it) {
+    sum += (*it).second;
+  }
+  std::snprintf(line, sizeof(line), "%s iterate", name);
+  report(line, n, t.elapsed());
+  EXPECT_TRUE(sum == (long long) (n * (n - 1) / 2));
+
+  std::printf("[   PERF   ]   %zu KB live, %.1f bytes per entry\n",
+              sup::alloc_telemetry<Tag>::snapshot().live_bytes >> 10,
+              (double) sup::alloc_telemetry<Tag>::snapshot().live_bytes / n);
+}
+
+TEST(flat_map_performance_test, lookup_table) {
+  size_t n = 1 << 18;
+  size_t lookups = scaled(1 << 21);
+  lookup_table<sup::map<int, int, std::less<int>, map_alloc>, map_tag>(
+      "map<int, int>", n, lookups);
+  lookup_table<sup::flat_map<int, int, std::less<int>, flat_map_alloc>,
+               flat_map_tag>("flat_map<int, int>", n, lookups);
+}
+
+}  // namespace flat_map_performance_test
@@ -0,0 +1,406 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../src/sstl_unordered_set.hpp"
+#include "performance_timer.hpp"
+
+namespace hashtable_performance_test {
+
+// std::hash, with the hash codes not stored in the nodes
+struct uncached_string_hash : std::hash<std::string> {};
+
+}  // namespace hashtable_performance_test
+
+namespace sup {
+template <>
+struct _hashtable_cache_hash_code<std::string,
+                                  hashtable_performance_test::uncached_string_hash>
+    : std::false_type {};
+}  // namespace sup
+
+// unordered_set<std::string> with & without the hash codes stored in the
+// nodes. Inserting grows the table by rehashing, which hashes every key
+// again unless the codes are stored, and every key compared in a chain is
+// compared as a string.
+
+namespace hashtable_performance_test {
+
+using performance_test::report;
+using performance_test::scaled;
+using performance_test::timer;
+
+template <class Set>
+void string_keys(const char* name, const std::vector<std::string>& keys) {
+  char line[64];
+  timer t;
+  Set s(53);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    s.insert(keys[i]);
+  }
+  std::snprintf(line, sizeof(line), "%s insert", name);
+  report(line, keys.size(), t.elapsed());
+  EXPECT_TRUE(s.size() == keys.size());
+
+  t.reset();
+  size_t length = 0;
+  for (int round = 0; round < 10; ++round) {
+    for (typename Set::iterator it = s.begin(); it != s.end(); ++it) {
+      length += (*it).size();
+    }
+  }
+  std::snprintf(line, sizeof(line), "%s iterate x10", name);
+  report(line, 10 * keys.size(), t.elapsed());
+  EXPECT_TRUE(length > 0);
+
+  t.reset();
+  s.rehash(4 * s.bucket_count());
+  std::snprintf(line, sizeof(line), "%s rehash", name);
+  report(line, keys.size(), t.elapsed());
+}
+
+TEST(hashtable_performance_test, cached_hash_codes) {
+  std::vector<std::string> keys;
+  size_t n = scaled(1 << 17);
+  for (size_t i = 0; i < n; ++i) {
+    keys.push_back("/usr/share/sstl/key/" + std::to_string(i * 2654435761u));
+  }
+  string_keys<sup::unordered_set<std::string> >(
+      "unordered_set<string> cached", keys);
+  string_keys<sup::unordered_set<std::string, uncached_string_hash> >(
+      "unordered_set<string> uncached", keys);
+}
+
+// a table with many more buckets than elements (reserved, or emptied by
+// erasing): begin() and iteration follow the element chain, so neither
+// depends on the number of buckets
+TEST(hashtable_performance_test, sparse_iteration) {
+  size_t rounds = scaled(1 << 14);
+  sup::unordered_set<int> s;
+  s.rehash(1 << 20);
+  for (int i = 0; i < 64; ++i) {
+    s.insert(i * 7919);
+  }
+
+  timer t;
+  long long sum = 0;
+  for (size_t round = 0; round < rounds; ++round) {
+    for (sup::unordered_set<int>::iterator it = s.begin(); it != s.end();
+         ++it) {
+      sum += *it;
+    }
+  }
+  report("unordered_set<int> 64 of 1M buckets iterate", 64 * rounds,
+         t.elapsed());
+  EXPECT_TRUE(sum > 0 && s.bucket_count() >= (1 << 20));
+
+  t.reset();
+  size_t found = 0;
+  for (size_t round = 0; round < rounds; ++round) {
+    s.erase(s.begin());
+    found += s.begin() != s.end();
+    s.insert(static_cast<int>(round) * 7919);
+  }
+  report("unordered_set<int> 1M buckets erase(begin())", rounds, t.elapsed());
+  EXPECT_TRUE(found == rounds);
+}
+
+}  // namespace hashtable_performance_test
+
+// The bucket policies: prime numbers of buckets with a division per index
+// (the policy before fastmod), prime numbers with fastmod (the default), and
+// powers of two with Fibonacci hashing. The index is computed for every
+// lookup & insertion, and for every node passed in a chain: it is most of
+// the cost of a lookup of an int key, whose nodes do not store the hash
+// code and whose hash is the identity. The table fits in the cache, so that
+// the index is not hidden behind cache misses.
+
+namespace hashtable_performance_test {
+
+struct modulo_buckets {
+  static size_t next_size(size_t n) {
+    return sup::__hashtable_prime_buckets::next_size(n);
+  }
+  static size_t at_least(size_t n) {
+    return sup::__hashtable_prime_buckets::at_least(n);
+  }
+  static size_t max_size() { return sup::__hashtable_prime_buckets::max_size(); }
+  void reset(size_t n) { divisor = n; }
+  size_t index(size_t h) const { return h % divisor; }
+  size_t divisor;
+};
+
+template <class Key> struct modulo_hash : std::hash<Key> {};
+template <class Key> struct power2_hash : std::hash<Key> {};
+
+}  // namespace hashtable_performance_test
+
+namespace sup {
+template <class Key>
+struct _hashtable_bucket_policy<Key,
+                                hashtable_performance_test::modulo_hash<Key> > {
+  typedef hashtable_performance_test::modulo_buckets type;
+};
+template <class Key>
+struct _hashtable_bucket_policy<Key,
+                                hashtable_performance_test::power2_hash<Key> > {
+  typedef __hashtable_power2_buckets type;
+};
+}  // namespace sup
+
+namespace hashtable_performance_test {
+
+// each index feeds the next code: the latency of one index
+template <class Policy>
+void bucket_index(const char* name, size_t buckets, size_t n) {
+  Policy policy;
+  policy.reset(buckets);
+  timer t;
+  size_t h = 1, sum = 0;
+  for (size_t i = 0; i < n; ++i) {
+    h = policy.index(h) + i;
+    sum += h;
+  }
+  report(name, n, t.elapsed());
+  EXPECT_TRUE(sum > 0);
+}
+
+TEST(hashtable_performance_test, bucket_index) {
+  size_t n = scaled(1 << 24);
+  bucket_index<modulo_buckets>("bucket index modulo (24593)", 24593, n);
+  bucket_index<sup::__hashtable_prime_buckets>(
+      "bucket index fastmod (24593)", 24593, n);
+  bucket_index<sup::__hashtable_power2_buckets>(
+      "bucket index power of two (32768)", 32768, n);
+}
+
+template <class Set, class Key>
+void bucket_policy(const char* name, const std::vector<Key>& keys,
+                   const std::vector<Key>& lookups) {
+  char line[64];
+  timer t;
+  Set s;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    s.insert(keys[i]);
+  }
+  std::snprintf(line, sizeof(line), "%s insert", name);
+  report(line, keys.size(), t.elapsed());
+
+  t.reset();
+  size_t found = 0;
+  for (int round = 0; round < 32; ++round) {
+    for (size_t i = 0; i < lookups.size(); ++i) {
+      found += s.count(lookups[i]);
+    }
+  }
+  std::snprintf(line, sizeof(line), "%s find x32", name);
+  report(line, 32 * lookups.size(), t.elapsed());
+  EXPECT_TRUE(found > 0 && found < 32 * lookups.size());
+}
+
+TEST(hashtable_performance_test, bucket_policies) {
+  size_t n = scaled(1 << 14);  // fits in the cache
+  std::mt19937 gen(7);
+  std::vector<int> ints, int_lookups;
+  std::vector<std::string> strings, string_lookups;
+  for (size_t i = 0; i < n; ++i) {
+    ints.push_back(static_cast<int>(gen() >> 1));
+    strings.push_back("/usr/share/sstl/key/" + std::to_string(ints.back()));
+  }
+  // half of the keys are absent
+  for (size_t i = 0; i < n; ++i) {
+    int_lookups.push_back(i % 2 ? ints[gen() % n] : static_cast<int>(gen() >> 1));
+    string_lookups.push_back(i % 2 ? strings[gen() % n]
+                                   : "/usr/share/sstl/key/" + std::to_string(gen()));
+  }
+
+  bucket_policy<sup::unordered_set<int, modulo_hash<int> > >(
+      "unordered_set<int> modulo", ints, int_lookups);
+  bucket_policy<sup::unordered_set<int> >(
+      "unordered_set<int> fastmod", ints, int_lookups);
+  bucket_policy<sup::unordered_set<int, power2_hash<int> > >(
+      "unordered_set<int> power of two", ints, int_lookups);
+  bucket_policy<sup::unordered_set<std::string, modulo_hash<std::string> > >(
+      "unordered_set<string> modulo", strings, string_lookups);
+  bucket_policy<sup::unordered_set<std::string> >(
+      "unordered_set<string> fastmod", strings, string_lookups);
+  bucket_policy<sup::unordered_set<std::string, power2_hash<std::string> > >(
+      "unordered_set<string> power of two", strings, string_lookups);
+}
+
+}  // namespace hashtable_performance_test
+
+// The latency of each insertion of n int keys, with the stop-the-world
+// rehashing and with the incremental one. Growing moves every node at once
+// in the first: the insertion that triggers it is the tail of the
+// distribution. The incremental one still allocates & clears the new
+// buckets in that insertion.
+
+namespace hashtable_performance_test {
+
+// q-quantile of sorted values
+double quantile(const std::vector<double>& sorted, double q) {
+  size_t i = static_cast<size_t>(q * sorted.size());
+  return sorted[i < sorted.size() ? i : sorted.size() - 1];
+}
+
+template <class Set>
+void insertion_latency(const char* name, const std::vector<int>& keys,
+                       bool incremental) {
+  Set s;
+  s.incremental_rehash(incremental);
+  std::vector<double> latency(keys.size());
+  timer total;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    s.insert(keys[i]);
+    latency[i] = std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count();
+  }
+  double ms = total.elapsed();
+  EXPECT_TRUE(s.size() == keys.size());
+
+  std::sort(latency.begin(), latency.end());
+  std::printf("[   PERF   ] %-48s %10.2f ms   p50 %.2f us  p99 %.2f us  "
+              "p99.99 %.2f us  max %.2f us\n",
+              name, ms, quantile(latency, 0.5), quantile(latency, 0.99),
+              quantile(latency, 0.9999), latency.back());
+}
+
+TEST(hashtable_performance_test, incremental_rehash) {
+  size_t n = scaled(1 << 20);
+  std::vector<int> keys;
+  for (size_t i = 0; i < n; ++i) {
+    keys.push_back(static_cast<int>(i * 2654435761u >> 1));
+  }
+  insertion_latency<sup::unordered_set<int> >(
+      "unordered_set<int> insert, rehash at once", keys, false);
+  insertion_latency<sup::unordered_set<int> >(
+      "unordered_set<int> insert, incremental rehash", keys, true);
+}
+
+}  // namespace hashtable_performance_test
+
+// Lookups of std::string keys from const char*: std::hash<std::string> &
+// std::equal_to<std::string> need a std::string, built (and allocated, the
+// keys being longer than the small string buffer) for every lookup; the
+// transparent hasher & key_equal hash & compare the characters in place.
+
+namespace hashtable_performance_test {
+
+struct transparent_string_hash {
+  typedef void is_transparent;
+  size_t operator()(const std::string& s) const {
+    return std::_Hash_bytes(s.data(), s.size(), 0xc70f6907);
+  }
+  size_t operator()(const char* s) const {
+    return std::_Hash_bytes(s, std::strlen(s), 0xc70f6907);
+  }
+};
+
+struct transparent_string_equal {
+  typedef void is_transparent;
+  bool operator()(const std::string& a, const std::string& b) const {
+    return a == b;
+  }
+  bool operator()(const std::string& a, const char* b) const { return a == b; }
+};
+
+template <class Set>
+void c_string_lookup(const char* name, const std::vector<std::string>& keys,
+                     const std::vector<const char*>& lookups) {
+  Set s(keys.begin(), keys.end());
+  timer t;
+  size_t found = 0;
+  for (int round = 0; round < 4; ++round) {
+    for (size_t i = 0; i < lookups.size(); ++i) {
+      found += s.find(lookups[i]) != s.end();
+    }
+  }
+  report(name, 4 * lookups.size(), t.elapsed());
+  EXPECT_TRUE(found == 4 * lookups.size());
+}
+
+TEST(hashtable_performance_test, transparent_lookup) {
+  size_t n = scaled(1 << 16);
+  std::vector<std::string> keys;
+  for (size_t i = 0; i < n; ++i) {
+    keys.push_back("/usr/share/sstl/key/" + std::to_string(i * 2654435761u));
+  }
+  std::vector<const char*> lookups;
+  for (size_t i = 0; i < n; ++i) {
+    lookups.push_back(keys[(i * 7919) % n].c_str());
+  }
+  c_string_lookup<sup::unordered_set<std::string> >(
+      "unordered_set<string> find(const char*) converted", keys, lookups);
+  c_string_lookup<sup::unordered_set<std::string, transparent_string_hash,
+                                     transparent_string_equal> >(
+      "unordered_set<string> find(const char*) in place", keys, lookups);
+}
+
+}  // namespace hashtable_performance_test
+
+// building a table from a range: an element at a time (rehashing at every
+// growth), as a range (the buckets grow once), and in bulk (the elements are
+// sorted by bucket before linking; the hash codes computed by 1 or 4
+// threads). The best of 3 rounds.
+
+namespace hashtable_performance_test {
+
+template <class Set, class Key, class Build>
+void best_of_3(const char* name, size_t n, Build build) {
+  double best = 0;
+  for (int round = 0; round < 3; ++round) {
+    timer t;
+    Set s(53);
+    build(s);
+    const double ms = t.elapsed();
+    if (round == 0 || ms < best) best = ms;
+    EXPECT_TRUE(s.size() <= n && s.size() > 0);
+  }
+  report(name, n, best);
+}
+
+template <class Set, class Key>
+void build(const std::vector<Key>& keys, const char* name) {
+  char line[80];
+  const Key* first = &keys[0];
+  const Key* last = first + keys.size();
+
+  std::snprintf(line, sizeof(line), "%s element by element", name);
+  best_of_3<Set, Key>(line, keys.size(), [first, last](Set& s) {
+    for (const Key* k = first; k != last; ++k) s.insert(*k);
+  });
+  std::snprintf(line, sizeof(line), "%s insert(first, last)", name);
+  best_of_3<Set, Key>(line, keys.size(),
+                      [first, last](Set& s) { s.insert(first, last); });
+  const unsigned threads[] = {1, 4};
+  for (int i = 0; i < 2; ++i) {
+    const unsigned th = threads[i];
+    std::snprintf(line, sizeof(line), "%s bulk_insert, %u thread(s)", name, th);
+    best_of_3<Set, Key>(line, keys.size(), [first, last, th](Set& s) {
+      s.bulk_insert(first, last, th);
+    });
+  }
+}
+
+TEST(hashtable_performance_test, bulk_insert) {
+  std::mt19937 gen(17);
+  std::vector<std::string> strings;
+  std::vector<int> ints;
+  size_t n = scaled(1 << 18);
+  for (size_t i = 0; i < n; ++i) {
+    unsigned k = gen();
+    strings.push_back("/usr/share/sstl/key/" + std::to_string(k));
+    ints.push_back((int) k);
+  }
+  build<sup::unordered_set<std::string> >(strings, "set<string>");
+  build<sup::unordered_set<int> >(ints, "set<int>");
+}
+
+}  // namespace hashtable_performance_test
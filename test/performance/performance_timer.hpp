@@ -0,0 +1,44 @@
+#ifndef _SSTL_PERFORMANCE_TIMER_H
+#define _SSTL_PERFORMANCE_TIMER_H
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+// Helpers shared by the performance tests. The workload of every test is
+// multiplied by the environment variable SSTL_PERF_SCALE (default 1) so that
+// ctest stays fast while a real measurement can use a larger input.
+
+namespace performance_test {
+
+class timer {
+ public:
+  timer() : start(std::chrono::steady_clock::now()) {}
+
+  void reset() { start = std::chrono::steady_clock::now(); }
+
+  // elapsed time in milliseconds
+  double elapsed() const {
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+  }
+
+ private:
+  std::chrono::steady_clock::time_point start;
+};
+
+inline size_t scaled(size_t n) {
+  const char* scale = std::getenv("SSTL_PERF_SCALE");
+  long s = scale == nullptr ? 1 : std::atol(scale);
+  return s > 0 ? n * s : n;
+}
+
+// print one line: name, time and throughput (million operations per second)
+inline void report(const char* name, size_t ops, double ms) {
+  std::printf("[   PERF   ] %-48s %10.2f ms %10.2f Mops/s\n", name, ms,
+              ms > 0 ? ops / ms / 1000.0 : 0.0);
+}
+
+}  // namespace performance_test
+
+#endif
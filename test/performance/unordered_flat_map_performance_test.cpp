@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+#include "../../src/sstl_alloc_telemetry.hpp"
+#include "../../src/sstl_unordered_flat_map.hpp"
+#include "../../src/sstl_unordered_map.hpp"
+#include "performance_timer.hpp"
+
+// n int -> int entries: unordered_map (separate chaining, one node per
+// element) against unordered_flat_map (open addressing, control bytes probed
+// 16 at a time). Reported per container: the time to insert n keys, to look
+// up random keys (half of them absent), to iterate, to erase & re-insert
+// half of the keys, and the bytes it holds.
+
+namespace unordered_flat_map_performance_test {
+
+using performance_test::report;
+using performance_test::scaled;
+using performance_test::timer;
+
+struct chaining_tag {};
+struct flat_tag {};
+
+typedef sup::telemetry_alloc<sup::alloc, chaining_tag> chaining_alloc;
+typedef sup::telemetry_alloc<sup::alloc, flat_tag> flat_alloc;
+
+// a fixed permutation of [0, n), n a power of two
+inline int scramble(size_t i, size_t n) {
+  return (int) ((i * 2654435761u) & (n - 1));
+}
+
+template <class Map, class Tag>
+void hash_table(const char* name, size_t n, size_t lookups) {
+  char line[64];
+  sup::alloc_telemetry<Tag>::reset();
+  {
+    Map m;
+
+    timer t;
+    for (size_t i = 0; i < n; ++i) {
+      int k = scramble(i, n);
+      m.insert(std::make_pair(2 * k, k));
+    }
+    std::snprintf(line, sizeof(line), "%s insert", name);
+    report(line, n, t.elapsed());
+    EXPECT_TRUE(m.size() == n);
+    std::printf("[   PERF   ]   %zu KB live, %.1f bytes per entry\n",
+                sup::alloc_telemetry<Tag>::snapshot().live_bytes >> 10,
+                (double) sup::alloc_telemetry<Tag>::snapshot().live_bytes / n);
+
+    // random keys: a permutation would visit the nodes of the chaining
+    // table in the order they were allocated
+    std::mt19937 random(7);
+    std::vector<int> keys(lookups);
+    for (size_t i = 0; i < lookups; ++i) {
+      keys[i] = (int) (random() & (2 * n - 1));
+    }
+    t.reset();
+    size_t found = 0;
+    for (size_t i = 0; i < lookups; ++i) {
+      // half of the keys are odd: not found
+      found += m.find(keys[i]) != m.end();
+    }
+    std::snprintf(line, sizeof(line), "%s lookup", name);
+    report(line, lookups, t.elapsed());
+    EXPECT_TRUE(found > 0 && found < lookups);
+
+    t.reset();
+    long long sum = 0;
+    for (typename Map::iterator it = m.begin(); it != m.end(); ++it) {
+      sum += (*it).second;
+    }
+    std::snprintf(line, sizeof(line), "%s iterate", name);
+    report(line, n, t.elapsed());
+    EXPECT_TRUE(sum == (long long) (n * (n - 1) / 2));
+
+    t.reset();
+    for (size_t i = 0; i < n; i += 2) {
+      m.erase(m.find(2 * scramble(i, n)));
+    }
+    for (size_t i = 0; i < n; i += 2) {
+      int k = scramble(i, n);
+      m.insert(std::make_pair(2 * k, k));
+    }
+    std::snprintf(line, sizeof(line), "%s erase & insert", name);
+    report(line, n, t.elapsed());
+    EXPECT_TRUE(m.size() == n);
+  }
+}
+
+TEST(unordered_flat_map_performance_test, hash_table) {
+  size_t n = 1 << 18;
+  size_t lookups = scaled(1 << 21);
+  hash_table<sup::unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+                                chaining_alloc>,
+             chaining_tag>("unordered_map<int, int>", n, lookups);
+  hash_table<sup::unordered_flat_map<int, int, std::hash<int>,
+                                     std::equal_to<int>, flat_alloc>,
+             flat_tag>("unordered_flat_map<int, int>", n, lookups);
+}
+
+}  // namespace unordered_flat_map_performance_test
@@ -0,0 +1,330 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+
+#include "../../src/sstl_alloc_telemetry.hpp"
+#include "../../src/sstl_deque.hpp"
+#include "../../src/sstl_small_vector.hpp"
+#include "../../src/sstl_vector.hpp"
+#include "performance_timer.hpp"
+
+// Growing a large vector: with the default allocator a trivially copyable
+// buffer is resized by realloc, and by mremap once it is mapped (above
+// __SSTL_MMAP_THRESHOLD), so the kernel moves pages instead of the vector
+// copying every element. naive_allocator has no reallocate, so each growth
+// allocates, copies and frees.
+
+namespace vector_performance_test {
+
+using performance_test::report;
+using performance_test::scaled;
+using performance_test::timer;
+
+template <class Alloc>
+double push_back_growth(size_t n) {
+  timer t;
+  sup::vector<int, Alloc> v;
+  for (size_t i = 0; i < n; ++i) v.push_back((int) i);
+  double ms = t.elapsed();
+  EXPECT_TRUE(v.size() == n && v[n - 1] == (int) (n - 1));
+  return ms;
+}
+
+TEST(vector_performance_test, large_push_back_growth) {
+  size_t n = scaled(1 << 23);
+  report("vector<int> push_back growth (naive_allocator)", n,
+         push_back_growth<sup::naive_allocator>(n));
+  report("vector<int> push_back growth (alloc, mremap)", n,
+         push_back_growth<sup::alloc>(n));
+}
+
+// Heavyweight elements: a growing vector moves its std::string and
+// sup::vector elements into the new buffer (their move constructors are
+// noexcept), so no inner buffer is copied. copy_only<T> has no move
+// constructor, which is what every growth did before: each inner buffer is
+// allocated and copied again.
+template <class T>
+class copy_only {
+ public:
+  copy_only(const T& v) : value(v) {}
+  copy_only(const copy_only& c) : value(c.value) {}
+  copy_only& operator=(const copy_only& c) {
+    value = c.value;
+    return *this;
+  }
+  size_t size() const { return value.size(); }
+
+ private:
+  T value;
+};
+
+static const std::string long_text =
+  "a string long enough to live on the heap instead of inside the object";
+
+template <class Elem, class Value>
+double heavyweight_push_back_growth(size_t n, const Value& value) {
+  timer t;
+  sup::vector<Elem> v;
+  for (size_t i = 0; i < n; ++i) v.push_back(Elem(value));
+  double ms = t.elapsed();
+  EXPECT_TRUE(v.size() == n && v[n - 1].size() == value.size());
+  return ms;
+}
+
+TEST(vector_performance_test, heavyweight_push_back_growth) {
+  size_t n = scaled(1 << 19);
+  report("vector<string> growth (copy)", n,
+         heavyweight_push_back_growth<copy_only<std::string>>(n, long_text));
+  report("vector<string> growth (move)", n,
+         heavyweight_push_back_growth<std::string>(n, long_text));
+
+  sup::vector<int> inner(64, 1);
+  n = scaled(1 << 17);
+  report("vector<vector<int>> growth (copy)", n,
+         heavyweight_push_back_growth<copy_only<sup::vector<int>>>(n, inner));
+  report("vector<vector<int>> growth (move)", n,
+         heavyweight_push_back_growth<sup::vector<int>>(n, inner));
+}
+
+// insertion in the middle of a deque shifts half of the elements
+template <class String>
+double deque_middle_insert(size_t n) {
+  timer t;
+  sup::deque<String> d;
+  for (size_t i = 0; i < n; ++i) {
+    d.insert(d.begin() + d.size() / 2, String(long_text));
+  }
+  double ms = t.elapsed();
+  EXPECT_TRUE(d.size() == n);
+  return ms;
+}
+
+TEST(vector_performance_test, deque_heavyweight_insert) {
+  size_t n = scaled(1 << 12);
+  report("deque<string> middle insert (copy)", n,
+         deque_middle_insert<copy_only<std::string>>(n));
+  report("deque<string> middle insert (move)", n,
+         deque_middle_insert<std::string>(n));
+}
+
+// Relocation: sup::vector is trivially relocatable, so a vector of them
+// grows by realloc and shifts its elements on insert & erase by memmove.
+// move_only<T> hides the trait: its elements are moved and destroyed one by
+// one.
+template <class T>
+class move_only {
+ public:
+  move_only(const T& v) : value(v) {}
+  move_only(move_only&& m) noexcept : value(std::move(m.value)) {}
+  move_only& operator=(move_only&& m) noexcept {
+    value = std::move(m.value);
+    return *this;
+  }
+  size_t size() const { return value.size(); }
+
+ private:
+  T value;
+};
+
+template <class Elem>
+double front_insert_and_erase(size_t n, size_t rounds,
+                              const sup::vector<int>& inner) {
+  sup::vector<Elem> v;
+  for (size_t i = 0; i < n; ++i) v.push_back(Elem(inner));
+  timer t;
+  for (size_t i = 0; i < rounds; ++i) {
+    v.insert(v.begin(), Elem(inner));
+    v.erase(v.begin() + v.size() / 2);
+  }
+  double ms = t.elapsed();
+  EXPECT_TRUE(v.size() == n && v[0].size() == inner.size());
+  return ms;
+}
+
+TEST(vector_performance_test, relocating_elements) {
+  sup::vector<int> inner(4, 1);
+  size_t n = scaled(1 << 17);
+  report("vector<vector<int>> growth (move & destroy)", n,
+         heavyweight_push_back_growth<move_only<sup::vector<int>>>(n, inner));
+  report("vector<vector<int>> growth (relocate)", n,
+         heavyweight_push_back_growth<sup::vector<int>>(n, inner));
+
+  // counted in elements shifted
+  size_t rounds = scaled(1 << 8);
+  report("vector<vector<int>> front insert & erase (move)", rounds * n,
+         front_insert_and_erase<move_only<sup::vector<int>>>(n, rounds, inner));
+  report("vector<vector<int>> front insert & erase (relocate)", rounds * n,
+         front_insert_and_erase<sup::vector<int>>(n, rounds, inner));
+}
+
+// Short vectors: most vectors built per request hold a handful of
+// elements. A small_vector keeps up to 8 of them inline, so building and
+// dropping it never reaches the allocator.
+struct short_vector_tag {};
+struct short_small_vector_tag {};
+
+template <class Vector>
+double short_vectors(size_t n) {
+  size_t total = 0;
+  timer t;
+  for (size_t i = 0; i < n; ++i) {
+    Vector v;
+    for (size_t j = 0; j <= i % 8; ++j) v.push_back((int) j);
+    v.insert(v.begin(), -1);  // at most 9 elements
+    total += v.size();
+  }
+  double ms = t.elapsed();
+  EXPECT_TRUE(total > n);
+  return ms;
+}
+
+TEST(vector_performance_test, short_vectors) {
+  typedef sup::telemetry_alloc<sup::alloc, short_vector_tag> vector_alloc;
+  typedef sup::telemetry_alloc<sup::alloc, short_small_vector_tag> small_alloc;
+  sup::alloc_telemetry<short_vector_tag>::reset();
+  sup::alloc_telemetry<short_small_vector_tag>::reset();
+
+  size_t n = scaled(1 << 20);
+  report("vector<int> of 2 to 9 elements", n,
+         short_vectors<sup::vector<int, vector_alloc>>(n));
+  report("small_vector<int, 8> of 2 to 9 elements", n,
+         short_vectors<sup::small_vector<int, 8, small_alloc>>(n));
+
+  sup::alloc_stats_snapshot v = sup::alloc_telemetry<short_vector_tag>::snapshot();
+  sup::alloc_stats_snapshot s =
+      sup::alloc_telemetry<short_small_vector_tag>::snapshot();
+  std::printf("[   PERF   ] allocations: vector %zu, small_vector %zu\n",
+              v.allocations, s.allocations);
+  // only the vectors of 9 elements overflow
+  EXPECT_TRUE(s.allocations == n / 8 && v.allocations > n);
+}
+
+// Growth policies: a vector of n ints grown by push_back. Reported per
+// policy: the number of reallocations, the bytes of elements relocated on
+// the way (an upper bound: realloc may extend in place), the peak of the
+// live bytes of the vector (its share of the peak RSS) and the unused part
+// of the final buffer.
+struct growth_2_tag {};
+struct growth_1_5_tag {};
+struct growth_size_class_tag {};
+
+template <class Growth, class Tag>
+void growth_policy(const char* name, size_t n) {
+  typedef sup::telemetry_alloc<sup::alloc, Tag> alloc_type;
+  sup::alloc_telemetry<Tag>::reset();
+  size_t relocated_bytes = 0;
+  size_t unused = 0;
+
+  timer t;
+  {
+    sup::vector<int, alloc_type, Growth> v;
+    for (size_t i = 0; i < n; ++i) {
+      if (v.size() == v.capacity()) relocated_bytes += v.size() * sizeof(int);
+      v.push_back((int) i);
+    }
+    unused = v.capacity() - v.size();
+    EXPECT_TRUE(v.size() == n);
+  }
+  double ms = t.elapsed();
+
+  sup::alloc_stats_snapshot s = sup::alloc_telemetry<Tag>::snapshot();
+  report(name, n, ms);
+  std::printf("[   PERF   ]   %zu reallocations, %zu KB relocated, %zu KB peak, "
+              "%.1f%% unused\n",
+              s.allocations, relocated_bytes >> 10, s.peak_bytes >> 10,
+              100.0 * unused / (unused + n));
+}
+
+TEST(vector_performance_test, growth_policies) {
+  size_t n = scaled(3000000);
+  growth_policy<sup::growth_factor_2, growth_2_tag>(
+      "vector<int> growth (2x)", n);
+  growth_policy<sup::growth_factor_1_5, growth_1_5_tag>(
+      "vector<int> growth (1.5x)", n);
+  growth_policy<sup::growth_size_class, growth_size_class_tag>(
+      "vector<int> growth (size classes)", n);
+}
+
+// Sizing a buffer that is overwritten right after (read(), a decoder...):
+// resize(n) value initializes (zeroes) the n bytes first, resize_for_overwrite
+// only moves finish. Most of the time left is spent faulting in the fresh
+// pages of the mapped block.
+template <bool Overwrite>
+double resize_then_fill(size_t n, size_t rounds) {
+  timer t;
+  for (size_t r = 0; r < rounds; ++r) {
+    sup::vector<char> buffer;
+    if (Overwrite) {
+      buffer.resize_for_overwrite(n);
+    } else {
+      buffer.resize(n);
+    }
+    std::memset(&buffer[0], (int) r, n);
+    EXPECT_TRUE(buffer[n - 1] == (char) r);
+  }
+  return t.elapsed();
+}
+
+TEST(vector_performance_test, resize_for_overwrite) {
+  size_t n = 1 << 24;
+  size_t rounds = scaled(16);
+  // one operation per byte
+  report("vector<char> resize + fill (16 MB)", n * rounds,
+         resize_then_fill<false>(n, rounds));
+  report("vector<char> resize_for_overwrite + fill (16 MB)", n * rounds,
+         resize_then_fill<true>(n, rounds));
+}
+
+// Removing a share of the elements picked at random (so a branch on the
+// predicate cannot be predicted): erase() in a loop shifts the tail each
+// time, erase_if compacts in one pass. The random keys are the same for
+// every container.
+struct removal_ratio {
+  const char* name;
+  unsigned percent;
+};
+
+template <class Container>
+double erase_loop(size_t n, unsigned percent) {
+  Container c;
+  for (size_t i = 0; i < n; ++i) c.push_back((int) ((i * 2654435761u) % 100));
+  timer t;
+  for (typename Container::iterator it = c.begin(); it != c.end();) {
+    if ((unsigned) *it < percent)
+      it = c.erase(it);
+    else
+      ++it;
+  }
+  double ms = t.elapsed();
+  EXPECT_TRUE(c.size() <= n);
+  return ms;
+}
+
+template <class Container>
+double erase_if_pass(size_t n, unsigned percent) {
+  Container c;
+  for (size_t i = 0; i < n; ++i) c.push_back((int) ((i * 2654435761u) % 100));
+  timer t;
+  sup::erase_if(c, [percent](int x) { return (unsigned) x < percent; });
+  double ms = t.elapsed();
+  EXPECT_TRUE(c.size() <= n);
+  return ms;
+}
+
+TEST(vector_performance_test, erase_if) {
+  const removal_ratio ratios[] = {
+      {"1%", 1}, {"10%", 10}, {"50%", 50}, {"90%", 90}};
+  size_t small_n = scaled(1 << 15);
+  size_t n = scaled(1 << 23);
+  char name[64];
+  for (const removal_ratio& r : ratios) {
+    std::snprintf(name, sizeof(name), "vector<int> erase loop (%s, 32K)", r.name);
+    report(name, small_n, erase_loop<sup::vector<int>>(small_n, r.percent));
+    std::snprintf(name, sizeof(name), "vector<int> erase_if (%s)", r.name);
+    report(name, n, erase_if_pass<sup::vector<int>>(n, r.percent));
+    std::snprintf(name, sizeof(name), "deque<int> erase_if (%s)", r.name);
+    report(name, n, erase_if_pass<sup::deque<int>>(n, r.percent));
+  }
+}
+
+}  // namespace vector_performance_test